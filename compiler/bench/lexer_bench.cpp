@@ -0,0 +1,133 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词法分析吞吐基准
+ *
+ * 用法：lexer_bench [MB 数 | 源文件路径] [轮数]
+ * 默认生成约 16MB 以 ASCII 为主的源码（缩进、注释、字符串、长标识符），
+ * 依次以各可用扫描内核级别（scalar / sse2 / avx2）测量多轮，输出每个级别的最好成绩：
+ *   scan      逐个 next_token 不保存，只含扫描与 token 构造
+ *   tokenize  完整 tokenize，另含写入 token 数组（大文件时首次触碰新内存的开销明显）
+ * 并核对各级别产出的 token 完全一致。
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+#include "scan_kernels.h"
+#include "source_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// 贴近真实代码的排版：文档注释、缩进、较长的标识符与字符串
+std::string generate_source(size_t target_bytes) {
+    std::string src;
+    src.reserve(target_bytes + 1024);
+    for (size_t i = 0; src.size() < target_bytes; ++i) {
+        std::string n = std::to_string(i);
+        src += "/*\n";
+        src += " * accumulate_weighted_samples" + n + " walks the sample buffer and folds\n";
+        src += " * every reading into a running total, skipping calibration markers.\n";
+        src += " */\n";
+        src += "function accumulate_weighted_samples" + n +
+               "(number sample_count, number weight_factor) number {\n";
+        src += "    number running_total = 0;        // accumulated weighted value\n";
+        src += "    string description = \"weighted accumulation over the sample window\";\n";
+        src += "    for (number index = 0; index < sample_count; index = index + 1) {\n";
+        src += "        if (index % 16 == 0 && weight_factor > 2) {\n";
+        src += "            running_total = running_total + index * weight_factor;\n";
+        src += "        } else {\n";
+        src += "            running_total += normalize_reading" + n + "(index, description);\n";
+        src += "        }\n";
+        src += "    }\n";
+        src += "    return running_total;\n";
+        src += "}\n\n";
+    }
+    return src;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::unique_ptr<collie::SourceFile> source;
+    if (argc > 1 && std::atoi(argv[1]) <= 0) {
+        std::string error;
+        source = collie::SourceFile::read(argv[1], error);
+        if (!source) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    } else {
+        size_t megabytes = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 16;
+        source = std::make_unique<collie::SourceFile>(generate_source(megabytes << 20));
+    }
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (rounds <= 0) rounds = 5;
+
+    const double megabytes = static_cast<double>(source->size()) / (1024.0 * 1024.0);
+    std::printf("source: %.2f MB, best kernel level: %s\n\n", megabytes,
+                collie::scan::level_name(collie::scan::best_level()));
+    std::printf("%-8s %10s %10s %10s %12s %10s\n", "level", "tokens", "scan ms", "MB/s",
+                "tokenize ms", "MB/s");
+
+    std::vector<collie::Token> reference;
+    const collie::scan::ScanLevel levels[] = {collie::scan::ScanLevel::Scalar,
+                                              collie::scan::ScanLevel::SSE2,
+                                              collie::scan::ScanLevel::AVX2};
+    for (collie::scan::ScanLevel requested : levels) {
+        if (collie::scan::set_level(requested) != requested) {
+            continue;  // CPU 或平台不支持
+        }
+        double best_scan = 1e300;
+        double best_tokenize = 1e300;
+        std::vector<collie::Token> tokens;
+        for (int r = 0; r < rounds; ++r) {
+            auto t0 = Clock::now();
+            collie::Lexer scanner(*source);
+            size_t count = 0;
+            while (!scanner.next_token().is_eof()) {
+                ++count;
+            }
+            auto t1 = Clock::now();
+            collie::Lexer lexer(*source);
+            tokens = lexer.tokenize();
+            auto t2 = Clock::now();
+            if (count + 1 != tokens.size()) {
+                std::fprintf(stderr, "next_token and tokenize disagree\n");
+                return 1;
+            }
+            best_scan = std::min(best_scan, ms_between(t0, t1));
+            best_tokenize = std::min(best_tokenize, ms_between(t1, t2));
+        }
+
+        if (reference.empty()) {
+            reference = tokens;
+        } else if (tokens.size() != reference.size() ||
+                   !std::equal(tokens.begin(), tokens.end(), reference.begin(),
+                               [](const collie::Token& a, const collie::Token& b) {
+                                   return a.type() == b.type() && a.lexeme() == b.lexeme() &&
+                                          a.line() == b.line() && a.column() == b.column();
+                               })) {
+            std::fprintf(stderr, "%s kernels produced different tokens\n",
+                         collie::scan::level_name(requested));
+            return 1;
+        }
+        std::printf("%-8s %10zu %10.2f %10.1f %12.2f %10.1f\n",
+                    collie::scan::level_name(requested), tokens.size(), best_scan,
+                    megabytes / (best_scan / 1000.0), best_tokenize,
+                    megabytes / (best_tokenize / 1000.0));
+    }
+    collie::scan::set_level(collie::scan::best_level());
+    return 0;
+}
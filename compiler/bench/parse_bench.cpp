@@ -0,0 +1,139 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词法分析、语法分析与 AST 销毁耗时基准
+ *
+ * 用法：parse_bench [函数个数] [轮数]
+ * 生成一份由大量函数与类组成的源码，重复多轮，输出每个阶段的最好成绩及节点数、内存占用：
+ *   lex      完整 tokenize（token 词素是源码切片，除 token 数组外不应有按 token 的分配）
+ *   parse    从上述 token 数组解析（含词素驻留）
+ *   stream   Parser 直接从 Lexer 拉取 token 解析，不生成 token 数组
+ *   destroy  整棵树的销毁
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+#include "parser.h"
+#include "source_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// 每个函数覆盖声明、循环、分支、调用、数组、插值字符串等常见节点
+std::string generate_source(int functions) {
+    std::string src;
+    src.reserve(static_cast<size_t>(functions) * 640);
+    for (int i = 0; i < functions; ++i) {
+        std::string n = std::to_string(i);
+        src += "function compute" + n + "(a number, b number) number {\n";
+        src += "    number total = 0;\n";
+        src += "    for (number i = 0; i < a; i = i + 1) {\n";
+        src += "        if (i % 3 == 0 && b > 2) {\n";
+        src += "            total = total + i * b - (a / 2);\n";
+        src += "        } else {\n";
+        src += "            total += helper" + n + "(i, \"label_" + n + "\");\n";
+        src += "        }\n";
+        src += "    }\n";
+        src += "    array values = [a, b, total, " + n + "];\n";
+        src += "    while (total > 1000) { total = total - values[1]; }\n";
+        src += "    print(@\"compute" + n + " = {total}\");\n";
+        src += "    return total;\n";
+        src += "}\n";
+        src += "class Point" + n + " {\n";
+        src += "    public number x;\n";
+        src += "    public number y;\n";
+        src += "    public function length() number { return this.x * this.x + this.y * this.y; }\n";
+        src += "}\n";
+    }
+    return src;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (functions <= 0) functions = 20000;
+    if (rounds <= 0) rounds = 5;
+
+    const collie::SourceFile source(generate_source(functions));
+    std::vector<collie::Token> tokens;
+
+    double best_lex = 1e300;
+    double best_parse = 1e300;
+    double best_stream = 1e300;
+    double best_destroy = 1e300;
+    size_t nodes = 0;
+    size_t bytes = 0;
+    size_t statements = 0;
+
+    for (int r = 0; r < rounds; ++r) {
+        auto l0 = Clock::now();
+        collie::Lexer lexer(source);
+        tokens = lexer.tokenize();
+        auto l1 = Clock::now();
+        best_lex = std::min(best_lex, ms_between(l0, l1));
+
+        auto t1 = Clock::now();
+        std::optional<collie::Parser> parser;
+        parser.emplace(tokens);
+        std::optional<collie::ParsedProgram> program;
+        program.emplace(parser->parse_program());
+        auto t2 = Clock::now();
+
+        if (!parser->get_errors().empty()) {
+            std::fprintf(stderr, "generated source has %zu syntax errors\n",
+                         parser->get_errors().size());
+            return 1;
+        }
+        nodes = program->context()->node_count();
+        bytes = program->context()->bytes_reserved();
+        statements = program->size();
+
+        auto t3 = Clock::now();
+        program.reset();
+        parser.reset();
+        auto t4 = Clock::now();
+
+        best_parse = std::min(best_parse, ms_between(t1, t2));
+        best_destroy = std::min(best_destroy, ms_between(t3, t4));
+
+        auto s0 = Clock::now();
+        collie::Lexer stream_lexer(source);
+        collie::Parser stream_parser(stream_lexer);
+        collie::ParsedProgram streamed = stream_parser.parse_program();
+        auto s1 = Clock::now();
+        if (streamed.context()->node_count() != nodes) {
+            std::fprintf(stderr, "streaming parse produced a different AST\n");
+            return 1;
+        }
+        best_stream = std::min(best_stream, ms_between(s0, s1));
+    }
+
+    std::printf("source: %.2f MB, %zu tokens, %zu top-level statements\n",
+                static_cast<double>(source.size()) / (1024.0 * 1024.0), tokens.size(),
+                statements);
+    std::printf("AST: %zu nodes, %.2f MB reserved\n", nodes,
+                static_cast<double>(bytes) / (1024.0 * 1024.0));
+    std::printf("token array: %.2f MB (stream mode keeps %zu tokens)\n\n",
+                static_cast<double>(tokens.size() * sizeof(collie::Token)) / (1024.0 * 1024.0),
+                collie::TokenStream::WINDOW);
+    std::printf("%-10s %10s\n", "phase", "best ms");
+    std::printf("%-10s %10.2f\n", "lex", best_lex);
+    std::printf("%-10s %10.2f\n", "parse", best_parse);
+    std::printf("%-10s %10.2f\n", "lex+parse", best_lex + best_parse);
+    std::printf("%-10s %10.2f\n", "stream", best_stream);
+    std::printf("%-10s %10.2f\n", "destroy", best_destroy);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 语义分析耗时基准
+ *
+ * 用法：semantic_bench [函数个数] [轮数] [线程数]
+ * 生成一份能通过语义检查的源码（大量全局变量、函数与类，函数体内多层块作用域），
+ * 先解析一次，再对同一棵 AST 重复分析多轮，输出分析的最好成绩。
+ * 全局作用域随函数个数增长，每个函数体内的名字查找都要穿过它。
+ * 线程数为函数体/类体并行检查的线程数，缺省时取硬件并发数。
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "lexer.h"
+#include "parser.h"
+#include "semantic_analyzer.h"
+#include "source_file.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+std::string generate_source(int functions) {
+    std::string src;
+    src.reserve(static_cast<size_t>(functions) * 900);
+    for (int i = 0; i < functions; ++i) {
+        std::string n = std::to_string(i);
+        src += "number limit" + n + " = " + n + ";\n";
+        src += "function helper" + n + "(x number, label string) number {\n";
+        src += "    string tag = label + x;\n";
+        src += "    return x * 2 + limit" + n + ";\n";
+        src += "}\n";
+        src += "function compute" + n + "(a number, b number) number {\n";
+        src += "    number total = 0;\n";
+        src += "    for (number i = 0; i < a; i = i + 1) {\n";
+        src += "        number step = i * b;\n";
+        src += "        if (i % 3 == 0 && b > 2) {\n";
+        src += "            number bonus = step - (a / 2);\n";
+        src += "            total = total + bonus;\n";
+        src += "        } else {\n";
+        src += "            total += helper" + n + "(i, \"label_" + n + "\");\n";
+        src += "        }\n";
+        src += "    }\n";
+        src += "    array values = [a, b, total, limit" + n + "];\n";
+        src += "    while (total > 1000) { total = total - values[1]; }\n";
+        src += "    print(@\"compute" + n + " = {total}\");\n";
+        src += "    return total;\n";
+        src += "}\n";
+        src += "class Point" + n + " {\n";
+        src += "    public number x = 0;\n";
+        src += "    public number y = 0;\n";
+        src += "    public function length() number { return this.x * this.x + this.y * this.y; }\n";
+        src += "}\n";
+    }
+    return src;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int functions = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+    if (functions <= 0) functions = 20000;
+    if (rounds <= 0) rounds = 5;
+    int jobs = argc > 3 ? std::atoi(argv[3]) : 0;
+
+    const collie::SourceFile source(generate_source(functions));
+    collie::Lexer lexer(source);
+    collie::Parser parser(lexer);
+    collie::ParsedProgram program = parser.parse_program();
+    if (!parser.get_errors().empty()) {
+        std::fprintf(stderr, "generated source has %zu syntax errors\n",
+                     parser.get_errors().size());
+        return 1;
+    }
+
+    double best_analyze = 1e300;
+    for (int r = 0; r < rounds; ++r) {
+        collie::SemanticAnalyzer analyzer;
+        if (jobs > 0) analyzer.set_jobs(static_cast<size_t>(jobs));
+        auto t0 = Clock::now();
+        analyzer.analyze(program);
+        auto t1 = Clock::now();
+        if (analyzer.has_errors()) {
+            std::fprintf(stderr, "generated source has %zu semantic errors, first: %s\n",
+                         analyzer.get_errors().size(), analyzer.get_errors().front().what());
+            return 1;
+        }
+        best_analyze = std::min(best_analyze, ms_between(t0, t1));
+    }
+
+    std::printf("source: %.2f MB, %zu top-level statements, %zu AST nodes\n\n",
+                static_cast<double>(source.size()) / (1024.0 * 1024.0), program.size(),
+                program.context()->node_count());
+    std::printf("%-10s %10s\n", "phase", "best ms");
+    std::printf("%-10s %10.2f\n", "analyze", best_analyze);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: Value 拷贝/移动开销微基准
+ *
+ * 用法：value_bench [轮数]
+ * 对每种值分别测量：拷贝赋值、移动赋值、拷贝构造进 vector（模拟实参列表），
+ * 输出每次操作的平均纳秒数。堆载荷值（字符串/数组/大整数）的拷贝只增减引用计数。
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "value.h"
+
+namespace {
+
+using collie::BigInt;
+using collie::Value;
+
+constexpr size_t kBatch = 1 << 14;  // 每轮操作的值个数
+
+using Clock = std::chrono::steady_clock;
+
+double ns_per_op(Clock::time_point begin, Clock::time_point end, size_t ops) {
+    return std::chrono::duration<double, std::nano>(end - begin).count() /
+           static_cast<double>(ops);
+}
+
+// 防止优化器把基准循环整体消除
+volatile size_t g_sink = 0;
+
+void bench(const char* name, const Value& sample, int rounds) {
+    const size_t ops = kBatch * static_cast<size_t>(rounds);
+    std::vector<Value> src(kBatch, sample);
+    std::vector<Value> dst(kBatch);
+
+    // 拷贝赋值
+    auto begin = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            dst[i] = src[i];
+        }
+        g_sink = g_sink + static_cast<size_t>(dst[r % kBatch].kind());
+    }
+    double copy_ns = ns_per_op(begin, Clock::now(), ops);
+
+    // 移动赋值：来回搬运，保证每次移动的源都持有载荷
+    begin = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<Value>& from = (r % 2 == 0) ? dst : src;
+        std::vector<Value>& to = (r % 2 == 0) ? src : dst;
+        for (size_t i = 0; i < kBatch; ++i) {
+            to[i] = std::move(from[i]);
+        }
+        g_sink = g_sink + static_cast<size_t>(to[r % kBatch].kind());
+    }
+    double move_ns = ns_per_op(begin, Clock::now(), ops);
+
+    // 拷贝构造进新 vector（实参列表、数组字面量的典型路径）
+    const std::vector<Value>& filled = (rounds % 2 == 0) ? src : dst;
+    begin = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<Value> args(filled.begin(), filled.end());
+        g_sink = g_sink + args.size();
+    }
+    double construct_ns = ns_per_op(begin, Clock::now(), ops);
+
+    std::printf("%-10s %12.2f %12.2f %16.2f\n", name, copy_ns, move_ns, construct_ns);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+    if (rounds <= 0) rounds = 200;
+
+    std::printf("sizeof(Value) = %zu bytes, %zu values x %d rounds\n\n",
+                sizeof(Value), kBatch, rounds);
+    std::printf("%-10s %12s %12s %16s\n", "kind", "copy ns/op", "move ns/op",
+                "construct ns/op");
+
+    bench("none", Value::none(), rounds);
+    bench("bool", Value::boolean(true), rounds);
+    bench("decimal", Value::number(3.25), rounds);
+    bench("integer", Value::integer(BigInt(42)), rounds);
+    bench("string", Value::str(std::string(32, 'x')), rounds);
+    bench("array", Value::array(Value::ArrayStorage(8, Value::number(1.0))), rounds);
+    return 0;
+}
@@ -12,10 +12,19 @@
 #include <functional>
 #include <set>
 
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/CFG.h>
 #include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/PassTimingInfo.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Host.h>
 #include <llvm/TargetParser/Triple.h>
 
@@ -23,6 +32,24 @@ namespace collie {
 
 namespace {
 
+/// number 值在生成期可见的分量：make_num 以 insertvalue 组装（全常量时折叠为
+/// 常量 struct），沿链找到 index 分量直接返回，免 extractvalue；找不到返回 nullptr
+llvm::Value* num_component(llvm::Value* num, unsigned index) {
+    while (auto* insert = llvm::dyn_cast<llvm::InsertValueInst>(num)) {
+        if (insert->getIndices()[0] == index) {
+            return insert->getInsertedValueOperand();
+        }
+        num = insert->getAggregateOperand();
+    }
+    if (auto* constant = llvm::dyn_cast<llvm::Constant>(num)) {
+        llvm::Constant* element = constant->getAggregateElement(index);
+        if (element != nullptr && !llvm::isa<llvm::UndefValue>(element)) {
+            return element;
+        }
+    }
+    return nullptr;
+}
+
 /// 条件发射区深度 RAII（t117）：构造 +1 析构 -1（C++ 栈帧作用域即区内发射
 /// 作用域——区末汇合/PHI 无用户语句发射，析构时机恒等于区退出）
 struct CondDepthGuard {
@@ -140,9 +167,14 @@ struct CondDepthGuard {
 
 } // namespace
 
-CodeGenerator::CodeGenerator() : builder_(context_) {}
+CodeGenerator::CodeGenerator()
+    : owned_context_(std::make_unique<llvm::LLVMContext>()),
+      context_(*owned_context_),
+      builder_(context_) {}
 
-void CodeGenerator::generate(const std::vector<std::unique_ptr<Stmt>>& statements,
+CodeGenerator::~CodeGenerator() = default;
+
+void CodeGenerator::generate(const std::vector<StmtPtr>& statements,
                              const std::string& module_name) {
     module_ = std::make_unique<llvm::Module>(module_name, context_);
     // 显式标记宿主 target triple，免得 clang 编 .ll 时报 override-module 警告
@@ -273,17 +305,9 @@ void CodeGenerator::generate(const std::vector<std::unique_ptr<Stmt>>& statement
         llvm::FunctionType::get(ptr_ty, {builder_.getInt64Ty()}, false));
 
     // collie_rt number 运行时声明（t62，CG5 收窄）：tagged 双表示（tag 0=整数
-    // i64 / 1=小数 double 位模式），算术/比较/转串在运行时单点对齐解释器；
-    // 结果经出参写回（16 字节 struct 返回在 Win x64 走隐藏指针，出参避开 ABI 错配）
+    // i64 / 1=小数 double 位模式）；算术/比较在 codegen 侧按表示专用化内联
+    //（num_arith/num_cmp），转串/打印/解析仍在运行时单点对齐解释器
     llvm::Type* i64_ty = builder_.getInt64Ty();
-    rt_num_arith_ = module_->getOrInsertFunction(
-        "collie_rt_num_arith",
-        llvm::FunctionType::get(
-            void_ty, {i64_ty, i64_ty, i64_ty, i64_ty, i64_ty, ptr_ty, ptr_ty}, false));
-    rt_num_cmp_ = module_->getOrInsertFunction(
-        "collie_rt_num_cmp",
-        llvm::FunctionType::get(builder_.getInt32Ty(),
-                                {i64_ty, i64_ty, i64_ty, i64_ty, i64_ty}, false));
     rt_num_to_str_ = module_->getOrInsertFunction(
         "collie_rt_num_to_str",
         llvm::FunctionType::get(ptr_ty, {i64_ty, i64_ty}, false));
@@ -348,6 +372,91 @@ void CodeGenerator::generate(const std::vector<std::unique_ptr<Stmt>>& statement
     }
 }
 
+llvm::TargetMachine* CodeGenerator::target_machine(OptLevel level) {
+    if (target_machine_) {
+        return target_machine_.get();
+    }
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    const std::string triple = llvm::sys::getDefaultTargetTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (target == nullptr) {
+        throw CodeGenError("no LLVM target for '" + triple + "': " + error, 0, 0);
+    }
+    llvm::CodeGenOptLevel backend_level = llvm::CodeGenOptLevel::None;
+    switch (level) {
+        case OptLevel::O0: backend_level = llvm::CodeGenOptLevel::None; break;
+        case OptLevel::O1: backend_level = llvm::CodeGenOptLevel::Less; break;
+        case OptLevel::O2: backend_level = llvm::CodeGenOptLevel::Default; break;
+        case OptLevel::O3: backend_level = llvm::CodeGenOptLevel::Aggressive; break;
+    }
+    // generic CPU：产物可在同架构任意机器运行（与 clang 默认一致）；
+    // PIC：Linux 工具链默认链接 PIE，Windows COFF 下无影响
+    target_machine_.reset(target->createTargetMachine(
+        llvm::Triple(triple), "generic", "", llvm::TargetOptions(), llvm::Reloc::PIC_,
+        {}, backend_level));
+    if (!target_machine_) {
+        throw CodeGenError("cannot create LLVM target machine for '" + triple + "'", 0, 0);
+    }
+    return target_machine_.get();
+}
+
+void CodeGenerator::optimize(OptLevel level, bool time_passes) {
+    llvm::TargetMachine* machine = target_machine(level);
+    module_->setDataLayout(machine->createDataLayout());
+    optimize_module(*module_, machine, level, time_passes);
+}
+
+void CodeGenerator::optimize_module(llvm::Module& module, llvm::TargetMachine* machine,
+                                    OptLevel level, bool time_passes) {
+    // 插桩回调与计时器须比各分析管理器活得久（管理器持有其指针）
+    llvm::PassInstrumentationCallbacks instrumentation;
+    llvm::TimePassesHandler pass_timer(time_passes);
+    pass_timer.registerCallbacks(instrumentation);
+
+    llvm::LoopAnalysisManager loop_analyses;
+    llvm::FunctionAnalysisManager function_analyses;
+    llvm::CGSCCAnalysisManager cgscc_analyses;
+    llvm::ModuleAnalysisManager module_analyses;
+    llvm::PassBuilder pass_builder(machine, llvm::PipelineTuningOptions(), {},
+                                   &instrumentation);
+    pass_builder.registerModuleAnalyses(module_analyses);
+    pass_builder.registerCGSCCAnalyses(cgscc_analyses);
+    pass_builder.registerFunctionAnalyses(function_analyses);
+    pass_builder.registerLoopAnalyses(loop_analyses);
+    pass_builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses,
+                                      module_analyses);
+
+    llvm::ModulePassManager passes;
+    switch (level) {
+        case OptLevel::O0:
+            passes = pass_builder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+            break;
+        case OptLevel::O1:
+            passes = pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O1);
+            break;
+        case OptLevel::O2:
+            passes = pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+            break;
+        case OptLevel::O3:
+            passes = pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O3);
+            break;
+    }
+    passes.run(module, module_analyses);
+
+    if (time_passes) {
+        pass_timer.print();
+    }
+}
+
+std::pair<std::unique_ptr<llvm::LLVMContext>, std::unique_ptr<llvm::Module>>
+CodeGenerator::release_module() {
+    builder_.ClearInsertionPoint();
+    return {std::move(owned_context_), std::move(module_)};
+}
+
 std::string CodeGenerator::emit_ir() const {
     std::string out;
     llvm::raw_string_ostream stream(out);
@@ -355,6 +464,40 @@ std::string CodeGenerator::emit_ir() const {
     return stream.str();
 }
 
+void CodeGenerator::emit_object(const std::string& path, OptLevel level) {
+    llvm::TargetMachine* machine = target_machine(level);
+    module_->setDataLayout(machine->createDataLayout());
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(path, error, llvm::sys::fs::OF_None);
+    if (error) {
+        throw CodeGenError("cannot write object file '" + path + "': " + error.message(), 0, 0);
+    }
+    // 后端仍是旧 PassManager：指令选择、寄存器分配与 MC 输出由 TargetMachine 组装
+    llvm::legacy::PassManager passes;
+    if (machine->addPassesToEmitFile(passes, out, nullptr, llvm::CodeGenFileType::ObjectFile)) {
+        throw CodeGenError("LLVM target cannot emit object files", 0, 0);
+    }
+    passes.run(*module_);
+    out.flush();
+    if (out.has_error()) {
+        throw CodeGenError("failed writing object file '" + path + "'", 0, 0);
+    }
+}
+
+void CodeGenerator::emit_bitcode(const std::string& path) const {
+    std::error_code error;
+    llvm::raw_fd_ostream out(path, error, llvm::sys::fs::OF_None);
+    if (error) {
+        throw CodeGenError("cannot write bitcode file '" + path + "': " + error.message(), 0, 0);
+    }
+    llvm::WriteBitcodeToFile(*module_, out);
+    out.flush();
+    if (out.has_error()) {
+        throw CodeGenError("failed writing bitcode file '" + path + "'", 0, 0);
+    }
+}
+
 CodeGenerator::CGValue CodeGenerator::emit(const Expr* expr) {
     expr->accept(*this);
     return last_value_;
@@ -464,7 +607,7 @@ void CodeGenerator::visitBinary(const BinaryExpr& expr) {
             require_numeric(lhs);
             require_numeric(rhs);
             if (has_num) {
-                last_value_ = {call_num_arith(3, to_num(lhs), to_num(rhs)), CGType::Num};
+                last_value_ = {num_arith(3, to_num(lhs), to_num(rhs)), CGType::Num};
                 return;
             }
             last_value_ = {builder_.CreateFDiv(to_double(lhs), to_double(rhs), "divtmp"),
@@ -475,63 +618,25 @@ void CodeGenerator::visitBinary(const BinaryExpr& expr) {
             // '%' floor 取模（SPEC §4，结果符号与除数一致）：
             //   r = srem(a, b); r 非零且与 b 异号时 r += b（select 无分支实现）
             if (has_num) {
-                // number 参与（t62）：下沉运行时（双整数 floor 取模、除零落
-                // double 路径 NaN，对齐解释器 eval_arithmetic）
+                // number 参与（t62）：双整数 floor 取模、除零落 double 路径 NaN
+                //（对齐解释器 eval_arithmetic），按表示专用化内联
                 require_numeric(lhs);
                 require_numeric(rhs);
-                last_value_ = {call_num_arith(4, to_num(lhs), to_num(rhs)), CGType::Num};
+                last_value_ = {num_arith(4, to_num(lhs), to_num(rhs)), CGType::Num};
                 return;
             }
             if (lhs.type == CGType::Double || rhs.type == CGType::Double) {
-                // decimal 参与（t80）：FRem 语义即 fmod（截断取余），floor 修正
-                // 对齐解释器 eval_arithmetic——r 非零且与除数异号时 r += b；
-                // 除零 FRem 天然 NaN，且 NaN 使 ONE 比较为 false 不触发修正
-                // （与解释器 b==0.0 提前返 NaN 殊途同归）；-0.0 == 0.0 使
-                // nonzero 为 false 同解释器 r != 0.0 判定
+                // decimal 参与（t80）：fmod + floor 修正，见 double_floor_mod
                 require_numeric(lhs);
                 require_numeric(rhs);
-                llvm::Value* l = to_double(lhs);
-                llvm::Value* r = to_double(rhs);
-                llvm::Value* rem = builder_.CreateFRem(l, r, "fremtmp");
-                llvm::Value* fzero =
-                    llvm::ConstantFP::get(builder_.getDoubleTy(), 0.0);
-                llvm::Value* nonzero = builder_.CreateFCmpONE(rem, fzero);
-                llvm::Value* rem_neg = builder_.CreateFCmpOLT(rem, fzero);
-                llvm::Value* rhs_neg = builder_.CreateFCmpOLT(r, fzero);
-                llvm::Value* sign_diff = builder_.CreateICmpNE(rem_neg, rhs_neg);
-                llvm::Value* need_fix = builder_.CreateAnd(nonzero, sign_diff);
-                llvm::Value* fixed = builder_.CreateFAdd(rem, r, "fremfix");
-                last_value_ = {builder_.CreateSelect(need_fix, fixed, rem,
-                                                     "floorfmod"),
+                last_value_ = {double_floor_mod(to_double(lhs), to_double(rhs)),
                                CGType::Double};
                 return;
             }
             if (lhs.type != CGType::Int || rhs.type != CGType::Int) {
                 unsupported("'%' on non-integer operands", op.line(), op.column());
             }
-            // INT64_MIN % -1 会触发 x86 idiv 硬件陷阱（srem UB，CG1 t58）；
-            // 数学结果为 0（解释器 BigInt floor_mod 同），select 换安全除数 1：
-            // srem(INT64_MIN, 1) = 0，后续 need_fix 不触发，结果自然为 0
-            llvm::Value* int_min = llvm::ConstantInt::get(
-                builder_.getInt64Ty(), llvm::APInt::getSignedMinValue(64));
-            llvm::Value* neg_one =
-                llvm::ConstantInt::getSigned(builder_.getInt64Ty(), -1);
-            llvm::Value* is_edge = builder_.CreateAnd(
-                builder_.CreateICmpEQ(lhs.value, int_min),
-                builder_.CreateICmpEQ(rhs.value, neg_one));
-            llvm::Value* safe_rhs =
-                builder_.CreateSelect(is_edge, builder_.getInt64(1), rhs.value, "safediv");
-            llvm::Value* rem = builder_.CreateSRem(lhs.value, safe_rhs, "remtmp");
-            llvm::Value* zero = builder_.getInt64(0);
-            llvm::Value* nonzero = builder_.CreateICmpNE(rem, zero);
-            llvm::Value* rem_neg = builder_.CreateICmpSLT(rem, zero);
-            llvm::Value* rhs_neg = builder_.CreateICmpSLT(rhs.value, zero);
-            llvm::Value* sign_diff = builder_.CreateICmpNE(rem_neg, rhs_neg);
-            llvm::Value* need_fix = builder_.CreateAnd(nonzero, sign_diff);
-            // remfix 不会溢出：|rem| < |rhs| 且二者异号，rem+rhs 落在 (-|rhs|, |rhs|)
-            llvm::Value* fixed = builder_.CreateAdd(rem, rhs.value, "remfix");
-            last_value_ = {builder_.CreateSelect(need_fix, fixed, rem, "floormod"),
-                           CGType::Int};
+            last_value_ = {int_floor_mod(lhs.value, rhs.value), CGType::Int};
             return;
         }
         case TokenType::OP_PLUS:
@@ -549,11 +654,11 @@ void CodeGenerator::visitBinary(const BinaryExpr& expr) {
             require_numeric(lhs);
             require_numeric(rhs);
             if (has_num) {
-                // number 参与（t62）：下沉运行时（双整数精确 + i64 溢出走
-                // CG1 陷阱，混合走 double，对齐解释器 eval_arithmetic）
+                // number 参与（t62）：双整数精确 + i64 溢出走 CG1 陷阱，混合走
+                // double（对齐解释器 eval_arithmetic），按表示专用化内联
                 const int op_code = op.type() == TokenType::OP_PLUS    ? 0
                                   : op.type() == TokenType::OP_MINUS   ? 1 : 2;
-                last_value_ = {call_num_arith(op_code, to_num(lhs), to_num(rhs)),
+                last_value_ = {num_arith(op_code, to_num(lhs), to_num(rhs)),
                                CGType::Num};
                 return;
             }
@@ -685,8 +790,7 @@ void CodeGenerator::visitBinary(const BinaryExpr& expr) {
                 return;
             }
             if (has_num) {
-                // number 比较（t62）：collie_rt_num_cmp（双整数精确、混合 double
-                // 视图、NaN IEEE 语义），返 0/1 后与 0 做 icmp ne 得 i1
+                // number 比较（t62）：双整数精确、混合 double 视图、NaN IEEE 语义
                 require_numeric(lhs);
                 require_numeric(rhs);
                 const int op_code = t == TokenType::OP_EQUAL      ? 0
@@ -694,15 +798,7 @@ void CodeGenerator::visitBinary(const BinaryExpr& expr) {
                                   : t == TokenType::OP_LESS       ? 2
                                   : t == TokenType::OP_LESS_EQ    ? 3
                                   : t == TokenType::OP_GREATER    ? 4 : 5;
-                llvm::Value* a = to_num(lhs);
-                llvm::Value* b = to_num(rhs);
-                llvm::Value* c = builder_.CreateCall(
-                    rt_num_cmp_,
-                    {builder_.getInt64(static_cast<uint64_t>(op_code)),
-                     num_tag(a), num_bits(a), num_tag(b), num_bits(b)},
-                    "numcmp");
-                last_value_ = {builder_.CreateICmpNE(c, builder_.getInt32(0), "cmptmp"),
-                               CGType::Bool};
+                last_value_ = {num_cmp(op_code, to_num(lhs), to_num(rhs)), CGType::Bool};
                 return;
             }
             require_numeric(lhs);
@@ -820,9 +916,9 @@ void CodeGenerator::visitUnary(const UnaryExpr& expr) {
     } else if (v.type == CGType::Double) {
         last_value_ = {builder_.CreateFNeg(v.value, "negtmp"), CGType::Double};
     } else if (v.type == CGType::Num) {
-        // number 一元负号（t62）：op 5 下沉运行时（-INT64_MIN 走 CG1 陷阱）
-        llvm::Value* zero = make_num(builder_.getInt64(0), builder_.getInt64(0));
-        last_value_ = {call_num_arith(5, to_num(v), zero), CGType::Num};
+        // number 一元负号（t62）：整数态 -INT64_MIN 走 CG1 陷阱，小数态取负
+        llvm::Value* num = to_num(v);
+        last_value_ = {num_arith(5, num, num), CGType::Num};
     } else {
         unsupported("unary '-' on non-numeric operand", op.line(), op.column());
     }
@@ -4032,14 +4128,8 @@ llvm::Value* CodeGenerator::gen_match_eq(const CGValue& target, const CGValue& c
     };
     if (is_numeric(target.type) && is_numeric(cand.type)) {
         if (target.type == CGType::Num || cand.type == CGType::Num) {
-            // number 相等（t62）：collie_rt_num_cmp op 0（双整数精确、混合 double 视图）
-            llvm::Value* a = to_num(target);
-            llvm::Value* b = to_num(cand);
-            llvm::Value* c = builder_.CreateCall(
-                rt_num_cmp_,
-                {builder_.getInt64(0), num_tag(a), num_bits(a), num_tag(b), num_bits(b)},
-                "numcmp");
-            return builder_.CreateICmpNE(c, builder_.getInt32(0), "matcheq");
+            // number 相等（t62）：双整数精确、混合 double 视图
+            return num_cmp(0, to_num(target), to_num(cand));
         }
         if (target.type == CGType::Double || cand.type == CGType::Double) {
             // 混合表示按 double 视图相等（5 == 5.0，对齐解释器 values_equal）
@@ -4130,15 +4220,8 @@ llvm::Value* CodeGenerator::gen_tuple_eq(const CGValue& lhs, const CGValue& rhs,
                 // 剩余异型标量配对（Str×Int、Bool×Str 等）kind 不等恒 false
                 e = builder_.getInt1(false);
             } else if (a.type == CGType::Num || b.type == CGType::Num) {
-                // number 相等（t62）：rt_num_cmp op 0（双整数精确、混合 double 视图）
-                llvm::Value* x = to_num(a);
-                llvm::Value* y = to_num(b);
-                llvm::Value* c = builder_.CreateCall(
-                    rt_num_cmp_,
-                    {builder_.getInt64(0), num_tag(x), num_bits(x),
-                     num_tag(y), num_bits(y)},
-                    "numcmp");
-                e = builder_.CreateICmpNE(c, builder_.getInt32(0), "tupeq");
+                // number 相等（t62）：双整数精确、混合 double 视图
+                e = num_cmp(0, to_num(a), to_num(b));
             } else if (a.type == CGType::Double || b.type == CGType::Double) {
                 // 混合表示按 double 视图相等（5 == 5.0，对齐解释器 values_equal）
                 e = builder_.CreateFCmpOEQ(to_double(a), to_double(b), "tupeq");
@@ -4456,13 +4539,17 @@ void CodeGenerator::gen_multi_match(const MultiMatchExpr& expr) {
 }
 
 llvm::Value* CodeGenerator::checked_int_arith(llvm::Intrinsic::ID id, llvm::Value* lhs,
-                                              llvm::Value* rhs, const llvm::Twine& name) {
+                                              llvm::Value* rhs, const llvm::Twine& name,
+                                              llvm::Value* guard) {
     // s{add,sub,mul}.with.overflow 返 {i64 结果, i1 溢出位}；溢出分支调陷阱
     // 报错退出（不回返，unreachable 收尾），把 CG1 的静默回绕变为显式报错；
     // 每检查点独立 trap/cont 块，后续 LLVM 优化自行合并
     llvm::Value* pair = builder_.CreateBinaryIntrinsic(id, lhs, rhs);
     llvm::Value* result = builder_.CreateExtractValue(pair, 0, name);
     llvm::Value* overflowed = builder_.CreateExtractValue(pair, 1, "ovf");
+    if (guard != nullptr) {
+        overflowed = builder_.CreateAnd(guard, overflowed, "ovf");
+    }
     llvm::Function* fn = builder_.GetInsertBlock()->getParent();
     llvm::BasicBlock* trap_bb = llvm::BasicBlock::Create(context_, "ovf.trap", fn);
     llvm::BasicBlock* cont_bb = llvm::BasicBlock::Create(context_, "ovf.cont", fn);
@@ -4496,7 +4583,11 @@ llvm::Value* CodeGenerator::check_bit_range(llvm::Value* v, long long max_val,
 llvm::Value* CodeGenerator::num_to_int_checked(llvm::Value* num) {
     // number → integer 窄化（t111）：tag 1（小数态）陷阱退出（对齐解释器
     // coerce_to_declared "cannot assign decimal value to 'integer' variable"，
-    // 核心消息一致、位置前缀缺失同既定 CG 陷阱分歧）；整数态 bits 即 i64
+    // 核心消息一致、位置前缀缺失同既定 CG 陷阱分歧）；整数态 bits 即 i64，
+    // 编译期已知为整数态时免检查
+    if (num_static_tag(num) == 0) {
+        return num_bits(num);
+    }
     llvm::Function* fn = builder_.GetInsertBlock()->getParent();
     auto* trap_bb = llvm::BasicBlock::Create(context_, "numnarrow.trap", fn);
     auto* cont_bb = llvm::BasicBlock::Create(context_, "numnarrow.cont", fn);
@@ -4517,16 +4608,20 @@ llvm::Value* CodeGenerator::to_double(const CGValue& v) {
         case CGType::Bool:   return builder_.CreateUIToFP(v.value, builder_.getDoubleTy());
         case CGType::Num: {
             // Num → double 视图（t90）：tag 0 整数 SIToFP、tag 1 位模式还原，
-            // 两分支均无副作用，select 免分支
-            llvm::Value* tag = num_tag(v.value);
+            // 两分支均无副作用，select 免分支；表示编译期已知时只发一路
+            const int tag = num_static_tag(v.value);
             llvm::Value* bits = num_bits(v.value);
+            if (tag == 0) {
+                return builder_.CreateSIToFP(bits, builder_.getDoubleTy());
+            }
+            if (tag == 1) {
+                return builder_.CreateBitCast(bits, builder_.getDoubleTy());
+            }
             llvm::Value* as_int =
                 builder_.CreateSIToFP(bits, builder_.getDoubleTy());
             llvm::Value* as_dbl =
                 builder_.CreateBitCast(bits, builder_.getDoubleTy());
-            llvm::Value* is_int =
-                builder_.CreateICmpEQ(tag, builder_.getInt64(0), "numisint");
-            return builder_.CreateSelect(is_int, as_int, as_dbl, "numdbl");
+            return builder_.CreateSelect(num_is_int(v.value), as_int, as_dbl, "numdbl");
         }
         default:             unsupported("numeric conversion of non-numeric value", 0, 0);
     }
@@ -4552,10 +4647,16 @@ llvm::Value* CodeGenerator::make_num(llvm::Value* tag, llvm::Value* bits) {
 }
 
 llvm::Value* CodeGenerator::num_tag(llvm::Value* num) {
+    if (llvm::Value* tag = num_component(num, 0)) {
+        return tag;
+    }
     return builder_.CreateExtractValue(num, 0, "numtag");
 }
 
 llvm::Value* CodeGenerator::num_bits(llvm::Value* num) {
+    if (llvm::Value* bits = num_component(num, 1)) {
+        return bits;
+    }
     return builder_.CreateExtractValue(num, 1, "numbits");
 }
 
@@ -4585,7 +4686,7 @@ llvm::Value* CodeGenerator::to_number_num(const CGValue& v, size_t line, size_t
             return make_num(builder_.getInt64(0),
                             builder_.CreateZExt(v.value, builder_.getInt64Ty(), "bits"));
         case CGType::Str: {
-            // 结果经出参写回（同 call_num_arith 的 ABI 规避），槽落 entry alloca
+            // 结果经出参写回（16 字节 struct 返回在 Win x64 走隐藏指针，出参避开 ABI 错配），槽落 entry alloca
             llvm::AllocaInst* otag = create_entry_alloca(builder_.getInt64Ty(), "tonum.otag");
             llvm::AllocaInst* obits = create_entry_alloca(builder_.getInt64Ty(), "tonum.obits");
             builder_.CreateCall(rt_str_to_num_, {v.value, otag, obits});
@@ -4729,17 +4830,165 @@ void CodeGenerator::gen_number_method(const CGValue& object, const std::string&
     last_value_ = {phi, numeric_result ? CGType::Num : CGType::Bool};
 }
 
-llvm::Value* CodeGenerator::call_num_arith(int op, llvm::Value* a, llvm::Value* b) {
-    // 结果经出参写回（16 字节 struct 返回在 Win x64 走隐藏指针，出参避开
-    // ABI 错配）；出参槽落 entry alloca（IR 规范位置，利于 mem2reg）
-    llvm::AllocaInst* otag = create_entry_alloca(builder_.getInt64Ty(), "num.otag");
-    llvm::AllocaInst* obits = create_entry_alloca(builder_.getInt64Ty(), "num.obits");
-    builder_.CreateCall(rt_num_arith_,
-                        {builder_.getInt64(static_cast<uint64_t>(op)),
-                         num_tag(a), num_bits(a), num_tag(b), num_bits(b),
-                         otag, obits});
-    return make_num(builder_.CreateLoad(builder_.getInt64Ty(), otag, "numtag"),
-                    builder_.CreateLoad(builder_.getInt64Ty(), obits, "numbits"));
+int CodeGenerator::num_static_tag(llvm::Value* num) {
+    llvm::Value* tag = num_component(num, 0);
+    if (auto* c = llvm::dyn_cast_or_null<llvm::ConstantInt>(tag)) {
+        return c->isZero() ? 0 : 1;
+    }
+    return -1;
+}
+
+llvm::Value* CodeGenerator::num_is_int(llvm::Value* num) {
+    const int tag = num_static_tag(num);
+    if (tag >= 0) {
+        return builder_.getInt1(tag == 0);
+    }
+    return builder_.CreateICmpEQ(num_tag(num), builder_.getInt64(0), "numisint");
+}
+
+llvm::Value* CodeGenerator::num_arith(int op, llvm::Value* a, llvm::Value* b) {
+    // 语义同 collie_rt_num_arith（对齐解释器 eval_arithmetic）：双整数态 + - *
+    // 精确（溢出 CG1 陷阱）、% floor 取模（除零落 double 路径得 NaN）；
+    // '/' 与混合表示走 double 视图，结果为小数态。
+    // int_ok 为结果取整数态的条件：表示编译期已知时它是常量，只发一路；
+    // 否则两路都发（均无副作用），按 int_ok select 合并 tag 与 bits
+    const bool unary = op == 5;
+    llvm::Value* int_ok = nullptr;
+    if (op == 3) {
+        int_ok = builder_.getInt1(false);
+    } else {
+        llvm::Value* a_int = num_is_int(a);
+        llvm::Value* b_int = unary ? builder_.getInt1(true) : num_is_int(b);
+        int_ok = builder_.CreateAnd(a_int, b_int, "numbothint");
+        if (op == 4) {
+            int_ok = builder_.CreateAnd(
+                int_ok, builder_.CreateICmpNE(num_bits(b), builder_.getInt64(0)), "nummodint");
+        }
+    }
+    auto* known = llvm::dyn_cast<llvm::ConstantInt>(int_ok);
+
+    llvm::Value* int_result = nullptr;
+    if (!known || known->isOne()) {
+        // 整数路径：动态表示时溢出陷阱只在 int_ok 成立时触发（小数态 bits 不是整数）
+        llvm::Value* guard = known ? nullptr : int_ok;
+        llvm::Value* x = num_bits(a);
+        llvm::Value* y = num_bits(b);
+        switch (op) {
+            case 0:
+                int_result = checked_int_arith(llvm::Intrinsic::sadd_with_overflow, x, y,
+                                               "numadd", guard);
+                break;
+            case 1:
+                int_result = checked_int_arith(llvm::Intrinsic::ssub_with_overflow, x, y,
+                                               "numsub", guard);
+                break;
+            case 2:
+                int_result = checked_int_arith(llvm::Intrinsic::smul_with_overflow, x, y,
+                                               "nummul", guard);
+                break;
+            case 4:
+                // 不走整数路径时除数可能为 0（或小数位模式），换安全除数免 srem UB
+                int_result = int_floor_mod(
+                    x, known ? y : builder_.CreateSelect(int_ok, y, builder_.getInt64(1)));
+                break;
+            default:
+                int_result = checked_int_arith(llvm::Intrinsic::ssub_with_overflow,
+                                               builder_.getInt64(0), x, "numneg", guard);
+                break;
+        }
+        if (known) {
+            return make_num(builder_.getInt64(0), int_result);
+        }
+    }
+
+    llvm::Value* x = to_double({a, CGType::Num});
+    llvm::Value* y = unary ? nullptr : to_double({b, CGType::Num});
+    llvm::Value* dbl_result = nullptr;
+    switch (op) {
+        case 0: dbl_result = builder_.CreateFAdd(x, y, "numfadd"); break;
+        case 1: dbl_result = builder_.CreateFSub(x, y, "numfsub"); break;
+        case 2: dbl_result = builder_.CreateFMul(x, y, "numfmul"); break;
+        case 3: dbl_result = builder_.CreateFDiv(x, y, "numfdiv"); break;
+        case 4: dbl_result = double_floor_mod(x, y); break;
+        default: dbl_result = builder_.CreateFNeg(x, "numfneg"); break;
+    }
+    llvm::Value* dbl_bits = builder_.CreateBitCast(dbl_result, builder_.getInt64Ty(), "bits");
+    if (known) {
+        return make_num(builder_.getInt64(1), dbl_bits);
+    }
+    return make_num(builder_.CreateSelect(int_ok, builder_.getInt64(0), builder_.getInt64(1),
+                                          "numtag"),
+                    builder_.CreateSelect(int_ok, int_result, dbl_bits, "numbits"));
+}
+
+llvm::Value* CodeGenerator::num_cmp(int op, llvm::Value* a, llvm::Value* b) {
+    // 语义同 collie_rt_num_cmp：双整数态 i64 精确比较，其余 double 视图（NaN 下
+    // 全序比较与 '==' 为 false、'!=' 为 true，UNE 即 C 的 !=）；表示已知时只发一路
+    llvm::Value* both_int = builder_.CreateAnd(num_is_int(a), num_is_int(b), "numbothint");
+    auto* known = llvm::dyn_cast<llvm::ConstantInt>(both_int);
+
+    llvm::Value* int_cmp = nullptr;
+    if (!known || known->isOne()) {
+        static const llvm::CmpInst::Predicate kIntPreds[] = {
+            llvm::CmpInst::ICMP_EQ, llvm::CmpInst::ICMP_NE, llvm::CmpInst::ICMP_SLT,
+            llvm::CmpInst::ICMP_SLE, llvm::CmpInst::ICMP_SGT, llvm::CmpInst::ICMP_SGE};
+        int_cmp = builder_.CreateICmp(kIntPreds[op], num_bits(a), num_bits(b), "numicmp");
+        if (known) {
+            return int_cmp;
+        }
+    }
+    static const llvm::CmpInst::Predicate kFloatPreds[] = {
+        llvm::CmpInst::FCMP_OEQ, llvm::CmpInst::FCMP_UNE, llvm::CmpInst::FCMP_OLT,
+        llvm::CmpInst::FCMP_OLE, llvm::CmpInst::FCMP_OGT, llvm::CmpInst::FCMP_OGE};
+    llvm::Value* dbl_cmp = builder_.CreateFCmp(kFloatPreds[op], to_double({a, CGType::Num}),
+                                               to_double({b, CGType::Num}), "numfcmp");
+    if (known) {
+        return dbl_cmp;
+    }
+    return builder_.CreateSelect(both_int, int_cmp, dbl_cmp, "numcmp");
+}
+
+llvm::Value* CodeGenerator::int_floor_mod(llvm::Value* lhs, llvm::Value* rhs) {
+    // r = srem(a, b); r 非零且与 b 异号时 r += b（select 无分支实现）。
+    // INT64_MIN % -1 会触发 x86 idiv 硬件陷阱（srem UB，CG1 t58）；
+    // 数学结果为 0（解释器 BigInt floor_mod 同），select 换安全除数 1：
+    // srem(INT64_MIN, 1) = 0，后续 need_fix 不触发，结果自然为 0
+    llvm::Value* int_min = llvm::ConstantInt::get(
+        builder_.getInt64Ty(), llvm::APInt::getSignedMinValue(64));
+    llvm::Value* neg_one =
+        llvm::ConstantInt::getSigned(builder_.getInt64Ty(), -1);
+    llvm::Value* is_edge = builder_.CreateAnd(
+        builder_.CreateICmpEQ(lhs, int_min),
+        builder_.CreateICmpEQ(rhs, neg_one));
+    llvm::Value* safe_rhs =
+        builder_.CreateSelect(is_edge, builder_.getInt64(1), rhs, "safediv");
+    llvm::Value* rem = builder_.CreateSRem(lhs, safe_rhs, "remtmp");
+    llvm::Value* zero = builder_.getInt64(0);
+    llvm::Value* nonzero = builder_.CreateICmpNE(rem, zero);
+    llvm::Value* rem_neg = builder_.CreateICmpSLT(rem, zero);
+    llvm::Value* rhs_neg = builder_.CreateICmpSLT(rhs, zero);
+    llvm::Value* sign_diff = builder_.CreateICmpNE(rem_neg, rhs_neg);
+    llvm::Value* need_fix = builder_.CreateAnd(nonzero, sign_diff);
+    // remfix 不会溢出：|rem| < |rhs| 且二者异号，rem+rhs 落在 (-|rhs|, |rhs|)
+    llvm::Value* fixed = builder_.CreateAdd(rem, rhs, "remfix");
+    return builder_.CreateSelect(need_fix, fixed, rem, "floormod");
+}
+
+llvm::Value* CodeGenerator::double_floor_mod(llvm::Value* lhs, llvm::Value* rhs) {
+    // decimal 参与（t80）：FRem 语义即 fmod（截断取余），floor 修正
+    // 对齐解释器 eval_arithmetic——r 非零且与除数异号时 r += b；
+    // 除零 FRem 天然 NaN，且 NaN 使 ONE 比较为 false 不触发修正
+    // （与解释器 b==0.0 提前返 NaN 殊途同归）；-0.0 == 0.0 使
+    // nonzero 为 false 同解释器 r != 0.0 判定
+    llvm::Value* rem = builder_.CreateFRem(lhs, rhs, "fremtmp");
+    llvm::Value* fzero = llvm::ConstantFP::get(builder_.getDoubleTy(), 0.0);
+    llvm::Value* nonzero = builder_.CreateFCmpONE(rem, fzero);
+    llvm::Value* rem_neg = builder_.CreateFCmpOLT(rem, fzero);
+    llvm::Value* rhs_neg = builder_.CreateFCmpOLT(rhs, fzero);
+    llvm::Value* sign_diff = builder_.CreateICmpNE(rem_neg, rhs_neg);
+    llvm::Value* need_fix = builder_.CreateAnd(nonzero, sign_diff);
+    llvm::Value* fixed = builder_.CreateFAdd(rem, rhs, "fremfix");
+    return builder_.CreateSelect(need_fix, fixed, rem, "floorfmod");
 }
 
 llvm::Value* CodeGenerator::to_str(const CGValue& v, const Token& where) {
@@ -23,6 +23,7 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <llvm/IR/IRBuilder.h>
@@ -31,8 +32,15 @@
 
 #include "../parser/ast.h"
 
+namespace llvm {
+class TargetMachine;
+}
+
 namespace collie {
 
+/// @brief 进程内优化级别（colliec -O0～-O3，对应新 PassManager 的标准流水线）
+enum class OptLevel { O0, O1, O2, O3 };
+
 /**
  * @brief 代码生成期错误（不支持的构造、超出 i64 的整数字面量等）
  */
@@ -58,14 +66,36 @@ private:
 class CodeGenerator : public ExprVisitor, public StmtVisitor {
 public:
     CodeGenerator();
+    ~CodeGenerator() override;
 
     /// @brief 生成整个程序模块（顶层语句收拢进 @main），verifyModule 门禁失败抛 CodeGenError
-    void generate(const std::vector<std::unique_ptr<Stmt>>& statements,
+    void generate(const std::vector<StmtPtr>& statements,
                   const std::string& module_name);
 
-    /// @brief 输出 .ll 文本（生成后调用）；驱动再调 LLVM 自带 clang 把 .ll 编成本地二进制
+    /// @brief 进程内优化（generate 后、emit_ir 前调用）：按宿主 TargetMachine 设定
+    /// DataLayout，跑新 PassManager 的 per-module 标准流水线（-O0 只跑 always-inline 等
+    /// 必需 pass）；time_passes 为真时向 stderr 输出各 pass 耗时报告
+    void optimize(OptLevel level, bool time_passes = false);
+
+    /// @brief 对任意模块跑同一套流水线（machine 可为空，按默认 TTI 优化；
+    /// JIT 对惰性切分出的各函数分区复用）
+    static void optimize_module(llvm::Module& module, llvm::TargetMachine* machine,
+                                OptLevel level, bool time_passes = false);
+
+    /// @brief 交出模块及其所属上下文（collie --jit 交给 ORC 执行，generate 后调用）；
+    /// 之后本生成器不可再生成或输出
+    std::pair<std::unique_ptr<llvm::LLVMContext>, std::unique_ptr<llvm::Module>> release_module();
+
+    /// @brief 输出 .ll 文本（生成后调用，供 --emit-llvm 与 IR 快照测试）
     std::string emit_ir() const;
 
+    /// @brief 经宿主 TargetMachine 直接写目标文件（optimize 后调用，后端级别随 level），
+    /// 省去 .ll 文本的打印与外部重解析；打不开文件或 target 不支持时抛 CodeGenError
+    void emit_object(const std::string& path, OptLevel level);
+
+    /// @brief 写 LLVM bitcode（.bc），打不开文件时抛 CodeGenError
+    void emit_bitcode(const std::string& path) const;
+
     // ---- ExprVisitor ----
     void visitLiteral(const LiteralExpr& expr) override;
     void visitIdentifier(const IdentifierExpr& expr) override;
@@ -355,10 +385,19 @@ private:
     /// @brief number 值组装（t62）：tag + bits → {i64, i64} first-class struct
     llvm::Value* make_num(llvm::Value* tag, llvm::Value* bits);
 
-    /// @brief number 值拆解（t62）：extractvalue 取 tag / bits 分量
+    /// @brief number 值拆解（t62）：extractvalue 取 tag / bits 分量；
+    /// 值由 make_num 就地组装时直接返回组装用的分量
     llvm::Value* num_tag(llvm::Value* num);
     llvm::Value* num_bits(llvm::Value* num);
 
+    /// @brief number 值的表示在生成期是否已知：0 整数态 / 1 小数态 / -1 运行期才知。
+    /// integer/decimal 加宽、常量与专用化算术的结果都带常量 tag；变量、形参、
+    /// 返回值、数组元素等动态边界读出的值为 -1
+    static int num_static_tag(llvm::Value* num);
+
+    /// @brief 整数态判定 i1（表示已知时为常量，否则比较 tag）
+    llvm::Value* num_is_int(llvm::Value* num);
+
     /// @brief Int/Double/Num → Num（t62）：integer/decimal→number 加宽保持
     /// 原表示打 tag（对齐解释器 coerce_to_declared），Num 原样返回
     llvm::Value* to_num(const CGValue& v);
@@ -375,14 +414,27 @@ private:
     void gen_number_method(const CGValue& object, const std::string& name,
                            size_t line, size_t column);
 
-    /// @brief number 算术运行时调用（t62）：op 编码见 collie_rt_num_arith
-    /// （0=+ 1=- 2=* 3=/ 4=% 5=一元负号）；结果经 entry alloca 出参写回
-    llvm::Value* call_num_arith(int op, llvm::Value* a, llvm::Value* b);
+    /// @brief number 算术（t62 语义，同 collie_rt_num_arith）：op 0=+ 1=- 2=* 3=/ 4=%
+    /// 5=一元负号（b 忽略）。按两侧表示专用化内联：已知双整数态只发 i64 路径
+    ///（溢出陷阱），已知含小数态或 '/' 只发 double 路径；表示动态时两路都发、
+    /// 按 tag select 合并，不调运行时
+    llvm::Value* num_arith(int op, llvm::Value* a, llvm::Value* b);
+
+    /// @brief number 比较（同 collie_rt_num_cmp）：op 0='==' 1='!=' 2='<' 3='<=' 4='>'
+    /// 5='>='，返 i1；双整数态 icmp、其余 double 视图 fcmp，同样按表示专用化
+    llvm::Value* num_cmp(int op, llvm::Value* a, llvm::Value* b);
+
+    /// @brief floor 取模（SPEC §4，结果符号与除数一致）：i64 版含 INT64_MIN % -1
+    /// 边界（调用方保证除数非 0），double 版除零得 NaN
+    llvm::Value* int_floor_mod(llvm::Value* lhs, llvm::Value* rhs);
+    llvm::Value* double_floor_mod(llvm::Value* lhs, llvm::Value* rhs);
 
     /// @brief i64 带溢出检查的加/减/乘（CG1 t58）：s*.with.overflow intrinsic，
-    /// 溢出分支调 collie_rt 陷阱报错退出，插入点落在继续块后返回结果值
+    /// 溢出分支调 collie_rt 陷阱报错退出，插入点落在继续块后返回结果值；
+    /// guard 非空时仅在 guard 为真时才陷阱（number 动态表示的整数路径）
     llvm::Value* checked_int_arith(llvm::Intrinsic::ID id, llvm::Value* lhs,
-                                   llvm::Value* rhs, const llvm::Twine& name);
+                                   llvm::Value* rhs, const llvm::Twine& name,
+                                   llvm::Value* guard = nullptr);
 
     /// @brief byte/word 赋值点范围检查（t69）：无符号比较 (u64)v > max 一次
     /// 覆盖负数与超上限，越界分支调 collie_rt 陷阱（对齐解释器
@@ -443,9 +495,15 @@ private:
     /// @brief 不支持的构造统一报错出口
     [[noreturn]] void unsupported(const std::string& what, size_t line, size_t column);
 
-    llvm::LLVMContext context_;
+    /// @brief 宿主 TargetMachine（首次调用时初始化本机 target 并创建，之后复用；
+    /// 后端优化级别随 level），找不到 target 抛 CodeGenError
+    llvm::TargetMachine* target_machine(OptLevel level);
+
+    std::unique_ptr<llvm::LLVMContext> owned_context_;  // release_module 时随模块一并交出
+    llvm::LLVMContext& context_;
     std::unique_ptr<llvm::Module> module_;
     llvm::IRBuilder<> builder_;
+    std::unique_ptr<llvm::TargetMachine> target_machine_;
     /// collie_rt 垫片打印接口（S6 t53）：print 逐参调用，输出对齐解释器
     llvm::FunctionCallee rt_print_str_;   // void(ptr)
     llvm::FunctionCallee rt_print_i64_;   // void(i64)
@@ -493,9 +551,8 @@ private:
     llvm::FunctionCallee rt_tuple_get_;  // i64(ptr names, ptr vals, ptr key)，tuple 动态键 get（t84）
     /// collie_rt 类实例分配（t60）：字段块 malloc，布局读写全在 codegen 侧
     llvm::FunctionCallee rt_obj_new_;    // ptr(i64 size)
-    /// collie_rt number 运行时（t62，CG5 收窄）：tagged 双表示，语义单点对齐解释器
-    llvm::FunctionCallee rt_num_arith_;  // void(i64 op, i64, i64, i64, i64, ptr otag, ptr obits)
-    llvm::FunctionCallee rt_num_cmp_;    // i32(i64 op, i64, i64, i64, i64)，返 0/1
+    /// collie_rt number 运行时（t62，CG5 收窄）：tagged 双表示；算术/比较已内联
+    ///（num_arith/num_cmp），这里只剩转串/打印
     llvm::FunctionCallee rt_num_to_str_; // ptr(i64 tag, i64 bits)，malloc 新串
     llvm::FunctionCallee rt_print_num_;  // void(i64 tag, i64 bits)，格式对齐 to_string
     /// collie_rt toNumber 字符串解析（t63）：复刻解释器 to_number_value，失败返 NaN
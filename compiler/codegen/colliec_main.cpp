@@ -3,15 +3,24 @@
  * @brief Collie 本地编译器驱动（M6 t49，S1/S2 最小子集）
  *
  * 流水线：读源码 → Lexer → Parser（+语法门禁）→ SemanticAnalyzer（+语义门禁）
- *        → CodeGenerator 生成 LLVM IR → 写 .ll → 调 LLVM 自带 clang 编成本地二进制。
+ *        → CodeGenerator 生成 LLVM IR → 进程内优化 → TargetMachine 直出目标文件
+ *        → 调 C 编译器驱动仅做最终链接（Windows 为 LLVM 自带 clang.exe，产物 .exe；
+ *          Linux 优先 LLVM 自带 clang，缺失时退回 PATH 中的 cc，产物为无后缀 ELF）。
  *
- * 用法：colliec [--emit-llvm] [-o <output>] <source.collie>
- *   --emit-llvm  只生成 <base>.ll，不链接
- *   -o <output>  指定输出路径（默认与源文件同名换后缀）
+ * 用法：colliec [-O0|-O1|-O2|-O3] [--time-passes] [--emit-llvm|--emit-bc|--emit-obj]
+ *               [-o <output>] <source.collie>
+ *   -O<n>          进程内优化级别（默认 -O0）：中端流水线与后端代码生成同级别
+ *   --time-passes  向 stderr 输出各编译阶段与各优化 pass 的耗时报告
+ *   --emit-llvm    只生成 <base>.ll（优化后），不链接
+ *   --emit-bc      只生成 <base>.bc（优化后的 bitcode），不链接
+ *   --emit-obj     只生成目标文件 <base>.obj（非 Windows 为 .o），不链接
+ *   -o <output>    指定输出路径（默认与源文件同名换后缀）
  */
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -21,10 +30,15 @@
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <windows.h>
+#else
+#include <unistd.h>
 #endif
 
+#include <llvm/Support/Timer.h>
+
 #include "code_generator.h"
 #include "../lexer/lexer.h"
+#include "../lexer/source_file.h"
 #include "../parser/parser.h"
 #include "../semantic/semantic_analyzer.h"
 
@@ -34,20 +48,25 @@
 
 namespace {
 
-/// @brief 读取源文件（二进制，去 UTF-8 BOM）；失败返回 false
-bool read_source(const std::string& path, std::string& out) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file) return false;
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    out = ss.str();
-    if (out.size() >= 3 && static_cast<unsigned char>(out[0]) == 0xEF &&
-        static_cast<unsigned char>(out[1]) == 0xBB &&
-        static_cast<unsigned char>(out[2]) == 0xBF) {
-        out.erase(0, 3);
-    }
-    return true;
-}
+// 平台相关的产物命名与链接器驱动（Linux 另需显式 -lm：collie_rt 用到 libm）
+#ifdef _WIN32
+constexpr const char* kObjectExtension = ".obj";
+constexpr const char* kExecutableExtension = ".exe";
+constexpr const char* kRuntimeLibName = "collie_rt.lib";
+constexpr const char* kLinkerDriver = "clang.exe";
+constexpr const char* kLinkerFallback = nullptr;
+constexpr const char* kSystemLibs = "";
+#else
+constexpr const char* kObjectExtension = ".o";
+constexpr const char* kExecutableExtension = "";
+constexpr const char* kRuntimeLibName = "libcollie_rt.a";
+constexpr const char* kLinkerDriver = "clang";
+constexpr const char* kLinkerFallback = "cc";
+constexpr const char* kSystemLibs = " -lm";
+#endif
+
+/// @brief 产物种类：默认编链为可执行文件，--emit-* 停在对应中间产物
+enum class EmitKind { Executable, LlvmIr, Bitcode, Object };
 
 /// @brief 去掉路径的扩展名（用于派生 .ll / .exe 输出名）
 std::string strip_extension(const std::string& path) {
@@ -59,32 +78,81 @@ std::string strip_extension(const std::string& path) {
     return path.substr(0, dot);
 }
 
-/// @brief 运行期定位 collie_rt 垫片静态库（t53）：与 colliec.exe 同目录部署。
+/// @brief 运行期定位 collie_rt 垫片静态库（t53）：与 colliec 同目录部署。
 /// 不用 CMake 烘焙绝对路径——构建树路径含非 ASCII 字符时宏值经编译器命令行
 /// 会发生编码错乱（clang 收到乱码路径找不到文件），运行期定位则天然无此问题。
+/// 自身路径：Windows 取 GetModuleFileNameA，Linux 读 /proc/self/exe，都失败时退回 argv[0]。
 std::string locate_rt_lib(const char* argv0) {
     std::string exe_path;
 #ifdef _WIN32
     char buf[MAX_PATH];
     DWORD len = GetModuleFileNameA(nullptr, buf, MAX_PATH);
     if (len > 0 && len < MAX_PATH) exe_path.assign(buf, len);
+#else
+    char buf[4096];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf));
+    if (len > 0 && static_cast<size_t>(len) < sizeof(buf)) exe_path.assign(buf, len);
 #endif
     if (exe_path.empty()) exe_path = argv0;
     size_t slash = exe_path.find_last_of("/\\");
     std::string dir = (slash == std::string::npos) ? "." : exe_path.substr(0, slash);
-    return dir + "/collie_rt.lib";
+    return dir + "/" + kRuntimeLibName;
+}
+
+/// @brief 链接器驱动：优先 LLVM 包自带的 clang；包内没有（如发行版拆分的 llvm-N
+/// 软件包）且平台有退路时用 PATH 中的系统 cc
+std::string locate_linker() {
+    const std::string bundled = std::string(COLLIE_LLVM_BIN) + "/" + kLinkerDriver;
+    if (kLinkerFallback == nullptr || std::ifstream(bundled).good()) {
+        return bundled;
+    }
+    return kLinkerFallback;
+}
+
+/// @brief 给 std::system 的命令行参数加引号：Windows 用双引号，POSIX shell 用单引号
+///（内嵌单引号转义为 '\''）
+std::string quote_arg(const std::string& arg) {
+#ifdef _WIN32
+    return "\"" + arg + "\"";
+#else
+    std::string quoted = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+#endif
 }
 
 } // namespace
 
 int main(int argc, char* argv[]) {
-    bool emit_llvm_only = false;
+    EmitKind emit_kind = EmitKind::Executable;
+    bool time_passes = false;
+    collie::OptLevel opt_level = collie::OptLevel::O0;
     std::string filename;
     std::string output;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--emit-llvm") {
-            emit_llvm_only = true;
+            emit_kind = EmitKind::LlvmIr;
+        } else if (arg == "--emit-bc") {
+            emit_kind = EmitKind::Bitcode;
+        } else if (arg == "--emit-obj") {
+            emit_kind = EmitKind::Object;
+        } else if (arg == "--time-passes") {
+            time_passes = true;
+        } else if (arg == "-O0") {
+            opt_level = collie::OptLevel::O0;
+        } else if (arg == "-O1") {
+            opt_level = collie::OptLevel::O1;
+        } else if (arg == "-O2") {
+            opt_level = collie::OptLevel::O2;
+        } else if (arg == "-O3") {
+            opt_level = collie::OptLevel::O3;
         } else if (arg == "-o" && i + 1 < argc) {
             output = argv[++i];
         } else if (filename.empty()) {
@@ -94,31 +162,39 @@ int main(int argc, char* argv[]) {
 
     if (filename.empty()) {
         std::cerr << "Usage: " << argv[0]
-                  << " [--emit-llvm] [-o <output>] <source.collie>" << std::endl;
+                  << " [-O0|-O1|-O2|-O3] [--time-passes] [--emit-llvm|--emit-bc|--emit-obj]"
+                  << " [-o <output>]"
+                  << " <source.collie>" << std::endl;
         return 1;
     }
 
-    std::string source;
-    if (!read_source(filename, source)) {
-        std::cerr << "Error: cannot open source file: " << filename << std::endl;
-        return 1;
-    }
+    // --time-passes 的阶段计时（报告在 phase_timers 析构时输出到 stderr）；
+    // 未开启时不启动计时器，报告为空
+    llvm::TimerGroup phase_timers("colliec", "colliec phase timing report");
+    llvm::Timer frontend_timer("frontend", "lex + parse + semantic", phase_timers);
+    llvm::Timer codegen_timer("codegen", "IR generation + verify", phase_timers);
+    llvm::Timer optimize_timer("optimize", "in-process optimization", phase_timers);
+    llvm::Timer emit_timer("emit", "backend + write output", phase_timers);
+    llvm::Timer link_timer("link", "final link", phase_timers);
+    if (time_passes) frontend_timer.startTimer();
 
-    // 词法
-    std::vector<collie::Token> tokens;
-    try {
-        collie::Lexer lexer(source);
-        tokens = lexer.tokenize();
-    } catch (const std::exception& e) {
-        std::cerr << "Error during tokenization: " << e.what() << std::endl;
+    std::string read_error;
+    std::unique_ptr<collie::SourceFile> source = collie::SourceFile::read(filename, read_error);
+    if (!source) {
+        std::cerr << "Error: " << read_error << std::endl;
         return 1;
     }
 
-    // 语法（错误恢复 + 门禁）
-    collie::Parser parser(tokens);
-    std::vector<std::unique_ptr<collie::Stmt>> stmts;
+    // 词法 + 语法（错误恢复 + 门禁）：Parser 边解析边从 Lexer 拉取 token，
+    // 不生成完整的 token 数组；source 须存活到语法分析结束
+    collie::Lexer lexer(*source);
+    collie::Parser parser(lexer);
+    collie::ParsedProgram stmts;
     try {
         stmts = parser.parse_program();
+    } catch (const collie::LexError& e) {
+        std::cerr << "Error during tokenization: " << e.what() << std::endl;
+        return 1;
     } catch (const std::exception& e) {
         std::cerr << "Error during parsing: " << e.what() << std::endl;
         return 1;
@@ -148,10 +224,19 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // 代码生成
+    if (time_passes) frontend_timer.stopTimer();
+
+    // 代码生成 + 进程内优化
     collie::CodeGenerator codegen;
     try {
+        if (time_passes) codegen_timer.startTimer();
         codegen.generate(stmts, strip_extension(filename));
+        if (time_passes) {
+            codegen_timer.stopTimer();
+            optimize_timer.startTimer();
+        }
+        codegen.optimize(opt_level, time_passes);
+        if (time_passes) optimize_timer.stopTimer();
     } catch (const collie::CodeGenError& e) {
         std::cerr << "Codegen error";
         if (e.line() > 0) std::cerr << " at line " << e.line() << ", column " << e.column();
@@ -159,40 +244,64 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // 写 .ll
-    const std::string ll_path = strip_extension(output.empty() ? filename : output) + ".ll";
-    {
-        std::ofstream ll_file(ll_path, std::ios::binary);
-        if (!ll_file) {
-            std::cerr << "Error: cannot write IR file: " << ll_path << std::endl;
-            return 1;
+    // 输出：--emit-llvm/--emit-bc/--emit-obj 写出对应产物即止；默认经 TargetMachine
+    // 直出目标文件，再链接成可执行文件。产物名均由 -o（缺省为源文件）换后缀得到
+    const std::string base = strip_extension(output.empty() ? filename : output);
+    std::string out_path = base + kObjectExtension;
+    if (emit_kind == EmitKind::LlvmIr) out_path = base + ".ll";
+    if (emit_kind == EmitKind::Bitcode) out_path = base + ".bc";
+    if (time_passes) emit_timer.startTimer();
+    try {
+        if (emit_kind == EmitKind::LlvmIr) {
+            std::ofstream ll_file(out_path, std::ios::binary);
+            if (!ll_file) {
+                std::cerr << "Error: cannot write IR file: " << out_path << std::endl;
+                return 1;
+            }
+            ll_file << codegen.emit_ir();
+        } else if (emit_kind == EmitKind::Bitcode) {
+            codegen.emit_bitcode(out_path);
+        } else {
+            codegen.emit_object(out_path, opt_level);
         }
-        ll_file << codegen.emit_ir();
+    } catch (const collie::CodeGenError& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
+    if (time_passes) emit_timer.stopTimer();
 
-    if (emit_llvm_only) {
-        std::cout << ll_path << std::endl;
+    if (emit_kind != EmitKind::Executable) {
+        std::cout << out_path << std::endl;
         return 0;
     }
 
-    // 调用 LLVM 自带 clang 把 .ll 编成本地二进制
+    // 调用链接器驱动仅做最终链接（目标文件 + collie_rt，不再经过编译阶段）
+    const std::string& obj_path = out_path;
     const std::string exe_path =
-        output.empty() ? strip_extension(filename) + ".exe" : output;
-    const std::string clang_bin = std::string(COLLIE_LLVM_BIN) + "/clang.exe";
+        output.empty() ? strip_extension(filename) + kExecutableExtension : output;
+    const std::string linker = locate_linker();
 
-    // Windows 下 std::system 需把含空格路径的整条命令再套一层引号；
-    // -Wno-override-module：模块 triple 与 clang 宿主 triple 仅差 MSVC 版本后缀，告警无意义；
-    // collie_rt.lib：print 垫片接口实现（t53，输出格式对齐解释器），与 colliec 同目录
+    // collie_rt：print 垫片接口实现（t53，输出格式对齐解释器），与 colliec 同目录；
+    // Windows 下 std::system 需把含空格路径的整条命令再套一层引号
     const std::string rt_lib = locate_rt_lib(argv[0]);
     std::ostringstream cmd;
-    cmd << "\"\"" << clang_bin << "\" -Wno-override-module \"" << ll_path
-        << "\" \"" << rt_lib << "\" -o \"" << exe_path << "\"\"";
-    const int rc = std::system(cmd.str().c_str());
+    cmd << quote_arg(linker) << " " << quote_arg(obj_path) << " " << quote_arg(rt_lib)
+        << kSystemLibs << " -o " << quote_arg(exe_path);
+#ifdef _WIN32
+    const std::string command = "\"" + cmd.str() + "\"";
+#else
+    const std::string command = cmd.str();
+#endif
+    if (time_passes) link_timer.startTimer();
+    const int rc = std::system(command.c_str());
+    if (time_passes) link_timer.stopTimer();
     if (rc != 0) {
-        std::cerr << "Error: linking failed (clang exit code " << rc << "). "
-                  << "IR written to " << ll_path << std::endl;
+        std::cerr << "Error: linking failed (" << linker << " exit code " << rc << "). "
+                  << "Object written to " << obj_path << std::endl;
         return 1;
     }
+    // 中间目标文件链接成功即删（与 clang 驱动的临时 .obj 行为一致）
+    std::remove(obj_path.c_str());
     std::cout << exe_path << std::endl;
     return 0;
 }
@@ -0,0 +1,147 @@
+/**
+ * @file jit_executor.cpp
+ * @brief collie --jit 的进程内执行器实现（ORC LLLazyJIT）
+ */
+#include "jit_executor.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "runtime/collie_rt.h"
+
+namespace collie {
+
+namespace {
+
+/// @brief ORC 接口的 Expected/Error 统一转成 CodeGenError（what 说明哪一步失败）
+template <typename T>
+T take(llvm::Expected<T> value, const char* what) {
+    if (!value) {
+        throw CodeGenError(std::string("jit: ") + what + ": " +
+                           llvm::toString(value.takeError()), 0, 0);
+    }
+    return std::move(*value);
+}
+
+void check(llvm::Error error, const char* what) {
+    if (error) {
+        throw CodeGenError(std::string("jit: ") + what + ": " +
+                           llvm::toString(std::move(error)), 0, 0);
+    }
+}
+
+struct RuntimeSymbol {
+    const char* name;
+    void* address;
+};
+
+#define COLLIE_RT_SYMBOL(fn) {#fn, reinterpret_cast<void*>(&fn)}
+
+// collie_rt 全部对外接口（与 runtime/collie_rt.h 一一对应）。按地址登记而不依赖
+// 宿主的动态符号表：可执行文件默认不导出静态库里的符号，未被引用的还会被链接器丢弃
+const RuntimeSymbol kRuntimeSymbols[] = {
+    COLLIE_RT_SYMBOL(collie_rt_print_str),
+    COLLIE_RT_SYMBOL(collie_rt_print_i64),
+    COLLIE_RT_SYMBOL(collie_rt_print_f64),
+    COLLIE_RT_SYMBOL(collie_rt_print_bool),
+    COLLIE_RT_SYMBOL(collie_rt_print_sep),
+    COLLIE_RT_SYMBOL(collie_rt_print_newline),
+    COLLIE_RT_SYMBOL(collie_rt_concat),
+    COLLIE_RT_SYMBOL(collie_rt_i64_to_str),
+    COLLIE_RT_SYMBOL(collie_rt_f64_to_str),
+    COLLIE_RT_SYMBOL(collie_rt_bool_to_str),
+    COLLIE_RT_SYMBOL(collie_rt_strcmp),
+    COLLIE_RT_SYMBOL(collie_rt_str_len),
+    COLLIE_RT_SYMBOL(collie_rt_str_index),
+    COLLIE_RT_SYMBOL(collie_rt_str_trim),
+    COLLIE_RT_SYMBOL(collie_rt_str_substring),
+    COLLIE_RT_SYMBOL(collie_rt_trap_int_overflow),
+    COLLIE_RT_SYMBOL(collie_rt_trap_bit_range),
+    COLLIE_RT_SYMBOL(collie_rt_trap_num_narrow),
+    COLLIE_RT_SYMBOL(collie_rt_trap_shift_count),
+    COLLIE_RT_SYMBOL(collie_rt_trap_arr_kind),
+    COLLIE_RT_SYMBOL(collie_rt_trap_undefined_method),
+    COLLIE_RT_SYMBOL(collie_rt_trap_undefined_property),
+    COLLIE_RT_SYMBOL(collie_rt_arr_new),
+    COLLIE_RT_SYMBOL(collie_rt_arr_get),
+    COLLIE_RT_SYMBOL(collie_rt_arr_set),
+    COLLIE_RT_SYMBOL(collie_rt_arr_len),
+    COLLIE_RT_SYMBOL(collie_rt_arr_kind),
+    COLLIE_RT_SYMBOL(collie_rt_arr_set_num),
+    COLLIE_RT_SYMBOL(collie_rt_arr_eq),
+    COLLIE_RT_SYMBOL(collie_rt_tuple_get),
+    COLLIE_RT_SYMBOL(collie_rt_arr_to_str),
+    COLLIE_RT_SYMBOL(collie_rt_obj_new),
+    COLLIE_RT_SYMBOL(collie_rt_num_arith),
+    COLLIE_RT_SYMBOL(collie_rt_num_cmp),
+    COLLIE_RT_SYMBOL(collie_rt_num_to_str),
+    COLLIE_RT_SYMBOL(collie_rt_print_num),
+    COLLIE_RT_SYMBOL(collie_rt_str_to_num),
+};
+
+#undef COLLIE_RT_SYMBOL
+
+} // namespace
+
+int JitExecutor::run(CodeGenerator& codegen) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+
+    // 惰性 JIT：每个函数单独成区，首次调用时经桩函数触发编译
+    std::unique_ptr<llvm::orc::LLLazyJIT> jit =
+        take(llvm::orc::LLLazyJITBuilder().create(), "cannot create LLLazyJIT");
+    llvm::orc::JITDylib& main_dylib = jit->getMainJITDylib();
+
+    // collie_rt 按地址登记；libc/libm 等其余外部符号从宿主进程查找
+    llvm::orc::MangleAndInterner mangle(jit->getExecutionSession(), jit->getDataLayout());
+    llvm::orc::SymbolMap runtime_symbols;
+    for (const RuntimeSymbol& symbol : kRuntimeSymbols) {
+        runtime_symbols[mangle(symbol.name)] = llvm::orc::ExecutorSymbolDef(
+            llvm::orc::ExecutorAddr::fromPtr(symbol.address),
+            llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable);
+    }
+    check(main_dylib.define(llvm::orc::absoluteSymbols(std::move(runtime_symbols))),
+          "cannot define collie_rt symbols");
+    main_dylib.addGenerator(
+        take(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                 jit->getDataLayout().getGlobalPrefix()),
+             "cannot search host process symbols"));
+
+    // 各函数分区在编译前按 level_ 优化（分区粒度小，跨函数内联让位于惰性编译）
+    std::shared_ptr<llvm::TargetMachine> machine = take(
+        take(llvm::orc::JITTargetMachineBuilder::detectHost(), "cannot detect host")
+            .createTargetMachine(),
+        "cannot create target machine");
+    const OptLevel level = level_;
+    jit->getIRTransformLayer().setTransform(
+        [machine, level](llvm::orc::ThreadSafeModule module,
+                         llvm::orc::MaterializationResponsibility&)
+            -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+            module.withModuleDo([&](llvm::Module& partition) {
+                CodeGenerator::optimize_module(partition, machine.get(), level);
+            });
+            return std::move(module);
+        });
+
+    auto [context, module] = codegen.release_module();
+    check(jit->addLazyIRModule(
+              llvm::orc::ThreadSafeModule(std::move(module), std::move(context))),
+          "cannot add module");
+
+    // 查找 @main 会先编译它所在的分区；失败时尚未执行任何用户代码
+    llvm::orc::ExecutorAddr main_address = take(jit->lookup("main"), "cannot compile @main");
+    auto* main_fn = main_address.toPtr<int (*)()>();
+    return main_fn();
+}
+
+} // namespace collie
@@ -0,0 +1,29 @@
+/**
+ * @file jit_executor.h
+ * @brief collie --jit 的进程内执行器（ORC LLLazyJIT）
+ *
+ * 不落盘、不起外部进程：CodeGenerator 生成的模块直接交给 ORC 执行。
+ * 模块按函数切分，函数首次被调用时才经 IR 变换层优化（与 colliec 同一套
+ * PassBuilder 流水线）并编译成本机代码；collie_rt 接口按宿主进程内静态链接的
+ * 函数地址登记，其余外部符号（libc/libm）从宿主进程中查找。
+ */
+#pragma once
+
+#include "code_generator.h"
+
+namespace collie {
+
+class JitExecutor {
+public:
+    explicit JitExecutor(OptLevel level = OptLevel::O2) : level_(level) {}
+
+    /// @brief 接管 codegen 已生成的模块并执行其 @main，返回 @main 的返回值。
+    /// JIT 建立失败或 @main 编译失败时抛 CodeGenError——此时尚未执行任何用户代码，
+    /// 调用方可以回退到解释器
+    int run(CodeGenerator& codegen);
+
+private:
+    OptLevel level_;  // 各函数分区的优化级别
+};
+
+} // namespace collie
@@ -87,8 +87,9 @@
  *     字段初始值紧随 new 写入
  *
  * number 双表示运行时（t62，缺口 CG5 收窄）：值 = tag + 8 字节位模式
- *   （tag 0=整数 i64 / 1=小数 double 位模式），算术/比较/转串集中在运行时
- *   单点对齐解释器 eval_arithmetic/eval_comparison/Value::to_string：
+ *   （tag 0=整数 i64 / 1=小数 double 位模式），单点对齐解释器
+ *   eval_arithmetic/eval_comparison/Value::to_string。算术/比较现由 codegen
+ *   内联为纯 IR（num_arith/num_cmp），两接口保留为语义参照与既有目标文件的链接兼容：
  *   void collie_rt_num_arith(op, atag, abits, btag, bbits, otag, obits);
  *     // op 0=+ 1=- 2=* 3=/ 4=% 5=一元负号（b 忽略）；双整数精确 + - * %
  *     // （i64 溢出走 CG1 陷阱）、除法恒小数、混合走 double、除零 IEEE 754；
@@ -111,6 +112,8 @@
  *   4) 其余               → "%g"（C++ ostringstream 默认与 printf %g 同为 6 位有效数字）
  */
 
+#include "collie_rt.h"
+
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
@@ -0,0 +1,69 @@
+/**
+ * @file collie_rt.h
+ * @brief Collie 运行时垫片库对外接口声明（纯 C，C++ 可直接包含）
+ *
+ * 各接口的语义与对齐解释器的细节见 collie_rt.c 文件头的接口约定。
+ * codegen 按名字声明并调用这些函数：AOT 产物由链接器解析，
+ * collie --jit 则按本头文件取宿主进程内的函数地址登记给 JIT。
+ */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* print 标量输出（t53） */
+void collie_rt_print_str(const char* s);
+void collie_rt_print_i64(long long v);
+void collie_rt_print_f64(double v);
+void collie_rt_print_bool(int v);
+void collie_rt_print_sep(void);
+void collie_rt_print_newline(void);
+
+/* 字符串运行时（t54–t57） */
+const char* collie_rt_concat(const char* a, const char* b);
+const char* collie_rt_i64_to_str(long long v);
+const char* collie_rt_f64_to_str(double v);
+const char* collie_rt_bool_to_str(int v);
+int collie_rt_strcmp(const char* a, const char* b);
+long long collie_rt_str_len(const char* s);
+const char* collie_rt_str_index(const char* s, long long index);
+const char* collie_rt_str_trim(const char* s, int mode);
+const char* collie_rt_str_substring(const char* s, long long start, long long end);
+
+/* 运行期陷阱：stderr 报错后 exit(1) */
+void collie_rt_trap_int_overflow(void);
+void collie_rt_trap_bit_range(const char* name, long long max, long long got);
+void collie_rt_trap_num_narrow(void);
+void collie_rt_trap_shift_count(void);
+void collie_rt_trap_arr_kind(long long kind);
+void collie_rt_trap_undefined_method(const char* name);
+void collie_rt_trap_undefined_property(const char* name);
+
+/* 数组 / tuple 运行时（t59 起） */
+void* collie_rt_arr_new(long long len, long long kind);
+long long collie_rt_arr_get(void* arr, long long index);
+void collie_rt_arr_set(void* arr, long long index, long long bits);
+long long collie_rt_arr_len(void* arr);
+long long collie_rt_arr_kind(void* arr);
+void collie_rt_arr_set_num(void* arr, long long index, long long tag, long long bits);
+long long collie_rt_arr_eq(void* lhs, void* rhs);
+long long collie_rt_tuple_get(void* names, void* vals, const char* key);
+const char* collie_rt_arr_to_str(void* arr);
+
+/* 类实例分配（t60） */
+void* collie_rt_obj_new(long long size);
+
+/* number 双表示运行时（t62/t63） */
+void collie_rt_num_arith(long long op, long long atag, long long abits,
+                         long long btag, long long bbits,
+                         long long* otag, long long* obits);
+int collie_rt_num_cmp(long long op, long long atag, long long abits,
+                      long long btag, long long bbits);
+const char* collie_rt_num_to_str(long long tag, long long bits);
+void collie_rt_print_num(long long tag, long long bits);
+void collie_rt_str_to_num(const char* s, long long* otag, long long* obits);
+
+#ifdef __cplusplus
+}
+#endif
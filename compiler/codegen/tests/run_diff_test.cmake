@@ -1,7 +1,7 @@
 # 差分测试脚本（t50）：colliec 编译产物输出 vs collie 解释器输出，须逐字节一致
 # 用法：cmake -DCOLLIEC=<colliec 路径> -DCOLLIE=<collie 路径> -DSOURCE=<用例.collie>
-#            -DWORK_DIR=<临时目录> -P run_diff_test.cmake
-# 由 codegen/CMakeLists.txt 以 CONFIGURATIONS Release 注册进 ctest。
+#            -DWORK_DIR=<临时目录> [-DCOLLIEC_FLAGS=-O2] -P run_diff_test.cmake
+# 由 tests/CMakeLists.txt 注册进 ctest（MSVC 下限 CONFIGURATIONS Release）。
 
 foreach(_required COLLIEC COLLIE SOURCE WORK_DIR)
     if(NOT DEFINED ${_required})
@@ -11,11 +11,17 @@ endforeach()
 
 get_filename_component(_case_name "${SOURCE}" NAME_WE)
 file(MAKE_DIRECTORY "${WORK_DIR}")
-set(_exe "${WORK_DIR}/${_case_name}.exe")
+# 不同优化级别的同一用例并行跑时产物不能同名
+string(REPLACE "-" "" _flags_tag "${COLLIEC_FLAGS}")
+if(CMAKE_HOST_WIN32)
+    set(_exe "${WORK_DIR}/${_case_name}${_flags_tag}.exe")
+else()
+    set(_exe "${WORK_DIR}/${_case_name}${_flags_tag}")
+endif()
 
 # 1) colliec 编译为本地二进制
 execute_process(
-    COMMAND "${COLLIEC}" "${SOURCE}" -o "${_exe}"
+    COMMAND "${COLLIEC}" ${COLLIEC_FLAGS} "${SOURCE}" -o "${_exe}"
     RESULT_VARIABLE _rc
     OUTPUT_VARIABLE _out
     ERROR_VARIABLE _err)
@@ -43,7 +49,7 @@ if(NOT _rc EQUAL 0)
     message(FATAL_ERROR "interpreter failed on ${_case_name} (rc=${_rc}):\n${_err}")
 endif()
 
-# 4) 逐字节比对（两侧均为 Windows 文本模式 \r\n，天然对齐）
+# 4) 逐字节比对（两侧换行一致：Windows 均为文本模式 \r\n，Linux 均为 \n）
 if(NOT _native_out STREQUAL _interp_out)
     message(FATAL_ERROR "differential mismatch on ${_case_name}:\n"
                         "--- native ---\n${_native_out}"
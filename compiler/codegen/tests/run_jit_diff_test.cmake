@@ -0,0 +1,43 @@
+# JIT 差分测试脚本：collie --jit 输出 vs collie 解释器输出，须逐字节一致
+# 用法：cmake -DCOLLIE=<collie 路径> -DSOURCE=<用例.collie> -P run_jit_diff_test.cmake
+# 由 tests/CMakeLists.txt 注册进 ctest（MSVC 下限 CONFIGURATIONS Release）。
+
+foreach(_required COLLIE SOURCE)
+    if(NOT DEFINED ${_required})
+        message(FATAL_ERROR "missing -D${_required}=...")
+    endif()
+endforeach()
+
+get_filename_component(_case_name "${SOURCE}" NAME_WE)
+
+# 1) JIT 执行。标准错误须为空：--jit 回退解释器时会在此提示一行，
+#    若不检查，回退后的输出与解释器天然一致，测试会悄悄通过
+execute_process(
+    COMMAND "${COLLIE}" --jit "${SOURCE}"
+    RESULT_VARIABLE _rc
+    OUTPUT_VARIABLE _jit_out
+    ERROR_VARIABLE _err)
+if(NOT _rc EQUAL 0)
+    message(FATAL_ERROR "collie --jit failed on ${_case_name} (rc=${_rc}):\n${_err}")
+endif()
+if(NOT _err STREQUAL "")
+    message(FATAL_ERROR "collie --jit did not run ${_case_name} natively:\n${_err}")
+endif()
+
+# 2) 解释器执行同一源文件
+execute_process(
+    COMMAND "${COLLIE}" "${SOURCE}"
+    RESULT_VARIABLE _rc
+    OUTPUT_VARIABLE _interp_out
+    ERROR_VARIABLE _err)
+if(NOT _rc EQUAL 0)
+    message(FATAL_ERROR "interpreter failed on ${_case_name} (rc=${_rc}):\n${_err}")
+endif()
+
+# 3) 逐字节比对
+if(NOT _jit_out STREQUAL _interp_out)
+    message(FATAL_ERROR "differential mismatch on ${_case_name}:\n"
+                        "--- jit ---\n${_jit_out}"
+                        "--- interpreter ---\n${_interp_out}")
+endif()
+message(STATUS "jit diff ok: ${_case_name}")
@@ -281,6 +281,28 @@ BigInt BigInt::floor_mod(const BigInt& divisor) const {
     return r;
 }
 
+bool BigInt::to_int64(int64_t& out) const {
+    if (sign_ == 0) {
+        out = 0;
+        return true;
+    }
+    if (limbs_.size() > 2) return false;
+    uint64_t mag = limbs_[0];
+    if (limbs_.size() == 2) {
+        mag |= static_cast<uint64_t>(limbs_[1]) << 32;
+    }
+    const uint64_t max_positive = static_cast<uint64_t>(INT64_MAX);
+    if (sign_ > 0) {
+        if (mag > max_positive) return false;
+        out = static_cast<int64_t>(mag);
+    } else {
+        // 负数幅值可达 2^63（INT64_MIN），先减一再取负避免溢出
+        if (mag > max_positive + 1) return false;
+        out = -static_cast<int64_t>(mag - 1) - 1;
+    }
+    return true;
+}
+
 double BigInt::to_double() const {
     if (sign_ == 0) return 0.0;
     double mag = 0.0;
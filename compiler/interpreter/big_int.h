@@ -58,6 +58,9 @@ public:
      */
     BigInt floor_mod(const BigInt& divisor) const;
 
+    /// 值落在 int64 范围内时写入 out 并返回 true（供 Value 内联小整数）
+    bool to_int64(int64_t& out) const;
+
     /// 转为 double（超出范围得 ±Infinity；大数存在精度损失，仅用于混合运算）
     double to_double() const;
 
@@ -0,0 +1,149 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 寄存器式字节码：指令集与函数原型
+ */
+#ifndef COLLIE_BYTECODE_CHUNK_H
+#define COLLIE_BYTECODE_CHUNK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../value.h"
+#include "../runtime.h"
+#include "../../parser/ast.h"
+#include "../../lexer/token.h"
+
+namespace collie {
+namespace bytecode {
+
+/**
+ * @brief 操作码
+ *
+ * 寄存器 R[i] 为当前帧的第 i 个寄存器：前 frame_size 个即 Resolver 分配的变量槽位，
+ * 其上为编译期分配的临时寄存器。注释中 K/N/S/P/T/C 分别为常量、名字、调用点、
+ * 属性访问点、元组形状、类表下标；“位置”指该指令在 Proto::positions 中登记的源 token。
+ */
+enum class OpCode : uint8_t {
+    // 数据移动
+    Move,           ///< R[a] = R[b]
+    LoadConst,      ///< R[a] = K[b]
+    LoadNone,       ///< R[a] = none
+    GetGlobal,      ///< R[a] = 全局帧槽位 b
+    SetGlobal,      ///< 全局帧槽位 b = R[a]
+    GetOuter,       ///< R[a] = 沿词法外层链第 c 帧的槽位 b
+    SetOuter,       ///< 沿词法外层链第 c 帧的槽位 b = R[a]
+    Coerce,         ///< R[a] = 按声明类型 b（TokenType）校验/转换 R[a]，位置为报错点
+
+    // 运算：R[a] = R[b] op R[c]，位置为运算符 token
+    Binary,
+    BinaryOwned,    ///< 同 Binary，但 R[b] 是运算后即失效的临时寄存器（字符串拼接可移走就地追加）
+    Unary,          ///< R[a] = op R[b]
+    AndTest,        ///< 短路 &&：R[b] 确定为 false 时 R[a] = 结果并跳转到 c
+    OrTest,         ///< 短路 ||：R[b] 确定为 true 时 R[a] = 结果并跳转到 c
+    And,            ///< R[a] = R[b] && R[c]（Kleene 三值合并）
+    Or,             ///< R[a] = R[b] || R[c]
+
+    // 跳转
+    Jump,           ///< pc = a
+    JumpIfFalse,    ///< 条件语境（tribool 报错）：R[a] 为假时 pc = b，位置为关键字
+    JumpIfTrue,     ///< 条件语境：R[a] 为真时 pc = b
+    JumpIfNotTruthy,///< 三元表达式：按真值判断，R[a] 为假时 pc = b
+    JumpIfEqual,    ///< R[a] == R[b] 时 pc = c（switch / ==? 匹配）
+    TriSwitch,      ///< 三分支三元：R[a] 为 false 跳 b、unset 跳 c、true 顺序执行
+
+    // 调用
+    Call,           ///< R[a] = R[b](R[b+1] .. R[b+c])；a < 0 丢弃结果
+    TailCall,       ///< 尾调用 return R[b](..)：可复用当前帧时原地替换为被调帧，否则同 Call
+    Invoke,         ///< R[a] = R[b].S[c].name(R[b+1] ..)，按接收者动态分派
+    CallMethod,     ///< R[a] = S[c].method(this = R[b], R[b+1] ..)，静态绑定（构造器/base）
+    Return,         ///< 返回 R[a]
+    ReturnNone,     ///< 返回 none
+    Print,          ///< 输出 R[b] .. R[b+c-1]，R[a] = none
+    Len,            ///< R[a] = len(R[b])
+    ToString,       ///< R[a] = toString(R[b])
+    ToNumber,       ///< R[a] = toNumber(R[b])
+
+    // 聚合值
+    NewArray,       ///< R[a] = [R[b] .. R[b+c-1]]
+    NewTuple,       ///< R[a] = (R[b] ..)，形状 T[c]
+    Index,          ///< R[a] = R[b][R[c]]
+    CheckIndexable, ///< 校验 R[a] 可按下标写入
+    IndexSet,       ///< R[a][R[b]] = R[c]
+    GetProperty,    ///< R[a] = R[b].P[c].name（实例字段按 P[c] 缓存的槽位读取）
+    CheckInstance,  ///< 校验 R[a] 为类实例（属性赋值的接收者）
+    SetProperty,    ///< R[a].P[b].name = 按字段声明类型校验后的 R[c]，R[c] 回写校验结果
+    NewObject,      ///< R[a] = 类 C[b] 的新实例，c 个字段槽位（由随后的 InitField 逐个写入）
+    InitField,      ///< R[a] 的字段槽位 b = R[c]（new 时按字段布局 base-first 初始化，值已校验）
+
+    Throw,          ///< 抛 RuntimeError：消息 N[a]，位置为报错点
+};
+
+/**
+ * @brief 单条指令：定长 16 字节，操作数含义见 OpCode
+ */
+struct Instruction {
+    OpCode op;
+    int32_t a = 0;
+    int32_t b = 0;
+    int32_t c = 0;
+};
+
+/**
+ * @brief 调用点信息
+ *
+ * Invoke 用 name 在接收者的类链上动态查找方法，结果按接收者类缓存在 cache 中；
+ * CallMethod 在编译期已绑定 method 与其定义类。argc 为实参个数（不含 this）。
+ */
+struct CallSite {
+    std::string name;
+    int argc = 0;
+    const FunctionStmt* method = nullptr;
+    BuiltinMethod builtin = BuiltinMethod::None;  ///< Invoke：方法名预解析的内建方法
+    mutable MethodCache cache;  ///< 执行期填充（Proto 在 VM 中只读）
+};
+
+/**
+ * @brief 属性访问点信息（GetProperty/SetProperty）：字段名 + 按接收者类缓存的字段槽位
+ */
+struct PropertySite {
+    std::string name;
+    mutable FieldCache cache;
+};
+
+/**
+ * @brief 函数原型：一个函数/方法/顶层程序编译后的字节码与常量表
+ */
+struct Proto {
+    const FunctionStmt* function = nullptr;  ///< 源函数（顶层程序为 nullptr）
+    std::string name;
+    int num_params = 0;    ///< 形参个数（不含 this）
+    bool is_method = false;
+    int num_regs = 0;      ///< 帧大小：变量槽位 + 临时寄存器峰值
+
+    std::vector<Instruction> code;
+    std::vector<const Token*> positions;  ///< 与 code 平行：报错位置/运算符 token
+    std::vector<Value> constants;
+    std::vector<std::string> names;
+    std::vector<CallSite> call_sites;
+    std::vector<PropertySite> property_sites;
+    std::vector<std::vector<std::string>> tuple_shapes;
+    std::vector<const ClassStmt*> classes;
+};
+
+/**
+ * @brief 编译产物：全部函数原型 + 入口 + 类声明表
+ */
+struct Program {
+    std::vector<std::unique_ptr<Proto>> protos;
+    const Proto* main = nullptr;
+    std::unordered_map<const FunctionStmt*, const Proto*> functions;
+    ClassRegistry classes;
+};
+
+} // namespace bytecode
+} // namespace collie
+
+#endif // COLLIE_BYTECODE_CHUNK_H
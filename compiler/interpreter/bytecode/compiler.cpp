@@ -0,0 +1,1000 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 字节码编译器的实现
+ */
+#include "compiler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace collie {
+namespace bytecode {
+
+namespace {
+
+/**
+ * @brief 判断表达式求值是否可能改写变量（赋值或可能执行用户代码的调用）
+ *
+ * 只影响操作数是否需要先复制出变量寄存器，保守判断即可。
+ */
+class WriteScanner : public ExprVisitor {
+public:
+    static bool may_write(const Expr* expr) {
+        if (!expr) return false;
+        WriteScanner scanner;
+        expr->accept(scanner);
+        return scanner.found_;
+    }
+
+private:
+    void scan(const Expr* expr) {
+        if (expr && !found_) expr->accept(*this);
+    }
+    void scan_all(const std::vector<ExprPtr>& exprs) {
+        for (const auto& e : exprs) scan(e.get());
+    }
+
+    void visitLiteral(const LiteralExpr&) override {}
+    void visitIdentifier(const IdentifierExpr&) override {}
+    void visitBinary(const BinaryExpr& e) override { scan(e.left()); scan(e.right()); }
+    void visitUnary(const UnaryExpr& e) override { scan(e.operand()); }
+    void visitAssign(const AssignExpr&) override { found_ = true; }
+    void visitCall(const CallExpr& e) override {
+        if (e.builtin() != BuiltinFunction::None) {
+            scan_all(e.arguments());
+        } else {
+            found_ = true;
+        }
+    }
+    void visitTuple(const TupleExpr& e) override { scan_all(e.elements()); }
+    void visitTernary(const TernaryExpr& e) override {
+        scan(e.condition()); scan(e.then_expr()); scan(e.else_expr()); scan(e.unset_expr());
+    }
+    void visitMultiMatch(const MultiMatchExpr& e) override {
+        scan(e.target());
+        for (const auto& branch : e.branches()) {
+            scan_all(branch.values);
+            scan(branch.result.get());
+        }
+        scan(e.default_expr());
+    }
+    void visitArrayLiteral(const ArrayLiteralExpr& e) override { scan_all(e.elements()); }
+    void visitIndex(const IndexExpr& e) override { scan(e.object()); scan(e.index()); }
+    void visitIndexAssign(const IndexAssignExpr& e) override {
+        scan(e.object()); scan(e.index()); scan(e.value());
+    }
+    void visitMethodCall(const MethodCallExpr&) override { found_ = true; }
+    void visitProperty(const PropertyExpr& e) override { scan(e.object()); }
+    void visitPropertyAssign(const PropertyAssignExpr& e) override {
+        scan(e.object()); scan(e.value());
+    }
+    void visitNew(const NewExpr&) override { found_ = true; }
+    void visitThis(const ThisExpr&) override {}
+    void visitBaseCall(const BaseCallExpr&) override { found_ = true; }
+    void visitBaseMethodCall(const BaseMethodCallExpr&) override { found_ = true; }
+
+    bool found_ = false;
+};
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// 顶层入口与函数
+// -----------------------------------------------------------------------------
+std::unique_ptr<Program> Compiler::compile(const std::vector<StmtPtr>& statements,
+                                           int global_slots) {
+    auto program = std::make_unique<Program>();
+    program_ = program.get();
+    states_.clear();
+
+    Proto* main = new_proto(nullptr, "<main>");
+    program_->main = main;
+    FunctionState top;
+    top.proto = main;
+    top.slots.assign(static_cast<size_t>(global_slots), SlotInfo{});
+    top.next_temp = global_slots;
+    main->num_regs = global_slots;
+    states_.push_back(std::move(top));
+
+    // new/base 在编译期绑定类与构造器：先登记全部顶层类，
+    // 使类声明之前定义的函数体也能引用它
+    for (const auto& stmt : statements) {
+        if (auto* klass = dynamic_cast<const ClassStmt*>(stmt.get())) {
+            program_->classes.define(*klass);
+        }
+    }
+    // 顶层函数值在入口处先登记到各自槽位，支持调用源码中位于其后的函数
+    for (const auto& stmt : statements) {
+        if (auto* fn = dynamic_cast<const FunctionStmt*>(stmt.get())) {
+            emit(OpCode::LoadConst, fn->slot(), add_constant(Value::function(fn)));
+        }
+    }
+    for (const auto& stmt : statements) {
+        stmt->accept(*this);
+    }
+    emit(OpCode::ReturnNone, 0);
+
+    states_.clear();
+    program_ = nullptr;
+    return program;
+}
+
+Proto* Compiler::new_proto(const FunctionStmt* function, const std::string& name) {
+    program_->protos.push_back(std::make_unique<Proto>());
+    Proto* p = program_->protos.back().get();
+    p->function = function;
+    p->name = name;
+    if (function) {
+        program_->functions[function] = p;
+    }
+    return p;
+}
+
+void Compiler::compile_function(const FunctionStmt& fn, bool is_method,
+                                const ClassStmt* klass) {
+    Proto* p = new_proto(&fn, std::string(fn.name().lexeme()));
+    p->num_params = static_cast<int>(fn.parameters().size());
+    p->is_method = is_method;
+    p->num_regs = fn.frame_size();
+
+    FunctionState fs;
+    fs.proto = p;
+    fs.klass = klass;
+    fs.slots.assign(static_cast<size_t>(fn.frame_size()), SlotInfo{});
+    fs.next_temp = fn.frame_size();
+    states_.push_back(std::move(fs));
+
+    // 形参：方法的 this 占槽位 0，形参顺延；入口处按声明类型校验/隐式转换
+    const int first = is_method ? 1 : 0;
+    for (size_t i = 0; i < fn.parameters().size(); ++i) {
+        const Parameter& param = fn.parameters()[i];
+        int slot = first + static_cast<int>(i);
+        state().slots[static_cast<size_t>(slot)] = SlotInfo{param.type.type(), false};
+        emit_coerce(slot, param.type.type(), param.name);
+    }
+    for (const auto& stmt : fn.body()->statements()) {
+        stmt->accept(*this);
+    }
+    emit(OpCode::ReturnNone, 0);  // 无显式 return —— 返回 none（不按返回类型校验）
+
+    states_.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// 指令发射与寄存器分配
+// -----------------------------------------------------------------------------
+int Compiler::emit(OpCode op, int a, int b, int c, const Token* position) {
+    Proto& p = proto();
+    p.code.push_back(Instruction{op, a, b, c});
+    p.positions.push_back(position);
+    return static_cast<int>(p.code.size()) - 1;
+}
+
+int Compiler::here() const {
+    return static_cast<int>(states_.back().proto->code.size());
+}
+
+void Compiler::patch(int jump, int target) {
+    Instruction& in = proto().code[static_cast<size_t>(jump)];
+    switch (in.op) {
+        case OpCode::Jump:
+            in.a = target;
+            break;
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+        case OpCode::JumpIfNotTruthy:
+            in.b = target;
+            break;
+        default:  // AndTest / OrTest / JumpIfEqual
+            in.c = target;
+            break;
+    }
+}
+
+void Compiler::emit_coerce(int reg, TokenType declared, const Token& position) {
+    // object/类名等动态类型不校验，省去整条指令
+    if (runtime::needs_coercion(declared)) {
+        emit(OpCode::Coerce, reg, static_cast<int>(declared), 0, &position);
+    }
+}
+
+void Compiler::emit_throw(const std::string& message, const Token& position) {
+    emit(OpCode::Throw, add_name(message), 0, 0, &position);
+}
+
+int Compiler::add_constant(const Value& value) {
+    proto().constants.push_back(value);
+    return static_cast<int>(proto().constants.size()) - 1;
+}
+
+int Compiler::add_name(const std::string& name) {
+    auto& names = proto().names;
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return static_cast<int>(it - names.begin());
+    }
+    names.push_back(name);
+    return static_cast<int>(names.size()) - 1;
+}
+
+int Compiler::add_call_site(const std::string& name, int argc, const FunctionStmt* method) {
+    CallSite site;
+    site.name = name;
+    site.argc = argc;
+    site.method = method;
+    proto().call_sites.push_back(std::move(site));
+    return static_cast<int>(proto().call_sites.size()) - 1;
+}
+
+int Compiler::add_property_site(const std::string& name) {
+    PropertySite site;
+    site.name = name;
+    proto().property_sites.push_back(std::move(site));
+    return static_cast<int>(proto().property_sites.size()) - 1;
+}
+
+int Compiler::add_class(const ClassStmt* klass) {
+    auto& classes = proto().classes;
+    auto it = std::find(classes.begin(), classes.end(), klass);
+    if (it != classes.end()) {
+        return static_cast<int>(it - classes.begin());
+    }
+    classes.push_back(klass);
+    return static_cast<int>(classes.size()) - 1;
+}
+
+int Compiler::alloc_temp() {
+    return alloc_temps(1);
+}
+
+int Compiler::alloc_temps(int count) {
+    FunctionState& fs = state();
+    int first = fs.next_temp;
+    fs.next_temp += count;
+    fs.proto->num_regs = std::max(fs.proto->num_regs, fs.next_temp);
+    return first;
+}
+
+void Compiler::free_temps(int mark) {
+    state().next_temp = mark;
+}
+
+// -----------------------------------------------------------------------------
+// 变量访问
+// -----------------------------------------------------------------------------
+int Compiler::local_register(const VarSlot& ref) const {
+    if (!ref.resolved()) return -1;
+    if (ref.global) {
+        // 顶层代码的全局变量即当前帧（全局帧）的槽位
+        return states_.size() == 1 ? ref.slot : -1;
+    }
+    return ref.depth == 0 ? ref.slot : -1;
+}
+
+Compiler::SlotInfo* Compiler::slot_info(const VarSlot& ref) {
+    if (!ref.resolved()) return nullptr;
+    size_t index;
+    if (ref.global) {
+        index = 0;
+    } else {
+        if (static_cast<size_t>(ref.depth) >= states_.size()) return nullptr;
+        index = states_.size() - 1 - static_cast<size_t>(ref.depth);
+    }
+    auto& slots = states_[index].slots;
+    if (static_cast<size_t>(ref.slot) >= slots.size()) return nullptr;
+    return &slots[static_cast<size_t>(ref.slot)];
+}
+
+void Compiler::load_var(const VarSlot& ref, int dst) {
+    int reg = local_register(ref);
+    if (reg >= 0) {
+        if (reg != dst) emit(OpCode::Move, dst, reg);
+    } else if (ref.global) {
+        emit(OpCode::GetGlobal, dst, ref.slot);
+    } else {
+        emit(OpCode::GetOuter, dst, ref.slot, ref.depth);
+    }
+}
+
+void Compiler::store_var(const VarSlot& ref, int src) {
+    int reg = local_register(ref);
+    if (reg >= 0) {
+        if (reg != src) emit(OpCode::Move, reg, src);
+    } else if (ref.global) {
+        emit(OpCode::SetGlobal, src, ref.slot);
+    } else {
+        emit(OpCode::SetOuter, src, ref.slot, ref.depth);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 表达式
+// -----------------------------------------------------------------------------
+void Compiler::expr_to(const Expr* expr, int dst) {
+    int saved = dst_;
+    dst_ = dst;
+    expr->accept(*this);
+    dst_ = saved;
+}
+
+int Compiler::expr_any(const Expr* expr) {
+    if (auto* id = dynamic_cast<const IdentifierExpr*>(expr)) {
+        int reg = local_register(id->slot());
+        if (reg >= 0) return reg;
+    } else if (auto* self = dynamic_cast<const ThisExpr*>(expr)) {
+        int reg = local_register(self->slot());  // this 不可重新赋值，可直接引用
+        if (reg >= 0) return reg;
+    }
+    int tmp = alloc_temp();
+    expr_to(expr, tmp);
+    return tmp;
+}
+
+int Compiler::operand(const Expr* expr, const Expr* later, const Expr* later2) {
+    if (auto* id = dynamic_cast<const IdentifierExpr*>(expr)) {
+        if (local_register(id->slot()) >= 0 &&
+            (WriteScanner::may_write(later) || WriteScanner::may_write(later2))) {
+            int tmp = alloc_temp();
+            expr_to(expr, tmp);
+            return tmp;
+        }
+    }
+    return expr_any(expr);
+}
+
+void Compiler::compile_discarded(const Expr* expr) {
+    if (auto* assign = dynamic_cast<const AssignExpr*>(expr)) {
+        compile_assign(*assign, -1);
+        return;
+    }
+    int mark = state().next_temp;
+    expr_to(expr, alloc_temp());
+    free_temps(mark);
+}
+
+void Compiler::compile_arguments(const std::vector<ExprPtr>& arguments,
+                                 int base) {
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        int mark = state().next_temp;
+        expr_to(arguments[i].get(), base + static_cast<int>(i));
+        free_temps(mark);
+    }
+}
+
+void Compiler::visitLiteral(const LiteralExpr& expr) {
+    // 字面量在编译期转为常量（非法字面量保持运行到此处才报错）
+    try {
+        emit(OpCode::LoadConst, dst_, add_constant(runtime::literal_value(expr.token())));
+    } catch (const RuntimeError& e) {
+        emit_throw(e.what(), expr.token());
+    }
+}
+
+void Compiler::visitIdentifier(const IdentifierExpr& expr) {
+    if (!expr.slot().resolved()) {
+        // 语义分析通过后一般不会到这里（如类体内按裸名引用字段），作为兜底保护
+        emit_throw("Undefined variable '" + std::string(expr.name().lexeme()) + "'",
+                   expr.name());
+        return;
+    }
+    load_var(expr.slot(), dst_);
+}
+
+void Compiler::visitBinary(const BinaryExpr& expr) {
+    const Token& op = expr.op();
+    int dst = dst_;
+    int mark = state().next_temp;
+
+    // 逻辑运算短路：AndTest/OrTest 命中短路时直接写结果并跳过右侧
+    if (op.type() == TokenType::OP_AND || op.type() == TokenType::OP_OR) {
+        const bool is_and = op.type() == TokenType::OP_AND;
+        int left = operand(expr.left(), expr.right());
+        int test = emit(is_and ? OpCode::AndTest : OpCode::OrTest, dst, left);
+        int right = expr_any(expr.right());
+        emit(is_and ? OpCode::And : OpCode::Or, dst, left, right);
+        patch(test, here());
+        free_temps(mark);
+        return;
+    }
+
+    int left = operand(expr.left(), expr.right());
+    int right = expr_any(expr.right());
+    // 左操作数落在本表达式新分配的临时寄存器时，运算后即无人再读
+    emit(left >= mark ? OpCode::BinaryOwned : OpCode::Binary, dst, left, right, &op);
+    free_temps(mark);
+}
+
+void Compiler::visitUnary(const UnaryExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int src = expr_any(expr.operand());
+    emit(OpCode::Unary, dst, src, 0, &expr.op());
+    free_temps(mark);
+}
+
+void Compiler::visitAssign(const AssignExpr& expr) {
+    compile_assign(expr, dst_);
+}
+
+void Compiler::compile_assign(const AssignExpr& expr, int dst) {
+    const Token& name = expr.name();
+    const VarSlot& ref = expr.slot();
+    int mark = state().next_temp;
+
+    // const 保护：禁止对常量重新赋值（先于右侧求值报错，与树遍历一致）
+    SlotInfo* info = slot_info(ref);
+    if (info && info->is_const) {
+        emit_throw("Cannot assign to constant '" + std::string(name.lexeme()) + "'", name);
+        return;
+    }
+    if (!ref.resolved()) {
+        expr_to(expr.value(), alloc_temp());
+        emit_throw("Assignment to undefined variable '" + std::string(name.lexeme()) + "'",
+                   name);
+        free_temps(mark);
+        return;
+    }
+    TokenType declared = info ? info->declared : TokenType::KW_OBJECT;
+
+    int reg = local_register(ref);
+    if (reg >= 0) {
+        // 当前帧变量：右侧直接写入其槽位，校验后即完成赋值
+        expr_to(expr.value(), reg);
+        emit_coerce(reg, declared, name);
+        if (dst >= 0 && dst != reg) emit(OpCode::Move, dst, reg);
+    } else {
+        int tmp = dst >= 0 ? dst : alloc_temp();
+        expr_to(expr.value(), tmp);
+        emit_coerce(tmp, declared, name);
+        store_var(ref, tmp);
+    }
+    free_temps(mark);
+}
+
+void Compiler::visitCall(const CallExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    const auto& args = expr.arguments();
+    const Token& paren = expr.paren();
+
+    // 内建函数 print / len / toString / toNumber（Resolver 已按名字预解析）
+    const IdentifierExpr* callee = dynamic_cast<const IdentifierExpr*>(expr.callee());
+    if (expr.builtin() != BuiltinFunction::None) {
+        const auto name = callee->name().lexeme();
+        if (expr.builtin() == BuiltinFunction::Print) {
+            // print(a, b, ...)：各参数以单个空格分隔，末尾换行。
+            int base = alloc_temps(static_cast<int>(args.size()));
+            compile_arguments(args, base);
+            emit(OpCode::Print, dst, base, static_cast<int>(args.size()));
+        } else if (args.size() != 1) {
+            emit_throw(std::string(name) + "() expects exactly 1 argument", paren);
+        } else {
+            int src = expr_any(args[0].get());
+            OpCode op = expr.builtin() == BuiltinFunction::Len        ? OpCode::Len
+                      : expr.builtin() == BuiltinFunction::ToString ? OpCode::ToString
+                                                                     : OpCode::ToNumber;
+            emit(op, dst, src, 0, &paren);
+        }
+        free_temps(mark);
+        return;
+    }
+
+    compile_user_call(expr, OpCode::Call, dst);
+    free_temps(mark);
+}
+
+void Compiler::compile_user_call(const CallExpr& expr, OpCode op, int dst) {
+    // 用户自定义函数：R[base] 为被调函数，实参依次紧随其后
+    const auto& args = expr.arguments();
+    int base = alloc_temps(1 + static_cast<int>(args.size()));
+    expr_to(expr.callee(), base);
+    compile_arguments(args, base + 1);
+    const IdentifierExpr* callee = dynamic_cast<const IdentifierExpr*>(expr.callee());
+    std::string name = callee ? std::string(callee->name().lexeme()) : "<expr>";
+    emit(op, dst, base, add_call_site(name, static_cast<int>(args.size()), nullptr),
+         &expr.paren());
+}
+
+void Compiler::visitTuple(const TupleExpr& expr) {
+    // 元组字面量（t45）：名字表与元素平行（无名元素为空串）
+    int dst = dst_;
+    int mark = state().next_temp;
+    int base = alloc_temps(static_cast<int>(expr.elements().size()));
+    compile_arguments(expr.elements(), base);
+    proto().tuple_shapes.push_back(expr.names());
+    emit(OpCode::NewTuple, dst, base, static_cast<int>(proto().tuple_shapes.size()) - 1);
+    free_temps(mark);
+}
+
+void Compiler::visitTernary(const TernaryExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int cond = expr_any(expr.condition());
+    free_temps(mark);
+
+    std::vector<int> to_end;
+    if (expr.unset_expr() != nullptr) {
+        // tribool 三分支形式 a ? x : y : z（t43）：按三态选择分支
+        int sw = emit(OpCode::TriSwitch, cond, 0, 0, &expr.question_token());
+        expr_to(expr.then_expr(), dst);
+        to_end.push_back(emit(OpCode::Jump, 0));
+        proto().code[static_cast<size_t>(sw)].b = here();
+        expr_to(expr.else_expr(), dst);
+        to_end.push_back(emit(OpCode::Jump, 0));
+        proto().code[static_cast<size_t>(sw)].c = here();
+        expr_to(expr.unset_expr(), dst);
+    } else {
+        // 两分支时按真值判断：unset 走 false 分支
+        int jump = emit(OpCode::JumpIfNotTruthy, cond, 0);
+        expr_to(expr.then_expr(), dst);
+        to_end.push_back(emit(OpCode::Jump, 0));
+        patch(jump, here());
+        expr_to(expr.else_expr(), dst);
+    }
+    for (int j : to_end) patch(j, here());
+}
+
+void Compiler::visitMultiMatch(const MultiMatchExpr& expr) {
+    // `==?` 多路匹配（t44）：按序比较候选值，命中第一个匹配分支；
+    // 惰性求值：未命中分支的结果不执行，命中后剩余候选值也不再求值
+    int dst = dst_;
+    int mark = state().next_temp;
+    bool values_write = false;
+    for (const auto& branch : expr.branches()) {
+        for (const auto& value : branch.values) {
+            values_write = values_write || WriteScanner::may_write(value.get());
+        }
+    }
+    int target = values_write ? alloc_temp() : expr_any(expr.target());
+    if (values_write) expr_to(expr.target(), target);
+
+    std::vector<std::vector<int>> hits(expr.branches().size());
+    for (size_t i = 0; i < expr.branches().size(); ++i) {
+        for (const auto& value : expr.branches()[i].values) {
+            int inner = state().next_temp;
+            int v = expr_any(value.get());
+            hits[i].push_back(emit(OpCode::JumpIfEqual, target, v));
+            free_temps(inner);
+        }
+    }
+    free_temps(mark);
+
+    std::vector<int> to_end;
+    if (expr.default_expr() != nullptr) {
+        expr_to(expr.default_expr(), dst);
+        to_end.push_back(emit(OpCode::Jump, 0));
+    } else {
+        // 语义层已保证 tribool 穷尽三态或有默认分支；此处防御 object 动态路径
+        emit_throw("No branch of '==?' matched the value", expr.op());
+    }
+    for (size_t i = 0; i < expr.branches().size(); ++i) {
+        for (int j : hits[i]) patch(j, here());
+        expr_to(expr.branches()[i].result.get(), dst);
+        to_end.push_back(emit(OpCode::Jump, 0));
+    }
+    for (int j : to_end) patch(j, here());
+}
+
+void Compiler::visitArrayLiteral(const ArrayLiteralExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int base = alloc_temps(static_cast<int>(expr.elements().size()));
+    compile_arguments(expr.elements(), base);
+    emit(OpCode::NewArray, dst, base, static_cast<int>(expr.elements().size()));
+    free_temps(mark);
+}
+
+void Compiler::visitIndex(const IndexExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int object = operand(expr.object(), expr.index());
+    int index = expr_any(expr.index());
+    emit(OpCode::Index, dst, object, index, &expr.bracket());
+    free_temps(mark);
+}
+
+void Compiler::visitIndexAssign(const IndexAssignExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int object = operand(expr.object(), expr.index(), expr.value());
+    emit(OpCode::CheckIndexable, object, 0, 0, &expr.bracket());
+    int index = operand(expr.index(), expr.value());
+    int value = expr_any(expr.value());
+    emit(OpCode::IndexSet, object, index, value, &expr.bracket());
+    // 赋值表达式的值为右侧值，支持链式赋值
+    if (dst >= 0 && dst != value) emit(OpCode::Move, dst, value);
+    free_temps(mark);
+}
+
+void Compiler::visitMethodCall(const MethodCallExpr& expr) {
+    // R[base] 为接收者，实参紧随其后；实例方法调用时该区间即被调帧的 this 与形参
+    int dst = dst_;
+    int mark = state().next_temp;
+    const auto& args = expr.arguments();
+    int base = alloc_temps(1 + static_cast<int>(args.size()));
+    expr_to(expr.object(), base);
+    compile_arguments(args, base + 1);
+    int site = add_call_site(std::string(expr.name().lexeme()),
+                             static_cast<int>(args.size()), nullptr);
+    proto().call_sites[static_cast<size_t>(site)].builtin = expr.builtin();
+    emit(OpCode::Invoke, dst, base, site, &expr.name());
+    free_temps(mark);
+}
+
+void Compiler::visitProperty(const PropertyExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int object = expr_any(expr.object());
+    emit(OpCode::GetProperty, dst, object, add_property_site(std::string(expr.name().lexeme())),
+         &expr.name());
+    free_temps(mark);
+}
+
+void Compiler::visitPropertyAssign(const PropertyAssignExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    int object = operand(expr.object(), expr.value());
+    emit(OpCode::CheckInstance, object, 0, 0, &expr.name());
+    // SetProperty 把校验/转换后的值写回值寄存器，故值须在独立的临时寄存器
+    int value = alloc_temp();
+    expr_to(expr.value(), value);
+    emit(OpCode::SetProperty, object, add_property_site(std::string(expr.name().lexeme())), value,
+         &expr.name());
+    if (dst >= 0) emit(OpCode::Move, dst, value);
+    free_temps(mark);
+}
+
+void Compiler::visitNew(const NewExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    const Token& class_name = expr.class_name();
+    const std::string name(class_name.lexeme());
+
+    const ClassStmt* klass = program_->classes.find(name);
+    if (!klass) {
+        emit_throw("Undefined class '" + name + "'", class_name);
+        return;
+    }
+
+    // 按字段布局 base-first 初始化字段（子类同名字段覆盖）：初始化表达式在 new 处求值，
+    // 按字段声明类型校验/隐式转换，无初始化的字段为 none；槽位在编译期即确定
+    const ClassLayout* layout = nullptr;
+    try {
+        layout = &program_->classes.layout_of(klass);
+    } catch (const RuntimeError& e) {
+        emit_throw(e.what(), klass->superclass());
+        free_temps(mark);
+        return;
+    }
+    int object = alloc_temp();
+    emit(OpCode::NewObject, object, add_class(klass), static_cast<int>(layout->size()),
+         &class_name);
+    for (const ClassLayout::FieldInit& step : layout->inits) {
+        const VarDeclStmt* field = step.field;
+        int inner = state().next_temp;
+        int value = alloc_temp();
+        if (field->initializer()) {
+            expr_to(field->initializer(), value);
+            emit_coerce(value, field->type().type(), field->name());
+        } else {
+            emit(OpCode::LoadNone, value);
+        }
+        emit(OpCode::InitField, object, static_cast<int>(step.slot), value);
+        free_temps(inner);
+    }
+
+    // 构造器为与类名同名的成员函数；无构造器时要求 0 实参
+    const auto& args = expr.arguments();
+    int base = alloc_temps(1 + static_cast<int>(args.size()));
+    emit(OpCode::Move, base, object);
+    compile_arguments(args, base + 1);
+    const FunctionStmt* ctor = program_->classes.find_method(klass, name);
+    if (ctor) {
+        emit(OpCode::CallMethod, -1, base,
+             add_call_site(name, static_cast<int>(args.size()), ctor), &class_name);
+    } else if (!args.empty()) {
+        emit_throw("Class '" + name + "' has no constructor but got " +
+                       std::to_string(args.size()) + " argument(s)",
+                   class_name);
+    }
+    emit(OpCode::Move, dst, object);
+    free_temps(mark);
+}
+
+void Compiler::visitThis(const ThisExpr& expr) {
+    if (!expr.slot().resolved()) {
+        emit_throw("'this' can only be used inside a class method", expr.keyword());
+        return;
+    }
+    load_var(expr.slot(), dst_);
+}
+
+void Compiler::visitBaseCall(const BaseCallExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    const Token& keyword = expr.keyword();
+    const ClassStmt* klass = state().klass;
+
+    // base 按“定义当前构造器的类”的父类解析，编译期即可确定父类构造器
+    if (!klass || !klass->has_superclass()) {
+        emit_throw("'base' requires the enclosing class to have a superclass", keyword);
+        return;
+    }
+    const ClassStmt* super = nullptr;
+    try {
+        super = program_->classes.superclass_of(klass);
+    } catch (const RuntimeError& e) {
+        emit_throw(e.what(), klass->superclass());
+        return;
+    }
+    if (!expr.this_slot().resolved()) {
+        emit_throw("'base' can only be used inside a constructor", keyword);
+        return;
+    }
+
+    const auto& args = expr.arguments();
+    int base = alloc_temps(1 + static_cast<int>(args.size()));
+    load_var(expr.this_slot(), base);
+    compile_arguments(args, base + 1);
+
+    const std::string super_name(super->name().lexeme());
+    const FunctionStmt* ctor = program_->classes.find_method(super, super_name);
+    if (ctor) {
+        emit(OpCode::CallMethod, -1, base,
+             add_call_site(super_name, static_cast<int>(args.size()), ctor), &keyword);
+    } else if (!args.empty()) {
+        emit_throw("Class '" + super_name + "' has no constructor but got " +
+                       std::to_string(args.size()) + " argument(s)",
+                   keyword);
+    }
+    emit(OpCode::LoadNone, dst);
+    free_temps(mark);
+}
+
+void Compiler::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
+    int dst = dst_;
+    int mark = state().next_temp;
+    const Token& keyword = expr.keyword();
+    const ClassStmt* klass = state().klass;
+
+    // base 按“定义当前方法的类”的父类解析，从父类链查找方法，绕过子类覆写（C# 语义）
+    if (!klass || !klass->has_superclass()) {
+        emit_throw("'base' requires the enclosing class to have a superclass", keyword);
+        return;
+    }
+    const ClassStmt* super = nullptr;
+    try {
+        super = program_->classes.superclass_of(klass);
+    } catch (const RuntimeError& e) {
+        emit_throw(e.what(), klass->superclass());
+        return;
+    }
+    if (!expr.this_slot().resolved()) {
+        emit_throw("'base' can only be used inside a class method", keyword);
+        return;
+    }
+
+    const auto& args = expr.arguments();
+    int base = alloc_temps(1 + static_cast<int>(args.size()));
+    load_var(expr.this_slot(), base);
+    compile_arguments(args, base + 1);
+
+    const std::string method_name(expr.method().lexeme());
+    const FunctionStmt* method = program_->classes.find_method(super, method_name);
+    if (!method) {
+        emit_throw("Undefined method '" + method_name + "' in superclass chain of '" +
+                       std::string(klass->name().lexeme()) + "'",
+                   keyword);
+    } else {
+        emit(OpCode::CallMethod, dst, base,
+             add_call_site(method_name, static_cast<int>(args.size()), method), &keyword);
+    }
+    free_temps(mark);
+}
+
+// -----------------------------------------------------------------------------
+// 语句
+// -----------------------------------------------------------------------------
+void Compiler::visitExpression(const ExpressionStmt& stmt) {
+    compile_discarded(stmt.expression());
+}
+
+void Compiler::visitVarDecl(const VarDeclStmt& stmt) {
+    // 按声明类型校验/隐式转换初始值；无初始化时绑定 none，不做校验（首次赋值时再检查）
+    int reg = stmt.slot();
+    if (stmt.initializer()) {
+        expr_to(stmt.initializer(), reg);
+        emit_coerce(reg, stmt.type().type(), stmt.name());
+    } else {
+        emit(OpCode::LoadNone, reg);
+    }
+    state().slots[static_cast<size_t>(reg)] = SlotInfo{stmt.type().type(), stmt.is_const()};
+}
+
+void Compiler::visitBlock(const BlockStmt& stmt) {
+    for (const auto& s : stmt.statements()) {
+        s->accept(*this);
+    }
+}
+
+void Compiler::visitIf(const IfStmt& stmt) {
+    int mark = state().next_temp;
+    int cond = expr_any(stmt.condition());
+    free_temps(mark);
+    int jump = emit(OpCode::JumpIfFalse, cond, 0, 0, &stmt.if_token());
+    stmt.then_branch()->accept(*this);
+    if (stmt.else_branch()) {
+        int skip = emit(OpCode::Jump, 0);
+        patch(jump, here());
+        stmt.else_branch()->accept(*this);
+        patch(skip, here());
+    } else {
+        patch(jump, here());
+    }
+}
+
+void Compiler::visitWhile(const WhileStmt& stmt) {
+    int start = here();
+    int mark = state().next_temp;
+    int cond = expr_any(stmt.condition());
+    free_temps(mark);
+    int exit = emit(OpCode::JumpIfFalse, cond, 0, 0, &stmt.while_token());
+
+    state().loops.emplace_back();
+    stmt.body()->accept(*this);
+    emit(OpCode::Jump, start);
+    LoopContext loop = std::move(state().loops.back());
+    state().loops.pop_back();
+
+    for (int j : loop.continue_jumps) patch(j, start);
+    patch(exit, here());
+    for (int j : loop.break_jumps) patch(j, here());
+}
+
+void Compiler::visitFor(const ForStmt& stmt) {
+    // for 的初始化变量作用域限定在循环内部（Resolver 已分配独立槽位）
+    if (stmt.initializer()) {
+        stmt.initializer()->accept(*this);
+    }
+    int start = here();
+    int exit = -1;
+    if (stmt.condition()) {
+        int mark = state().next_temp;
+        int cond = expr_any(stmt.condition());
+        free_temps(mark);
+        exit = emit(OpCode::JumpIfFalse, cond, 0, 0, &stmt.for_token());
+    }
+
+    state().loops.emplace_back();
+    stmt.body()->accept(*this);
+    LoopContext loop = std::move(state().loops.back());
+    state().loops.pop_back();
+
+    // continue 落到增量处
+    int increment = here();
+    if (stmt.increment()) {
+        compile_discarded(stmt.increment());
+    }
+    emit(OpCode::Jump, start);
+
+    for (int j : loop.continue_jumps) patch(j, increment);
+    if (exit >= 0) patch(exit, here());
+    for (int j : loop.break_jumps) patch(j, here());
+}
+
+void Compiler::visitDoWhile(const DoWhileStmt& stmt) {
+    int start = here();
+    state().loops.emplace_back();
+    stmt.body()->accept(*this);
+    LoopContext loop = std::move(state().loops.back());
+    state().loops.pop_back();
+
+    int check = here();
+    int mark = state().next_temp;
+    int cond = expr_any(stmt.condition());
+    free_temps(mark);
+    emit(OpCode::JumpIfTrue, cond, start, 0, &stmt.do_token());
+
+    for (int j : loop.continue_jumps) patch(j, check);
+    for (int j : loop.break_jumps) patch(j, here());
+}
+
+void Compiler::visitSwitch(const SwitchStmt& stmt) {
+    // 按序比较各 case 的值，命中第一个等值分支（无 fallthrough），无匹配则执行 default
+    int mark = state().next_temp;
+    bool values_write = false;
+    for (const auto& sc : stmt.cases()) {
+        for (const auto& value : sc.values) {
+            values_write = values_write || WriteScanner::may_write(value.get());
+        }
+    }
+    int cond = values_write ? alloc_temp() : expr_any(stmt.condition());
+    if (values_write) expr_to(stmt.condition(), cond);
+
+    std::vector<std::vector<int>> hits(stmt.cases().size());
+    const SwitchCase* default_case = nullptr;
+    for (size_t i = 0; i < stmt.cases().size(); ++i) {
+        const SwitchCase& sc = stmt.cases()[i];
+        if (sc.is_default) {
+            default_case = &sc;
+            continue;
+        }
+        for (const auto& value : sc.values) {
+            int inner = state().next_temp;
+            int v = expr_any(value.get());
+            hits[i].push_back(emit(OpCode::JumpIfEqual, cond, v));
+            free_temps(inner);
+        }
+    }
+    free_temps(mark);
+
+    std::vector<int> to_end;
+    if (default_case && default_case->body) {
+        default_case->body->accept(*this);
+    }
+    to_end.push_back(emit(OpCode::Jump, 0));
+    for (size_t i = 0; i < stmt.cases().size(); ++i) {
+        if (hits[i].empty()) continue;
+        for (int j : hits[i]) patch(j, here());
+        stmt.cases()[i].body->accept(*this);
+        to_end.push_back(emit(OpCode::Jump, 0));
+    }
+    for (int j : to_end) patch(j, here());
+}
+
+void Compiler::visitFunction(const FunctionStmt& stmt) {
+    // 函数体单独编译为 Proto；声明处把函数值登记到当前帧槽位（与变量同层存储）
+    compile_function(stmt, false, state().klass);
+    emit(OpCode::LoadConst, stmt.slot(), add_constant(Value::function(&stmt)));
+}
+
+void Compiler::visitReturn(const ReturnStmt& stmt) {
+    int mark = state().next_temp;
+    int value;
+    if (stmt.tail_call()) {
+        // 尾调用 return f(...)：VM 能复用当前帧时直接由被调函数返回给调用方，
+        // 随后的校验与 Return 只在退化为普通调用时执行
+        value = alloc_temp();
+        compile_user_call(static_cast<const CallExpr&>(*stmt.value()), OpCode::TailCall,
+                          value);
+    } else if (stmt.value()) {
+        value = expr_any(stmt.value());
+    } else {
+        value = alloc_temp();
+        emit(OpCode::LoadNone, value);
+    }
+    // 返回值按声明返回类型校验/隐式转换（帧即将退出，可原地改写）
+    const FunctionStmt* fn = proto().function;
+    if (fn) {
+        emit_coerce(value, fn->return_type().type(), fn->return_type());
+    }
+    emit(OpCode::Return, value);
+    free_temps(mark);
+}
+
+void Compiler::visitClass(const ClassStmt& stmt) {
+    // 类声明在编译期登记（new/base 在编译期绑定类与构造器），
+    // 方法/构造器各自编译为 Proto；字段初始化在每个 new 处展开
+    program_->classes.define(stmt);
+    for (const auto& member : stmt.members()) {
+        if (auto* method = dynamic_cast<const FunctionStmt*>(member.get())) {
+            compile_function(*method, true, &stmt);
+        }
+    }
+}
+
+void Compiler::visitBreak(const BreakStmt& /*stmt*/) {
+    if (!state().loops.empty()) {
+        state().loops.back().break_jumps.push_back(emit(OpCode::Jump, 0));
+    }
+}
+
+void Compiler::visitContinue(const ContinueStmt& /*stmt*/) {
+    if (!state().loops.empty()) {
+        state().loops.back().continue_jumps.push_back(emit(OpCode::Jump, 0));
+    }
+}
+
+} // namespace bytecode
+} // namespace collie
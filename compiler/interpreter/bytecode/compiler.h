@@ -0,0 +1,144 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 字节码编译器：把语义检查后的 AST 降级为寄存器式字节码
+ */
+#ifndef COLLIE_BYTECODE_COMPILER_H
+#define COLLIE_BYTECODE_COMPILER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "chunk.h"
+#include "../../parser/ast.h"
+
+namespace collie {
+namespace bytecode {
+
+/**
+ * @brief 字节码编译器
+ *
+ * 前置：Resolver 已为变量回填 (depth, slot)。每个函数/方法/顶层程序编译为一个 Proto，
+ * 变量槽位直接作为寄存器，表达式求值的中间结果放在槽位之上的临时寄存器。
+ * 运算、校验与内建方法的语义全部委托 runtime::，编译器只决定求值顺序与控制流，
+ * 保证与树遍历解释器输出一致。
+ *
+ * 约定：表达式的目标寄存器只在其最后一条指令写入，之前不作暂存，
+ * 因此目标寄存器可以直接是被赋值变量的槽位。
+ */
+class Compiler : public ExprVisitor, public StmtVisitor {
+public:
+    /// @brief 编译整个程序；global_slots 为 Resolver 给出的全局帧槽位数
+    std::unique_ptr<Program> compile(const std::vector<StmtPtr>& statements,
+                                     int global_slots);
+
+private:
+    // ExprVisitor 接口（结果写入 dst_）
+    void visitLiteral(const LiteralExpr& expr) override;
+    void visitIdentifier(const IdentifierExpr& expr) override;
+    void visitBinary(const BinaryExpr& expr) override;
+    void visitUnary(const UnaryExpr& expr) override;
+    void visitAssign(const AssignExpr& expr) override;
+    void visitCall(const CallExpr& expr) override;
+    void visitTuple(const TupleExpr& expr) override;
+    void visitTernary(const TernaryExpr& expr) override;
+    void visitMultiMatch(const MultiMatchExpr& expr) override;
+    void visitArrayLiteral(const ArrayLiteralExpr& expr) override;
+    void visitIndex(const IndexExpr& expr) override;
+    void visitIndexAssign(const IndexAssignExpr& expr) override;
+    void visitMethodCall(const MethodCallExpr& expr) override;
+    void visitProperty(const PropertyExpr& expr) override;
+    void visitPropertyAssign(const PropertyAssignExpr& expr) override;
+    void visitNew(const NewExpr& expr) override;
+    void visitThis(const ThisExpr& expr) override;
+    void visitBaseCall(const BaseCallExpr& expr) override;
+    void visitBaseMethodCall(const BaseMethodCallExpr& expr) override;
+
+    // StmtVisitor 接口
+    void visitExpression(const ExpressionStmt& stmt) override;
+    void visitVarDecl(const VarDeclStmt& stmt) override;
+    void visitBlock(const BlockStmt& stmt) override;
+    void visitIf(const IfStmt& stmt) override;
+    void visitWhile(const WhileStmt& stmt) override;
+    void visitFor(const ForStmt& stmt) override;
+    void visitDoWhile(const DoWhileStmt& stmt) override;
+    void visitSwitch(const SwitchStmt& stmt) override;
+    void visitFunction(const FunctionStmt& stmt) override;
+    void visitReturn(const ReturnStmt& stmt) override;
+    void visitClass(const ClassStmt& stmt) override;
+    void visitBreak(const BreakStmt& stmt) override;
+    void visitContinue(const ContinueStmt& stmt) override;
+
+    /// 变量槽位的编译期信息（声明类型决定赋值时是否插 Coerce，const 赋值编译为 Throw）
+    struct SlotInfo {
+        TokenType declared = TokenType::KW_OBJECT;
+        bool is_const = false;
+    };
+
+    /// 循环上下文：break 跳到循环出口，continue 跳到条件/增量处
+    struct LoopContext {
+        std::vector<int> break_jumps;
+        std::vector<int> continue_jumps;
+    };
+
+    /// 正在编译的函数（states_[0] 为顶层程序）
+    struct FunctionState {
+        Proto* proto = nullptr;
+        const ClassStmt* klass = nullptr;  ///< 方法所属类（base 按其父类在编译期解析）
+        std::vector<SlotInfo> slots;
+        int next_temp = 0;                 ///< 下一个空闲临时寄存器
+        std::vector<LoopContext> loops;
+    };
+
+    Proto* new_proto(const FunctionStmt* function, const std::string& name);
+    void compile_function(const FunctionStmt& fn, bool is_method, const ClassStmt* klass);
+
+    // 表达式编译
+    void expr_to(const Expr* expr, int dst);
+    /// 求值到任意寄存器：当前帧变量直接返回其槽位，否则分配临时寄存器
+    int expr_any(const Expr* expr);
+    /// 二元等场景的先求值操作数：若后续表达式可能改写变量，则先复制到临时寄存器，
+    /// 保持“先求值者先取值”的语义
+    int operand(const Expr* expr, const Expr* later, const Expr* later2 = nullptr);
+    void compile_assign(const AssignExpr& expr, int dst);
+    void compile_discarded(const Expr* expr);
+    /// 连续求值实参到 base 起的寄存器（调用方已预留）
+    void compile_arguments(const std::vector<ExprPtr>& arguments, int base);
+    /// 用户函数调用：被调函数与实参放入连续临时寄存器后发射 Call/TailCall，结果写 dst
+    void compile_user_call(const CallExpr& expr, OpCode op, int dst);
+
+    // 变量访问
+    int local_register(const VarSlot& ref) const;
+    SlotInfo* slot_info(const VarSlot& ref);
+    void load_var(const VarSlot& ref, int dst);
+    void store_var(const VarSlot& ref, int src);
+
+    // 指令发射
+    int emit(OpCode op, int a, int b = 0, int c = 0, const Token* position = nullptr);
+    int here() const;
+    void patch(int jump, int target);
+    void emit_coerce(int reg, TokenType declared, const Token& position);
+    void emit_throw(const std::string& message, const Token& position);
+    int add_constant(const Value& value);
+    int add_name(const std::string& name);
+    int add_call_site(const std::string& name, int argc, const FunctionStmt* method);
+    int add_property_site(const std::string& name);
+    int add_class(const ClassStmt* klass);
+
+    int alloc_temp();
+    /// 连续分配 count 个临时寄存器，返回首个
+    int alloc_temps(int count);
+    void free_temps(int mark);
+
+    FunctionState& state() { return states_.back(); }
+    Proto& proto() { return *states_.back().proto; }
+
+    Program* program_ = nullptr;
+    std::vector<FunctionState> states_;
+    int dst_ = 0;  ///< 当前表达式的目标寄存器
+};
+
+} // namespace bytecode
+} // namespace collie
+
+#endif // COLLIE_BYTECODE_COMPILER_H
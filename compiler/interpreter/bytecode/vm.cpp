@@ -0,0 +1,440 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 字节码虚拟机的实现
+ */
+#include "vm.h"
+#include "compiler.h"
+#include "../resolver.h"
+#include "../runtime.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace collie {
+namespace bytecode {
+
+// -----------------------------------------------------------------------------
+// 顶层入口与帧管理
+// -----------------------------------------------------------------------------
+void VM::interpret(const std::vector<StmtPtr>& statements) {
+    // 变量解析 → 字节码编译 → 执行；编译产物引用 AST，AST 生命周期覆盖执行期
+    Resolver resolver;
+    int global_slots = resolver.resolve(statements);
+    Compiler compiler;
+    program_ = compiler.compile(statements, global_slots);
+
+    stack_.clear();
+    frames_.clear();
+    push_frame(program_->main, 0, 0, npos, nullptr);
+    run();
+}
+
+void VM::push_frame(const Proto* proto, size_t base, size_t parent, size_t ret,
+                    const Token* at) {
+    // 全局帧之外的帧数即调用深度
+    if (at && frames_.size() > max_call_depth_) {
+        throw runtime::call_depth_exceeded(max_call_depth_, at->line(), at->column());
+    }
+    CallFrame frame;
+    frame.proto = proto;
+    frame.base = base;
+    frame.parent = parent;
+    frame.ret = ret;
+    frames_.push_back(frame);
+    reserve_registers(base, proto->num_regs);
+}
+
+void VM::reserve_registers(size_t base, int regs) {
+    size_t needed = base + static_cast<size_t>(regs);
+    if (stack_.size() < needed) {
+        // 按倍数扩容，深递归时摊还 O(1)
+        stack_.resize(std::max(needed, stack_.size() * 2));
+    }
+}
+
+const Proto* VM::proto_of(const FunctionStmt* fn) const {
+    return program_->functions.at(fn);
+}
+
+size_t VM::enclosing_frame(const FunctionStmt* fn, size_t line, size_t column) const {
+    if (fn->enclosing() == nullptr) {
+        return 0;  // 顶层函数/顶层类的方法：外层帧即全局帧
+    }
+    // 嵌套函数：名字只在外层函数体内可见，调用点的词法外层链上必有外层函数的活动帧
+    size_t index = frames_.size() - 1;
+    while (true) {
+        if (frames_[index].proto->function == fn->enclosing()) return index;
+        if (index == 0) break;
+        index = frames_[index].parent;
+    }
+    throw RuntimeError("Nested function '" + std::string(fn->name().lexeme()) +
+                           "' called outside its enclosing function",
+                       line, column);
+}
+
+// -----------------------------------------------------------------------------
+// 分发循环
+// -----------------------------------------------------------------------------
+void VM::run() {
+    CallFrame* frame = nullptr;
+    const Proto* proto = nullptr;
+    const Instruction* code = nullptr;
+    Value* R = nullptr;
+    size_t pc = 0;
+
+    // 压帧/弹帧后重新取当前帧（帧栈与值栈扩容都会使指针失效）
+    auto reload = [&]() {
+        frame = &frames_.back();
+        proto = frame->proto;
+        code = proto->code.data();
+        R = stack_.data() + frame->base;
+        pc = frame->pc;
+    };
+    reload();
+
+    while (true) {
+        const Instruction& in = code[pc];
+        const size_t at = pc++;
+        switch (in.op) {
+            // ---- 数据移动 ----
+            case OpCode::Move:
+                R[in.a] = R[in.b];
+                break;
+            case OpCode::LoadConst:
+                R[in.a] = proto->constants[static_cast<size_t>(in.b)];
+                break;
+            case OpCode::LoadNone:
+                R[in.a] = Value::none();
+                break;
+            case OpCode::GetGlobal:
+                R[in.a] = stack_[static_cast<size_t>(in.b)];
+                break;
+            case OpCode::SetGlobal:
+                stack_[static_cast<size_t>(in.b)] = R[in.a];
+                break;
+            case OpCode::GetOuter:
+            case OpCode::SetOuter: {
+                size_t index = frames_.size() - 1;
+                for (int d = 0; d < in.c; ++d) {
+                    index = frames_[index].parent;
+                }
+                Value& slot = stack_[frames_[index].base + static_cast<size_t>(in.b)];
+                if (in.op == OpCode::GetOuter) {
+                    R[in.a] = slot;
+                } else {
+                    slot = R[in.a];
+                }
+                break;
+            }
+            case OpCode::Coerce: {
+                const Token& pos = *proto->positions[at];
+                runtime::coerce_in_place(static_cast<TokenType>(in.b), R[in.a],
+                                         pos.line(), pos.column());
+                break;
+            }
+
+            // ---- 运算 ----
+            case OpCode::Binary:
+                R[in.a] = runtime::eval_binary(*proto->positions[at], R[in.b], R[in.c]);
+                break;
+            case OpCode::BinaryOwned: {
+                const Token& op = *proto->positions[at];
+                if (op.type() == TokenType::OP_PLUS && R[in.b].is_string()) {
+                    R[in.a] = runtime::concat(std::move(R[in.b]), R[in.c]);
+                } else {
+                    R[in.a] = runtime::eval_binary(op, R[in.b], R[in.c]);
+                }
+                break;
+            }
+            case OpCode::Unary:
+                R[in.a] = runtime::eval_unary(*proto->positions[at], R[in.b]);
+                break;
+            case OpCode::AndTest:
+            case OpCode::OrTest: {
+                // 短路：AND 遇确定 False、OR 遇确定 True 时右侧不求值
+                int l = runtime::logic_rank(R[in.b]);
+                if (l == (in.op == OpCode::AndTest ? 0 : 2)) {
+                    R[in.a] = runtime::logic_result(l, R[in.b].is_tribool());
+                    pc = static_cast<size_t>(in.c);
+                }
+                break;
+            }
+            case OpCode::And:
+            case OpCode::Or: {
+                int l = runtime::logic_rank(R[in.b]);
+                int r = runtime::logic_rank(R[in.c]);
+                int combined = in.op == OpCode::And ? std::min(l, r) : std::max(l, r);
+                R[in.a] = runtime::logic_result(combined,
+                                                R[in.b].is_tribool() || R[in.c].is_tribool());
+                break;
+            }
+
+            // ---- 跳转 ----
+            case OpCode::Jump:
+                pc = static_cast<size_t>(in.a);
+                break;
+            case OpCode::JumpIfFalse:
+                if (!runtime::condition_truthy(R[in.a], *proto->positions[at])) {
+                    pc = static_cast<size_t>(in.b);
+                }
+                break;
+            case OpCode::JumpIfTrue:
+                if (runtime::condition_truthy(R[in.a], *proto->positions[at])) {
+                    pc = static_cast<size_t>(in.b);
+                }
+                break;
+            case OpCode::JumpIfNotTruthy:
+                if (!R[in.a].is_truthy()) {
+                    pc = static_cast<size_t>(in.b);
+                }
+                break;
+            case OpCode::JumpIfEqual:
+                if (runtime::values_equal(R[in.a], R[in.b])) {
+                    pc = static_cast<size_t>(in.c);
+                }
+                break;
+            case OpCode::TriSwitch: {
+                const Value& cond = R[in.a];
+                if (!cond.is_tribool()) {
+                    // 语义层已拦静态可知情况；这里防御 object 动态路径
+                    const Token& pos = *proto->positions[at];
+                    throw RuntimeError("Three-branch ternary requires a tribool condition",
+                                       pos.line(), pos.column());
+                }
+                if (cond.as_tribool() == Value::Tri::False) {
+                    pc = static_cast<size_t>(in.b);
+                } else if (cond.as_tribool() == Value::Tri::Unset) {
+                    pc = static_cast<size_t>(in.c);
+                }
+                break;
+            }
+
+            // ---- 调用 ----
+            case OpCode::Call:
+            case OpCode::TailCall: {
+                const CallSite& site = proto->call_sites[static_cast<size_t>(in.c)];
+                const Token& paren = *proto->positions[at];
+                const Value& callee = R[in.b];
+                if (!callee.is_function()) {
+                    throw RuntimeError("'" + site.name + "' is not a function",
+                                       paren.line(), paren.column());
+                }
+                const FunctionStmt* fn = callee.as_function();
+                // 参数数量检查（语义层已验证，此为兜底保护）
+                if (static_cast<size_t>(site.argc) != fn->parameters().size()) {
+                    throw RuntimeError("Expected " + std::to_string(fn->parameters().size()) +
+                                           " arguments but got " + std::to_string(site.argc),
+                                       paren.line(), paren.column());
+                }
+                size_t parent = enclosing_frame(fn, paren.line(), paren.column());
+                // 尾调用：被调函数不以当前帧为词法外层（帧复用后外层帧还要被访问）、
+                // 且返回类型与当前函数一致（省去当前函数的返回值校验）时，实参下移到
+                // 槽位 0..n-1，当前帧原地改为被调帧，返回时直接回到当前帧的调用方
+                if (in.op == OpCode::TailCall && parent != frames_.size() - 1 &&
+                    fn->return_type().type() == proto->function->return_type().type()) {
+                    for (int i = 0; i < site.argc; ++i) {
+                        R[i] = std::move(R[in.b + 1 + i]);
+                    }
+                    frame->tail_caller = proto->function;
+                    frame->proto = proto_of(fn);
+                    frame->parent = parent;
+                    frame->pc = 0;
+                    reserve_registers(frame->base, frame->proto->num_regs);
+                    reload();
+                    break;
+                }
+                // 被调帧的形参槽位 0..n-1 正好覆盖调用方放实参的寄存器
+                frame->pc = pc;
+                push_frame(proto_of(fn), frame->base + static_cast<size_t>(in.b) + 1, parent,
+                           frame->base + static_cast<size_t>(in.a), &paren);
+                reload();
+                break;
+            }
+            case OpCode::Invoke: {
+                const CallSite& site = proto->call_sites[static_cast<size_t>(in.c)];
+                const Token& name = *proto->positions[at];
+                const Value& object = R[in.b];
+
+                // 类实例：沿继承链分发用户定义方法（toString 保留为通用内建兜底）
+                if (object.is_instance()) {
+                    const FunctionStmt* method =
+                        runtime::lookup_method(program_->classes, site.cache,
+                                               object.as_instance().klass, site.name,
+                                               cache_stats_).method;
+                    if (!method) {
+                        if (site.builtin == BuiltinMethod::ToString) {
+                            R[in.a] = Value::str(object.to_string());
+                            break;
+                        }
+                        throw RuntimeError("Undefined method '" + site.name + "' on object",
+                                           name.line(), name.column());
+                    }
+                    // 元数检查（语义层对 object 动态放行，运行期是唯一门禁）
+                    if (static_cast<size_t>(site.argc) != method->parameters().size()) {
+                        throw RuntimeError(
+                            site.name + "() expects " +
+                                std::to_string(method->parameters().size()) +
+                                " argument(s), got " + std::to_string(site.argc),
+                            name.line(), name.column());
+                    }
+                    size_t parent = enclosing_frame(method, name.line(), name.column());
+                    // 接收者所在寄存器即被调帧的 this（槽位 0）
+                    frame->pc = pc;
+                    push_frame(proto_of(method), frame->base + static_cast<size_t>(in.b),
+                               parent, frame->base + static_cast<size_t>(in.a), &name);
+                    reload();
+                    break;
+                }
+
+                // 非实例值：内建方法（tuple/string/number/tribool 及通用 toString/toNumber）
+                std::vector<Value> args(R + in.b + 1, R + in.b + 1 + site.argc);
+                R[in.a] = runtime::call_builtin_method(object, site.builtin, site.name, args,
+                                                       name.line(), name.column());
+                break;
+            }
+            case OpCode::CallMethod: {
+                // 构造器与 base 调用：方法已在编译期绑定
+                const CallSite& site = proto->call_sites[static_cast<size_t>(in.c)];
+                const Token& pos = *proto->positions[at];
+                const FunctionStmt* method = site.method;
+                if (static_cast<size_t>(site.argc) != method->parameters().size()) {
+                    throw RuntimeError(
+                        std::string(method->name().lexeme()) + "() expects " +
+                            std::to_string(method->parameters().size()) +
+                            " argument(s), got " + std::to_string(site.argc),
+                        pos.line(), pos.column());
+                }
+                size_t parent = enclosing_frame(method, pos.line(), pos.column());
+                frame->pc = pc;
+                size_t ret = in.a < 0 ? npos : frame->base + static_cast<size_t>(in.a);
+                push_frame(proto_of(method), frame->base + static_cast<size_t>(in.b), parent,
+                           ret, &pos);
+                reload();
+                break;
+            }
+            case OpCode::Return:
+            case OpCode::ReturnNone: {
+                Value result = in.op == OpCode::Return ? std::move(R[in.a]) : Value::none();
+                if (in.op == OpCode::ReturnNone && frame->tail_caller) {
+                    // 经尾调用到达的函数体无显式 return：按尾调用方的返回类型校验 none
+                    const Token& type = frame->tail_caller->return_type();
+                    result = runtime::coerce_to_declared(type.type(), result, type.line(),
+                                                         type.column());
+                }
+                size_t ret = frame->ret;
+                frames_.pop_back();
+                if (frames_.empty()) {
+                    return;  // 全局帧执行完毕
+                }
+                if (ret != npos) {
+                    stack_[ret] = std::move(result);
+                }
+                reload();
+                break;
+            }
+            case OpCode::Print: {
+                // print(a, b, ...)：各参数以单个空格分隔，末尾换行。
+                std::string line;
+                for (int i = 0; i < in.c; ++i) {
+                    if (i > 0) line += ' ';
+                    line += R[in.b + i].to_string();
+                }
+                out_ << line << '\n';
+                R[in.a] = Value::none();
+                break;
+            }
+            case OpCode::Len: {
+                const Token& paren = *proto->positions[at];
+                R[in.a] = runtime::builtin_len(R[in.b], paren.line(), paren.column());
+                break;
+            }
+            case OpCode::ToString:
+                R[in.a] = Value::str(R[in.b].to_string());
+                break;
+            case OpCode::ToNumber: {
+                const Token& paren = *proto->positions[at];
+                R[in.a] = runtime::to_number_value(R[in.b], paren.line(), paren.column());
+                break;
+            }
+
+            // ---- 聚合值 ----
+            case OpCode::NewArray: {
+                Value::ArrayStorage elements(R + in.b, R + in.b + in.c);
+                R[in.a] = Value::array(std::move(elements));
+                break;
+            }
+            case OpCode::NewTuple: {
+                const auto& names = proto->tuple_shapes[static_cast<size_t>(in.c)];
+                std::vector<Value> elements(R + in.b, R + in.b + names.size());
+                R[in.a] = Value::tuple(std::move(elements), names);
+                break;
+            }
+            case OpCode::Index:
+                R[in.a] = runtime::index_get(R[in.b], R[in.c], *proto->positions[at]);
+                break;
+            case OpCode::CheckIndexable:
+                runtime::check_index_assignable(R[in.a], *proto->positions[at]);
+                break;
+            case OpCode::IndexSet:
+                runtime::index_set(R[in.a], R[in.b], R[in.c], *proto->positions[at]);
+                break;
+            case OpCode::GetProperty: {
+                const Token& name = *proto->positions[at];
+                const PropertySite& site = proto->property_sites[static_cast<size_t>(in.c)];
+                if (R[in.b].is_instance()) {
+                    InstanceData& instance = R[in.b].as_instance();
+                    FieldTarget target = runtime::lookup_field(program_->classes, site.cache,
+                                                               instance.klass, site.name,
+                                                               cache_stats_);
+                    R[in.a] = runtime::instance_field(instance, target, site.name,
+                                                      name.line(), name.column());
+                } else {
+                    R[in.a] = runtime::get_property(R[in.b], site.name,
+                                                    name.line(), name.column());
+                }
+                break;
+            }
+            case OpCode::CheckInstance:
+                if (!R[in.a].is_instance()) {
+                    const Token& name = *proto->positions[at];
+                    throw RuntimeError(std::string("Cannot assign property on ") +
+                                           R[in.a].kind_name(),
+                                       name.line(), name.column());
+                }
+                break;
+            case OpCode::SetProperty: {
+                const Token& pos = *proto->positions[at];
+                const PropertySite& site = proto->property_sites[static_cast<size_t>(in.b)];
+                const std::string& name = site.name;
+                InstanceData& instance = R[in.a].as_instance();
+                FieldTarget target = runtime::lookup_field(program_->classes, site.cache,
+                                                           instance.klass, name, cache_stats_);
+                Value& slot = runtime::instance_field(instance, target, name,
+                                                      pos.line(), pos.column());
+                // 按字段声明类型校验/隐式转换
+                runtime::coerce_in_place(target.field->type().type(), R[in.c],
+                                         pos.line(), pos.column());
+                slot = R[in.c];
+                break;
+            }
+            case OpCode::NewObject:
+                R[in.a] = Value::instance(proto->classes[static_cast<size_t>(in.b)],
+                                          static_cast<size_t>(in.c));
+                break;
+            case OpCode::InitField:
+                R[in.a].as_instance().fields[in.b] = R[in.c];
+                break;
+
+            case OpCode::Throw: {
+                const Token& pos = *proto->positions[at];
+                throw RuntimeError(proto->names[static_cast<size_t>(in.a)],
+                                   pos.line(), pos.column());
+            }
+        }
+    }
+}
+
+} // namespace bytecode
+} // namespace collie
@@ -0,0 +1,85 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 寄存器式字节码虚拟机（路线 A 的第二执行引擎）
+ */
+#ifndef COLLIE_BYTECODE_VM_H
+#define COLLIE_BYTECODE_VM_H
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include "chunk.h"
+#include "../value.h"
+#include "../../parser/ast.h"
+
+namespace collie {
+namespace bytecode {
+
+/**
+ * @brief 字节码虚拟机
+ *
+ * 先由 Resolver 回填变量槽位，再经 Compiler 降级为字节码，最后在单个分发循环内执行。
+ * 所有帧的寄存器连续存放在同一个值栈上：全局帧位于栈底，调用时被调帧的寄存器
+ * 窗口直接覆盖调用方放实参的临时寄存器，传参无需拷贝；调用/返回只压弹帧记录，
+ * 不占用 C++ 调用栈，递归深度只受调用深度上限约束；尾调用原地复用当前帧。
+ * 输出与 RuntimeError 消息与树遍历解释器一致。
+ */
+class VM {
+public:
+    /// @param out 程序 print 输出的目标流（main 传 std::cout，测试传 ostringstream）
+    explicit VM(std::ostream& out) : out_(out) {}
+
+    /// @brief 编译并执行整个程序（顶层语句列表）
+    void interpret(const std::vector<StmtPtr>& statements);
+
+    /// @brief 设置调用深度上限（默认 kDefaultMaxCallDepth），超限抛 RuntimeError
+    void set_max_call_depth(size_t depth) { max_call_depth_ = depth; }
+
+    /// @brief 方法分派/字段赋值内联缓存的命中统计
+    const InlineCacheStats& cache_stats() const { return cache_stats_; }
+
+private:
+    /// 活动帧记录
+    struct CallFrame {
+        const Proto* proto = nullptr;
+        size_t base = 0;    ///< 寄存器窗口在值栈上的起点
+        size_t pc = 0;      ///< 调用其他函数时保存的返回点
+        size_t parent = 0;  ///< 词法外层帧下标（GetOuter/SetOuter 沿此链跳转）
+        size_t ret = 0;     ///< 返回值写入的值栈下标（npos 表示丢弃）
+        /// 以尾调用复用本帧的上一个函数：本帧无显式 return 时，
+        /// none 仍须按它的返回类型校验（与不复用帧时一致）
+        const FunctionStmt* tail_caller = nullptr;
+    };
+
+    void run();
+
+    /// @brief 压入被调帧并确保值栈容纳其寄存器窗口；超过调用深度上限时
+    /// 以调用点 at 的位置抛 RuntimeError（全局帧 at 为 nullptr）
+    void push_frame(const Proto* proto, size_t base, size_t parent, size_t ret,
+                    const Token* at);
+
+    /// @brief 确保值栈容纳从 base 起 regs 个寄存器
+    void reserve_registers(size_t base, int regs);
+
+    /// @brief 按函数取其 Proto（编译产物必含全部函数）
+    const Proto* proto_of(const FunctionStmt* fn) const;
+
+    /// @brief 取函数调用的词法外层帧下标（嵌套函数在外层函数活动帧外被调用时抛 RuntimeError）
+    size_t enclosing_frame(const FunctionStmt* fn, size_t line, size_t column) const;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    std::ostream& out_;
+    std::unique_ptr<Program> program_;
+    std::vector<Value> stack_;       ///< 值栈：各帧寄存器窗口
+    std::vector<CallFrame> frames_;  ///< 帧栈（frames_[0] 为全局帧）
+    size_t max_call_depth_ = kDefaultMaxCallDepth;
+    InlineCacheStats cache_stats_;
+};
+
+} // namespace bytecode
+} // namespace collie
+
+#endif // COLLIE_BYTECODE_VM_H
@@ -1,99 +1,131 @@
 /*
  * @Author: Zhang Bokai <zbrook@126.com>
  * @Date: 2026-07-25
- * @Description: 解释器的变量作用域链
+ * @Description: 解释器的变量帧栈（按槽位索引）
  */
 #ifndef COLLIE_INTERPRETER_ENVIRONMENT_H
 #define COLLIE_INTERPRETER_ENVIRONMENT_H
 
-#include <string>
-#include <unordered_map>
+#include <cstddef>
 #include <vector>
 #include "value.h"
+#include "../parser/ast.h"
 #include "../lexer/token.h"
 
 namespace collie {
 
 /**
- * @brief 变量作用域链
+ * @brief 变量帧栈
  *
- * 用作用域栈实现变量的声明、读取与赋值。内层作用域可遮蔽外层的同名变量；
- * 读取/赋值按从内到外的顺序查找。支持 const 变量保护与声明类型记录。
+ * 每次函数/方法调用压入一帧，全局代码占栈底的全局帧。帧内变量按 Resolver
+ * 分配的槽位存放（块作用域已在解析期展平），读写为数组下标，不再按名字查找。
+ * 每帧记录词法外层帧的下标，VarSlot 的 depth 沿这条链向外跳转；
+ * 全局引用直接索引全局帧。支持 const 变量保护与声明类型记录。
  */
 class Environment {
 public:
-    Environment() { push_scope(); }  // 全局作用域
+    /// 变量槽：值 + const 标记 + 声明类型（KW_OBJECT 表示动态类型，不做运行期校验）
+    struct Binding {
+        Value value;
+        bool is_const = false;
+        TokenType declared_type = TokenType::KW_OBJECT;
+    };
 
-    void push_scope() { scopes_.emplace_back(); }
-    void pop_scope() {
-        if (scopes_.size() > 1) scopes_.pop_back();
-    }
+    Environment() { frames_.emplace_back(); }  // 全局帧
 
-    /// @brief 在当前作用域声明变量（允许遮蔽外层同名变量）
-    /// declared_type 缺省 KW_OBJECT 表示动态类型（不做运行期校验）
-    void define(const std::string& name, const Value& value, bool is_const = false,
-                TokenType declared_type = TokenType::KW_OBJECT) {
-        scopes_.back()[name] = Binding{value, is_const, declared_type};
+    /// @brief 按 Resolver 给出的全局槽位数重置全局帧
+    void reset_globals(size_t slot_count) {
+        frames_[0].slots.assign(slot_count, Binding{});
     }
 
-    /// @brief 从内到外查找变量，找到返回其值指针，否则返回 nullptr
-    Value* get(const std::string& name) {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            auto found = it->find(name);
-            if (found != it->end()) return &found->second.value;
+    /// @brief 压入函数帧（parent 为词法外层帧下标）
+    void push_frame(const FunctionStmt* function, size_t slot_count, size_t parent) {
+        if (++top_ == frames_.size()) {
+            frames_.emplace_back();
         }
-        return nullptr;
+        // 复用已退出帧的存储（保留容量），避免每次调用重新分配
+        Frame& frame = frames_[top_];
+        frame.slots.assign(slot_count, Binding{});
+        frame.function = function;
+        frame.parent = parent;
     }
 
-    /// @brief 检查变量是否为 const（从内到外查找）
-    bool is_const(const std::string& name) const {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            auto found = it->find(name);
-            if (found != it->end()) return found->second.is_const;
-        }
-        return false;
+    /// @brief 以另一函数的新帧原地替换当前帧（尾调用复用帧，帧栈深度不变）
+    void reuse_frame(const FunctionStmt* function, size_t slot_count, size_t parent) {
+        Frame& frame = frames_[top_];
+        frame.slots.assign(slot_count, Binding{});
+        frame.function = function;
+        frame.parent = parent;
     }
 
-    /// @brief 查询变量的声明类型（从内到外查找；未声明返回 KW_OBJECT 动态放行）
-    TokenType declared_type(const std::string& name) const {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            auto found = it->find(name);
-            if (found != it->end()) return found->second.declared_type;
+    void pop_frame() {
+        if (top_ == 0) return;
+        frames_[top_].slots.clear();  // 及时释放帧内引用的数组/实例
+        --top_;
+    }
+
+    /// @brief 当前帧下标（全局帧为 0）
+    size_t current_frame() const { return top_; }
+
+    /// @brief 当前帧所属函数（全局帧为 nullptr）
+    const FunctionStmt* current_function() const { return frames_[top_].function; }
+
+    /**
+     * @brief 取函数 function 的一次活动帧下标：从当前帧沿词法外层链查找；
+     * 找不到返回 npos（嵌套函数被带出其外层函数后调用）
+     */
+    size_t find_frame(const FunctionStmt* function) const {
+        size_t index = top_;
+        while (true) {
+            if (frames_[index].function == function) return index;
+            if (index == 0) return npos;
+            index = frames_[index].parent;
         }
-        return TokenType::KW_OBJECT;
     }
 
-    /// @brief 赋值到最近作用域中已声明的同名变量，成功返回 true
-    bool assign(const std::string& name, const Value& value) {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            auto found = it->find(name);
-            if (found != it->end()) {
-                found->second.value = value;
-                return true;
-            }
+    /// @brief 按解析结果取变量槽，未解析返回 nullptr
+    Binding* lookup(const VarSlot& ref) {
+        if (!ref.resolved()) return nullptr;
+        size_t index = ref.global ? 0 : top_;
+        for (int d = 0; d < ref.depth; ++d) {
+            index = frames_[index].parent;
         }
-        return false;
+        return &frames_[index].slots[static_cast<size_t>(ref.slot)];
     }
 
+    /// @brief 在当前帧的指定槽位声明变量（允许遮蔽外层同名变量）
+    void define(int slot, const Value& value, bool is_const = false,
+                TokenType declared_type = TokenType::KW_OBJECT) {
+        frames_[top_].slots[static_cast<size_t>(slot)] =
+            Binding{value, is_const, declared_type};
+    }
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
 private:
-    struct Binding {
-        Value value;
-        bool is_const = false;
-        TokenType declared_type = TokenType::KW_OBJECT;
+    struct Frame {
+        std::vector<Binding> slots;
+        const FunctionStmt* function = nullptr;  ///< 所属函数（全局帧为 nullptr）
+        size_t parent = 0;                       ///< 词法外层帧下标
     };
-    std::vector<std::unordered_map<std::string, Binding>> scopes_;
+    std::vector<Frame> frames_;  ///< 帧栈；top_ 之上的帧为可复用的空闲存储
+    size_t top_ = 0;
 };
 
 /**
- * @brief RAII 作用域守卫：构造时进入新作用域，析构时退出。
+ * @brief RAII 帧守卫：构造时压入函数帧，析构时弹出（异常路径同样还原）。
  */
-class ScopeGuard {
+class FrameGuard {
 public:
-    explicit ScopeGuard(Environment& env) : env_(env) { env_.push_scope(); }
-    ~ScopeGuard() { env_.pop_scope(); }
+    FrameGuard(Environment& env, const FunctionStmt* function, size_t slot_count,
+               size_t parent)
+        : env_(env) {
+        env_.push_frame(function, slot_count, parent);
+    }
+    ~FrameGuard() { env_.pop_frame(); }
 
-    ScopeGuard(const ScopeGuard&) = delete;
-    ScopeGuard& operator=(const ScopeGuard&) = delete;
+    FrameGuard(const FrameGuard&) = delete;
+    FrameGuard& operator=(const FrameGuard&) = delete;
 
 private:
     Environment& env_;
@@ -4,6 +4,8 @@
  * @Description: 树遍历解释器（路线 A）的实现
  */
 #include "interpreter.h"
+#include "native_stack.h"
+#include "resolver.h"
 
 #include <algorithm>
 #include <cctype>
@@ -14,239 +16,222 @@
 namespace collie {
 
 namespace {
-// 循环控制流通过异常在解释器内部传递，不对外暴露。
-struct BreakSignal {};
-struct ContinueSignal {};
 
-/// @brief 函数返回控制流信号，携带返回值。
-struct ReturnSignal {
-    Value value;
+/// 每层 Collie 调用消耗的原生栈估计值（visitCall → execute → accept 等多层嵌套，
+/// Debug 构建实测约 1～2KB，留足余量）
+constexpr size_t kNativeBytesPerCall = 4096;
+/// 原生栈预留的上下限：下限即常见的默认线程栈；上限在 64 位只占虚拟地址、
+/// 按需提交，32 位受地址空间限制
+constexpr size_t kMinNativeStack = 8 << 20;
+constexpr size_t kMaxNativeStack =
+    sizeof(void*) >= 8 ? static_cast<size_t>(4ULL << 30) : static_cast<size_t>(256) << 20;
+/// 栈底保留量：两次深度检查之间的表达式嵌套、异常展开与输出仍需要栈空间
+constexpr size_t kNativeStackReserve = 512 << 10;
+
+/// 按调用深度上限估算执行线程所需的原生栈容量
+size_t native_stack_size(size_t max_call_depth) {
+    if (max_call_depth >= (kMaxNativeStack - kNativeStackReserve) / kNativeBytesPerCall) {
+        return kMaxNativeStack;
+    }
+    return std::max(kMinNativeStack, max_call_depth * kNativeBytesPerCall + kNativeStackReserve);
+}
+
+/// 静态类型是否保证值为 number（见 ExprTypeTable）
+bool is_numeric_static(TokenType type) {
+    return runtime::satisfies_declared(TokenType::KW_NUMBER, type);
+}
+
+bool is_arithmetic_op(TokenType type) {
+    switch (type) {
+        case TokenType::OP_PLUS:
+        case TokenType::OP_MINUS:
+        case TokenType::OP_MULTIPLY:
+        case TokenType::OP_DIVIDE:
+        case TokenType::OP_MODULO:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// 调用退出时（含异常路径）回退 enter_call 增加的调用深度
+struct DepthGuard {
+    size_t& depth;
+    ~DepthGuard() { --depth; }
 };
-}  // namespace
+
+} // namespace
 
 // -----------------------------------------------------------------------------
 // 顶层入口
 // -----------------------------------------------------------------------------
-void Interpreter::interpret(const std::vector<std::unique_ptr<Stmt>>& statements) {
-    for (const auto& stmt : statements) {
-        execute(stmt.get());
-    }
+void Interpreter::interpret(const std::vector<StmtPtr>& statements) {
+    // 变量解析：为声明分配槽位、把引用绑定到 (depth, slot)，执行期按下标访问
+    Resolver resolver(expr_types_);
+    env_.reset_globals(static_cast<size_t>(resolver.resolve(statements)));
+    literals_ = resolver.take_literals();
+    call_depth_ = 0;
+
+    // 每层 Collie 调用嵌套若干层 C++ 帧，默认线程栈只够数千层：
+    // 换到按深度上限预留的大栈线程上执行，并记录栈起点供 enter_call 检查剩余量
+    run_on_native_stack(native_stack_size(max_call_depth_), [&](size_t available) {
+        char marker;
+        native_stack_base_ = reinterpret_cast<uintptr_t>(&marker);
+        native_stack_budget_ =
+            available > kNativeStackReserve ? available - kNativeStackReserve : 0;
+        // 顶层函数与类先登记再执行语句，支持引用源码中位于其后的函数和类（与 VM 一致）
+        for (const auto& stmt : statements) {
+            if (auto* fn = dynamic_cast<const FunctionStmt*>(stmt.get())) {
+                env_.define(fn->slot(), Value::function(fn));
+            } else if (auto* klass = dynamic_cast<const ClassStmt*>(stmt.get())) {
+                classes_.define(*klass);
+            }
+        }
+        for (const auto& stmt : statements) {
+            execute(stmt.get());
+        }
+    });
 }
 
 Value Interpreter::evaluate(const Expr* expr) {
     expr->accept(*this);
-    return result_;
+    return std::move(result_);
 }
 
-void Interpreter::execute(const Stmt* stmt) {
+Interpreter::Completion Interpreter::execute(const Stmt* stmt) {
+    completion_ = Completion::Normal;
     stmt->accept(*this);
+    return completion_;
 }
 
-void Interpreter::execute_block(const BlockStmt& block) {
-    ScopeGuard guard(env_);
+Interpreter::Completion Interpreter::execute_block(const BlockStmt& block) {
+    // 块内局部变量已由 Resolver 展平为所在帧的槽位，块本身无需压栈；
+    // 遇 break/continue/return 立即停止，把完成状态交给外层语句处理
     for (const auto& stmt : block.statements()) {
-        execute(stmt.get());
+        Completion completion = execute(stmt.get());
+        if (completion != Completion::Normal) {
+            return completion;
+        }
     }
+    return Completion::Normal;
 }
 
 // -----------------------------------------------------------------------------
 // 表达式
 // -----------------------------------------------------------------------------
 void Interpreter::visitLiteral(const LiteralExpr& expr) {
-    const Token& tok = expr.token();
-    std::string lexeme(tok.lexeme());
-    switch (tok.type()) {
-        case TokenType::LITERAL_NUMBER:
-            // 特殊数值字面量（词法层把 Infinity/NaN 归为 LITERAL_NUMBER）；
-            // 不依赖 std::stod 对 "Infinity"/"NaN" 拼写的平台行为，显式特判
-            if (lexeme == "Infinity") {
-                result_ = Value::number(std::numeric_limits<double>::infinity());
-            } else if (lexeme == "NaN") {
-                result_ = Value::number(std::numeric_limits<double>::quiet_NaN());
-            } else if (lexeme.size() > 1 && lexeme[0] == '0' &&
-                       (lexeme[1] == 'x' || lexeme[1] == 'X')) {
-                // 十六进制整数字面量（t47）：逐位 *16+digit 累积为 BigInt，
-                // 任意精度精确（不经 64 位）
-                BigInt acc(0);
-                BigInt sixteen(16);
-                for (size_t i = 2; i < lexeme.size(); ++i) {
-                    char c = lexeme[i];
-                    int d;
-                    if (c >= '0' && c <= '9') d = c - '0';
-                    else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
-                    else d = c - 'A' + 10;
-                    acc = acc * sixteen + BigInt(static_cast<long long>(d));
-                }
-                result_ = Value::integer(std::move(acc));
-            } else if (lexeme.find_first_of(".eEf") == std::string::npos) {
-                // 整数字面量（t42）：BigInt 任意精度承载，不经 double 不丢精度
-                result_ = Value::integer(BigInt::from_decimal_string(lexeme));
-            } else {
-                // 小数字面量（含 '.'/'e'/'f'）：stod 解析自然停在 'f' 后缀处
-                result_ = Value::number(std::stod(lexeme));
-            }
-            break;
-        case TokenType::LITERAL_STRING:
-        case TokenType::LITERAL_CHAR:
-        case TokenType::LITERAL_CHARACTER:
-            // 词法器已完成转义解码，lexeme 即为字符串内容
-            result_ = Value::str(std::move(lexeme));
-            break;
-        case TokenType::KW_TRUE:
-            result_ = Value::boolean(true);
-            break;
-        case TokenType::KW_FALSE:
-            result_ = Value::boolean(false);
-            break;
-        case TokenType::KW_UNSET:
-            // unset 为 tribool 专属字面量（t43，见 draft.md）
-            result_ = Value::tribool(Value::Tri::Unset);
-            break;
-        case TokenType::LITERAL_BOOL:
-            result_ = Value::boolean(lexeme == "true");
-            break;
-        case TokenType::KW_NULL:
-        case TokenType::KW_NONE:
-            result_ = Value::none();
-            break;
-        default:
-            throw RuntimeError("Unsupported literal", tok.line(), tok.column());
+    // 字面量已由 Resolver 预先求值，这里只拷贝（堆载荷仅增引用计数）；
+    // 未解析的只有非法字面量，重新解析以抛出原有 RuntimeError
+    if (expr.constant() < 0) {
+        result_ = runtime::literal_value(expr.token());
+        return;
     }
+    result_ = literals_[expr.constant()];
 }
 
 void Interpreter::visitIdentifier(const IdentifierExpr& expr) {
     const Token& name = expr.name();
-    Value* v = env_.get(std::string(name.lexeme()));
-    if (!v) {
-        // 语义分析通过后一般不会到这里，作为解释器的兜底保护
+    Environment::Binding* binding = env_.lookup(expr.slot());
+    if (!binding) {
+        // 语义分析通过后一般不会到这里（如类体内按裸名引用字段），作为解释器的兜底保护
         throw RuntimeError("Undefined variable '" + std::string(name.lexeme()) + "'",
                            name.line(), name.column());
     }
-    result_ = *v;
+    result_ = binding->value;
 }
 
 void Interpreter::visitBinary(const BinaryExpr& expr) {
     const Token& op = expr.op();
 
     // 逻辑运算需要短路求值：先算左侧，必要时才算右侧。
-    // bool/tribool 混合按 Kleene 三值逻辑（t43，经作者确认）：
-    // Tri 编码 False=0 < Unset=1 < True=2，AND 取 min、OR 取 max；
+    // bool/tribool 混合按 Kleene 三值逻辑（见 runtime::logic_rank），
     // 任一操作数为 tribool 时结果为 tribool，否则保持 bool。
     if (op.type() == TokenType::OP_AND || op.type() == TokenType::OP_OR) {
         const bool is_and = op.type() == TokenType::OP_AND;
-        auto tri_of = [](const Value& v) {
-            if (v.is_tribool()) return static_cast<int>(v.as_tribool());
-            return v.is_truthy() ? 2 : 0;  // 非 tribool 沿用真值判断（object 动态路径）
-        };
         Value left = evaluate(expr.left());
-        int l = tri_of(left);
+        int l = runtime::logic_rank(left);
         // 短路：AND 遇确定 False、OR 遇确定 True 时右侧不求值
         if ((is_and && l == 0) || (!is_and && l == 2)) {
-            result_ = left.is_tribool()
-                ? Value::tribool(static_cast<Value::Tri>(l))
-                : Value::boolean(l == 2);
+            result_ = runtime::logic_result(l, left.is_tribool());
             return;
         }
         Value right = evaluate(expr.right());
-        int r = tri_of(right);
+        int r = runtime::logic_rank(right);
         int combined = is_and ? std::min(l, r) : std::max(l, r);
-        if (left.is_tribool() || right.is_tribool()) {
-            result_ = Value::tribool(static_cast<Value::Tri>(combined));
-        } else {
-            result_ = Value::boolean(combined == 2);
-        }
+        result_ = runtime::logic_result(combined,
+                                        left.is_tribool() || right.is_tribool());
         return;
     }
 
     Value left = evaluate(expr.left());
     Value right = evaluate(expr.right());
-    result_ = eval_binary(op, left, right);
+    if (is_numeric_static(expr.left()->static_type()) &&
+        is_numeric_static(expr.right()->static_type()) &&
+        is_arithmetic_op(op.type())) {
+        // 语义层已证两侧均为 number：不再判断拼接（种类只剩一次比较兜底）
+        result_ = runtime::eval_numeric_arithmetic(op, left, right);
+        return;
+    }
+    if (op.type() == TokenType::OP_PLUS && left.is_string()) {
+        // 左侧为拼接中间结果时独占，交出所有权就地追加
+        result_ = runtime::concat(std::move(left), right);
+        return;
+    }
+    result_ = runtime::eval_binary(op, left, right);
 }
 
 void Interpreter::visitUnary(const UnaryExpr& expr) {
-    const Token& op = expr.op();
-    Value operand = evaluate(expr.operand());
-    switch (op.type()) {
-        case TokenType::OP_MINUS:
-            if (!operand.is_number()) {
-                throw RuntimeError("Unary '-' requires a number", op.line(), op.column());
-            }
-            // 整数值走 BigInt 精确取负，保持整数表示（t42）
-            if (operand.is_integer_value()) {
-                result_ = Value::integer(operand.as_integer().negated());
-            } else {
-                result_ = Value::number(-operand.as_number());
-            }
-            break;
-        case TokenType::OP_NOT:
-            // Kleene 非（t43）：!unset = unset；tribool 结果仍为 tribool
-            if (operand.is_tribool()) {
-                Value::Tri t = operand.as_tribool();
-                result_ = Value::tribool(
-                    t == Value::Tri::Unset
-                        ? Value::Tri::Unset
-                        : (t == Value::Tri::True ? Value::Tri::False
-                                                 : Value::Tri::True));
-            } else {
-                result_ = Value::boolean(!operand.is_truthy());
-            }
-            break;
-        case TokenType::OP_BIT_NOT:
-            // 位取反（t47）：整数值走 BigInt 精确（~x = -x-1，任意精度）
-            if (!operand.is_integer_value()) {
-                throw RuntimeError("Bitwise '~' requires an integer",
-                                   op.line(), op.column());
-            }
-            result_ = Value::integer(operand.as_integer().negated() - BigInt(1));
-            break;
-        default:
-            throw RuntimeError("Unsupported unary operator", op.line(), op.column());
-    }
+    result_ = runtime::eval_unary(expr.op(), evaluate(expr.operand()));
 }
 
 void Interpreter::visitAssign(const AssignExpr& expr) {
     const Token& name = expr.name();
+    const Environment::Binding* target = env_.lookup(expr.slot());
     // const 保护：禁止对常量重新赋值
-    if (env_.is_const(std::string(name.lexeme()))) {
+    if (target && target->is_const) {
         throw RuntimeError("Cannot assign to constant '" +
                                std::string(name.lexeme()) + "'",
                            name.line(), name.column());
     }
     Value value = evaluate(expr.value());
-    // 按变量声明类型校验/隐式转换（未声明时返回 KW_OBJECT 放行，交给下方报 undefined）
-    value = coerce_to_declared(env_.declared_type(std::string(name.lexeme())),
-                               value, name.line(), name.column());
-    if (!env_.assign(std::string(name.lexeme()), value)) {
+    // 右侧求值可能压入新帧，重新按槽位取绑定
+    Environment::Binding* binding = env_.lookup(expr.slot());
+    if (!binding) {
         throw RuntimeError("Assignment to undefined variable '" +
                                std::string(name.lexeme()) + "'",
                            name.line(), name.column());
     }
+    // 按变量声明类型校验/隐式转换（静态类型已满足时省去）
+    if (!runtime::skips_coercion(binding->declared_type, expr.value()->static_type(), value)) {
+        runtime::coerce_in_place(binding->declared_type, value, name.line(), name.column());
+    }
+    binding->value = value;
     result_ = value;  // 赋值表达式的值为所赋的值
 }
 
 void Interpreter::visitCall(const CallExpr& expr) {
-    // 内建函数 print / len / toString / toNumber
-    const IdentifierExpr* callee = dynamic_cast<const IdentifierExpr*>(expr.callee());
-    if (callee && callee->name().lexeme() == "print") {
-        call_builtin_print(expr);
-        return;
-    }
-    if (callee && callee->name().lexeme() == "len") {
-        call_builtin_len(expr);
-        return;
-    }
-    if (callee && callee->name().lexeme() == "toString") {
-        call_builtin_to_string(expr);
-        return;
-    }
-    if (callee && callee->name().lexeme() == "toNumber") {
-        call_builtin_to_number(expr);
-        return;
+    // 内建函数 print / len / toString / toNumber（Resolver 已按名字预解析）
+    switch (expr.builtin()) {
+        case BuiltinFunction::Print:    call_builtin_print(expr); return;
+        case BuiltinFunction::Len:      call_builtin_len(expr); return;
+        case BuiltinFunction::ToString: call_builtin_to_string(expr); return;
+        case BuiltinFunction::ToNumber: call_builtin_to_number(expr); return;
+        case BuiltinFunction::None:     break;
     }
 
     // 用户自定义函数调用
+    std::vector<Value> args;
+    const FunctionStmt* fn = evaluate_call(expr, args);
+    const Token& paren = expr.paren();
+    size_t parent = enclosing_frame(fn, paren.line(), paren.column());
+    result_ = call_function(fn, expr, std::move(args), parent);
+}
+
+const FunctionStmt* Interpreter::evaluate_call(const CallExpr& expr,
+                                               std::vector<Value>& args) {
     Value callee_val = evaluate(expr.callee());
     if (!callee_val.is_function()) {
+        const IdentifierExpr* callee = dynamic_cast<const IdentifierExpr*>(expr.callee());
         std::string name = callee ? std::string(callee->name().lexeme()) : "<expr>";
         throw RuntimeError("'" + name + "' is not a function",
                            expr.paren().line(), expr.paren().column());
@@ -255,7 +240,7 @@ void Interpreter::visitCall(const CallExpr& expr) {
     const FunctionStmt* fn = callee_val.as_function();
 
     // 求值实参
-    std::vector<Value> args;
+    args.reserve(expr.arguments().size());
     for (const auto& arg : expr.arguments()) {
         args.push_back(evaluate(arg.get()));
     }
@@ -266,31 +251,79 @@ void Interpreter::visitCall(const CallExpr& expr) {
                                " arguments but got " + std::to_string(args.size()),
                            expr.paren().line(), expr.paren().column());
     }
-
-    // 创建函数作用域并绑定形参（按形参声明类型校验/隐式转换）
-    ScopeGuard guard(env_);
-    for (size_t i = 0; i < fn->parameters().size(); ++i) {
-        const Parameter& param = fn->parameters()[i];
-        Value bound = coerce_to_declared(param.type.type(), args[i],
+    return fn;
+}
+
+Value Interpreter::call_function(const FunctionStmt* fn, const CallExpr& call,
+                                 std::vector<Value> args, size_t parent) {
+    enter_call(call.paren().line(), call.paren().column());
+    DepthGuard depth_guard{call_depth_};
+
+    FrameGuard guard(env_, fn, static_cast<size_t>(fn->frame_size()), parent);
+    const FunctionStmt* tail_caller = nullptr;  ///< 以尾调用进入 fn 的函数
+    const CallExpr* site = &call;  ///< 当前 fn 的调用点（尾调用后随之切换）
+    while (true) {
+        // 绑定形参（形参占槽位 0..n-1，按形参声明类型校验/隐式转换；
+        // 实参静态类型已满足形参类型时直接绑定）
+        for (size_t i = 0; i < fn->parameters().size(); ++i) {
+            const Parameter& param = fn->parameters()[i];
+            TokenType declared = param.type.type();
+            if (!runtime::skips_coercion(declared, site->arguments()[i]->static_type(),
+                                         args[i])) {
+                runtime::coerce_in_place(declared, args[i],
                                          param.name.line(), param.name.column());
-        env_.define(std::string(param.name.lexeme()), bound, false,
-                    param.type.type());
-    }
+            }
+            env_.define(static_cast<int>(i), args[i], false, declared);
+        }
 
-    // 执行函数体，捕获 ReturnSignal（返回值按声明返回类型校验/隐式转换）
-    try {
-        for (const auto& stmt : fn->body()->statements()) {
-            execute(stmt.get());
+        if (execute_block(*fn->body()) != Completion::Return) {
+            // 无显式 return —— 返回 none；经尾调用到达时，none 仍须经过
+            // 尾调用方 return 的返回类型校验（与不做帧复用时一致）
+            if (!tail_caller) return Value::none();
+            return runtime::coerce_to_declared(tail_caller->return_type().type(), Value::none(),
+                                               tail_caller->return_type().line(),
+                                               tail_caller->return_type().column());
         }
-        // 无显式 return —— 返回 none
-        result_ = Value::none();
-    } catch (const ReturnSignal& ret) {
-        result_ = coerce_to_declared(fn->return_type().type(), ret.value,
-                                     fn->return_type().line(),
-                                     fn->return_type().column());
+        completion_ = Completion::Normal;
+        if (!tail_call_.function) {
+            // return 的返回值按声明返回类型校验/隐式转换（静态类型已满足时省去）
+            if (!runtime::skips_coercion(fn->return_type().type(), return_static_type_, return_value_)) {
+                runtime::coerce_in_place(fn->return_type().type(), return_value_,
+                                         fn->return_type().line(),
+                                         fn->return_type().column());
+            }
+            return std::move(return_value_);
+        }
+
+        // 尾调用：被调函数与 fn 返回类型一致（登记时已校验），其返回值即 fn 的返回值，
+        // 直接在本帧内接着执行，不再嵌套 C++ 调用
+        tail_caller = fn;
+        fn = tail_call_.function;
+        site = tail_call_.call;
+        args = std::move(tail_call_.args);
+        tail_call_.function = nullptr;
+        env_.reuse_frame(fn, static_cast<size_t>(fn->frame_size()), tail_call_.parent);
     }
 }
 
+void Interpreter::enter_call(size_t line, size_t column) {
+    if (call_depth_ >= max_call_depth_) {
+        throw runtime::call_depth_exceeded(max_call_depth_, line, column);
+    }
+    // 深度上限之外再按实际栈用量兜底（上限调得过大或单层帧异常大时）
+    char marker;
+    uintptr_t here = reinterpret_cast<uintptr_t>(&marker);
+    size_t used = here < native_stack_base_ ? native_stack_base_ - here
+                                            : here - native_stack_base_;
+    if (used > native_stack_budget_) {
+        throw RuntimeError("Native stack exhausted at call depth " +
+                               std::to_string(call_depth_) +
+                               " (lower --max-depth or use --engine=vm)",
+                           line, column);
+    }
+    ++call_depth_;
+}
+
 void Interpreter::call_builtin_print(const CallExpr& expr) {
     // print(a, b, ...)：各参数以单个空格分隔，末尾换行。
     const auto& args = expr.arguments();
@@ -310,17 +343,8 @@ void Interpreter::call_builtin_len(const CallExpr& expr) {
         throw RuntimeError("len() expects exactly 1 argument",
                            expr.paren().line(), expr.paren().column());
     }
-    Value v = evaluate(args[0].get());
-    if (v.is_array()) {
-        result_ = Value::integer(BigInt(static_cast<long long>(v.as_array().size())));
-        return;
-    }
-    if (!v.is_string()) {
-        throw RuntimeError(std::string("len() expects a string or array, got ") + v.kind_name(),
-                           expr.paren().line(), expr.paren().column());
-    }
-    // 长度恒为整数（t42）
-    result_ = Value::integer(BigInt(static_cast<long long>(utf8_length(v.as_string()))));
+    result_ = runtime::builtin_len(evaluate(args[0].get()),
+                                   expr.paren().line(), expr.paren().column());
 }
 
 void Interpreter::call_builtin_to_string(const CallExpr& expr) {
@@ -340,169 +364,8 @@ void Interpreter::call_builtin_to_number(const CallExpr& expr) {
         throw RuntimeError("toNumber() expects exactly 1 argument",
                            expr.paren().line(), expr.paren().column());
     }
-    result_ = to_number_value(evaluate(args[0].get()),
-                              expr.paren().line(), expr.paren().column());
-}
-
-Value Interpreter::coerce_to_declared(TokenType declared, const Value& value,
-                                      size_t line, size_t column) {
-    switch (declared) {
-        case TokenType::KW_NUMBER:
-            if (!value.is_number()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'number' variable",
-                                   line, column);
-            }
-            return value;
-        case TokenType::KW_INTEGER:
-            // integer 只接受整数表示的值（t42）：decimal 不可隐式窄化
-            if (!value.is_number()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'integer' variable",
-                                   line, column);
-            }
-            if (!value.is_integer_value()) {
-                throw RuntimeError(
-                    "Type mismatch: cannot assign decimal value to 'integer' variable",
-                    line, column);
-            }
-            return value;
-        case TokenType::KW_DECIMAL:
-            // decimal 接受任意数值；整数值隐式加宽为小数表示（t42）
-            if (!value.is_number()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'decimal' variable",
-                                   line, column);
-            }
-            if (value.is_integer_value()) {
-                return Value::number(value.as_number());
-            }
-            return value;
-        case TokenType::KW_BYTE:
-        case TokenType::KW_WORD: {
-            // 位类型运行期校验（t47）：须为整数值，byte 0-255、word 0-65535
-            const char* name = (declared == TokenType::KW_BYTE) ? "byte" : "word";
-            if (!value.is_number() || !value.is_integer_value()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to '" + name +
-                                       "' variable",
-                                   line, column);
-            }
-            const BigInt& iv = value.as_integer();
-            const long long max_val =
-                (declared == TokenType::KW_BYTE) ? 255LL : 65535LL;
-            if (BigInt::compare(iv, BigInt(0)) < 0 ||
-                BigInt::compare(iv, BigInt(max_val)) > 0) {
-                throw RuntimeError(std::string("Value out of range for '") + name +
-                                       "' (expected 0-" + std::to_string(max_val) +
-                                       ", got " + iv.to_string() + ")",
-                                   line, column);
-            }
-            return value;
-        }
-        case TokenType::KW_BOOL:
-            if (!value.is_bool()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'bool' variable",
-                                   line, column);
-            }
-            return value;
-        case TokenType::KW_TRIBOOL:
-            // tribool 接受 bool 隐式加宽（t43）；反向（tribool -> bool）不允许
-            if (value.is_tribool()) {
-                return value;
-            }
-            if (value.is_bool()) {
-                return Value::tribool(value.as_bool() ? Value::Tri::True
-                                                      : Value::Tri::False);
-            }
-            throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                   value.kind_name() + " to 'tribool' variable",
-                               line, column);
-        case TokenType::KW_ARRAY:
-            if (!value.is_array()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'array' variable",
-                                   line, column);
-            }
-            return value;
-        case TokenType::KW_TUPLE:
-            if (!value.is_tuple()) {
-                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                       value.kind_name() + " to 'Tuple' variable",
-                                   line, column);
-            }
-            return value;
-        case TokenType::KW_STRING:
-            if (value.is_string()) {
-                return value;
-            }
-            // 语义层允许 number/bool 隐式转 string，运行期在此落地
-            if (value.is_number() || value.is_bool()) {
-                return Value::str(value.to_string());
-            }
-            throw RuntimeError(std::string("Type mismatch: cannot assign ") +
-                                   value.kind_name() + " to 'string' variable",
-                               line, column);
-        default:
-            // object/类名（IDENTIFIER）等动态类型不校验
-            return value;
-    }
-}
-
-Value Interpreter::to_number_value(const Value& v, size_t line, size_t column) {
-    if (v.is_number()) {
-        return v;
-    }
-    if (v.is_bool()) {
-        // bool 转整数 0/1（t42：保持整数表示）
-        return Value::integer(BigInt(v.as_bool() ? 1 : 0));
-    }
-    if (v.is_string()) {
-        // 两端去空白后解析；不可解析的字符串按文档返回 NaN（见 04-numeric.md：
-        // "infinity".toNumber() == NaN），不再报运行时错误。
-        const std::string& raw = v.as_string();
-        size_t b = 0, e = raw.size();
-        while (b < e && std::isspace(static_cast<unsigned char>(raw[b]))) ++b;
-        while (e > b && std::isspace(static_cast<unsigned char>(raw[e - 1]))) --e;
-        std::string s = raw.substr(b, e - b);
-
-        // 特殊形式严格大小写匹配："Infinity"/"+Infinity"/"-Infinity"
-        if (s == "Infinity" || s == "+Infinity") {
-            return Value::number(std::numeric_limits<double>::infinity());
-        }
-        if (s == "-Infinity") {
-            return Value::number(-std::numeric_limits<double>::infinity());
-        }
-        // 纯整数形式（可带符号）走 BigInt 精确转换，不经 double 不丢精度（t42）
-        if (!s.empty()) {
-            size_t digits_begin = (s[0] == '+' || s[0] == '-') ? 1 : 0;
-            bool all_digits = digits_begin < s.size();
-            for (size_t i = digits_begin; i < s.size(); ++i) {
-                if (!std::isdigit(static_cast<unsigned char>(s[i]))) {
-                    all_digits = false;
-                    break;
-                }
-            }
-            if (all_digits) {
-                return Value::integer(BigInt::from_decimal_string(s));
-            }
-        }
-        try {
-            size_t pos = 0;
-            double n = std::stod(s, &pos);
-            // 尾部残留字符视为非法；stod 对 "inf"/"nan" 等拼写宽松，
-            // 非有限结果一律视为不可解析（如 "infinity" 应得 NaN）
-            if (pos == s.size() && std::isfinite(n)) {
-                return Value::number(n);
-            }
-        } catch (const std::exception&) {
-            // fall through: 不可解析 → NaN
-        }
-        return Value::number(std::numeric_limits<double>::quiet_NaN());
-    }
-    throw RuntimeError(std::string("toNumber() cannot convert ") + v.kind_name(),
-                       line, column);
+    result_ = runtime::to_number_value(evaluate(args[0].get()),
+                                       expr.paren().line(), expr.paren().column());
 }
 
 void Interpreter::visitTuple(const TupleExpr& expr) {
@@ -546,7 +409,7 @@ void Interpreter::visitMultiMatch(const MultiMatchExpr& expr) {
     Value target = evaluate(expr.target());
     for (const auto& branch : expr.branches()) {
         for (const auto& value : branch.values) {
-            if (values_equal(target, evaluate(value.get()))) {
+            if (runtime::values_equal(target, evaluate(value.get()))) {
                 result_ = evaluate(branch.result.get());
                 return;
             }
@@ -573,616 +436,70 @@ void Interpreter::visitArrayLiteral(const ArrayLiteralExpr& expr) {
 void Interpreter::visitIndex(const IndexExpr& expr) {
     Value object = evaluate(expr.object());
     Value index = evaluate(expr.index());
-    if (object.is_string()) {
-        // 字符串按 UTF-8 码点索引（与 len 一致），返回单字符子串
-        const std::string& s = object.as_string();
-        size_t i = normalize_index(index, utf8_length(s), expr.bracket());
-        result_ = Value::str(utf8_char_at(s, i));
-        return;
-    }
-    if (object.is_tuple()) {
-        // 元组按位置索引（t45）：0 起始，支持负索引
-        const auto& tup = object.as_tuple();
-        size_t i = normalize_index(index, tup.elements.size(), expr.bracket());
-        result_ = tup.elements[i];
-        return;
-    }
-    if (!object.is_array()) {
-        throw RuntimeError(std::string("Only arrays, strings and tuples can be indexed, got ") +
-                               object.kind_name(),
-                           expr.bracket().line(), expr.bracket().column());
-    }
-    size_t i = normalize_index(index, object.as_array().size(), expr.bracket());
-    result_ = object.as_array()[i];
+    result_ = runtime::index_get(object, index, expr.bracket());
 }
 
 void Interpreter::visitIndexAssign(const IndexAssignExpr& expr) {
     Value object = evaluate(expr.object());
-    if (object.is_string()) {
-        // 语义层已拦截静态可知的情况；这里防御 object 动态路径（如数组元素为字符串）
-        throw RuntimeError("Strings are immutable, cannot assign to index",
-                           expr.bracket().line(), expr.bracket().column());
-    }
-    if (object.is_tuple()) {
-        // 元组不可变（t45）；语义层已拦，这里防御 object 动态路径
-        throw RuntimeError("Tuples are immutable, cannot assign to index",
-                           expr.bracket().line(), expr.bracket().column());
-    }
-    if (!object.is_array()) {
-        throw RuntimeError(std::string("Only arrays can be index-assigned, got ") +
-                               object.kind_name(),
-                           expr.bracket().line(), expr.bracket().column());
-    }
+    runtime::check_index_assignable(object, expr.bracket());
     Value index = evaluate(expr.index());
     Value value = evaluate(expr.value());
-    size_t i = normalize_index(index, object.as_array().size(), expr.bracket());
-    // 数组为引用语义：写入共享底层存储，对所有持有者可见。
-    object.as_array()[i] = value;
+    runtime::index_set(object, index, value, expr.bracket());
     result_ = value;  // 赋值表达式的值为右侧值，支持链式赋值
 }
 
 void Interpreter::visitMethodCall(const MethodCallExpr& expr) {
     Value object = evaluate(expr.object());
-    const std::string name(expr.name().lexeme());
+    const std::string_view name = expr.name().lexeme();
     size_t line = expr.name().line();
     size_t column = expr.name().column();
 
-    // 类实例：沿继承链分发用户定义方法（toString 保留为通用内建兜底）
+    // 类实例：沿继承链分发用户定义方法（toString 保留为通用内建兜底），
+    // 查找结果按接收者类缓存在本调用点上
     if (object.is_instance()) {
-        const ClassStmt* defining_class = nullptr;
-        const FunctionStmt* method =
-            find_method(object.as_instance().klass, name, &defining_class);
-        if (method) {
+        MethodTarget target =
+            runtime::lookup_method(classes_, method_caches_[&expr],
+                                   object.as_instance().klass, name, cache_stats_);
+        if (target.method) {
             std::vector<Value> args;
             for (const auto& argument : expr.arguments()) {
                 args.push_back(evaluate(argument.get()));
             }
-            result_ = call_class_method(object, method, defining_class,
+            result_ = call_class_method(object, target.method, target.defining_class,
                                         args, line, column);
             return;
         }
-        if (name == "toString") {
+        if (expr.builtin() == BuiltinMethod::ToString) {
             result_ = Value::str(object.to_string());
             return;
         }
-        throw RuntimeError("Undefined method '" + name + "' on object",
-                           line, column);
-    }
-
-    // 除 subString/get 外内建方法均为 0 参（语义层已校验，这里防御 object 动态路径）
-    if (name != "subString" && name != "get" && !expr.arguments().empty()) {
-        throw RuntimeError(name + "() expects no arguments", line, column);
-    }
-
-    // tuple 专属方法（t45）：get("key") 按名字动态获取命名字段
-    if (name == "get") {
-        if (!object.is_tuple()) {
-            throw RuntimeError("Method 'get()' is only supported on tuples, got " +
-                                   std::string(object.kind_name()),
-                               line, column);
-        }
-        if (expr.arguments().size() != 1) {
-            throw RuntimeError("get() expects 1 argument(s), got " +
-                                   std::to_string(expr.arguments().size()),
-                               line, column);
-        }
-        Value key = evaluate(expr.arguments()[0].get());
-        if (!key.is_string()) {
-            throw RuntimeError(std::string("get() key must be a string, got ") +
-                                   key.kind_name(),
-                               line, column);
-        }
-        const auto& tup = object.as_tuple();
-        for (size_t i = 0; i < tup.names.size(); ++i) {
-            if (!tup.names[i].empty() && tup.names[i] == key.as_string()) {
-                result_ = tup.elements[i];
-                return;
-            }
-        }
-        throw RuntimeError("Undefined tuple field '" + key.as_string() + "'",
+        throw RuntimeError("Undefined method '" + std::string(name) + "' on object",
                            line, column);
     }
 
-    // 通用方法：与内建函数 toString/toNumber 行为一致
-    if (name == "toString") {
-        result_ = Value::str(object.to_string());
-        return;
-    }
-    if (name == "toNumber") {
-        result_ = to_number_value(object, line, column);
-        return;
-    }
-
-    // tribool 专属方法（t43，经作者确认：条件语境需显式判断，返回 bool）
-    if (name == "isTrue" || name == "isFalse" || name == "isUnset") {
-        if (!object.is_tribool()) {
-            throw RuntimeError("Method '" + name + "()' is only supported on tribool, got " +
-                                   std::string(object.kind_name()),
-                               line, column);
-        }
-        Value::Tri t = object.as_tribool();
-        result_ = Value::boolean(name == "isTrue"    ? t == Value::Tri::True
-                                 : name == "isFalse" ? t == Value::Tri::False
-                                                     : t == Value::Tri::Unset);
-        return;
-    }
-
-    // string 专属方法（见设计文档 03-character.md）
-    if (name == "trim" || name == "trimLeft" || name == "trimRight" ||
-        name == "subString") {
-        if (!object.is_string()) {
-            throw RuntimeError("Method '" + name + "()' is only supported on strings, got " +
-                                   std::string(object.kind_name()),
-                               line, column);
-        }
-        const std::string& s = object.as_string();
-        if (name == "subString") {
-            // .subString(startIndex[, endIndex = length])，endIndex 传 -1/NaN 时取 length；
-            // 区间为 [start, end)，按 UTF-8 码点计数，越界截断、start >= end 时为空串
-            if (expr.arguments().empty() || expr.arguments().size() > 2) {
-                throw RuntimeError("subString() expects 1 to 2 argument(s)", line, column);
-            }
-            Value start_value = evaluate(expr.arguments()[0].get());
-            if (!start_value.is_number()) {
-                throw RuntimeError("subString() indices must be numbers", line, column);
-            }
-            size_t length = utf8_length(s);
-            double end_raw = static_cast<double>(length);
-            if (expr.arguments().size() == 2) {
-                Value end_value = evaluate(expr.arguments()[1].get());
-                if (!end_value.is_number()) {
-                    throw RuntimeError("subString() indices must be numbers", line, column);
-                }
-                end_raw = end_value.as_number();
-                if (std::isnan(end_raw) || end_raw == -1.0) {
-                    end_raw = static_cast<double>(length);
-                }
-            }
-            double start_raw = start_value.as_number();
-            if (std::isnan(start_raw)) { start_raw = 0.0; }
-            double len_d = static_cast<double>(length);
-            double start_d = std::min(std::max(std::floor(start_raw), 0.0), len_d);
-            double end_d = std::min(std::max(std::floor(end_raw), 0.0), len_d);
-            if (start_d >= end_d) {
-                result_ = Value::str("");
-                return;
-            }
-            size_t from = utf8_byte_offset(s, static_cast<size_t>(start_d));
-            size_t to = utf8_byte_offset(s, static_cast<size_t>(end_d));
-            result_ = Value::str(s.substr(from, to - from));
-            return;
-        }
-        // trim 系列：空白字符为空格与 Tab 制表符（见 03-character.md）
-        auto is_blank = [](char c) { return c == ' ' || c == '\t'; };
-        size_t begin = 0;
-        size_t end = s.size();
-        if (name != "trimRight") {
-            while (begin < end && is_blank(s[begin])) { ++begin; }
-        }
-        if (name != "trimLeft") {
-            while (end > begin && is_blank(s[end - 1])) { --end; }
-        }
-        result_ = Value::str(s.substr(begin, end - begin));
-        return;
-    }
-
-    // number 专属方法（见设计文档 04-numeric.md）
-    if (!object.is_number()) {
-        throw RuntimeError("Method '" + name + "()' is only supported on numbers, got " +
-                               std::string(object.kind_name()),
-                           line, column);
-    }
-    // 整数表示的精确路径（t42）：超大整数经 double 会丢精度/饱和为 Infinity，
-    // 故直接按 BigInt 回答；整数恒有限、恒非 NaN/Infinity
-    if (object.is_integer_value()) {
-        const BigInt& n = object.as_integer();
-        if (name == "abs") {
-            result_ = Value::integer(n.sign() < 0 ? n.negated() : n);
-            return;
-        }
-        if (name == "integerPart") { result_ = Value::integer(n); return; }
-        if (name == "decimalPart") { result_ = Value::integer(BigInt(0)); return; }
-        if (name == "isInteger")   { result_ = Value::boolean(true); return; }
-        if (name == "isDecimal")   { result_ = Value::boolean(false); return; }
-        if (name == "isNaN")       { result_ = Value::boolean(false); return; }
-        if (name == "isInfinity")  { result_ = Value::boolean(false); return; }
-        if (name == "isFinite")    { result_ = Value::boolean(true); return; }
-        if (name == "isPositive")  { result_ = Value::boolean(n.sign() > 0); return; }
-        if (name == "isNegative")  { result_ = Value::boolean(n.sign() < 0); return; }
-        throw RuntimeError("Unknown method '" + name + "'", line, column);
-    }
-    double a = object.as_number();
-    if (name == "abs") {
-        result_ = Value::number(std::fabs(a));
-    } else if (name == "integerPart") {
-        // 向零取整：-123.456.integerPart() == -123
-        result_ = Value::number(std::trunc(a));
-    } else if (name == "decimalPart") {
-        // 保留符号：-123.456.decimalPart() == -0.456
-        result_ = Value::number(a - std::trunc(a));
-    } else if (name == "isInteger") {
-        result_ = Value::boolean(std::isfinite(a) && a == std::floor(a));
-    } else if (name == "isDecimal") {
-        // 文档规定 Infinity/NaN 的 isInteger/isDecimal 均为 false
-        result_ = Value::boolean(std::isfinite(a) && a != std::floor(a));
-    } else if (name == "isNaN") {
-        result_ = Value::boolean(std::isnan(a));
-    } else if (name == "isInfinity") {
-        result_ = Value::boolean(std::isinf(a));
-    } else if (name == "isFinite") {
-        result_ = Value::boolean(std::isfinite(a));
-    } else if (name == "isPositive") {
-        result_ = Value::boolean(a > 0.0);   // NaN 与 0 均为 false
-    } else if (name == "isNegative") {
-        result_ = Value::boolean(a < 0.0);
-    } else {
-        throw RuntimeError("Unknown method '" + name + "'", line, column);
+    // 非实例值：内建方法（tuple/string/number/tribool 及通用 toString/toNumber）
+    std::vector<Value> args;
+    for (const auto& argument : expr.arguments()) {
+        args.push_back(evaluate(argument.get()));
     }
+    result_ = runtime::call_builtin_method(object, expr.builtin(), name, args, line, column);
 }
 
 void Interpreter::visitProperty(const PropertyExpr& expr) {
     Value object = evaluate(expr.object());
-    const std::string name(expr.name().lexeme());
-    size_t line = expr.name().line();
-    size_t column = expr.name().column();
-
-    // 类实例：读取字段（字段需在类体中声明，未声明即报错）
+    const Token& name = expr.name();
+    // 类实例：字段槽位按接收者类缓存在本访问点上，读取即下标访问
     if (object.is_instance()) {
-        auto& fields = object.as_instance().fields;
-        auto it = fields.find(name);
-        if (it == fields.end()) {
-            throw RuntimeError("Undefined property '" + name + "' on object",
-                               line, column);
-        }
-        result_ = it->second;
+        InstanceData& instance = object.as_instance();
+        FieldTarget target = runtime::lookup_field(classes_, field_caches_[&expr],
+                                                   instance.klass, name.lexeme(),
+                                                   cache_stats_);
+        result_ = runtime::instance_field(instance, target, name.lexeme(),
+                                          name.line(), name.column());
         return;
     }
-
-    // 元组（t45）：length 属性与命名字段读取
-    if (object.is_tuple()) {
-        const auto& tup = object.as_tuple();
-        if (name == "length") {
-            result_ = Value::integer(
-                BigInt(static_cast<long long>(tup.elements.size())));
-            return;
-        }
-        for (size_t i = 0; i < tup.names.size(); ++i) {
-            if (tup.names[i] == name) {
-                result_ = tup.elements[i];
-                return;
-            }
-        }
-        throw RuntimeError("Undefined tuple field '" + name + "'", line, column);
-    }
-
-    // 内建属性（见设计文档 03-character.md）：string 按 UTF-8 码点计数；
-    // 长度恒为整数（t42）
-    if (name == "length") {
-        if (object.is_string()) {
-            result_ = Value::integer(
-                BigInt(static_cast<long long>(utf8_length(object.as_string()))));
-            return;
-        }
-        if (object.is_array()) {
-            result_ = Value::integer(
-                BigInt(static_cast<long long>(object.as_array().size())));
-            return;
-        }
-        throw RuntimeError(
-            std::string("Property 'length' is only supported on strings and arrays, got ") +
-                object.kind_name(),
-            line, column);
-    }
-    throw RuntimeError("Unknown property '" + name + "'", line, column);
-}
-
-size_t Interpreter::normalize_index(const Value& index, size_t size,
-                                    const Token& bracket) {
-    if (!index.is_number()) {
-        throw RuntimeError(std::string("Index must be a number, got ") +
-                               index.kind_name(),
-                           bracket.line(), bracket.column());
-    }
-    double raw = index.as_number();
-    if (raw != std::floor(raw)) {
-        throw RuntimeError("Index must be an integer",
-                           bracket.line(), bracket.column());
-    }
-    long long i = static_cast<long long>(raw);
-    // 负索引：-1 表示最后一个元素
-    if (i < 0) {
-        i += static_cast<long long>(size);
-    }
-    if (i < 0 || i >= static_cast<long long>(size)) {
-        throw RuntimeError("Index " + index.to_string() +
-                               " out of range (size " + std::to_string(size) + ")",
-                           bracket.line(), bracket.column());
-    }
-    return static_cast<size_t>(i);
-}
-
-namespace {
-/// UTF-8 首字节 → 码点字节长度（非法字节按 1 处理，防御性前进）
-size_t utf8_char_length(unsigned char c) {
-    if ((c & 0x80) == 0)    return 1;  // ASCII
-    if ((c & 0xE0) == 0xC0) return 2;
-    if ((c & 0xF0) == 0xE0) return 3;
-    if ((c & 0xF8) == 0xF0) return 4;
-    return 1;
-}
-}  // namespace
-
-size_t Interpreter::utf8_length(const std::string& s) {
-    size_t count = 0;
-    for (size_t i = 0; i < s.size(); ) {
-        i += utf8_char_length(static_cast<unsigned char>(s[i]));
-        ++count;
-    }
-    return count;
-}
-
-std::string Interpreter::utf8_char_at(const std::string& s, size_t index) {
-    size_t byte = 0;
-    for (size_t seen = 0; byte < s.size(); ++seen) {
-        size_t char_len = utf8_char_length(static_cast<unsigned char>(s[byte]));
-        if (seen == index) {
-            return s.substr(byte, char_len);
-        }
-        byte += char_len;
-    }
-    return "";  // 前置条件保证不到达（index < utf8_length(s)）
-}
-
-size_t Interpreter::utf8_byte_offset(const std::string& s, size_t index) {
-    size_t byte = 0;
-    for (size_t seen = 0; byte < s.size() && seen < index; ++seen) {
-        byte += utf8_char_length(static_cast<unsigned char>(s[byte]));
-    }
-    return byte;
-}
-
-// -----------------------------------------------------------------------------
-// 二元运算
-// -----------------------------------------------------------------------------
-Value Interpreter::eval_binary(const Token& op, const Value& left, const Value& right) {
-    switch (op.type()) {
-        case TokenType::OP_PLUS:
-        case TokenType::OP_MINUS:
-        case TokenType::OP_MULTIPLY:
-        case TokenType::OP_DIVIDE:
-        case TokenType::OP_MODULO:
-            return eval_arithmetic(op, left, right);
-
-        case TokenType::OP_EQUAL:
-            return Value::boolean(values_equal(left, right));
-        case TokenType::OP_NOT_EQUAL:
-            return Value::boolean(!values_equal(left, right));
-
-        case TokenType::OP_GREATER:
-        case TokenType::OP_LESS:
-        case TokenType::OP_GREATER_EQ:
-        case TokenType::OP_LESS_EQ:
-            return eval_comparison(op, left, right);
-
-        case TokenType::OP_BIT_AND:
-        case TokenType::OP_BIT_OR:
-        case TokenType::OP_BIT_XOR:
-        case TokenType::OP_BIT_LSHIFT:
-        case TokenType::OP_BIT_RSHIFT:
-            return eval_bitwise(op, left, right);
-
-        default:
-            throw RuntimeError("Unsupported binary operator", op.line(), op.column());
-    }
-}
-
-Value Interpreter::eval_arithmetic(const Token& op, const Value& left, const Value& right) {
-    // '+' 在任一侧为字符串时表示拼接
-    if (op.type() == TokenType::OP_PLUS &&
-        (left.is_string() || right.is_string())) {
-        return Value::str(left.to_string() + right.to_string());
-    }
-
-    if (!left.is_number() || !right.is_number()) {
-        throw RuntimeError("Arithmetic operands must be numbers", op.line(), op.column());
-    }
-
-    // 双整数精确路径（t42）：+ - * % 走 BigInt，自动扩容不溢出；
-    // 除法恒产小数（Python 式 true division），落到下方 double 路径；
-    // 取模除数为 0 时同样落到 double 路径得 NaN（保持 IEEE 754 语义）
-    if (left.is_integer_value() && right.is_integer_value()) {
-        const BigInt& ia = left.as_integer();
-        const BigInt& ib = right.as_integer();
-        switch (op.type()) {
-            case TokenType::OP_PLUS:     return Value::integer(ia + ib);
-            case TokenType::OP_MINUS:    return Value::integer(ia - ib);
-            case TokenType::OP_MULTIPLY: return Value::integer(ia * ib);
-            case TokenType::OP_MODULO:
-                // floor 语义（Python 风格）：结果符号与除数一致
-                if (!ib.is_zero()) {
-                    return Value::integer(ia.floor_mod(ib));
-                }
-                break;
-            default:
-                break;
-        }
-    }
-
-    double a = left.as_number();
-    double b = right.as_number();
-    switch (op.type()) {
-        case TokenType::OP_PLUS:     return Value::number(a + b);
-        case TokenType::OP_MINUS:    return Value::number(a - b);
-        case TokenType::OP_MULTIPLY: return Value::number(a * b);
-        case TokenType::OP_DIVIDE:
-            // 除零遵循 IEEE 754（与 t31 的 Infinity/NaN 语义衔接，经作者确认）：
-            // 1/0 → +Infinity、-1/0 → -Infinity、0/0 → NaN
-            return Value::number(a / b);
-        case TokenType::OP_MODULO: {
-            // 取模除数为 0 同样遵循 IEEE 754：fmod(x, 0) → NaN
-            if (b == 0.0) {
-                return Value::number(std::numeric_limits<double>::quiet_NaN());
-            }
-            // 设计文档规定取模为 floor 语义（Python 风格）：结果符号与除数一致，
-            // 如 -1 % 5 == 4、-1 % -5 == -1、1 % -5 == -4（见 04-numeric.md）
-            double r = std::fmod(a, b);
-            if (r != 0.0 && ((r < 0.0) != (b < 0.0))) {
-                r += b;
-            }
-            return Value::number(r);
-        }
-        default:
-            throw RuntimeError("Unsupported arithmetic operator", op.line(), op.column());
-    }
-}
-
-Value Interpreter::eval_bitwise(const Token& op, const Value& left, const Value& right) {
-    // 位运算仅在整数域内定义（t47）：两侧必须是整数值；
-    // 求值走 int64 路径（超出 64 位范围报运行时错误，不静默截断）
-    if (!left.is_integer_value() || !right.is_integer_value()) {
-        throw RuntimeError("Bitwise operands must be integers",
-                           op.line(), op.column());
-    }
-    auto to_i64 = [&op](const Value& v) -> long long {
-        try {
-            return std::stoll(v.as_integer().to_string());
-        } catch (const std::out_of_range&) {
-            throw RuntimeError("Bitwise operand out of 64-bit range",
-                               op.line(), op.column());
-        }
-    };
-    long long a = to_i64(left);
-    long long b = to_i64(right);
-
-    switch (op.type()) {
-        case TokenType::OP_BIT_AND:
-            return Value::integer(BigInt(a & b));
-        case TokenType::OP_BIT_OR:
-            return Value::integer(BigInt(a | b));
-        case TokenType::OP_BIT_XOR:
-            return Value::integer(BigInt(a ^ b));
-        case TokenType::OP_BIT_LSHIFT:
-        case TokenType::OP_BIT_RSHIFT: {
-            // 移位数限 0-63，避免 C++ 未定义行为
-            if (b < 0 || b > 63) {
-                throw RuntimeError("Shift count must be in range 0-63",
-                                   op.line(), op.column());
-            }
-            if (op.type() == TokenType::OP_BIT_LSHIFT) {
-                // 无符号域内左移再转回，回避负数左移的 UB
-                return Value::integer(BigInt(static_cast<long long>(
-                    static_cast<unsigned long long>(a) << b)));
-            }
-            // 右移为算术移位（符号位扩展，C++20 起标准保证）
-            return Value::integer(BigInt(a >> b));
-        }
-        default:
-            throw RuntimeError("Unsupported bitwise operator", op.line(), op.column());
-    }
-}
-
-Value Interpreter::eval_comparison(const Token& op, const Value& left, const Value& right) {
-    // 双整数走 BigInt 精确比较（t42，超大整数不受 double 精度影响）
-    if (left.is_integer_value() && right.is_integer_value()) {
-        int c = BigInt::compare(left.as_integer(), right.as_integer());
-        switch (op.type()) {
-            case TokenType::OP_GREATER:    return Value::boolean(c > 0);
-            case TokenType::OP_LESS:       return Value::boolean(c < 0);
-            case TokenType::OP_GREATER_EQ: return Value::boolean(c >= 0);
-            case TokenType::OP_LESS_EQ:    return Value::boolean(c <= 0);
-            default: break;
-        }
-    }
-    // 数字比较
-    if (left.is_number() && right.is_number()) {
-        double a = left.as_number();
-        double b = right.as_number();
-        switch (op.type()) {
-            case TokenType::OP_GREATER:    return Value::boolean(a > b);
-            case TokenType::OP_LESS:       return Value::boolean(a < b);
-            case TokenType::OP_GREATER_EQ: return Value::boolean(a >= b);
-            case TokenType::OP_LESS_EQ:    return Value::boolean(a <= b);
-            default: break;
-        }
-    }
-    // 字符串按字典序比较
-    if (left.is_string() && right.is_string()) {
-        const std::string& a = left.as_string();
-        const std::string& b = right.as_string();
-        switch (op.type()) {
-            case TokenType::OP_GREATER:    return Value::boolean(a > b);
-            case TokenType::OP_LESS:       return Value::boolean(a < b);
-            case TokenType::OP_GREATER_EQ: return Value::boolean(a >= b);
-            case TokenType::OP_LESS_EQ:    return Value::boolean(a <= b);
-            default: break;
-        }
-    }
-    throw RuntimeError("Comparison operands must be both numbers or both strings",
-                       op.line(), op.column());
-}
-
-bool Interpreter::values_equal(const Value& left, const Value& right) {
-    // tribool 与 bool 可等值比较（t43：t == true / t == unset）：三态一致才相等，
-    // unset 与 true/false 均不等；与其他类型比较恒不等
-    if (left.is_tribool() || right.is_tribool()) {
-        auto tri_of = [](const Value& v) {
-            if (v.is_tribool()) return static_cast<int>(v.as_tribool());
-            return v.as_bool() ? 2 : 0;
-        };
-        if ((left.is_tribool() || left.is_bool()) &&
-            (right.is_tribool() || right.is_bool())) {
-            return tri_of(left) == tri_of(right);
-        }
-        return false;
-    }
-    if (left.kind() != right.kind()) return false;
-    switch (left.kind()) {
-        case Value::Kind::None:   return true;
-        case Value::Kind::Bool:   return left.as_bool() == right.as_bool();
-        case Value::Kind::Number:
-            // 双整数走 BigInt 精确相等（t42）；混合表示按 double 视图比较（5 == 5.0）
-            if (left.is_integer_value() && right.is_integer_value()) {
-                return BigInt::compare(left.as_integer(), right.as_integer()) == 0;
-            }
-            return left.as_number() == right.as_number();
-        case Value::Kind::String: return left.as_string() == right.as_string();
-        case Value::Kind::Array: {
-            // 数组按元素逐个深度比较
-            const auto& l = left.as_array();
-            const auto& r = right.as_array();
-            if (l.size() != r.size()) return false;
-            for (size_t i = 0; i < l.size(); ++i) {
-                if (!values_equal(l[i], r[i])) return false;
-            }
-            return true;
-        }
-        case Value::Kind::Tuple: {
-            // 元组按元素与名字表逐个深度比较（名字不同则不相等）
-            const auto& lt = left.as_tuple();
-            const auto& rt = right.as_tuple();
-            if (lt.elements.size() != rt.elements.size()) return false;
-            if (lt.names != rt.names) return false;
-            for (size_t i = 0; i < lt.elements.size(); ++i) {
-                if (!values_equal(lt.elements[i], rt.elements[i])) return false;
-            }
-            return true;
-        }
-        default: break;
-    }
-    return false;
-}
-
-bool Interpreter::condition_truthy(const Value& value, const Token& keyword) {
-    // tribool 不能直接作条件（t43，经作者确认）：必须显式写
-    // isTrue()/isFalse()/isUnset() 或与 true/false/unset 比较，避免
-    // unset 语义含糊；语义层已拦静态可知情况，这里防御动态路径
-    if (value.is_tribool()) {
-        throw RuntimeError(
-            "Condition must be a bool; tribool requires explicit "
-            "isTrue()/isFalse()/isUnset()",
-            keyword.line(), keyword.column());
-    }
-    return value.is_truthy();
+    result_ = runtime::get_property(object, std::string(name.lexeme()),
+                                    name.line(), name.column());
 }
 
 // -----------------------------------------------------------------------------
@@ -1197,19 +514,22 @@ void Interpreter::visitVarDecl(const VarDeclStmt& stmt) {
     // 无初始化时绑定 none，不做校验（首次赋值时再检查）。
     Value value = Value::none();
     if (stmt.initializer()) {
-        value = coerce_to_declared(stmt.type().type(), evaluate(stmt.initializer()),
-                                   stmt.name().line(), stmt.name().column());
+        value = evaluate(stmt.initializer());
+        if (!runtime::skips_coercion(stmt.type().type(),
+                                     stmt.initializer()->static_type(), value)) {
+            runtime::coerce_in_place(stmt.type().type(), value,
+                                     stmt.name().line(), stmt.name().column());
+        }
     }
-    env_.define(std::string(stmt.name().lexeme()), value, stmt.is_const(),
-                stmt.type().type());
+    env_.define(stmt.slot(), value, stmt.is_const(), stmt.type().type());
 }
 
 void Interpreter::visitBlock(const BlockStmt& stmt) {
-    execute_block(stmt);
+    completion_ = execute_block(stmt);
 }
 
 void Interpreter::visitIf(const IfStmt& stmt) {
-    if (condition_truthy(evaluate(stmt.condition()), stmt.if_token())) {
+    if (runtime::condition_truthy(evaluate(stmt.condition()), stmt.if_token())) {
         execute(stmt.then_branch());
     } else if (stmt.else_branch()) {
         execute(stmt.else_branch());
@@ -1217,48 +537,51 @@ void Interpreter::visitIf(const IfStmt& stmt) {
 }
 
 void Interpreter::visitWhile(const WhileStmt& stmt) {
-    while (condition_truthy(evaluate(stmt.condition()), stmt.while_token())) {
-        try {
-            execute(stmt.body());
-        } catch (const BreakSignal&) {
+    while (runtime::condition_truthy(evaluate(stmt.condition()), stmt.while_token())) {
+        Completion completion = execute(stmt.body());
+        if (completion == Completion::Break) {
             break;
-        } catch (const ContinueSignal&) {
-            continue;
+        }
+        if (completion == Completion::Return) {
+            return;  // 保持 Return 状态，交给外层函数调用
         }
     }
+    completion_ = Completion::Normal;
 }
 
 void Interpreter::visitFor(const ForStmt& stmt) {
-    // for 的初始化变量作用域限定在循环内部
-    ScopeGuard guard(env_);
+    // for 的初始化变量作用域限定在循环内部（Resolver 已分配独立槽位）
     if (stmt.initializer()) {
         execute(stmt.initializer());
     }
     while (stmt.condition() == nullptr ||
-           condition_truthy(evaluate(stmt.condition()), stmt.for_token())) {
-        try {
-            execute(stmt.body());
-        } catch (const BreakSignal&) {
+           runtime::condition_truthy(evaluate(stmt.condition()), stmt.for_token())) {
+        Completion completion = execute(stmt.body());
+        if (completion == Completion::Break) {
             break;
-        } catch (const ContinueSignal&) {
-            // 落到下方执行 increment 后继续
         }
+        if (completion == Completion::Return) {
+            return;  // 保持 Return 状态，交给外层函数调用
+        }
+        // 正常结束或 continue：执行 increment 后继续
         if (stmt.increment()) {
             evaluate(stmt.increment());
         }
     }
+    completion_ = Completion::Normal;
 }
 
 void Interpreter::visitDoWhile(const DoWhileStmt& stmt) {
     do {
-        try {
-            execute(stmt.body());
-        } catch (const BreakSignal&) {
+        Completion completion = execute(stmt.body());
+        if (completion == Completion::Break) {
             break;
-        } catch (const ContinueSignal&) {
-            continue;
         }
-    } while (condition_truthy(evaluate(stmt.condition()), stmt.do_token()));
+        if (completion == Completion::Return) {
+            return;  // 保持 Return 状态，交给外层函数调用
+        }
+    } while (runtime::condition_truthy(evaluate(stmt.condition()), stmt.do_token()));
+    completion_ = Completion::Normal;
 }
 
 void Interpreter::visitSwitch(const SwitchStmt& stmt) {
@@ -1274,7 +597,7 @@ void Interpreter::visitSwitch(const SwitchStmt& stmt) {
         // 检查是否匹配任一值
         for (const auto& val_expr : sc.values) {
             Value val = evaluate(val_expr.get());
-            if (values_equal(cond, val)) {
+            if (runtime::values_equal(cond, val)) {
                 execute(sc.body.get());
                 return; // 匹配后不继续检查其他分支（无 fallthrough）
             }
@@ -1288,21 +611,46 @@ void Interpreter::visitSwitch(const SwitchStmt& stmt) {
 }
 
 void Interpreter::visitFunction(const FunctionStmt& stmt) {
-    // 将函数声明登记到当前作用域（与变量同层存储）。
+    // 将函数声明登记到当前帧的槽位（与变量同层存储）。
     // 函数值持有 FunctionStmt 的非拥有指针（AST 生命周期覆盖解释执行期）。
-    env_.define(std::string(stmt.name().lexeme()), Value::function(&stmt));
+    env_.define(stmt.slot(), Value::function(&stmt));
 }
 
 void Interpreter::visitReturn(const ReturnStmt& stmt) {
-    // 求值 return 表达式（若无表达式则返回 none），通过内部信号传播回 visitCall。
-    Value val = stmt.value() ? evaluate(stmt.value()) : Value::none();
-    throw ReturnSignal{val};
+    // 求值 return 表达式（若无表达式则返回 none），经完成状态逐层传回 visitCall。
+    if (!stmt.tail_call()) {
+        return_value_ = stmt.value() ? evaluate(stmt.value()) : Value::none();
+        return_static_type_ = stmt.value() ? stmt.value()->static_type() : TokenType::INVALID;
+        completion_ = Completion::Return;
+        return;
+    }
+
+    // 尾调用 return f(...)：被调函数不以当前帧为词法外层（帧复用后外层帧还要被访问）、
+    // 且返回类型与当前函数一致（省去当前函数的返回值校验）时，登记给 call_function
+    // 在当前帧内执行；否则按普通调用求值
+    const auto& call = static_cast<const CallExpr&>(*stmt.value());
+    std::vector<Value> args;
+    const FunctionStmt* fn = evaluate_call(call, args);
+    const Token& paren = call.paren();
+    size_t parent = enclosing_frame(fn, paren.line(), paren.column());
+    const FunctionStmt* current = env_.current_function();
+    if (parent != env_.current_frame() &&
+        fn->return_type().type() == current->return_type().type()) {
+        tail_call_.function = fn;
+        tail_call_.call = &call;
+        tail_call_.args = std::move(args);
+        tail_call_.parent = parent;
+    } else {
+        return_value_ = call_function(fn, call, std::move(args), parent);
+        return_static_type_ = call.static_type();
+    }
+    completion_ = Completion::Return;
 }
 
 void Interpreter::visitClass(const ClassStmt& stmt) {
     // 登记类声明（持有 AST 非拥有指针，AST 生命周期覆盖解释执行期）。
     // 字段初始化与构造器执行延迟到 new 时进行。
-    classes_[std::string(stmt.name().lexeme())] = &stmt;
+    classes_.define(stmt);
 }
 
 void Interpreter::visitNew(const NewExpr& expr) {
@@ -1310,35 +658,28 @@ void Interpreter::visitNew(const NewExpr& expr) {
     size_t line = expr.class_name().line();
     size_t column = expr.class_name().column();
 
-    auto it = classes_.find(name);
-    if (it == classes_.end()) {
+    const ClassStmt* klass = classes_.find(name);
+    if (!klass) {
         throw RuntimeError("Undefined class '" + name + "'", line, column);
     }
-    const ClassStmt* klass = it->second;
 
-    // 创建实例并初始化字段：沿继承链 base-first 执行（子类同名字段覆盖），
+    // 创建实例并按字段布局初始化：沿继承链 base-first 执行（子类同名字段覆盖），
     // 有初始化表达式的求值后按字段声明类型校验/隐式转换，否则为 none
-    std::vector<const ClassStmt*> chain;
-    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
-        chain.push_back(c);
-    }
-    auto data = std::make_shared<InstanceData>();
-    data->klass = klass;
-    for (auto rit = chain.rbegin(); rit != chain.rend(); ++rit) {
-        for (const auto& member : (*rit)->members()) {
-            if (auto* field = dynamic_cast<const VarDeclStmt*>(member.get())) {
-                Value init = Value::none();
-                if (field->initializer()) {
-                    init = coerce_to_declared(field->type().type(),
-                                              evaluate(field->initializer()),
-                                              field->name().line(),
-                                              field->name().column());
-                }
-                data->fields[std::string(field->name().lexeme())] = init;
+    const ClassLayout& layout = classes_.layout_of(klass);
+    Value instance = Value::instance(klass, layout.size());
+    for (const ClassLayout::FieldInit& step : layout.inits) {
+        const VarDeclStmt* field = step.field;
+        Value init = Value::none();
+        if (field->initializer()) {
+            init = evaluate(field->initializer());
+            if (!runtime::skips_coercion(field->type().type(),
+                                         field->initializer()->static_type(), init)) {
+                runtime::coerce_in_place(field->type().type(), init,
+                                         field->name().line(), field->name().column());
             }
         }
+        instance.as_instance().fields[step.slot] = init;
     }
-    Value instance = Value::instance(std::move(data));
 
     // 求值构造器实参
     std::vector<Value> args;
@@ -1348,7 +689,7 @@ void Interpreter::visitNew(const NewExpr& expr) {
 
     // 构造器为与类名同名的成员函数（不继承，仅在本类命中）；
     // 无构造器时要求 0 实参，且不隐式调用父类构造器
-    const FunctionStmt* ctor = find_method(klass, name);
+    const FunctionStmt* ctor = classes_.find_method(klass, name);
     if (ctor) {
         call_class_method(instance, ctor, klass, args, line, column);
     } else if (!args.empty()) {
@@ -1361,12 +702,12 @@ void Interpreter::visitNew(const NewExpr& expr) {
 }
 
 void Interpreter::visitThis(const ThisExpr& expr) {
-    Value* value = env_.get("this");
-    if (!value) {
+    const Environment::Binding* binding = env_.lookup(expr.slot());
+    if (!binding) {
         throw RuntimeError("'this' can only be used inside a class method",
                            expr.keyword().line(), expr.keyword().column());
     }
-    result_ = *value;
+    result_ = binding->value;
 }
 
 void Interpreter::visitBaseCall(const BaseCallExpr& expr) {
@@ -1379,16 +720,16 @@ void Interpreter::visitBaseCall(const BaseCallExpr& expr) {
             "'base' requires the enclosing class to have a superclass",
             line, column);
     }
-    const ClassStmt* super = superclass_of(current_class_);
+    const ClassStmt* super = classes_.superclass_of(current_class_);
 
-    Value* self = env_.get("this");
+    const Environment::Binding* self = env_.lookup(expr.this_slot());
     if (!self) {
         throw RuntimeError("'base' can only be used inside a constructor",
                            line, column);
     }
-    // 拷贝一份：call_class_method 内 ScopeGuard 压栈可能重分配环境存储，
-    // 直接引用 env_ 内部指针会悬空
-    Value self_value = *self;
+    // 拷贝一份：实参求值与 call_class_method 内压帧会改写帧栈存储，
+    // 直接引用 env_ 内部指针可能悬空
+    Value self_value = self->value;
 
     std::vector<Value> args;
     for (const auto& argument : expr.arguments()) {
@@ -1397,7 +738,7 @@ void Interpreter::visitBaseCall(const BaseCallExpr& expr) {
 
     // 父类构造器与父类名同名（构造器不继承，仅在父类自身命中）
     const std::string super_name(super->name().lexeme());
-    const FunctionStmt* ctor = find_method(super, super_name);
+    const FunctionStmt* ctor = classes_.find_method(super, super_name);
     if (!ctor) {
         if (!args.empty()) {
             throw RuntimeError("Class '" + super_name +
@@ -1424,16 +765,16 @@ void Interpreter::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
             "'base' requires the enclosing class to have a superclass",
             line, column);
     }
-    const ClassStmt* super = superclass_of(current_class_);
+    const ClassStmt* super = classes_.superclass_of(current_class_);
 
-    Value* self = env_.get("this");
+    const Environment::Binding* self = env_.lookup(expr.this_slot());
     if (!self) {
         throw RuntimeError("'base' can only be used inside a class method",
                            line, column);
     }
-    // 拷贝一份：call_class_method 内 ScopeGuard 压栈可能重分配环境存储，
-    // 直接引用 env_ 内部指针会悬空
-    Value self_value = *self;
+    // 拷贝一份：实参求值与 call_class_method 内压帧会改写帧栈存储，
+    // 直接引用 env_ 内部指针可能悬空
+    Value self_value = self->value;
 
     std::vector<Value> args;
     for (const auto& argument : expr.arguments()) {
@@ -1442,7 +783,7 @@ void Interpreter::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
 
     const std::string method_name(expr.method().lexeme());
     const ClassStmt* defining_class = nullptr;
-    const FunctionStmt* method = find_method(super, method_name, &defining_class);
+    const FunctionStmt* method = classes_.find_method(super, method_name, &defining_class);
     if (!method) {
         throw RuntimeError(
             "Undefined method '" + method_name + "' in superclass chain of '" +
@@ -1455,7 +796,7 @@ void Interpreter::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
 
 void Interpreter::visitPropertyAssign(const PropertyAssignExpr& expr) {
     Value object = evaluate(expr.object());
-    const std::string name(expr.name().lexeme());
+    const std::string_view name = expr.name().lexeme();
     size_t line = expr.name().line();
     size_t column = expr.name().column();
 
@@ -1466,62 +807,18 @@ void Interpreter::visitPropertyAssign(const PropertyAssignExpr& expr) {
     }
 
     Value value = evaluate(expr.value());
-    auto& fields = object.as_instance().fields;
-    auto it = fields.find(name);
-    if (it == fields.end()) {
-        throw RuntimeError("Undefined property '" + name + "' on object",
-                           line, column);
-    }
-    // 按字段声明类型校验/隐式转换
-    if (const VarDeclStmt* field = find_field(object.as_instance().klass, name)) {
-        value = coerce_to_declared(field->type().type(), value, line, column);
-    }
-    it->second = value;
+    InstanceData& instance = object.as_instance();
+    FieldTarget target = runtime::lookup_field(classes_, field_caches_[&expr],
+                                               instance.klass, name, cache_stats_);
+    Value& slot = runtime::instance_field(instance, target, name, line, column);
+    // 按字段声明类型校验/隐式转换（静态类型已满足时省去）
+    if (!runtime::skips_coercion(target.field->type().type(), expr.value()->static_type(), value)) {
+        runtime::coerce_in_place(target.field->type().type(), value, line, column);
+    }
+    slot = value;
     result_ = value;  // 赋值表达式的值为所赋的值
 }
 
-const FunctionStmt* Interpreter::find_method(const ClassStmt* klass,
-                                             const std::string& name,
-                                             const ClassStmt** defining_class) const {
-    // 沿继承链自子向父查找，子类同名方法实现覆写
-    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
-        for (const auto& member : c->members()) {
-            if (auto* fn = dynamic_cast<const FunctionStmt*>(member.get())) {
-                if (fn->name().lexeme() == name) {
-                    if (defining_class) *defining_class = c;
-                    return fn;
-                }
-            }
-        }
-    }
-    return nullptr;
-}
-
-const VarDeclStmt* Interpreter::find_field(const ClassStmt* klass,
-                                           const std::string& name) const {
-    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
-        for (const auto& member : c->members()) {
-            if (auto* field = dynamic_cast<const VarDeclStmt*>(member.get())) {
-                if (field->name().lexeme() == name) return field;
-            }
-        }
-    }
-    return nullptr;
-}
-
-const ClassStmt* Interpreter::superclass_of(const ClassStmt* klass) const {
-    if (!klass->has_superclass()) return nullptr;
-    const std::string super_name(klass->superclass().lexeme());
-    auto it = classes_.find(super_name);
-    if (it == classes_.end()) {
-        // 语义层要求父类先声明，正常不可达；防御未登记的动态路径
-        throw RuntimeError("Undefined superclass '" + super_name + "'",
-                           klass->superclass().line(),
-                           klass->superclass().column());
-    }
-    return it->second;
-}
-
 Value Interpreter::call_class_method(const Value& instance,
                                      const FunctionStmt* method,
                                      const ClassStmt* defining_class,
@@ -1536,7 +833,10 @@ Value Interpreter::call_class_method(const Value& instance,
             line, column);
     }
 
-    // 方法作用域：绑定 this 与形参（按声明类型校验/隐式转换），捕获 ReturnSignal；
+    enter_call(line, column);
+    DepthGuard depth_guard{call_depth_};
+
+    // 方法帧：this 占槽位 0、形参顺延（按声明类型校验/隐式转换），执行到 return 为止；
     // current_class_ 切换为定义类，供体内 base 按其父类解析（RAII 确保异常路径也还原）
     struct ClassContextGuard {
         const ClassStmt*& slot;
@@ -1545,35 +845,50 @@ Value Interpreter::call_class_method(const Value& instance,
             : slot(s), prev(s) { s = v; }
         ~ClassContextGuard() { slot = prev; }
     } class_guard(current_class_, defining_class);
-    ScopeGuard guard(env_);
-    env_.define("this", instance);
+    size_t parent = enclosing_frame(method, line, column);
+    FrameGuard guard(env_, method, static_cast<size_t>(method->frame_size()), parent);
+    env_.define(0, instance);
     for (size_t i = 0; i < method->parameters().size(); ++i) {
         const Parameter& param = method->parameters()[i];
-        Value bound = coerce_to_declared(param.type.type(), args[i],
-                                         param.name.line(), param.name.column());
-        env_.define(std::string(param.name.lexeme()), bound, false,
-                    param.type.type());
+        Value bound = runtime::coerce_to_declared(param.type.type(), args[i],
+                                                  param.name.line(), param.name.column());
+        env_.define(static_cast<int>(i + 1), bound, false, param.type.type());
     }
 
-    try {
-        for (const auto& stmt : method->body()->statements()) {
-            execute(stmt.get());
-        }
+    if (execute_block(*method->body()) != Completion::Return) {
         return Value::none();  // 无显式 return
-    } catch (const ReturnSignal& ret) {
-        // 返回值按声明返回类型校验/隐式转换
-        return coerce_to_declared(method->return_type().type(), ret.value,
-                                  method->return_type().line(),
-                                  method->return_type().column());
     }
+    completion_ = Completion::Normal;
+    // 返回值按声明返回类型校验/隐式转换
+    if (!runtime::skips_coercion(method->return_type().type(), return_static_type_, return_value_)) {
+        runtime::coerce_in_place(method->return_type().type(), return_value_,
+                                 method->return_type().line(),
+                                 method->return_type().column());
+    }
+    return std::move(return_value_);
+}
+
+size_t Interpreter::enclosing_frame(const FunctionStmt* fn, size_t line,
+                                    size_t column) const {
+    if (fn->enclosing() == nullptr) {
+        return 0;  // 顶层函数/顶层类的方法：外层帧即全局帧
+    }
+    // 嵌套函数：名字只在外层函数体内可见，调用点的词法外层链上必有外层函数的活动帧
+    size_t parent = env_.find_frame(fn->enclosing());
+    if (parent == Environment::npos) {
+        throw RuntimeError("Nested function '" + std::string(fn->name().lexeme()) +
+                               "' called outside its enclosing function",
+                           line, column);
+    }
+    return parent;
 }
 
 void Interpreter::visitBreak(const BreakStmt& /*stmt*/) {
-    throw BreakSignal{};
+    completion_ = Completion::Break;
 }
 
 void Interpreter::visitContinue(const ContinueStmt& /*stmt*/) {
-    throw ContinueSignal{};
+    completion_ = Completion::Continue;
 }
 
 } // namespace collie
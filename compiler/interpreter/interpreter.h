@@ -6,35 +6,22 @@
 #ifndef COLLIE_INTERPRETER_H
 #define COLLIE_INTERPRETER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <ostream>
-#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "value.h"
 #include "environment.h"
+#include "runtime.h"
 #include "../parser/ast.h"
+#include "../parser/expr_types.h"
 #include "../lexer/token.h"
 
 namespace collie {
 
-/**
- * @brief 运行期错误，携带源位置，由调用方（main / 测试）捕获后上报。
- */
-class RuntimeError : public std::runtime_error {
-public:
-    RuntimeError(const std::string& message, size_t line, size_t column)
-        : std::runtime_error(message), line_(line), column_(column) {}
-
-    size_t line() const { return line_; }
-    size_t column() const { return column_; }
-
-private:
-    size_t line_;
-    size_t column_;
-};
-
 /**
  * @brief 树遍历解释器
  *
@@ -42,6 +29,13 @@ private:
  * if / while / for、break / continue、用户自定义函数（声明/调用/return）、
  * class 基础（字段/方法/构造器/new/this），以及内建函数 print。
  *
+ * 程序在一条按调用深度上限预留了大栈的独立线程上执行；普通函数体内的
+ * 尾调用 return f(...) 复用当前帧，尾递归不消耗原生栈。
+ *
+ * 给定语义分析导出的静态类型表（set_expr_types）时，静态已知为 number 的算术
+ * 省去种类检查，静态类型已满足声明类型的实参/初始值/返回值省去校验与转换；
+ * 未收录（动态 object 等）的表达式照旧在运行期检查。
+ *
  * 暂不支持（会抛 RuntimeError）：元组。
  * TODO(interpreter): 后续补齐类型检查/强转、元组、继承等。
  */
@@ -51,7 +45,16 @@ public:
     explicit Interpreter(std::ostream& out) : out_(out) {}
 
     /// @brief 解释执行整个程序（顶层语句列表）
-    void interpret(const std::vector<std::unique_ptr<Stmt>>& statements);
+    void interpret(const std::vector<StmtPtr>& statements);
+
+    /// @brief 设置调用深度上限（默认 kDefaultMaxCallDepth），超限抛 RuntimeError
+    void set_max_call_depth(size_t depth) { max_call_depth_ = depth; }
+
+    /// @brief 设置语义分析导出的静态类型表（非拥有，须覆盖 interpret 期间；可为空）
+    void set_expr_types(const ExprTypeTable* types) { expr_types_ = types; }
+
+    /// @brief 方法分派/字段赋值内联缓存的命中统计
+    const InlineCacheStats& cache_stats() const { return cache_stats_; }
 
 private:
     // ExprVisitor 接口
@@ -90,34 +93,19 @@ private:
     void visitBreak(const BreakStmt& stmt) override;
     void visitContinue(const ContinueStmt& stmt) override;
 
+    /**
+     * @brief 语句的完成状态
+     *
+     * break/continue/return 作为 execute/execute_block 的返回值逐层向外传递：
+     * 循环消化 Break/Continue，函数调用消化 Return（返回值暂存于 return_value_）。
+     * C++ 异常只用于 RuntimeError。
+     */
+    enum class Completion { Normal, Break, Continue, Return };
+
     // 求值 / 执行辅助
     Value evaluate(const Expr* expr);
-    void execute(const Stmt* stmt);
-    void execute_block(const BlockStmt& block);
-
-    Value eval_binary(const Token& op, const Value& left, const Value& right);
-    Value eval_arithmetic(const Token& op, const Value& left, const Value& right);
-    Value eval_comparison(const Token& op, const Value& left, const Value& right);
-    /// 位运算 & | ^ << >>（t47）：两侧须为整数值，int64 域内求值
-    Value eval_bitwise(const Token& op, const Value& left, const Value& right);
-    static bool values_equal(const Value& left, const Value& right);
-
-    /// @brief 条件真值（if/while/for/do-while）：tribool 不能直接作条件
-    /// （t43，经作者确认，需显式 isTrue()/== 判断），违反抛 RuntimeError
-    static bool condition_truthy(const Value& value, const Token& keyword);
-
-    /// @brief 归一化索引（支持负索引，-1 为末尾），越界抛 RuntimeError
-    static size_t normalize_index(const Value& index, size_t size,
-                                  const Token& bracket);
-
-    /// @brief 统计 UTF-8 字符串的码点数（而非字节数）
-    static size_t utf8_length(const std::string& s);
-
-    /// @brief 取 UTF-8 字符串第 i 个码点（前置：i < utf8_length(s)），返回单字符子串
-    static std::string utf8_char_at(const std::string& s, size_t i);
-
-    /// @brief 取第 index 个码点的字节偏移（index >= 码点数时返回 s.size()）
-    static size_t utf8_byte_offset(const std::string& s, size_t index);
+    Completion execute(const Stmt* stmt);
+    Completion execute_block(const BlockStmt& block);
 
     // 内建函数
     void call_builtin_print(const CallExpr& expr);
@@ -125,42 +113,60 @@ private:
     void call_builtin_to_string(const CallExpr& expr);
     void call_builtin_to_number(const CallExpr& expr);
 
-    /// @brief 把值转为 number（string/bool/number），失败抛 RuntimeError；
-    /// toNumber 内建函数与 .toNumber() 方法共用
-    static Value to_number_value(const Value& v, size_t line, size_t column);
-
-    /// @brief 沿继承链查找指定名字的方法（含构造器，子类优先实现覆写），
-    /// 未找到返回 nullptr；defining_class 非空时回写定义该方法的类
-    const FunctionStmt* find_method(const ClassStmt* klass,
-                                    const std::string& name,
-                                    const ClassStmt** defining_class = nullptr) const;
+    /// @brief 求值被调函数与实参并做元数检查（visitCall 与尾调用 return 共用）
+    const FunctionStmt* evaluate_call(const CallExpr& expr, std::vector<Value>& args);
 
-    /// @brief 沿继承链查找指定名字的字段声明（子类优先），未找到返回 nullptr
-    const VarDeclStmt* find_field(const ClassStmt* klass,
-                                  const std::string& name) const;
+    /// @brief 执行用户函数：新帧内绑定形参，捕获 return；函数体以尾调用返回时
+    /// 原地复用当前帧继续执行被调函数（蹦床），原生栈深度不随尾递归增长。
+    /// call 为调用点，实参的静态类型已满足形参类型时绑定不再校验
+    Value call_function(const FunctionStmt* fn, const CallExpr& call,
+                        std::vector<Value> args, size_t parent);
 
-    /// @brief 取父类声明（无父类返回 nullptr，父类未登记抛 RuntimeError）
-    const ClassStmt* superclass_of(const ClassStmt* klass) const;
+    /// @brief 进入一层调用：检查调用深度上限与剩余原生栈，超限抛 RuntimeError
+    void enter_call(size_t line, size_t column);
 
-    /// @brief 执行类方法/构造器：新作用域内绑定 this 与形参，捕获 return；
+    /// @brief 执行类方法/构造器：新帧内绑定 this 与形参，捕获 return；
     /// defining_class 为定义该方法的类，供体内 base 按其父类解析
     Value call_class_method(const Value& instance, const FunctionStmt* method,
                             const ClassStmt* defining_class,
                             const std::vector<Value>& args,
                             size_t line, size_t column);
 
-    /// @brief 按声明类型校验/隐式转换值（string ← number/bool 转字符串，
-    /// object/类名等动态类型放行），不兼容抛 RuntimeError
-    static Value coerce_to_declared(TokenType declared, const Value& value,
-                                    size_t line, size_t column);
+    /// @brief 取函数调用的词法外层帧下标（嵌套函数在外层函数活动帧外被调用时抛 RuntimeError）
+    size_t enclosing_frame(const FunctionStmt* fn, size_t line, size_t column) const;
 
     std::ostream& out_;
     Environment env_;
     Value result_;  ///< 最近一次表达式求值的结果
-    std::unordered_map<std::string, const ClassStmt*> classes_;  ///< 已登记的类
+    std::vector<Value> literals_;  ///< 字面量常量池（Resolver 构建，按 LiteralExpr::constant() 访问）
+    Completion completion_ = Completion::Normal;  ///< 最近一条语句的完成状态
+    Value return_value_;  ///< Return 状态携带的返回值（由函数调用取走）
+    TokenType return_static_type_ = TokenType::INVALID;  ///< return_value_ 的静态类型
+    const ExprTypeTable* expr_types_ = nullptr;  ///< 语义层静态类型表（交给 Resolver 回填）
+    ClassRegistry classes_;  ///< 已登记的类
     /// 当前正在执行的方法/构造器的定义类（base 按它的父类解析，
     /// 不能用实例动态类型，否则多级继承时 base 会死循环）
     const ClassStmt* current_class_ = nullptr;
+    /// 内联缓存侧表：按 AST 节点挂接，键为方法调用点/属性读写点
+    std::unordered_map<const MethodCallExpr*, MethodCache> method_caches_;
+    std::unordered_map<const Expr*, FieldCache> field_caches_;
+    InlineCacheStats cache_stats_;
+
+    /// 待执行的尾调用：return f(...) 求值完被调函数与实参后登记于此、以 Return
+    /// 完成状态退出函数体，由外层 call_function 在同一帧内接着执行
+    struct TailCall {
+        const FunctionStmt* function = nullptr;
+        const CallExpr* call = nullptr;
+        std::vector<Value> args;
+        size_t parent = 0;
+    };
+    TailCall tail_call_;
+
+    size_t max_call_depth_ = kDefaultMaxCallDepth;
+    size_t call_depth_ = 0;  ///< 当前活动的函数/方法调用层数
+    /// 执行线程的原生栈起点与可用容量：每层调用检查剩余量，栈将耗尽时报错而非崩溃
+    uintptr_t native_stack_base_ = 0;
+    size_t native_stack_budget_ = 0;
 };
 
 } // namespace collie
@@ -0,0 +1,99 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 指定容量原生栈上执行的平台实现（POSIX 线程 / Win32 线程）
+ */
+#include "native_stack.h"
+
+#include <exception>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace collie {
+
+namespace {
+
+/// 无法另开线程时当前线程可用栈的保守估计（Windows 主线程默认仅 1MB）
+constexpr size_t kFallbackStackBytes = 1 << 20;
+/// 逐次减半重试的下限：再小就不比当前线程的栈更有用了
+constexpr size_t kMinStackBytes = 8 << 20;
+
+/// 线程入口的参数：要执行的任务、栈容量与回传的异常
+struct Task {
+    const std::function<void(size_t)>* body;
+    size_t stack_bytes;
+    std::exception_ptr error;
+};
+
+void run_task(Task& task) {
+    try {
+        (*task.body)(task.stack_bytes);
+    } catch (...) {
+        task.error = std::current_exception();
+    }
+}
+
+#ifdef _WIN32
+DWORD WINAPI thread_entry(LPVOID arg) {
+    run_task(*static_cast<Task*>(arg));
+    return 0;
+}
+
+/// 按 stack_bytes 预留栈并执行到结束；线程创建失败返回 false
+bool run_on_thread(Task& task) {
+    HANDLE thread = CreateThread(nullptr, task.stack_bytes, thread_entry, &task,
+                                 STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+    if (thread == nullptr) return false;
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+    return true;
+}
+#else
+void* thread_entry(void* arg) {
+    run_task(*static_cast<Task*>(arg));
+    return nullptr;
+}
+
+/// 按 stack_bytes 分配栈并执行到结束；线程创建失败返回 false
+bool run_on_thread(Task& task) {
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) != 0) return false;
+    bool started = pthread_attr_setstacksize(&attr, task.stack_bytes) == 0;
+    pthread_t thread;
+    started = started && pthread_create(&thread, &attr, thread_entry, &task) == 0;
+    pthread_attr_destroy(&attr);
+    if (!started) return false;
+    pthread_join(thread, nullptr);
+    return true;
+}
+#endif
+
+} // namespace
+
+void run_on_native_stack(size_t stack_bytes, const std::function<void(size_t)>& body) {
+    Task task{&body, stack_bytes, nullptr};
+    bool ran = false;
+    while (!ran && task.stack_bytes >= kMinStackBytes) {
+        ran = run_on_thread(task);
+        if (!ran) task.stack_bytes /= 2;
+    }
+    if (!ran) {
+        task.stack_bytes = kFallbackStackBytes;
+        run_task(task);
+    }
+    if (task.error) {
+        std::rethrow_exception(task.error);
+    }
+}
+
+} // namespace collie
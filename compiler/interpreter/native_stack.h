@@ -0,0 +1,25 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 在指定容量的原生栈上执行（树遍历解释器的深递归支撑）
+ */
+#ifndef COLLIE_INTERPRETER_NATIVE_STACK_H
+#define COLLIE_INTERPRETER_NATIVE_STACK_H
+
+#include <cstddef>
+#include <functional>
+
+namespace collie {
+
+/**
+ * @brief 在一条栈容量约为 stack_bytes 的新线程上同步执行 body，调用方阻塞等待
+ *
+ * body 的参数为实际可用的栈容量：大栈分配失败时逐次减半重试，仍失败则在当前线程
+ * 直接执行并传入保守估计值。body 抛出的异常原样转抛回调用线程。
+ * 64 位平台上大栈只是虚拟地址预留，按实际递归深度逐页提交物理内存。
+ */
+void run_on_native_stack(size_t stack_bytes, const std::function<void(size_t)>& body);
+
+} // namespace collie
+
+#endif // COLLIE_INTERPRETER_NATIVE_STACK_H
@@ -0,0 +1,321 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 解释器变量解析 pass 的实现
+ */
+#include "resolver.h"
+#include "runtime.h"
+
+#include <algorithm>
+
+namespace collie {
+
+// -----------------------------------------------------------------------------
+// 顶层入口与作用域管理
+// -----------------------------------------------------------------------------
+int Resolver::resolve(const std::vector<StmtPtr>& statements) {
+    frames_.clear();
+    literals_.clear();
+    frames_.emplace_back();  // 全局帧
+    begin_block();
+    // 顶层函数名先于一切语句占好槽位：函数体与顶层代码都可引用其后声明的函数
+    //（相互递归；执行引擎在运行前把顶层函数值预先登记到这些槽位）
+    for (const auto& stmt : statements) {
+        if (auto* fn = dynamic_cast<const FunctionStmt*>(stmt.get())) {
+            declare(std::string(fn->name().lexeme()));
+        }
+    }
+    for (const auto& stmt : statements) {
+        resolve(stmt.get());
+    }
+    end_block();
+    int global_slots = frames_.back().max_slots;
+    frames_.clear();
+    return global_slots;
+}
+
+void Resolver::resolve(const Expr* expr) {
+    if (!expr) return;
+    // 每次解析都重写，避免同一棵 AST 先后交给不同引擎时残留上一次的结论
+    expr->set_static_type(types_ ? types_->type_of(expr) : TokenType::INVALID);
+    expr->accept(*this);
+}
+
+void Resolver::resolve(const Stmt* stmt) {
+    if (stmt) stmt->accept(*this);
+}
+
+void Resolver::resolve_arguments(const std::vector<ExprPtr>& arguments) {
+    for (const auto& argument : arguments) {
+        resolve(argument.get());
+    }
+}
+
+void Resolver::resolve_scoped(const Stmt* stmt) {
+    begin_block();
+    resolve(stmt);
+    end_block();
+}
+
+void Resolver::begin_block() {
+    frames_.back().blocks.emplace_back();
+}
+
+void Resolver::end_block() {
+    FrameScope& frame = frames_.back();
+    // 块内局部变量的槽位整体归还，供后续兄弟块复用
+    frame.next_slot -= static_cast<int>(frame.blocks.back().size());
+    frame.blocks.pop_back();
+}
+
+int Resolver::declare(const std::string& name) {
+    FrameScope& frame = frames_.back();
+    auto& block = frame.blocks.back();
+    auto found = block.find(name);
+    if (found != block.end()) {
+        return found->second;
+    }
+    int slot = frame.next_slot++;
+    frame.max_slots = std::max(frame.max_slots, frame.next_slot);
+    block.emplace(name, slot);
+    return slot;
+}
+
+VarSlot Resolver::lookup(const std::string& name) const {
+    for (size_t f = frames_.size(); f-- > 0;) {
+        const FrameScope& frame = frames_[f];
+        for (auto block = frame.blocks.rbegin(); block != frame.blocks.rend(); ++block) {
+            auto found = block->find(name);
+            if (found == block->end()) continue;
+            VarSlot ref;
+            ref.slot = found->second;
+            if (f == 0) {
+                ref.global = true;
+            } else {
+                ref.depth = static_cast<int>(frames_.size() - 1 - f);
+            }
+            return ref;
+        }
+    }
+    return VarSlot{};
+}
+
+void Resolver::resolve_function(const FunctionStmt& fn, int name_slot, bool is_method) {
+    FrameScope frame;
+    frame.function = &fn;
+    frame.is_method = is_method;
+    frames_.push_back(std::move(frame));
+    begin_block();
+    if (is_method) {
+        declare("this");
+    }
+    for (const Parameter& param : fn.parameters()) {
+        declare(std::string(param.name.lexeme()));
+    }
+    resolve(fn.body());
+    end_block();
+
+    // 词法外层帧（全局帧的 function 为 nullptr）
+    const FunctionStmt* enclosing = frames_[frames_.size() - 2].function;
+    fn.set_layout(name_slot, frames_.back().max_slots, enclosing);
+    frames_.pop_back();
+}
+
+// -----------------------------------------------------------------------------
+// 表达式
+// -----------------------------------------------------------------------------
+void Resolver::visitLiteral(const LiteralExpr& expr) {
+    // 每个字面量节点只解析一次词素（整数字面量即一次 BigInt 十进制解析）；
+    // 非法字面量保持未解析，留到执行到此处时再报错；预解析阶段不让任何
+    // 转换异常逃出 resolve，否则程序还没运行就整体中止
+    try {
+        Value value = runtime::literal_value(expr.token());
+        expr.set_constant(static_cast<int>(literals_.size()));
+        literals_.push_back(std::move(value));
+    } catch (const std::exception&) {
+        expr.set_constant(-1);
+    }
+}
+
+void Resolver::visitIdentifier(const IdentifierExpr& expr) {
+    expr.set_slot(lookup(std::string(expr.name().lexeme())));
+}
+
+void Resolver::visitBinary(const BinaryExpr& expr) {
+    resolve(expr.left());
+    resolve(expr.right());
+}
+
+void Resolver::visitUnary(const UnaryExpr& expr) {
+    resolve(expr.operand());
+}
+
+void Resolver::visitAssign(const AssignExpr& expr) {
+    resolve(expr.value());
+    expr.set_slot(lookup(std::string(expr.name().lexeme())));
+}
+
+void Resolver::visitCall(const CallExpr& expr) {
+    // 内建函数按调用处名字识别（与语义层一致，优先于同名变量）
+    if (auto* callee = dynamic_cast<const IdentifierExpr*>(expr.callee())) {
+        expr.set_builtin(runtime::resolve_builtin_function(callee->name().lexeme()));
+    }
+    resolve(expr.callee());
+    resolve_arguments(expr.arguments());
+}
+
+void Resolver::visitTuple(const TupleExpr& expr) {
+    resolve_arguments(expr.elements());
+}
+
+void Resolver::visitTernary(const TernaryExpr& expr) {
+    resolve(expr.condition());
+    resolve(expr.then_expr());
+    resolve(expr.else_expr());
+    resolve(expr.unset_expr());
+}
+
+void Resolver::visitMultiMatch(const MultiMatchExpr& expr) {
+    resolve(expr.target());
+    for (const auto& branch : expr.branches()) {
+        resolve_arguments(branch.values);
+        resolve(branch.result.get());
+    }
+    resolve(expr.default_expr());
+}
+
+void Resolver::visitArrayLiteral(const ArrayLiteralExpr& expr) {
+    resolve_arguments(expr.elements());
+}
+
+void Resolver::visitIndex(const IndexExpr& expr) {
+    resolve(expr.object());
+    resolve(expr.index());
+}
+
+void Resolver::visitIndexAssign(const IndexAssignExpr& expr) {
+    resolve(expr.object());
+    resolve(expr.index());
+    resolve(expr.value());
+}
+
+void Resolver::visitMethodCall(const MethodCallExpr& expr) {
+    expr.set_builtin(runtime::resolve_builtin_method(expr.name().lexeme()));
+    resolve(expr.object());
+    resolve_arguments(expr.arguments());
+}
+
+void Resolver::visitProperty(const PropertyExpr& expr) {
+    resolve(expr.object());
+}
+
+void Resolver::visitPropertyAssign(const PropertyAssignExpr& expr) {
+    resolve(expr.object());
+    resolve(expr.value());
+}
+
+void Resolver::visitNew(const NewExpr& expr) {
+    resolve_arguments(expr.arguments());
+}
+
+void Resolver::visitThis(const ThisExpr& expr) {
+    expr.set_slot(lookup("this"));
+}
+
+void Resolver::visitBaseCall(const BaseCallExpr& expr) {
+    expr.set_this_slot(lookup("this"));
+    resolve_arguments(expr.arguments());
+}
+
+void Resolver::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
+    expr.set_this_slot(lookup("this"));
+    resolve_arguments(expr.arguments());
+}
+
+// -----------------------------------------------------------------------------
+// 语句
+// -----------------------------------------------------------------------------
+void Resolver::visitExpression(const ExpressionStmt& stmt) {
+    resolve(stmt.expression());
+}
+
+void Resolver::visitVarDecl(const VarDeclStmt& stmt) {
+    // 先解析初始化表达式再声明：`number x = x + 1` 中右侧 x 指向外层同名变量
+    resolve(stmt.initializer());
+    stmt.set_slot(declare(std::string(stmt.name().lexeme())));
+}
+
+void Resolver::visitBlock(const BlockStmt& stmt) {
+    begin_block();
+    for (const auto& s : stmt.statements()) {
+        resolve(s.get());
+    }
+    end_block();
+}
+
+void Resolver::visitIf(const IfStmt& stmt) {
+    resolve(stmt.condition());
+    resolve_scoped(stmt.then_branch());
+    resolve_scoped(stmt.else_branch());
+}
+
+void Resolver::visitWhile(const WhileStmt& stmt) {
+    resolve(stmt.condition());
+    resolve_scoped(stmt.body());
+}
+
+void Resolver::visitFor(const ForStmt& stmt) {
+    // 初始化变量作用域限定在循环内部
+    begin_block();
+    resolve(stmt.initializer());
+    resolve(stmt.condition());
+    resolve(stmt.increment());
+    resolve(stmt.body());
+    end_block();
+}
+
+void Resolver::visitDoWhile(const DoWhileStmt& stmt) {
+    resolve_scoped(stmt.body());
+    resolve(stmt.condition());
+}
+
+void Resolver::visitSwitch(const SwitchStmt& stmt) {
+    resolve(stmt.condition());
+    for (const auto& sc : stmt.cases()) {
+        resolve_arguments(sc.values);
+        resolve_scoped(sc.body.get());
+    }
+}
+
+void Resolver::visitFunction(const FunctionStmt& stmt) {
+    // 先声明函数名再解析函数体，支持递归调用
+    int slot = declare(std::string(stmt.name().lexeme()));
+    resolve_function(stmt, slot, false);
+}
+
+void Resolver::visitReturn(const ReturnStmt& stmt) {
+    resolve(stmt.value());
+    // 尾调用只在普通函数帧内成立：方法帧的 return 由方法调用消化，不参与帧复用
+    const FrameScope& frame = frames_.back();
+    auto* call = dynamic_cast<const CallExpr*>(stmt.value());
+    stmt.set_tail_call(frame.function != nullptr && !frame.is_method && call != nullptr &&
+                       call->builtin() == BuiltinFunction::None);
+}
+
+void Resolver::visitClass(const ClassStmt& stmt) {
+    // 类体成员不是运行期变量：字段初始化式在外层上下文解析（new 时求值），
+    // 方法/构造器各自成帧，this 占槽位 0
+    for (const auto& member : stmt.members()) {
+        if (auto* method = dynamic_cast<const FunctionStmt*>(member.get())) {
+            resolve_function(*method, -1, true);
+        } else if (auto* field = dynamic_cast<const VarDeclStmt*>(member.get())) {
+            resolve(field->initializer());
+        }
+    }
+}
+
+void Resolver::visitBreak(const BreakStmt& /*stmt*/) {}
+
+void Resolver::visitContinue(const ContinueStmt& /*stmt*/) {}
+
+} // namespace collie
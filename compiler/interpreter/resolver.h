@@ -0,0 +1,113 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 解释器的变量解析 pass：把变量引用绑定到 (depth, slot)
+ */
+#ifndef COLLIE_INTERPRETER_RESOLVER_H
+#define COLLIE_INTERPRETER_RESOLVER_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "value.h"
+#include "../parser/ast.h"
+#include "../parser/expr_types.h"
+
+namespace collie {
+
+/**
+ * @brief 变量解析器（语义分析通过后、解释执行前运行一次）
+ *
+ * 按语义层同构的词法作用域遍历 AST，为每个变量声明分配帧内槽位，
+ * 并把 IdentifierExpr/AssignExpr/this 回填为 VarSlot，使运行期变量访问
+ * 变为数组下标而非逐层字符串哈希查找；同时把 CallExpr/MethodCallExpr 的
+ * 内建函数/方法名解析为枚举，执行期不再逐个比较名字；字面量预先求值进常量池，
+ * LiteralExpr 回填池下标，执行期不再重复解析词素；并标记普通函数体内的
+ * 尾调用 return f(...)，供两个引擎复用当前帧。给定语义层的静态类型表时，
+ * 把各表达式的静态类型回填到节点（Expr::static_type），未给定则一律置为动态。
+ *
+ * 帧布局：每个函数（含类方法/构造器）一帧，全局代码一帧；块作用域不单独成帧，
+ * 块内局部变量展平进所在函数帧，块退出后槽位可被后续兄弟块复用。
+ * 类体成员（字段/方法名）不是运行期变量，按名引用时保持未解析。
+ */
+class Resolver : public ExprVisitor, public StmtVisitor {
+public:
+    /// @param types 语义分析导出的静态类型表（可为空；须在 resolve 期间存活）
+    explicit Resolver(const ExprTypeTable* types = nullptr) : types_(types) {}
+
+    /// @brief 解析整个程序，返回全局帧所需槽位数
+    int resolve(const std::vector<StmtPtr>& statements);
+
+    /// @brief 取走 resolve 期间构建的字面量常量池（按 LiteralExpr::constant() 下标访问）
+    std::vector<Value> take_literals() { return std::move(literals_); }
+
+private:
+    // ExprVisitor 接口
+    void visitLiteral(const LiteralExpr& expr) override;
+    void visitIdentifier(const IdentifierExpr& expr) override;
+    void visitBinary(const BinaryExpr& expr) override;
+    void visitUnary(const UnaryExpr& expr) override;
+    void visitAssign(const AssignExpr& expr) override;
+    void visitCall(const CallExpr& expr) override;
+    void visitTuple(const TupleExpr& expr) override;
+    void visitTernary(const TernaryExpr& expr) override;
+    void visitMultiMatch(const MultiMatchExpr& expr) override;
+    void visitArrayLiteral(const ArrayLiteralExpr& expr) override;
+    void visitIndex(const IndexExpr& expr) override;
+    void visitIndexAssign(const IndexAssignExpr& expr) override;
+    void visitMethodCall(const MethodCallExpr& expr) override;
+    void visitProperty(const PropertyExpr& expr) override;
+    void visitPropertyAssign(const PropertyAssignExpr& expr) override;
+    void visitNew(const NewExpr& expr) override;
+    void visitThis(const ThisExpr& expr) override;
+    void visitBaseCall(const BaseCallExpr& expr) override;
+    void visitBaseMethodCall(const BaseMethodCallExpr& expr) override;
+
+    // StmtVisitor 接口
+    void visitExpression(const ExpressionStmt& stmt) override;
+    void visitVarDecl(const VarDeclStmt& stmt) override;
+    void visitBlock(const BlockStmt& stmt) override;
+    void visitIf(const IfStmt& stmt) override;
+    void visitWhile(const WhileStmt& stmt) override;
+    void visitFor(const ForStmt& stmt) override;
+    void visitDoWhile(const DoWhileStmt& stmt) override;
+    void visitSwitch(const SwitchStmt& stmt) override;
+    void visitFunction(const FunctionStmt& stmt) override;
+    void visitReturn(const ReturnStmt& stmt) override;
+    void visitClass(const ClassStmt& stmt) override;
+    void visitBreak(const BreakStmt& stmt) override;
+    void visitContinue(const ContinueStmt& stmt) override;
+
+    /// 一个函数帧的解析上下文（function 为 nullptr 即全局帧）
+    struct FrameScope {
+        const FunctionStmt* function = nullptr;
+        bool is_method = false;  ///< 类方法/构造器帧（其中的 return 不做尾调用）
+        int next_slot = 0;  ///< 下一个空闲槽位（块退出时回退，实现槽位复用）
+        int max_slots = 0;  ///< 峰值槽位数，即帧大小
+        std::vector<std::unordered_map<std::string, int>> blocks;  ///< 块作用域：名字 -> 槽位
+    };
+
+    void resolve(const Expr* expr);
+    void resolve(const Stmt* stmt);
+    void resolve_arguments(const std::vector<ExprPtr>& arguments);
+    /// 以新块作用域解析单条语句（与语义层 if/while 分支的 begin_scope 同构）
+    void resolve_scoped(const Stmt* stmt);
+    /// 解析函数/方法体：新帧，this（仅方法）与形参依次占槽
+    void resolve_function(const FunctionStmt& fn, int name_slot, bool is_method);
+
+    void begin_block();
+    void end_block();
+    /// 在当前块声明名字并返回槽位（同块重复声明复用原槽位，与旧 define 覆盖语义一致）
+    int declare(const std::string& name);
+    /// 由内向外查找名字，未找到返回未解析的 VarSlot
+    VarSlot lookup(const std::string& name) const;
+
+    std::vector<FrameScope> frames_;
+    std::vector<Value> literals_;  ///< 字面量常量池
+    const ExprTypeTable* types_;   ///< 静态类型表（非拥有，可为空）
+};
+
+} // namespace collie
+
+#endif // COLLIE_INTERPRETER_RESOLVER_H
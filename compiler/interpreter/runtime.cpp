@@ -0,0 +1,1244 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 解释器运行期语义的实现（自树遍历解释器抽出，两个执行引擎共用）
+ */
+#include "runtime.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace collie {
+
+// -----------------------------------------------------------------------------
+// 类声明表
+// -----------------------------------------------------------------------------
+const FunctionStmt* ClassRegistry::find_method(const ClassStmt* klass,
+                                             const std::string& name,
+                                             const ClassStmt** defining_class) const {
+    // 沿继承链自子向父查找，子类同名方法实现覆写
+    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
+        for (const auto& member : c->members()) {
+            if (auto* fn = dynamic_cast<const FunctionStmt*>(member.get())) {
+                if (fn->name().lexeme() == name) {
+                    if (defining_class) *defining_class = c;
+                    return fn;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+const VarDeclStmt* ClassRegistry::find_field(const ClassStmt* klass,
+                                           const std::string& name) const {
+    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
+        for (const auto& member : c->members()) {
+            if (auto* field = dynamic_cast<const VarDeclStmt*>(member.get())) {
+                if (field->name().lexeme() == name) return field;
+            }
+        }
+    }
+    return nullptr;
+}
+
+const ClassStmt* ClassRegistry::superclass_of(const ClassStmt* klass) const {
+    if (!klass->has_superclass()) return nullptr;
+    const std::string super_name(klass->superclass().lexeme());
+    auto it = classes_.find(super_name);
+    if (it == classes_.end()) {
+        // 语义层要求父类先声明，正常不可达；防御未登记的动态路径
+        throw RuntimeError("Undefined superclass '" + super_name + "'",
+                           klass->superclass().line(),
+                           klass->superclass().column());
+    }
+    return it->second;
+}
+
+int ClassLayout::slot_of(std::string_view name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+const ClassLayout& ClassRegistry::layout_of(const ClassStmt* klass) const {
+    auto cached = layouts_.find(klass);
+    if (cached != layouts_.end()) return cached->second;
+
+    std::vector<const ClassStmt*> chain;
+    for (const ClassStmt* c = klass; c != nullptr; c = superclass_of(c)) {
+        chain.push_back(c);
+    }
+    ClassLayout layout;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        for (const auto& member : (*it)->members()) {
+            auto* field = dynamic_cast<const VarDeclStmt*>(member.get());
+            if (!field) continue;
+            std::string name(field->name().lexeme());
+            int slot = layout.slot_of(name);
+            if (slot < 0) {
+                slot = static_cast<int>(layout.names.size());
+                layout.names.push_back(std::move(name));
+                layout.fields.push_back(field);
+            } else {
+                layout.fields[static_cast<size_t>(slot)] = field;  // 子类同名字段覆盖声明
+            }
+            layout.inits.push_back({static_cast<size_t>(slot), field});
+        }
+    }
+    return layouts_.emplace(klass, std::move(layout)).first->second;
+}
+
+namespace runtime {
+
+// -----------------------------------------------------------------------------
+// int64 溢出检测（内联整数快速路径；溢出时调用方回落 BigInt）
+// -----------------------------------------------------------------------------
+namespace {
+
+#if defined(__GNUC__) || defined(__clang__)
+inline bool add_overflow(int64_t a, int64_t b, int64_t* r) { return __builtin_add_overflow(a, b, r); }
+inline bool sub_overflow(int64_t a, int64_t b, int64_t* r) { return __builtin_sub_overflow(a, b, r); }
+inline bool mul_overflow(int64_t a, int64_t b, int64_t* r) { return __builtin_mul_overflow(a, b, r); }
+#else
+constexpr int64_t kI64Max = std::numeric_limits<int64_t>::max();
+constexpr int64_t kI64Min = std::numeric_limits<int64_t>::min();
+
+inline bool add_overflow(int64_t a, int64_t b, int64_t* r) {
+    if ((b > 0 && a > kI64Max - b) || (b < 0 && a < kI64Min - b)) return true;
+    *r = a + b;
+    return false;
+}
+inline bool sub_overflow(int64_t a, int64_t b, int64_t* r) {
+    if ((b < 0 && a > kI64Max + b) || (b > 0 && a < kI64Min + b)) return true;
+    *r = a - b;
+    return false;
+}
+inline bool mul_overflow(int64_t a, int64_t b, int64_t* r) {
+    if (a == 0 || b == 0) {
+        *r = 0;
+        return false;
+    }
+    if ((a == -1 && b == kI64Min) || (b == -1 && a == kI64Min)) return true;
+    if (a > 0 ? (b > 0 ? a > kI64Max / b : b < kI64Min / a)
+              : (b > 0 ? a < kI64Min / b : a < kI64Max / b)) {
+        return true;
+    }
+    *r = a * b;
+    return false;
+}
+#endif
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// 内联缓存
+// -----------------------------------------------------------------------------
+MethodTarget lookup_method(const ClassRegistry& classes, MethodCache& cache,
+                           const ClassStmt* klass, std::string_view name,
+                           InlineCacheStats& stats) {
+    if (const MethodTarget* hit = cache.find(klass)) {
+        ++stats.method_hits;
+        return *hit;
+    }
+    ++stats.method_misses;
+    MethodTarget target;
+    target.method = classes.find_method(klass, std::string(name), &target.defining_class);
+    cache.insert(klass, target);
+    return target;
+}
+
+FieldTarget lookup_field(const ClassRegistry& classes, FieldCache& cache,
+                         const ClassStmt* klass, std::string_view name,
+                         InlineCacheStats& stats) {
+    if (const FieldTarget* hit = cache.find(klass)) {
+        ++stats.field_hits;
+        return *hit;
+    }
+    ++stats.field_misses;
+    const ClassLayout& layout = classes.layout_of(klass);
+    FieldTarget target;
+    target.slot = layout.slot_of(name);
+    if (target.slot >= 0) {
+        target.field = layout.fields[static_cast<size_t>(target.slot)];
+    }
+    cache.insert(klass, target);
+    return target;
+}
+
+Value& instance_field(InstanceData& instance, const FieldTarget& target,
+                      std::string_view name, size_t line, size_t column) {
+    if (target.slot < 0) {
+        throw RuntimeError("Undefined property '" + std::string(name) + "' on object",
+                           line, column);
+    }
+    return instance.fields[target.slot];
+}
+
+RuntimeError call_depth_exceeded(size_t limit, size_t line, size_t column) {
+    return RuntimeError("Maximum call depth of " + std::to_string(limit) +
+                            " exceeded (infinite recursion?)",
+                        line, column);
+}
+
+// -----------------------------------------------------------------------------
+// 字面量与一元运算
+// -----------------------------------------------------------------------------
+Value literal_value(const Token& tok) {
+    std::string lexeme(tok.lexeme());
+    switch (tok.type()) {
+        case TokenType::LITERAL_NUMBER:
+            // 特殊数值字面量（词法层把 Infinity/NaN 归为 LITERAL_NUMBER）；
+            // 不依赖 std::stod 对 "Infinity"/"NaN" 拼写的平台行为，显式特判
+            if (lexeme == "Infinity") {
+                return Value::number(std::numeric_limits<double>::infinity());
+            } else if (lexeme == "NaN") {
+                return Value::number(std::numeric_limits<double>::quiet_NaN());
+            } else if (lexeme.size() > 1 && lexeme[0] == '0' &&
+                       (lexeme[1] == 'x' || lexeme[1] == 'X')) {
+                // 十六进制整数字面量（t47）：逐位 *16+digit 累积为 BigInt，
+                // 任意精度精确（不经 64 位）
+                BigInt acc(0);
+                BigInt sixteen(16);
+                for (size_t i = 2; i < lexeme.size(); ++i) {
+                    char c = lexeme[i];
+                    int d;
+                    if (c >= '0' && c <= '9') d = c - '0';
+                    else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+                    else d = c - 'A' + 10;
+                    acc = acc * sixteen + BigInt(static_cast<long long>(d));
+                }
+                return Value::integer(std::move(acc));
+            } else if (lexeme.find_first_of(".eEf") == std::string::npos) {
+                // 整数字面量（t42）：BigInt 任意精度承载，不经 double 不丢精度
+                return Value::integer(BigInt::from_decimal_string(lexeme));
+            } else {
+                // 小数字面量（含 '.'/'e'/'f'）：stod 解析自然停在 'f' 后缀处；
+                // 超出 double 表示范围（如次正规数 5e-324）时 stod 抛 out_of_range，
+                // 统一转为定位到该字面量的 RuntimeError
+                try {
+                    return Value::number(std::stod(lexeme));
+                } catch (const std::logic_error&) {
+                    throw RuntimeError("Number literal '" + lexeme + "' is out of range",
+                                       tok.line(), tok.column());
+                }
+            }
+        case TokenType::LITERAL_STRING:
+        case TokenType::LITERAL_CHAR:
+        case TokenType::LITERAL_CHARACTER:
+            // 词法器已完成转义解码，lexeme 即为字符串内容
+            return Value::str(std::move(lexeme));
+        case TokenType::KW_TRUE:
+            return Value::boolean(true);
+        case TokenType::KW_FALSE:
+            return Value::boolean(false);
+        case TokenType::KW_UNSET:
+            // unset 为 tribool 专属字面量（t43，见 draft.md）
+            return Value::tribool(Value::Tri::Unset);
+        case TokenType::LITERAL_BOOL:
+            return Value::boolean(lexeme == "true");
+        case TokenType::KW_NULL:
+        case TokenType::KW_NONE:
+            return Value::none();
+        default:
+            throw RuntimeError("Unsupported literal", tok.line(), tok.column());
+    }
+}
+
+Value eval_unary(const Token& op, const Value& operand) {
+    switch (op.type()) {
+        case TokenType::OP_MINUS:
+            if (!operand.is_number()) {
+                throw RuntimeError("Unary '-' requires a number", op.line(), op.column());
+            }
+            // 整数值精确取负，保持整数表示（t42）；仅 INT64_MIN 取负需升格
+            if (operand.is_small_integer() &&
+                operand.as_small_integer() != std::numeric_limits<int64_t>::min()) {
+                return Value::integer(-operand.as_small_integer());
+            }
+            if (operand.is_integer_value()) {
+                return Value::integer(operand.as_integer().negated());
+            }
+            return Value::number(-operand.as_number());
+        case TokenType::OP_NOT:
+            // Kleene 非（t43）：!unset = unset；tribool 结果仍为 tribool
+            if (operand.is_tribool()) {
+                Value::Tri t = operand.as_tribool();
+                return Value::tribool(
+                    t == Value::Tri::Unset
+                        ? Value::Tri::Unset
+                        : (t == Value::Tri::True ? Value::Tri::False
+                                                 : Value::Tri::True));
+            }
+            return Value::boolean(!operand.is_truthy());
+        case TokenType::OP_BIT_NOT:
+            // 位取反（t47）：整数值走 BigInt 精确（~x = -x-1，任意精度）
+            if (!operand.is_integer_value()) {
+                throw RuntimeError("Bitwise '~' requires an integer",
+                                   op.line(), op.column());
+            }
+            if (operand.is_small_integer()) {
+                return Value::integer(~operand.as_small_integer());  // 内联范围内恒不溢出
+            }
+            return Value::integer(operand.as_integer().negated() - BigInt(1));
+        default:
+            throw RuntimeError("Unsupported unary operator", op.line(), op.column());
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 逻辑运算
+// -----------------------------------------------------------------------------
+int logic_rank(const Value& value) {
+    // bool/tribool 混合按 Kleene 三值逻辑（t43，经作者确认）：
+    // Tri 编码 False=0 < Unset=1 < True=2，AND 取 min、OR 取 max
+    if (value.is_tribool()) return static_cast<int>(value.as_tribool());
+    return value.is_truthy() ? 2 : 0;  // 非 tribool 沿用真值判断（object 动态路径）
+}
+
+Value logic_result(int rank, bool tribool_result) {
+    if (tribool_result) {
+        return Value::tribool(static_cast<Value::Tri>(rank));
+    }
+    return Value::boolean(rank == 2);
+}
+
+// -----------------------------------------------------------------------------
+// 类型校验与转换
+// -----------------------------------------------------------------------------
+Value coerce_to_declared(TokenType declared, const Value& value,
+                         size_t line, size_t column) {
+    switch (declared) {
+        case TokenType::KW_NUMBER:
+            if (!value.is_number()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'number' variable",
+                                   line, column);
+            }
+            return value;
+        case TokenType::KW_INTEGER:
+            // integer 只接受整数表示的值（t42）：decimal 不可隐式窄化
+            if (!value.is_number()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'integer' variable",
+                                   line, column);
+            }
+            if (!value.is_integer_value()) {
+                throw RuntimeError(
+                    "Type mismatch: cannot assign decimal value to 'integer' variable",
+                    line, column);
+            }
+            return value;
+        case TokenType::KW_DECIMAL:
+            // decimal 接受任意数值；整数值隐式加宽为小数表示（t42）
+            if (!value.is_number()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'decimal' variable",
+                                   line, column);
+            }
+            if (value.is_integer_value()) {
+                return Value::number(value.as_number());
+            }
+            return value;
+        case TokenType::KW_BYTE:
+        case TokenType::KW_WORD: {
+            // 位类型运行期校验（t47）：须为整数值，byte 0-255、word 0-65535
+            const char* name = (declared == TokenType::KW_BYTE) ? "byte" : "word";
+            if (!value.is_number() || !value.is_integer_value()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to '" + name +
+                                       "' variable",
+                                   line, column);
+            }
+            const BigInt& iv = value.as_integer();
+            const long long max_val =
+                (declared == TokenType::KW_BYTE) ? 255LL : 65535LL;
+            if (BigInt::compare(iv, BigInt(0)) < 0 ||
+                BigInt::compare(iv, BigInt(max_val)) > 0) {
+                throw RuntimeError(std::string("Value out of range for '") + name +
+                                       "' (expected 0-" + std::to_string(max_val) +
+                                       ", got " + iv.to_string() + ")",
+                                   line, column);
+            }
+            return value;
+        }
+        case TokenType::KW_BOOL:
+            if (!value.is_bool()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'bool' variable",
+                                   line, column);
+            }
+            return value;
+        case TokenType::KW_TRIBOOL:
+            // tribool 接受 bool 隐式加宽（t43）；反向（tribool -> bool）不允许
+            if (value.is_tribool()) {
+                return value;
+            }
+            if (value.is_bool()) {
+                return Value::tribool(value.as_bool() ? Value::Tri::True
+                                                      : Value::Tri::False);
+            }
+            throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                   value.kind_name() + " to 'tribool' variable",
+                               line, column);
+        case TokenType::KW_ARRAY:
+            if (!value.is_array()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'array' variable",
+                                   line, column);
+            }
+            return value;
+        case TokenType::KW_TUPLE:
+            if (!value.is_tuple()) {
+                throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                       value.kind_name() + " to 'Tuple' variable",
+                                   line, column);
+            }
+            return value;
+        case TokenType::KW_STRING:
+            if (value.is_string()) {
+                return value;
+            }
+            // 语义层允许 number/bool 隐式转 string，运行期在此落地
+            if (value.is_number() || value.is_bool()) {
+                return Value::str(value.to_string());
+            }
+            throw RuntimeError(std::string("Type mismatch: cannot assign ") +
+                                   value.kind_name() + " to 'string' variable",
+                               line, column);
+        default:
+            // object/类名（IDENTIFIER）等动态类型不校验
+            return value;
+    }
+}
+
+Value to_number_value(const Value& v, size_t line, size_t column) {
+    if (v.is_number()) {
+        return v;
+    }
+    if (v.is_bool()) {
+        // bool 转整数 0/1（t42：保持整数表示）
+        return Value::integer(BigInt(v.as_bool() ? 1 : 0));
+    }
+    if (v.is_string()) {
+        // 两端去空白后解析；不可解析的字符串按文档返回 NaN（见 04-numeric.md：
+        // "infinity".toNumber() == NaN），不再报运行时错误。
+        const std::string& raw = v.as_string();
+        size_t b = 0, e = raw.size();
+        while (b < e && std::isspace(static_cast<unsigned char>(raw[b]))) ++b;
+        while (e > b && std::isspace(static_cast<unsigned char>(raw[e - 1]))) --e;
+        std::string s = raw.substr(b, e - b);
+
+        // 特殊形式严格大小写匹配："Infinity"/"+Infinity"/"-Infinity"
+        if (s == "Infinity" || s == "+Infinity") {
+            return Value::number(std::numeric_limits<double>::infinity());
+        }
+        if (s == "-Infinity") {
+            return Value::number(-std::numeric_limits<double>::infinity());
+        }
+        // 纯整数形式（可带符号）走 BigInt 精确转换，不经 double 不丢精度（t42）
+        if (!s.empty()) {
+            size_t digits_begin = (s[0] == '+' || s[0] == '-') ? 1 : 0;
+            bool all_digits = digits_begin < s.size();
+            for (size_t i = digits_begin; i < s.size(); ++i) {
+                if (!std::isdigit(static_cast<unsigned char>(s[i]))) {
+                    all_digits = false;
+                    break;
+                }
+            }
+            if (all_digits) {
+                return Value::integer(BigInt::from_decimal_string(s));
+            }
+        }
+        try {
+            size_t pos = 0;
+            double n = std::stod(s, &pos);
+            // 尾部残留字符视为非法；stod 对 "inf"/"nan" 等拼写宽松，
+            // 非有限结果一律视为不可解析（如 "infinity" 应得 NaN）
+            if (pos == s.size() && std::isfinite(n)) {
+                return Value::number(n);
+            }
+        } catch (const std::exception&) {
+            // fall through: 不可解析 → NaN
+        }
+        return Value::number(std::numeric_limits<double>::quiet_NaN());
+    }
+    throw RuntimeError(std::string("toNumber() cannot convert ") + v.kind_name(),
+                       line, column);
+}
+
+void coerce_in_place(TokenType declared, Value& value, size_t line, size_t column) {
+    switch (declared) {
+        case TokenType::KW_NUMBER:
+            if (value.is_number()) return;
+            break;
+        case TokenType::KW_INTEGER:
+            if (value.is_number() && value.is_integer_value()) return;
+            break;
+        case TokenType::KW_DECIMAL:
+            if (value.is_number() && !value.is_integer_value()) return;
+            break;
+        case TokenType::KW_BOOL:
+            if (value.is_bool()) return;
+            break;
+        case TokenType::KW_TRIBOOL:
+            if (value.is_tribool()) return;
+            break;
+        case TokenType::KW_ARRAY:
+            if (value.is_array()) return;
+            break;
+        case TokenType::KW_TUPLE:
+            if (value.is_tuple()) return;
+            break;
+        case TokenType::KW_STRING:
+            if (value.is_string()) return;
+            break;
+        default:
+            break;
+    }
+    // 需要转换、范围检查或报错的情形走完整路径
+    value = coerce_to_declared(declared, value, line, column);
+}
+
+bool needs_coercion(TokenType declared) {
+    switch (declared) {
+        case TokenType::KW_NUMBER:
+        case TokenType::KW_INTEGER:
+        case TokenType::KW_DECIMAL:
+        case TokenType::KW_BYTE:
+        case TokenType::KW_WORD:
+        case TokenType::KW_BOOL:
+        case TokenType::KW_TRIBOOL:
+        case TokenType::KW_ARRAY:
+        case TokenType::KW_TUPLE:
+        case TokenType::KW_STRING:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Value builtin_len(const Value& v, size_t line, size_t column) {
+    // len(string)：返回 UTF-8 码点数（而非字节数）；len(array)：返回元素个数。
+    if (v.is_array()) {
+        return Value::integer(static_cast<int64_t>(v.as_array().size()));
+    }
+    if (!v.is_string()) {
+        throw RuntimeError(std::string("len() expects a string or array, got ") + v.kind_name(),
+                           line, column);
+    }
+    // 长度恒为整数（t42）
+    return Value::integer(static_cast<int64_t>(utf8_length(v.as_string())));
+}
+
+// -----------------------------------------------------------------------------
+// 索引、内建方法与属性
+// -----------------------------------------------------------------------------
+Value index_get(const Value& object, const Value& index, const Token& bracket) {
+    if (object.is_string()) {
+        // 字符串按 UTF-8 码点索引（与 len 一致），返回单字符子串
+        const std::string& s = object.as_string();
+        size_t i = normalize_index(index, utf8_length(s), bracket);
+        return Value::str(utf8_char_at(s, i));
+    }
+    if (object.is_tuple()) {
+        // 元组按位置索引（t45）：0 起始，支持负索引
+        const auto& tup = object.as_tuple();
+        size_t i = normalize_index(index, tup.elements.size(), bracket);
+        return tup.elements[i];
+    }
+    if (!object.is_array()) {
+        throw RuntimeError(std::string("Only arrays, strings and tuples can be indexed, got ") +
+                               object.kind_name(),
+                           bracket.line(), bracket.column());
+    }
+    size_t i = normalize_index(index, object.as_array().size(), bracket);
+    return object.as_array()[i];
+}
+
+void check_index_assignable(const Value& object, const Token& bracket) {
+    if (object.is_string()) {
+        // 语义层已拦截静态可知的情况；这里防御 object 动态路径（如数组元素为字符串）
+        throw RuntimeError("Strings are immutable, cannot assign to index",
+                           bracket.line(), bracket.column());
+    }
+    if (object.is_tuple()) {
+        // 元组不可变（t45）；语义层已拦，这里防御 object 动态路径
+        throw RuntimeError("Tuples are immutable, cannot assign to index",
+                           bracket.line(), bracket.column());
+    }
+    if (!object.is_array()) {
+        throw RuntimeError(std::string("Only arrays can be index-assigned, got ") +
+                               object.kind_name(),
+                           bracket.line(), bracket.column());
+    }
+}
+
+void index_set(Value& object, const Value& index, const Value& value,
+               const Token& bracket) {
+    size_t i = normalize_index(index, object.as_array().size(), bracket);
+    // 数组为引用语义：写入共享底层存储，对所有持有者可见。
+    object.as_array()[i] = value;
+}
+
+BuiltinFunction resolve_builtin_function(std::string_view name) {
+    static const struct { std::string_view name; BuiltinFunction id; } kTable[] = {
+        {"print", BuiltinFunction::Print},
+        {"len", BuiltinFunction::Len},
+        {"toString", BuiltinFunction::ToString},
+        {"toNumber", BuiltinFunction::ToNumber},
+    };
+    for (const auto& entry : kTable) {
+        if (entry.name == name) return entry.id;
+    }
+    return BuiltinFunction::None;
+}
+
+BuiltinMethod resolve_builtin_method(std::string_view name) {
+    static const struct { std::string_view name; BuiltinMethod id; } kTable[] = {
+        {"get", BuiltinMethod::Get},
+        {"toString", BuiltinMethod::ToString},
+        {"toNumber", BuiltinMethod::ToNumber},
+        {"isTrue", BuiltinMethod::IsTrue},
+        {"isFalse", BuiltinMethod::IsFalse},
+        {"isUnset", BuiltinMethod::IsUnset},
+        {"trim", BuiltinMethod::Trim},
+        {"trimLeft", BuiltinMethod::TrimLeft},
+        {"trimRight", BuiltinMethod::TrimRight},
+        {"subString", BuiltinMethod::SubString},
+        {"abs", BuiltinMethod::Abs},
+        {"integerPart", BuiltinMethod::IntegerPart},
+        {"decimalPart", BuiltinMethod::DecimalPart},
+        {"isInteger", BuiltinMethod::IsInteger},
+        {"isDecimal", BuiltinMethod::IsDecimal},
+        {"isNaN", BuiltinMethod::IsNaN},
+        {"isInfinity", BuiltinMethod::IsInfinity},
+        {"isFinite", BuiltinMethod::IsFinite},
+        {"isPositive", BuiltinMethod::IsPositive},
+        {"isNegative", BuiltinMethod::IsNegative},
+    };
+    for (const auto& entry : kTable) {
+        if (entry.name == name) return entry.id;
+    }
+    return BuiltinMethod::None;
+}
+
+/// subString(startIndex[, endIndex = length])：按 UTF-8 码点截取
+static Value builtin_sub_string(const std::string& s, const std::vector<Value>& args,
+                                size_t line, size_t column) {
+    // endIndex 传 -1/NaN 时取 length；区间为 [start, end)，
+    // 越界截断、start >= end 时为空串
+    if (args.empty() || args.size() > 2) {
+        throw RuntimeError("subString() expects 1 to 2 argument(s)", line, column);
+    }
+    const Value& start_value = args[0];
+    if (!start_value.is_number()) {
+        throw RuntimeError("subString() indices must be numbers", line, column);
+    }
+    size_t length = utf8_length(s);
+    double end_raw = static_cast<double>(length);
+    if (args.size() == 2) {
+        const Value& end_value = args[1];
+        if (!end_value.is_number()) {
+            throw RuntimeError("subString() indices must be numbers", line, column);
+        }
+        end_raw = end_value.as_number();
+        if (std::isnan(end_raw) || end_raw == -1.0) {
+            end_raw = static_cast<double>(length);
+        }
+    }
+    double start_raw = start_value.as_number();
+    if (std::isnan(start_raw)) { start_raw = 0.0; }
+    double len_d = static_cast<double>(length);
+    double start_d = std::min(std::max(std::floor(start_raw), 0.0), len_d);
+    double end_d = std::min(std::max(std::floor(end_raw), 0.0), len_d);
+    if (start_d >= end_d) {
+        return Value::str("");
+    }
+    size_t from = utf8_byte_offset(s, static_cast<size_t>(start_d));
+    size_t to = utf8_byte_offset(s, static_cast<size_t>(end_d));
+    return Value::str(s.substr(from, to - from));
+}
+
+Value call_builtin_method(const Value& object, BuiltinMethod method, std::string_view name,
+                          const std::vector<Value>& args,
+                          size_t line, size_t column) {
+    // 除 subString/get 外内建方法均为 0 参（语义层已校验，这里防御 object 动态路径）
+    if (method != BuiltinMethod::SubString && method != BuiltinMethod::Get && !args.empty()) {
+        throw RuntimeError(std::string(name) + "() expects no arguments", line, column);
+    }
+
+    switch (method) {
+        case BuiltinMethod::Get: {
+            // tuple 专属方法（t45）：get("key") 按名字动态获取命名字段
+            if (!object.is_tuple()) {
+                throw RuntimeError("Method 'get()' is only supported on tuples, got " +
+                                       std::string(object.kind_name()),
+                                   line, column);
+            }
+            if (args.size() != 1) {
+                throw RuntimeError("get() expects 1 argument(s), got " +
+                                       std::to_string(args.size()),
+                                   line, column);
+            }
+            const Value& key = args[0];
+            if (!key.is_string()) {
+                throw RuntimeError(std::string("get() key must be a string, got ") +
+                                       key.kind_name(),
+                                   line, column);
+            }
+            const auto& tup = object.as_tuple();
+            for (size_t i = 0; i < tup.names.size(); ++i) {
+                if (!tup.names[i].empty() && tup.names[i] == key.as_string()) {
+                    return tup.elements[i];
+                }
+            }
+            throw RuntimeError("Undefined tuple field '" + key.as_string() + "'",
+                               line, column);
+        }
+
+        // 通用方法：与内建函数 toString/toNumber 行为一致
+        case BuiltinMethod::ToString:
+            return Value::str(object.to_string());
+        case BuiltinMethod::ToNumber:
+            return to_number_value(object, line, column);
+
+        // tribool 专属方法（t43，经作者确认：条件语境需显式判断，返回 bool）
+        case BuiltinMethod::IsTrue:
+        case BuiltinMethod::IsFalse:
+        case BuiltinMethod::IsUnset: {
+            if (!object.is_tribool()) {
+                throw RuntimeError("Method '" + std::string(name) +
+                                       "()' is only supported on tribool, got " +
+                                       std::string(object.kind_name()),
+                                   line, column);
+            }
+            Value::Tri t = object.as_tribool();
+            return Value::boolean(method == BuiltinMethod::IsTrue    ? t == Value::Tri::True
+                                  : method == BuiltinMethod::IsFalse ? t == Value::Tri::False
+                                                                     : t == Value::Tri::Unset);
+        }
+
+        // string 专属方法（见设计文档 03-character.md）
+        case BuiltinMethod::Trim:
+        case BuiltinMethod::TrimLeft:
+        case BuiltinMethod::TrimRight:
+        case BuiltinMethod::SubString: {
+            if (!object.is_string()) {
+                throw RuntimeError("Method '" + std::string(name) +
+                                       "()' is only supported on strings, got " +
+                                       std::string(object.kind_name()),
+                                   line, column);
+            }
+            const std::string& s = object.as_string();
+            if (method == BuiltinMethod::SubString) {
+                return builtin_sub_string(s, args, line, column);
+            }
+            // trim 系列：空白字符为空格与 Tab 制表符（见 03-character.md）
+            auto is_blank = [](char c) { return c == ' ' || c == '\t'; };
+            size_t begin = 0;
+            size_t end = s.size();
+            if (method != BuiltinMethod::TrimRight) {
+                while (begin < end && is_blank(s[begin])) { ++begin; }
+            }
+            if (method != BuiltinMethod::TrimLeft) {
+                while (end > begin && is_blank(s[end - 1])) { --end; }
+            }
+            return Value::str(s.substr(begin, end - begin));
+        }
+
+        default:
+            break;  // number 专属方法与未知方法名
+    }
+
+    // number 专属方法（见设计文档 04-numeric.md）
+    if (!object.is_number()) {
+        throw RuntimeError("Method '" + std::string(name) + "()' is only supported on numbers, got " +
+                               std::string(object.kind_name()),
+                           line, column);
+    }
+    // 整数表示的精确路径（t42）：超大整数经 double 会丢精度/饱和为 Infinity，
+    // 故直接按 BigInt 回答；整数恒有限、恒非 NaN/Infinity
+    if (object.is_integer_value()) {
+        switch (method) {
+            case BuiltinMethod::Abs: {
+                if (object.is_small_integer() &&
+                    object.as_small_integer() != std::numeric_limits<int64_t>::min()) {
+                    int64_t n = object.as_small_integer();
+                    return Value::integer(n < 0 ? -n : n);
+                }
+                const BigInt n = object.as_integer();
+                return Value::integer(n.sign() < 0 ? n.negated() : n);
+            }
+            case BuiltinMethod::IntegerPart: return object;
+            case BuiltinMethod::DecimalPart: return Value::integer(int64_t{0});
+            case BuiltinMethod::IsInteger:   return Value::boolean(true);
+            case BuiltinMethod::IsDecimal:   return Value::boolean(false);
+            case BuiltinMethod::IsNaN:       return Value::boolean(false);
+            case BuiltinMethod::IsInfinity:  return Value::boolean(false);
+            case BuiltinMethod::IsFinite:    return Value::boolean(true);
+            case BuiltinMethod::IsPositive:  return Value::boolean(object.as_number() > 0.0);
+            case BuiltinMethod::IsNegative:  return Value::boolean(object.as_number() < 0.0);
+            default:
+                throw RuntimeError("Unknown method '" + std::string(name) + "'", line, column);
+        }
+    }
+    double a = object.as_number();
+    switch (method) {
+        case BuiltinMethod::Abs:
+            return Value::number(std::fabs(a));
+        case BuiltinMethod::IntegerPart:
+            // 向零取整：-123.456.integerPart() == -123
+            return Value::number(std::trunc(a));
+        case BuiltinMethod::DecimalPart:
+            // 保留符号：-123.456.decimalPart() == -0.456
+            return Value::number(a - std::trunc(a));
+        case BuiltinMethod::IsInteger:
+            return Value::boolean(std::isfinite(a) && a == std::floor(a));
+        case BuiltinMethod::IsDecimal:
+            // 文档规定 Infinity/NaN 的 isInteger/isDecimal 均为 false
+            return Value::boolean(std::isfinite(a) && a != std::floor(a));
+        case BuiltinMethod::IsNaN:
+            return Value::boolean(std::isnan(a));
+        case BuiltinMethod::IsInfinity:
+            return Value::boolean(std::isinf(a));
+        case BuiltinMethod::IsFinite:
+            return Value::boolean(std::isfinite(a));
+        case BuiltinMethod::IsPositive:
+            return Value::boolean(a > 0.0);   // NaN 与 0 均为 false
+        case BuiltinMethod::IsNegative:
+            return Value::boolean(a < 0.0);
+        default:
+            throw RuntimeError("Unknown method '" + std::string(name) + "'", line, column);
+    }
+}
+
+Value get_property(const Value& object, const std::string& name,
+                   size_t line, size_t column) {
+
+    // 元组（t45）：length 属性与命名字段读取
+    if (object.is_tuple()) {
+        const auto& tup = object.as_tuple();
+        if (name == "length") {
+            return Value::integer(static_cast<int64_t>(tup.elements.size()));
+        }
+        for (size_t i = 0; i < tup.names.size(); ++i) {
+            if (tup.names[i] == name) {
+                return tup.elements[i];
+            }
+        }
+        throw RuntimeError("Undefined tuple field '" + name + "'", line, column);
+    }
+
+    // 内建属性（见设计文档 03-character.md）：string 按 UTF-8 码点计数；
+    // 长度恒为整数（t42）
+    if (name == "length") {
+        if (object.is_string()) {
+            return Value::integer(
+                BigInt(static_cast<long long>(utf8_length(object.as_string()))));
+        }
+        if (object.is_array()) {
+            return Value::integer(
+                BigInt(static_cast<long long>(object.as_array().size())));
+        }
+        throw RuntimeError(
+            std::string("Property 'length' is only supported on strings and arrays, got ") +
+                object.kind_name(),
+            line, column);
+    }
+    throw RuntimeError("Unknown property '" + name + "'", line, column);
+}
+
+size_t normalize_index(const Value& index, size_t size, const Token& bracket) {
+    if (!index.is_number()) {
+        throw RuntimeError(std::string("Index must be a number, got ") +
+                               index.kind_name(),
+                           bracket.line(), bracket.column());
+    }
+    long long i;
+    if (index.is_small_integer()) {
+        i = index.as_small_integer();
+    } else {
+        double raw = index.as_number();
+        if (raw != std::floor(raw)) {
+            throw RuntimeError("Index must be an integer",
+                               bracket.line(), bracket.column());
+        }
+        i = static_cast<long long>(raw);
+    }
+    // 负索引：-1 表示最后一个元素
+    if (i < 0) {
+        i += static_cast<long long>(size);
+    }
+    if (i < 0 || i >= static_cast<long long>(size)) {
+        throw RuntimeError("Index " + index.to_string() +
+                               " out of range (size " + std::to_string(size) + ")",
+                           bracket.line(), bracket.column());
+    }
+    return static_cast<size_t>(i);
+}
+
+/// UTF-8 首字节 → 码点字节长度（非法字节按 1 处理，防御性前进）
+static size_t utf8_char_length(unsigned char c) {
+    if ((c & 0x80) == 0)    return 1;  // ASCII
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+size_t utf8_length(const std::string& s) {
+    size_t count = 0;
+    for (size_t i = 0; i < s.size(); ) {
+        i += utf8_char_length(static_cast<unsigned char>(s[i]));
+        ++count;
+    }
+    return count;
+}
+
+std::string utf8_char_at(const std::string& s, size_t index) {
+    size_t byte = 0;
+    for (size_t seen = 0; byte < s.size(); ++seen) {
+        size_t char_len = utf8_char_length(static_cast<unsigned char>(s[byte]));
+        if (seen == index) {
+            return s.substr(byte, char_len);
+        }
+        byte += char_len;
+    }
+    return "";  // 前置条件保证不到达（index < utf8_length(s)）
+}
+
+size_t utf8_byte_offset(const std::string& s, size_t index) {
+    size_t byte = 0;
+    for (size_t seen = 0; byte < s.size() && seen < index; ++seen) {
+        byte += utf8_char_length(static_cast<unsigned char>(s[byte]));
+    }
+    return byte;
+}
+
+// -----------------------------------------------------------------------------
+// 二元运算
+// -----------------------------------------------------------------------------
+Value eval_binary(const Token& op, const Value& left, const Value& right) {
+    switch (op.type()) {
+        case TokenType::OP_PLUS:
+        case TokenType::OP_MINUS:
+        case TokenType::OP_MULTIPLY:
+        case TokenType::OP_DIVIDE:
+        case TokenType::OP_MODULO:
+            return eval_arithmetic(op, left, right);
+
+        case TokenType::OP_EQUAL:
+            return Value::boolean(values_equal(left, right));
+        case TokenType::OP_NOT_EQUAL:
+            return Value::boolean(!values_equal(left, right));
+
+        case TokenType::OP_GREATER:
+        case TokenType::OP_LESS:
+        case TokenType::OP_GREATER_EQ:
+        case TokenType::OP_LESS_EQ:
+            return eval_comparison(op, left, right);
+
+        case TokenType::OP_BIT_AND:
+        case TokenType::OP_BIT_OR:
+        case TokenType::OP_BIT_XOR:
+        case TokenType::OP_BIT_LSHIFT:
+        case TokenType::OP_BIT_RSHIFT:
+            return eval_bitwise(op, left, right);
+
+        default:
+            throw RuntimeError("Unsupported binary operator", op.line(), op.column());
+    }
+}
+
+namespace {
+
+// 算术求值核心：eval_arithmetic 与 eval_numeric_arithmetic 都在热路径上，
+// 各自内联一份，免去多一层调用
+inline Value numeric_arithmetic(const Token& op, const Value& left, const Value& right) {
+    // 双内联整数快速路径：int64 运算，溢出（或 INT64_MIN % -1）时落到下方 BigInt 路径
+    if (left.is_small_integer() && right.is_small_integer()) {
+        int64_t a = left.as_small_integer();
+        int64_t b = right.as_small_integer();
+        int64_t r;
+        switch (op.type()) {
+            case TokenType::OP_PLUS:
+                if (!add_overflow(a, b, &r)) return Value::integer(r);
+                break;
+            case TokenType::OP_MINUS:
+                if (!sub_overflow(a, b, &r)) return Value::integer(r);
+                break;
+            case TokenType::OP_MULTIPLY:
+                if (!mul_overflow(a, b, &r)) return Value::integer(r);
+                break;
+            case TokenType::OP_MODULO:
+                if (b != 0 && b != -1) {
+                    r = a % b;
+                    if (r != 0 && ((r < 0) != (b < 0))) r += b;  // floor 语义
+                    return Value::integer(r);
+                }
+                if (b == -1) return Value::integer(int64_t{0});
+                break;
+            default:
+                break;
+        }
+    }
+
+    // 双整数精确路径（t42）：+ - * % 走 BigInt，自动扩容不溢出；
+    // 除法恒产小数（Python 式 true division），落到下方 double 路径；
+    // 取模除数为 0 时同样落到 double 路径得 NaN（保持 IEEE 754 语义）
+    if (left.is_integer_value() && right.is_integer_value()) {
+        const BigInt& ia = left.as_integer();
+        const BigInt& ib = right.as_integer();
+        switch (op.type()) {
+            case TokenType::OP_PLUS:     return Value::integer(ia + ib);
+            case TokenType::OP_MINUS:    return Value::integer(ia - ib);
+            case TokenType::OP_MULTIPLY: return Value::integer(ia * ib);
+            case TokenType::OP_MODULO:
+                // floor 语义（Python 风格）：结果符号与除数一致
+                if (!ib.is_zero()) {
+                    return Value::integer(ia.floor_mod(ib));
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    double a = left.as_number();
+    double b = right.as_number();
+    switch (op.type()) {
+        case TokenType::OP_PLUS:     return Value::number(a + b);
+        case TokenType::OP_MINUS:    return Value::number(a - b);
+        case TokenType::OP_MULTIPLY: return Value::number(a * b);
+        case TokenType::OP_DIVIDE:
+            // 除零遵循 IEEE 754（与 t31 的 Infinity/NaN 语义衔接，经作者确认）：
+            // 1/0 → +Infinity、-1/0 → -Infinity、0/0 → NaN
+            return Value::number(a / b);
+        case TokenType::OP_MODULO: {
+            // 取模除数为 0 同样遵循 IEEE 754：fmod(x, 0) → NaN
+            if (b == 0.0) {
+                return Value::number(std::numeric_limits<double>::quiet_NaN());
+            }
+            // 设计文档规定取模为 floor 语义（Python 风格）：结果符号与除数一致，
+            // 如 -1 % 5 == 4、-1 % -5 == -1、1 % -5 == -4（见 04-numeric.md）
+            double r = std::fmod(a, b);
+            if (r != 0.0 && ((r < 0.0) != (b < 0.0))) {
+                r += b;
+            }
+            return Value::number(r);
+        }
+        default:
+            throw RuntimeError("Unsupported arithmetic operator", op.line(), op.column());
+    }
+}
+
+} // namespace
+
+Value eval_arithmetic(const Token& op, const Value& left, const Value& right) {
+    // '+' 在任一侧为字符串时表示拼接
+    if (op.type() == TokenType::OP_PLUS &&
+        (left.is_string() || right.is_string())) {
+        return concat(left, right);
+    }
+
+    if (!left.is_number() || !right.is_number()) {
+        throw RuntimeError("Arithmetic operands must be numbers", op.line(), op.column());
+    }
+    return numeric_arithmetic(op, left, right);
+}
+
+Value eval_numeric_arithmetic(const Token& op, const Value& left, const Value& right) {
+    // 静态类型只对已初始化的变量成立：操作数不是 number（读到未初始化变量的 none）
+    // 时走受检路径报错，不把 none 的载荷当作数值
+    if (!left.is_number() || !right.is_number()) {
+        return eval_arithmetic(op, left, right);
+    }
+    return numeric_arithmetic(op, left, right);
+}
+
+Value concat(Value left, const Value& right) {
+    if (!left.is_string()) {
+        left = Value::str(left.to_string());
+    }
+    if (!right.is_string()) {
+        return Value::concat(std::move(left), Value::str(right.to_string()));
+    }
+    return Value::concat(std::move(left), right);
+}
+
+Value eval_bitwise(const Token& op, const Value& left, const Value& right) {
+    // 位运算仅在整数域内定义（t47）：两侧必须是整数值；
+    // 求值走 int64 路径（超出 64 位范围报运行时错误，不静默截断）
+    if (!left.is_integer_value() || !right.is_integer_value()) {
+        throw RuntimeError("Bitwise operands must be integers",
+                           op.line(), op.column());
+    }
+    // 整数规范表示：落在 int64 内必为内联，升格为 BigInt 即超出 64 位
+    auto to_i64 = [&op](const Value& v) -> int64_t {
+        if (!v.is_small_integer()) {
+            throw RuntimeError("Bitwise operand out of 64-bit range",
+                               op.line(), op.column());
+        }
+        return v.as_small_integer();
+    };
+    int64_t a = to_i64(left);
+    int64_t b = to_i64(right);
+
+    switch (op.type()) {
+        case TokenType::OP_BIT_AND:
+            return Value::integer(a & b);
+        case TokenType::OP_BIT_OR:
+            return Value::integer(a | b);
+        case TokenType::OP_BIT_XOR:
+            return Value::integer(a ^ b);
+        case TokenType::OP_BIT_LSHIFT:
+        case TokenType::OP_BIT_RSHIFT: {
+            // 移位数限 0-63，避免 C++ 未定义行为
+            if (b < 0 || b > 63) {
+                throw RuntimeError("Shift count must be in range 0-63",
+                                   op.line(), op.column());
+            }
+            if (op.type() == TokenType::OP_BIT_LSHIFT) {
+                // 无符号域内左移再转回，回避负数左移的 UB
+                return Value::integer(static_cast<int64_t>(
+                    static_cast<uint64_t>(a) << b));
+            }
+            // 右移为算术移位（符号位扩展，C++20 起标准保证）
+            return Value::integer(a >> b);
+        }
+        default:
+            throw RuntimeError("Unsupported bitwise operator", op.line(), op.column());
+    }
+}
+
+Value eval_comparison(const Token& op, const Value& left, const Value& right) {
+    // 双内联整数直接比较机器整数
+    if (left.is_small_integer() && right.is_small_integer()) {
+        int64_t a = left.as_small_integer();
+        int64_t b = right.as_small_integer();
+        switch (op.type()) {
+            case TokenType::OP_GREATER:    return Value::boolean(a > b);
+            case TokenType::OP_LESS:       return Value::boolean(a < b);
+            case TokenType::OP_GREATER_EQ: return Value::boolean(a >= b);
+            case TokenType::OP_LESS_EQ:    return Value::boolean(a <= b);
+            default: break;
+        }
+    }
+    // 双整数走 BigInt 精确比较（t42，超大整数不受 double 精度影响）
+    if (left.is_integer_value() && right.is_integer_value()) {
+        int c = BigInt::compare(left.as_integer(), right.as_integer());
+        switch (op.type()) {
+            case TokenType::OP_GREATER:    return Value::boolean(c > 0);
+            case TokenType::OP_LESS:       return Value::boolean(c < 0);
+            case TokenType::OP_GREATER_EQ: return Value::boolean(c >= 0);
+            case TokenType::OP_LESS_EQ:    return Value::boolean(c <= 0);
+            default: break;
+        }
+    }
+    // 数字比较
+    if (left.is_number() && right.is_number()) {
+        double a = left.as_number();
+        double b = right.as_number();
+        switch (op.type()) {
+            case TokenType::OP_GREATER:    return Value::boolean(a > b);
+            case TokenType::OP_LESS:       return Value::boolean(a < b);
+            case TokenType::OP_GREATER_EQ: return Value::boolean(a >= b);
+            case TokenType::OP_LESS_EQ:    return Value::boolean(a <= b);
+            default: break;
+        }
+    }
+    // 字符串按字典序比较
+    if (left.is_string() && right.is_string()) {
+        const std::string& a = left.as_string();
+        const std::string& b = right.as_string();
+        switch (op.type()) {
+            case TokenType::OP_GREATER:    return Value::boolean(a > b);
+            case TokenType::OP_LESS:       return Value::boolean(a < b);
+            case TokenType::OP_GREATER_EQ: return Value::boolean(a >= b);
+            case TokenType::OP_LESS_EQ:    return Value::boolean(a <= b);
+            default: break;
+        }
+    }
+    throw RuntimeError("Comparison operands must be both numbers or both strings",
+                       op.line(), op.column());
+}
+
+bool values_equal(const Value& left, const Value& right) {
+    if (left.is_small_integer() && right.is_small_integer()) {
+        return left.as_small_integer() == right.as_small_integer();
+    }
+    // tribool 与 bool 可等值比较（t43：t == true / t == unset）：三态一致才相等，
+    // unset 与 true/false 均不等；与其他类型比较恒不等
+    if (left.is_tribool() || right.is_tribool()) {
+        auto tri_of = [](const Value& v) {
+            if (v.is_tribool()) return static_cast<int>(v.as_tribool());
+            return v.as_bool() ? 2 : 0;
+        };
+        if ((left.is_tribool() || left.is_bool()) &&
+            (right.is_tribool() || right.is_bool())) {
+            return tri_of(left) == tri_of(right);
+        }
+        return false;
+    }
+    if (left.kind() != right.kind()) return false;
+    switch (left.kind()) {
+        case Value::Kind::None:   return true;
+        case Value::Kind::Bool:   return left.as_bool() == right.as_bool();
+        case Value::Kind::Number:
+            // 双整数精确相等（t42）；混合表示按 double 视图比较（5 == 5.0）。
+            // 规范表示下内联整数与 BigInt 必不相等
+            if (left.is_integer_value() && right.is_integer_value()) {
+                if (left.is_small_integer() != right.is_small_integer()) return false;
+                return BigInt::compare(left.as_integer(), right.as_integer()) == 0;
+            }
+            return left.as_number() == right.as_number();
+        case Value::Kind::String: return left.as_string() == right.as_string();
+        case Value::Kind::Array: {
+            // 数组按元素逐个深度比较
+            const auto& l = left.as_array();
+            const auto& r = right.as_array();
+            if (l.size() != r.size()) return false;
+            for (size_t i = 0; i < l.size(); ++i) {
+                if (!values_equal(l[i], r[i])) return false;
+            }
+            return true;
+        }
+        case Value::Kind::Tuple: {
+            // 元组按元素与名字表逐个深度比较（名字不同则不相等）
+            const auto& lt = left.as_tuple();
+            const auto& rt = right.as_tuple();
+            if (lt.elements.size() != rt.elements.size()) return false;
+            if (lt.names != rt.names) return false;
+            for (size_t i = 0; i < lt.elements.size(); ++i) {
+                if (!values_equal(lt.elements[i], rt.elements[i])) return false;
+            }
+            return true;
+        }
+        default: break;
+    }
+    return false;
+}
+
+bool condition_truthy(const Value& value, const Token& keyword) {
+    // tribool 不能直接作条件（t43，经作者确认）：必须显式写
+    // isTrue()/isFalse()/isUnset() 或与 true/false/unset 比较，避免
+    // unset 语义含糊；语义层已拦静态可知情况，这里防御动态路径
+    if (value.is_tribool()) {
+        throw RuntimeError(
+            "Condition must be a bool; tribool requires explicit "
+            "isTrue()/isFalse()/isUnset()",
+            keyword.line(), keyword.column());
+    }
+    return value.is_truthy();
+}
+
+}  // namespace runtime
+
+} // namespace collie
@@ -0,0 +1,317 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 解释器运行期语义（树遍历解释器与字节码 VM 共用）
+ */
+#ifndef COLLIE_INTERPRETER_RUNTIME_H
+#define COLLIE_INTERPRETER_RUNTIME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "value.h"
+#include "../parser/ast.h"
+#include "../lexer/token.h"
+
+namespace collie {
+
+/**
+ * @brief 运行期错误，携带源位置，由调用方（main / 测试）捕获后上报。
+ */
+class RuntimeError : public std::runtime_error {
+public:
+    RuntimeError(const std::string& message, size_t line, size_t column)
+        : std::runtime_error(message), line_(line), column_(column) {}
+
+    size_t line() const { return line_; }
+    size_t column() const { return column_; }
+
+private:
+    size_t line_;
+    size_t column_;
+};
+
+/// 默认调用深度上限（两个引擎共用，main 的 --max-depth 可覆盖）：
+/// 超限抛 RuntimeError，不再耗尽原生栈崩溃；尾调用复用帧，不计入深度。
+/// 取 2^20：保证百万层的非尾递归可用
+constexpr size_t kDefaultMaxCallDepth = 1 << 20;
+
+/**
+ * @brief 类的字段布局：沿继承链 base-first 合并出的字段槽位
+ *
+ * 每个不同的字段名占一个槽位，父类字段在前；子类同名字段复用父类槽位，
+ * 其声明（赋值时的校验类型）取最派生类，与 find_field 一致。
+ */
+struct ClassLayout {
+    /// new 时的字段初始化步骤：继承链 base-first、类体内按声明顺序（被覆盖的父类字段也执行）
+    struct FieldInit {
+        size_t slot;
+        const VarDeclStmt* field;
+    };
+
+    std::vector<std::string> names;          ///< 槽位 -> 字段名
+    std::vector<const VarDeclStmt*> fields;  ///< 槽位 -> 字段声明
+    std::vector<FieldInit> inits;
+
+    size_t size() const { return names.size(); }
+    /// 按名字取槽位，不存在返回 -1
+    int slot_of(std::string_view name) const;
+};
+
+/**
+ * @brief 已登记的类声明表：继承链、方法与字段查找
+ *
+ * 持有 ClassStmt 的非拥有指针（AST 生命周期覆盖解释执行期）。
+ */
+class ClassRegistry {
+public:
+    void define(const ClassStmt& klass) {
+        classes_[std::string(klass.name().lexeme())] = &klass;
+    }
+
+    /// @brief 按名字取类声明，未登记返回 nullptr
+    const ClassStmt* find(const std::string& name) const {
+        auto it = classes_.find(name);
+        return it == classes_.end() ? nullptr : it->second;
+    }
+
+    /// @brief 取父类声明（无父类返回 nullptr，父类未登记抛 RuntimeError）
+    const ClassStmt* superclass_of(const ClassStmt* klass) const;
+
+    /// @brief 沿继承链查找指定名字的方法（含构造器，子类优先实现覆写），
+    /// 未找到返回 nullptr；defining_class 非空时回写定义该方法的类
+    const FunctionStmt* find_method(const ClassStmt* klass,
+                                    const std::string& name,
+                                    const ClassStmt** defining_class = nullptr) const;
+
+    /// @brief 沿继承链查找指定名字的字段声明（子类优先），未找到返回 nullptr
+    const VarDeclStmt* find_field(const ClassStmt* klass,
+                                  const std::string& name) const;
+
+    /// @brief 取类的字段布局（首次使用时计算并缓存；父类未登记抛 RuntimeError）
+    const ClassLayout& layout_of(const ClassStmt* klass) const;
+
+private:
+    std::unordered_map<std::string, const ClassStmt*> classes_;
+    /// 字段布局缓存（节点式容器，已返回的引用在插入后仍有效）
+    mutable std::unordered_map<const ClassStmt*, ClassLayout> layouts_;
+};
+
+/**
+ * @brief 按接收者类记录查找结果的内联缓存（挂在单个调用点/属性访问点上）
+ *
+ * 最多登记 kWays 个类：只见过一个类时为单态，比较一次指针即命中；
+ * 见过多个类时为多态，顺序比较。登记满后出现的新类直接走慢路径、不再登记（超多态）。
+ * 类声明在执行期间不变，条目无需失效。
+ */
+template <typename Target>
+class InlineCache {
+public:
+    static constexpr size_t kWays = 4;
+
+    /// 命中返回缓存的查找结果，未命中返回 nullptr
+    const Target* find(const ClassStmt* klass) const {
+        for (uint8_t i = 0; i < size_; ++i) {
+            if (classes_[i] == klass) return &targets_[i];
+        }
+        return nullptr;
+    }
+
+    void insert(const ClassStmt* klass, const Target& target) {
+        if (size_ == kWays) return;
+        classes_[size_] = klass;
+        targets_[size_] = target;
+        ++size_;
+    }
+
+private:
+    const ClassStmt* classes_[kWays] = {};
+    Target targets_[kWays] = {};
+    uint8_t size_ = 0;
+};
+
+/// @brief 字段访问缓存条目：槽位（未声明的字段为 -1）及字段声明（赋值时按其类型校验）
+struct FieldTarget {
+    int slot = -1;
+    const VarDeclStmt* field = nullptr;
+};
+
+/// @brief 方法分派缓存条目：方法（未找到时为 nullptr）及其定义类
+struct MethodTarget {
+    const FunctionStmt* method = nullptr;
+    const ClassStmt* defining_class = nullptr;
+};
+using MethodCache = InlineCache<MethodTarget>;
+using FieldCache = InlineCache<FieldTarget>;
+
+/// @brief 内联缓存命中/未命中计数（--cache-stats 输出）
+struct InlineCacheStats {
+    uint64_t method_hits = 0;
+    uint64_t method_misses = 0;
+    uint64_t field_hits = 0;
+    uint64_t field_misses = 0;
+};
+
+/**
+ * @brief 与执行引擎无关的值语义：字面量、运算符、类型校验、索引与内建方法
+ *
+ * 两个引擎只负责求值顺序与控制流，值层面的行为（含错误消息）统一在此实现，
+ * 保证树遍历解释器与 VM 输出逐字节一致。
+ */
+namespace runtime {
+
+/// @brief 经调用点缓存查找实例方法：命中时既不构造名字也不走继承链，
+/// 未命中时查 ClassRegistry 并登记（方法不存在也登记为 nullptr）
+MethodTarget lookup_method(const ClassRegistry& classes, MethodCache& cache,
+                           const ClassStmt* klass, std::string_view name,
+                           InlineCacheStats& stats);
+
+/// @brief 经属性访问点缓存查找字段槽位
+FieldTarget lookup_field(const ClassRegistry& classes, FieldCache& cache,
+                         const ClassStmt* klass, std::string_view name,
+                         InlineCacheStats& stats);
+
+/// @brief 调用深度超过 limit 时的运行期错误（两个引擎消息一致）
+RuntimeError call_depth_exceeded(size_t limit, size_t line, size_t column);
+
+/// @brief 字面量 token 转运行期值
+Value literal_value(const Token& tok);
+
+/// @brief 一元运算 - ! ~
+Value eval_unary(const Token& op, const Value& operand);
+
+/// @brief 非短路二元运算（算术/比较/相等/位运算）
+Value eval_binary(const Token& op, const Value& left, const Value& right);
+Value eval_arithmetic(const Token& op, const Value& left, const Value& right);
+/// @brief 两侧静态类型均为 number 时的算术 + - * / %（省去拼接检查；值不是 number 时照常报错）
+Value eval_numeric_arithmetic(const Token& op, const Value& left, const Value& right);
+/// @brief 字符串拼接 '+'（至少一侧为字符串，另一侧先转字符串表示）；
+/// left 以值传入：调用方交出独占的临时值时可就地追加
+Value concat(Value left, const Value& right);
+Value eval_comparison(const Token& op, const Value& left, const Value& right);
+/// 位运算 & | ^ << >>（t47）：两侧须为整数值，int64 域内求值
+Value eval_bitwise(const Token& op, const Value& left, const Value& right);
+
+/// @brief 逻辑运算的三态编码：tribool 取自身，其余按真值映射为 False/True
+int logic_rank(const Value& value);
+/// @brief 由三态编码构造 && / || 的结果：任一操作数为 tribool 时结果为 tribool
+Value logic_result(int rank, bool tribool_result);
+
+bool values_equal(const Value& left, const Value& right);
+
+/// @brief 条件真值（if/while/for/do-while）：tribool 不能直接作条件
+/// （t43，经作者确认，需显式 isTrue()/== 判断），违反抛 RuntimeError
+bool condition_truthy(const Value& value, const Token& keyword);
+
+/// @brief 按声明类型校验/隐式转换值（string ← number/bool 转字符串，
+/// object/类名等动态类型放行），不兼容抛 RuntimeError
+Value coerce_to_declared(TokenType declared, const Value& value,
+                         size_t line, size_t column);
+
+/// @brief coerce_to_declared 的原地版本：值已满足声明类型时直接放行，免去整值拷贝
+void coerce_in_place(TokenType declared, Value& value, size_t line, size_t column);
+
+/// @brief 声明类型是否需要运行期校验（object/类名等动态类型无需校验）
+bool needs_coercion(TokenType declared);
+
+/// @brief 静态类型为 static_type 的值是否无需校验/转换即满足声明类型
+/// （static_type 取自 Expr::static_type，INVALID 表示动态；
+/// integer/decimal/byte/word 涉及表示与范围，始终走 coerce_to_declared）。
+/// 每次绑定/赋值都要判断，内联在头文件中
+inline bool satisfies_declared(TokenType declared, TokenType static_type) {
+    switch (declared) {
+        case TokenType::KW_NUMBER:
+            // 任何数值静态类型都保证值为 number
+            switch (static_type) {
+                case TokenType::KW_NUMBER:
+                case TokenType::KW_INTEGER:
+                case TokenType::KW_DECIMAL:
+                case TokenType::KW_BYTE:
+                case TokenType::KW_WORD:
+                    return true;
+                default:
+                    return false;
+            }
+        case TokenType::KW_INTEGER:
+        case TokenType::KW_DECIMAL:
+        case TokenType::KW_BYTE:
+        case TokenType::KW_WORD:
+            return false;
+        case TokenType::KW_BOOL:
+        case TokenType::KW_TRIBOOL:
+        case TokenType::KW_STRING:
+        case TokenType::KW_ARRAY:
+        case TokenType::KW_TUPLE:
+            // bool 静态类型的值仍须加宽为 tribool，故只接受同类型
+            return static_type == declared;
+        default:
+            // object/类名等动态类型不校验（与 needs_coercion 一致）
+            return true;
+    }
+}
+
+/// @brief 值 value 能否凭静态类型免去按声明类型的校验/转换。
+/// 静态类型只对已初始化的变量成立；读到未初始化变量时值为 none，
+/// 多一次种类比较兜底，照常校验并报错
+inline bool skips_coercion(TokenType declared, TokenType static_type, const Value& value) {
+    return satisfies_declared(declared, static_type) && !value.is_none();
+}
+
+/// @brief 把值转为 number（string/bool/number），失败抛 RuntimeError；
+/// toNumber 内建函数与 .toNumber() 方法共用
+Value to_number_value(const Value& v, size_t line, size_t column);
+
+/// @brief len(string|array)
+Value builtin_len(const Value& v, size_t line, size_t column);
+
+/// @brief 归一化索引（支持负索引，-1 为末尾），越界抛 RuntimeError
+size_t normalize_index(const Value& index, size_t size, const Token& bracket);
+
+/// @brief object[index] 读取（数组/字符串/元组）
+Value index_get(const Value& object, const Value& index, const Token& bracket);
+
+/// @brief 校验 object 可按下标写入（仅数组），否则抛 RuntimeError
+void check_index_assignable(const Value& object, const Token& bracket);
+
+/// @brief 数组按下标写入（前置：check_index_assignable 已通过）
+void index_set(Value& object, const Value& index, const Value& value,
+               const Token& bracket);
+
+/// @brief 按调用处名字解析内建函数（非内建名为 None），由 Resolver 调用一次
+BuiltinFunction resolve_builtin_function(std::string_view name);
+/// @brief 按方法名解析内建方法（非内建名为 None），由 Resolver 调用一次
+BuiltinMethod resolve_builtin_method(std::string_view name);
+
+/// @brief 非实例值上的内建方法（tuple/string/number/tribool 与通用 toString/toNumber），
+/// 按预解析的 method 分派；name 仅用于报错
+Value call_builtin_method(const Value& object, BuiltinMethod method, std::string_view name,
+                          const std::vector<Value>& args,
+                          size_t line, size_t column);
+
+/// @brief 按 lookup_field 的结果取实例字段槽位，未声明的字段抛 RuntimeError
+Value& instance_field(InstanceData& instance, const FieldTarget& target,
+                      std::string_view name, size_t line, size_t column);
+
+/// @brief 非实例值的 object.name 属性读取（元组字段/length、string/array 的 length）；
+/// 类实例字段由执行引擎经 lookup_field/instance_field 按槽位读取
+Value get_property(const Value& object, const std::string& name,
+                   size_t line, size_t column);
+
+/// @brief 统计 UTF-8 字符串的码点数（而非字节数）
+size_t utf8_length(const std::string& s);
+
+/// @brief 取 UTF-8 字符串第 i 个码点（前置：i < utf8_length(s)），返回单字符子串
+std::string utf8_char_at(const std::string& s, size_t i);
+
+/// @brief 取第 index 个码点的字节偏移（index >= 码点数时返回 s.size()）
+size_t utf8_byte_offset(const std::string& s, size_t index);
+
+}  // namespace runtime
+
+} // namespace collie
+
+#endif // COLLIE_INTERPRETER_RUNTIME_H
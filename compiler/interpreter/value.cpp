@@ -0,0 +1,152 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 运行期值的堆单元管理：字符串拼接与 rope 展平/释放、实例分配
+ */
+#include "value.h"
+
+#include <new>
+
+namespace collie {
+
+namespace {
+
+/// 结果短于此字节数的拼接直接复制为扁平串：rope 节点本身的开销抵不过小串复制
+constexpr size_t kRopeMinSize = 128;
+
+} // namespace
+
+Value Value::concat(Value left, const Value& right) {
+    StringData& l = left.unbox<StringData>();
+    const size_t total = l.size + right.string_size();
+
+    // 左侧独占且为扁平串：无人能观察到修改，直接追加（std::string 几何扩容，均摊 O(1)）
+    if (left.payload_.cell->refs == 1 && !l.is_rope()) {
+        append_to(l.flat, right);
+        l.size = total;
+        return left;
+    }
+
+    if (total < kRopeMinSize) {
+        std::string out;
+        out.reserve(total);
+        append_to(out, left);
+        append_to(out, right);
+        return str(std::move(out));
+    }
+
+    // 左侧是上一次拼接留下的 rope 节点、且其左子串已只被它持有（典型如 s = s + x 循环）：
+    // 先就地展平，窃取左子串缓冲区只追加右片段，使拼接链始终保持两层
+    if (l.is_rope() && l.left.payload_.cell->refs == 1 &&
+        !l.left.unbox<StringData>().is_rope()) {
+        flatten(l);
+    }
+
+    StringData node;
+    node.left = std::move(left);
+    node.right = right;
+    node.size = total;
+    Value v;
+    v.set_heap(Kind::String, new Boxed<StringData>(std::move(node)));
+    return v;
+}
+
+void Value::flatten(StringData& root) {
+    // 沿左脊下行到最左扁平叶，记录脊上节点，并检查整条左脊是否都只被上一层持有
+    std::vector<StringData*> spine;
+    StringData* leaf = &root;
+    bool unique = true;
+    while (leaf->is_rope()) {
+        spine.push_back(leaf);
+        unique = unique && leaf->left.payload_.cell->refs == 1;
+        leaf = &leaf->left.unbox<StringData>();
+    }
+
+    std::string out;
+    if (unique) {
+        // 最左叶只经由本节点可达，窃取其缓冲区；不按总长 reserve，保留几何扩容的均摊性
+        out = std::move(leaf->flat);
+    } else {
+        out.reserve(root.size);
+        out = leaf->flat;
+    }
+    for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+        append_to(out, (*it)->right);
+    }
+
+    root.flat = std::move(out);
+    root.left = Value();
+    root.right = Value();
+}
+
+void Value::append_to(std::string& out, const Value& v) {
+    const StringData& data = v.unbox<StringData>();
+    if (!data.is_rope()) {
+        out += data.flat;
+        return;
+    }
+    // 显式栈中序遍历：先压右子再压左子，左子先出栈
+    std::vector<const StringData*> stack{&data};
+    while (!stack.empty()) {
+        const StringData* node = stack.back();
+        stack.pop_back();
+        if (!node->is_rope()) {
+            out += node->flat;
+            continue;
+        }
+        stack.push_back(&node->right.unbox<StringData>());
+        stack.push_back(&node->left.unbox<StringData>());
+    }
+}
+
+void Value::destroy_string() {
+    auto* cell = static_cast<Boxed<StringData>*>(payload_.cell);
+    StringData& data = cell->value;
+    if (data.is_rope()) {
+        // 把即将归零的 rope 子节点先摘下子树再析构，析构时不再递归
+        std::vector<Value> pending;
+        pending.push_back(std::move(data.left));
+        pending.push_back(std::move(data.right));
+        while (!pending.empty()) {
+            Value v = std::move(pending.back());
+            pending.pop_back();
+            if (v.payload_.cell->refs == 1) {
+                StringData& child = v.unbox<StringData>();
+                if (child.is_rope()) {
+                    pending.push_back(std::move(child.left));
+                    pending.push_back(std::move(child.right));
+                }
+            }
+        }
+    }
+    delete cell;
+}
+
+Value Value::instance(const ClassStmt* klass, size_t field_count) {
+    // 实例头与字段槽位一次分配：[Boxed<InstanceData>][Value x field_count]
+    void* block = ::operator new(sizeof(Boxed<InstanceData>) + field_count * sizeof(Value));
+    InstanceData data;
+    data.klass = klass;
+    data.field_count = field_count;
+    auto* cell = new (block) Boxed<InstanceData>(data);
+    Value* fields = reinterpret_cast<Value*>(cell + 1);
+    for (size_t i = 0; i < field_count; ++i) {
+        new (fields + i) Value();
+    }
+    cell->value.fields = fields;
+    Value v;
+    v.set_heap(Kind::Instance, cell);
+    return v;
+}
+
+void Value::destroy_instance() {
+    auto* cell = static_cast<Boxed<InstanceData>*>(payload_.cell);
+    InstanceData& data = cell->value;
+    for (size_t i = 0; i < data.field_count; ++i) {
+        data.fields[i].~Value();
+    }
+    cell->~Boxed<InstanceData>();
+    ::operator delete(cell);
+}
+
+} // namespace collie
@@ -10,9 +10,8 @@
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
-#include <memory>
 #include <sstream>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "big_int.h"
@@ -22,22 +21,32 @@ namespace collie {
 // 前置声明（避免包含完整 ast.h）
 class FunctionStmt;
 class ClassStmt;
-struct InstanceData;  // 定义在 Value 之后（字段表持有 Value）
+struct InstanceData;  // 定义在 Value 之后（字段槽位持有 Value）
+struct StringData;    // 定义在 Value 之后（rope 节点持有子串 Value）
 
 /**
  * @brief 解释器运行期的值
  *
  * v1 支持九种值：none（空）、bool、tribool、number、string、function、array、tuple、instance。
- * 数组、元组与类实例为引用语义（shared_ptr 共享底层存储），赋值/传参共享同一对象；
+ * 数组、元组与类实例为引用语义（共享底层存储），赋值/传参共享同一对象；
  * 元组不可变（t45，经作者确认）。
- * number 内部双表示（t42，经作者确认的 Python 式设计）：整数值用 BigInt
- * 任意精度承载（自动扩容，无溢出），小数值用 double（IEEE 754）；
+ * number 内部双表示（t42，经作者确认的 Python 式设计）：整数值任意精度（自动扩容，
+ * 无溢出），小数值用 double（IEEE 754）；整数落在 int64 范围内时内联存放，
+ * 超出才升格为 BigInt（规范形式：能内联的整数一定内联）；
  * 静态类型 number 是 integer/decimal 的超类型，两种表示都算 is_number()。
  * tribool 为三态布尔（t43，经作者确认）：true/false/unset，与 bool 独立。
+ *
+ * 内存布局：16 字节标签联合体——8 字节标签（种类 + 表示标记）+ 8 字节载荷。
+ * bool/tribool/int64/double/函数指针直接内联；BigInt、字符串、数组、元组、实例
+ * 放在带侵入式引用计数的堆单元里，载荷只存一个指针。拷贝 = 16 字节 + 引用计数加一，
+ * 移动不触碰堆。字符串与 BigInt 堆单元只读共享，数组/实例的共享即引用语义。
+ *
+ * 字符串拼接（见 concat）：左操作数独占且为扁平串时就地追加（均摊 O(1)），
+ * 否则较长的结果建为 rope 节点，按内容访问（as_string）时才惰性展平。
  */
 class Value {
 public:
-    enum class Kind { None, Bool, Tribool, Number, String, Function, Array, Tuple, Instance };
+    enum class Kind : uint8_t { None, Bool, Tribool, Number, String, Function, Array, Tuple, Instance };
 
     /// tribool 的三态；数值编码满足 Kleene 逻辑 AND=min、OR=max
     enum class Tri : uint8_t { False = 0, Unset = 1, True = 2 };
@@ -50,49 +59,90 @@ public:
         std::vector<std::string> names;
     };
 
-    Value() : kind_(Kind::None) {}
+    Value() : kind_(Kind::None) { payload_.bits = 0; }
+    ~Value() { release(); }
+
+    Value(const Value& other)
+        : kind_(other.kind_), num_is_int_(other.num_is_int_), heap_(other.heap_),
+          payload_(other.payload_) {
+        if (heap_) ++payload_.cell->refs;
+    }
+    Value(Value&& other) noexcept
+        : kind_(other.kind_), num_is_int_(other.num_is_int_), heap_(other.heap_),
+          payload_(other.payload_) {
+        other.kind_ = Kind::None;
+        other.num_is_int_ = false;
+        other.heap_ = false;
+    }
+    // 先构造副本再交换：右侧可能正由本值持有（如 v = v.as_array()[0]），不能先释放
+    Value& operator=(const Value& other) {
+        Value copy(other);
+        swap(copy);
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        Value moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+    void swap(Value& other) noexcept {
+        std::swap(kind_, other.kind_);
+        std::swap(num_is_int_, other.num_is_int_);
+        std::swap(heap_, other.heap_);
+        std::swap(payload_, other.payload_);
+    }
 
     static Value none() { return Value(); }
     static Value boolean(bool b) {
-        Value v; v.kind_ = Kind::Bool; v.bool_ = b; return v;
+        Value v; v.kind_ = Kind::Bool; v.payload_.boolean = b; return v;
     }
     static Value tribool(Tri t) {
-        Value v; v.kind_ = Kind::Tribool; v.tri_ = t; return v;
+        Value v; v.kind_ = Kind::Tribool; v.payload_.tri = t; return v;
     }
     static Value number(double n) {
-        Value v; v.kind_ = Kind::Number; v.num_ = n; return v;
+        Value v; v.kind_ = Kind::Number; v.payload_.num = n; return v;
     }
-    /// 整数值（BigInt 任意精度承载；打印/精确算术走整数路径）
-    static Value integer(BigInt n) {
+    /// 整数值（int64 内联；打印/精确算术走整数路径）
+    static Value integer(int64_t n) {
         Value v;
         v.kind_ = Kind::Number;
         v.num_is_int_ = true;
-        v.big_ = std::move(n);
+        v.payload_.i64 = n;
         return v;
     }
-    static Value str(std::string s) {
-        Value v; v.kind_ = Kind::String; v.str_ = std::move(s); return v;
+    /// 整数值（任意精度；落在 int64 范围内时转为内联表示）
+    static Value integer(BigInt n) {
+        int64_t small;
+        if (n.to_int64(small)) {
+            return integer(small);
+        }
+        Value v;
+        v.num_is_int_ = true;
+        v.set_heap(Kind::Number, new Boxed<BigInt>(std::move(n)));
+        return v;
     }
+    static Value str(std::string s);
+    /**
+     * @brief 字符串拼接 left + right（两侧均须为字符串）
+     * left 独占（引用计数为 1）且为扁平串时直接在其缓冲区追加；
+     * 否则短结果复制为扁平串，长结果建 rope 节点（O(1)，不复制内容）。
+     */
+    static Value concat(Value left, const Value& right);
     static Value function(const FunctionStmt* fn) {
-        Value v; v.kind_ = Kind::Function; v.fn_ = fn; return v;
+        Value v; v.kind_ = Kind::Function; v.payload_.fn = fn; return v;
     }
     static Value array(ArrayStorage elements) {
-        Value v;
-        v.kind_ = Kind::Array;
-        v.arr_ = std::make_shared<ArrayStorage>(std::move(elements));
-        return v;
+        Value v; v.set_heap(Kind::Array, new Boxed<ArrayStorage>(std::move(elements))); return v;
     }
     static Value tuple(std::vector<Value> elements, std::vector<std::string> names) {
         Value v;
-        v.kind_ = Kind::Tuple;
-        v.tup_ = std::make_shared<TupleStorage>();
-        v.tup_->elements = std::move(elements);
-        v.tup_->names = std::move(names);
+        v.set_heap(Kind::Tuple, new Boxed<TupleStorage>(
+                                    TupleStorage{std::move(elements), std::move(names)}));
         return v;
     }
-    static Value instance(std::shared_ptr<InstanceData> data) {
-        Value v; v.kind_ = Kind::Instance; v.inst_ = std::move(data); return v;
-    }
+    /// 新建 klass 的实例：field_count 个字段槽位（初值 none，由调用方按字段布局初始化），
+    /// 与实例头分配在同一块内存
+    static Value instance(const ClassStmt* klass, size_t field_count);
 
     Kind kind() const { return kind_; }
     bool is_none() const { return kind_ == Kind::None; }
@@ -101,6 +151,8 @@ public:
     bool is_number() const { return kind_ == Kind::Number; }
     /// number 且内部为整数表示（integer 类型值）
     bool is_integer_value() const { return kind_ == Kind::Number && num_is_int_; }
+    /// 整数且内联为 int64（算术/比较的机器整数快速路径）
+    bool is_small_integer() const { return kind_ == Kind::Number && num_is_int_ && !heap_; }
     /// number 且内部为小数表示（decimal 类型值）
     bool is_decimal_value() const { return kind_ == Kind::Number && !num_is_int_; }
     bool is_string() const { return kind_ == Kind::String; }
@@ -109,20 +161,30 @@ public:
     bool is_tuple() const { return kind_ == Kind::Tuple; }
     bool is_instance() const { return kind_ == Kind::Instance; }
 
-    bool as_bool() const { return bool_; }
-    Tri as_tribool() const { return tri_; }
+    bool as_bool() const { return payload_.boolean; }
+    Tri as_tribool() const { return payload_.tri; }
     /// 数值的 double 视图：整数表示时转 double（超大整数有精度损失，
     /// 仅供混合算术/比较等小数路径使用；精确路径用 as_integer）
-    double as_number() const { return num_is_int_ ? big_.to_double() : num_; }
-    /// 整数表示的 BigInt（仅当 is_integer_value() 时有效）
-    const BigInt& as_integer() const { return big_; }
-    const std::string& as_string() const { return str_; }
-    const FunctionStmt* as_function() const { return fn_; }
-    ArrayStorage& as_array() { return *arr_; }
-    const ArrayStorage& as_array() const { return *arr_; }
-    const TupleStorage& as_tuple() const { return *tup_; }
-    InstanceData& as_instance() { return *inst_; }
-    const InstanceData& as_instance() const { return *inst_; }
+    double as_number() const {
+        if (!num_is_int_) return payload_.num;
+        return heap_ ? unbox<BigInt>().to_double() : static_cast<double>(payload_.i64);
+    }
+    /// 整数表示的 BigInt 视图（仅当 is_integer_value() 时有效；内联整数临时构造）
+    BigInt as_integer() const {
+        return heap_ ? unbox<BigInt>() : BigInt(payload_.i64);
+    }
+    /// 内联整数值（仅当 is_small_integer() 时有效）
+    int64_t as_small_integer() const { return payload_.i64; }
+    /// 字符串内容（rope 节点在此惰性展平，之后直接返回缓存）
+    const std::string& as_string() const;
+    /// 字符串字节数（不触发展平）
+    size_t string_size() const;
+    const FunctionStmt* as_function() const { return payload_.fn; }
+    ArrayStorage& as_array() { return unbox<ArrayStorage>(); }
+    const ArrayStorage& as_array() const { return unbox<ArrayStorage>(); }
+    const TupleStorage& as_tuple() const { return unbox<TupleStorage>(); }
+    InstanceData& as_instance();
+    const InstanceData& as_instance() const;
 
     /**
      * @brief 真值判断
@@ -133,13 +195,15 @@ public:
     bool is_truthy() const {
         switch (kind_) {
             case Kind::None:     return false;
-            case Kind::Bool:     return bool_;
-            case Kind::Tribool:  return tri_ == Tri::True;
-            case Kind::Number:   return num_is_int_ ? !big_.is_zero() : num_ != 0.0;
-            case Kind::String:   return !str_.empty();
+            case Kind::Bool:     return payload_.boolean;
+            case Kind::Tribool:  return payload_.tri == Tri::True;
+            case Kind::Number:
+                if (!num_is_int_) return payload_.num != 0.0;
+                return heap_ || payload_.i64 != 0;  // 升格为 BigInt 的整数必不为零
+            case Kind::String:   return string_size() != 0;
             case Kind::Function: return true;  // 函数值始终为真
-            case Kind::Array:    return arr_ && !arr_->empty();
-            case Kind::Tuple:    return tup_ && !tup_->elements.empty();
+            case Kind::Array:    return !as_array().empty();
+            case Kind::Tuple:    return !as_tuple().elements.empty();
             case Kind::Instance: return true;  // 类实例始终为真
         }
         return false;
@@ -152,30 +216,34 @@ public:
     std::string to_string() const {
         switch (kind_) {
             case Kind::None:     return "none";
-            case Kind::Bool:     return bool_ ? "true" : "false";
+            case Kind::Bool:     return payload_.boolean ? "true" : "false";
             case Kind::Tribool:
-                return tri_ == Tri::True ? "true" : (tri_ == Tri::False ? "false" : "unset");
-            case Kind::String:   return str_;
+                return payload_.tri == Tri::True ? "true"
+                     : (payload_.tri == Tri::False ? "false" : "unset");
+            case Kind::String:   return as_string();
             case Kind::Function: return "<function>";
             case Kind::Number: {
                 // 整数表示：BigInt 精确打印（任意位数不丢精度）
-                if (num_is_int_) return big_.to_string();
+                if (num_is_int_) {
+                    return heap_ ? unbox<BigInt>().to_string() : std::to_string(payload_.i64);
+                }
                 // 特殊数值按文档格式输出（见 04-numeric.md）：
                 // NaN / +Infinity / -Infinity
-                if (std::isnan(num_)) return "NaN";
-                if (std::isinf(num_)) return num_ > 0 ? "+Infinity" : "-Infinity";
-                if (num_ == std::floor(num_) && std::fabs(num_) < 1e15) {
-                    return std::to_string(static_cast<long long>(num_));
+                const double num = payload_.num;
+                if (std::isnan(num)) return "NaN";
+                if (std::isinf(num)) return num > 0 ? "+Infinity" : "-Infinity";
+                if (num == std::floor(num) && std::fabs(num) < 1e15) {
+                    return std::to_string(static_cast<long long>(num));
                 }
                 std::ostringstream oss;
-                oss << num_;
+                oss << num;
                 return oss.str();
             }
             case Kind::Array: {
                 // 元素递归转字符串，形如 [1, 2, 3]
                 std::string out = "[";
                 bool first = true;
-                for (const Value& element : *arr_) {
+                for (const Value& element : as_array()) {
                     if (!first) out += ", ";
                     out += element.to_string();
                     first = false;
@@ -185,13 +253,14 @@ public:
             }
             case Kind::Tuple: {
                 // 元素递归转字符串，命名字段带名字，形如 (1, 2) / (name: Alice)
+                const TupleStorage& tuple = as_tuple();
                 std::string out = "(";
-                for (size_t i = 0; i < tup_->elements.size(); ++i) {
+                for (size_t i = 0; i < tuple.elements.size(); ++i) {
                     if (i != 0) out += ", ";
-                    if (!tup_->names[i].empty()) {
-                        out += tup_->names[i] + ": ";
+                    if (!tuple.names[i].empty()) {
+                        out += tuple.names[i] + ": ";
                     }
-                    out += tup_->elements[i].to_string();
+                    out += tuple.elements[i].to_string();
                 }
                 out += ")";
                 return out;
@@ -217,27 +286,121 @@ public:
     }
 
 private:
+    /// 堆单元公共头：侵入式引用计数（解释器单线程执行，无需原子操作）
+    struct HeapCell {
+        uint32_t refs = 1;
+    };
+    template <typename T>
+    struct Boxed : HeapCell {
+        explicit Boxed(T v) : value(std::move(v)) {}
+        T value;
+    };
+
+    /// 8 字节载荷：按 kind_/heap_ 解释
+    union Payload {
+        bool boolean;
+        Tri tri;
+        double num;
+        int64_t i64;
+        const FunctionStmt* fn;
+        HeapCell* cell;
+        uint64_t bits;
+    };
+
+    void set_heap(Kind kind, HeapCell* cell) {
+        kind_ = kind;
+        heap_ = true;
+        payload_.cell = cell;
+    }
+
+    template <typename T>
+    T& unbox() const {
+        return static_cast<Boxed<T>*>(payload_.cell)->value;
+    }
+
+    /// 引用计数减一，归零时按种类析构堆单元
+    void release() {
+        if (heap_ && --payload_.cell->refs == 0) {
+            destroy();
+        }
+    }
+    void destroy();
+
+    /// 展平 rope 节点：左脊全部独占时窃取最左叶的缓冲区，只追加其余片段
+    static void flatten(StringData& root);
+    /// 把字符串 v 的完整内容追加到 out（显式栈遍历 rope，不展平、不递归）
+    static void append_to(std::string& out, const Value& v);
+    /// 释放字符串堆单元：rope 子树逐层摘下再析构，避免长拼接链递归析构爆栈
+    void destroy_string();
+    /// 释放实例堆单元：析构尾随的字段槽位后整块归还
+    void destroy_instance();
+
     Kind kind_;
-    bool bool_ = false;
-    Tri tri_ = Tri::Unset;     ///< tribool 三态（缺省 unset，见 draft.md）
-    bool num_is_int_ = false;  ///< number 的内部表示：true=BigInt 整数，false=double 小数
-    double num_ = 0.0;
-    BigInt big_;               ///< 整数表示（num_is_int_ 为 true 时有效）
-    std::string str_;
-    const FunctionStmt* fn_ = nullptr;
-    std::shared_ptr<ArrayStorage> arr_;  ///< 数组存储（引用语义，赋值共享）
-    std::shared_ptr<TupleStorage> tup_;  ///< 元组存储（引用语义；元组不可变）
-    std::shared_ptr<InstanceData> inst_; ///< 类实例存储（引用语义，赋值共享）
+    bool num_is_int_ = false;  ///< number 的内部表示：true=整数（int64 内联或 BigInt），false=double 小数
+    bool heap_ = false;        ///< 载荷是否为堆单元指针（需引用计数）
+    Payload payload_;
 };
 
+static_assert(sizeof(Value) == 16, "Value must stay a 16-byte tagged union");
+
 /**
- * @brief 类实例的底层存储：所属类的 AST 节点 + 字段表
+ * @brief 类实例的底层存储：所属类的 AST 节点 + 按类字段布局排列的字段槽位
+ *
+ * 槽位下标由 ClassRegistry::layout_of 给出（继承链 base-first 合并），
+ * 槽位数组紧随实例头分配在同一块内存里。
  */
 struct InstanceData {
-    const ClassStmt* klass = nullptr;               ///< 所属类声明节点
-    std::unordered_map<std::string, Value> fields;  ///< 字段名 -> 字段值
+    const ClassStmt* klass = nullptr;  ///< 所属类声明节点
+    Value* fields = nullptr;           ///< 字段槽位（指向同一内存块的尾部）
+    size_t field_count = 0;
 };
 
+/**
+ * @brief 字符串堆单元：扁平串，或 rope 拼接节点（left + right）
+ *
+ * rope 节点展平后内容写入 flat 并丢弃子节点；展平不改变串内容，
+ * 因此可以在被多个值共享的节点上进行。
+ */
+struct StringData {
+    std::string flat;  ///< 扁平内容（rope 节点展平前为空）
+    Value left;        ///< rope 左子串（扁平串为 none）
+    Value right;       ///< rope 右子串
+    size_t size = 0;   ///< 总字节数（rope 节点无需展平即可得知）
+
+    bool is_rope() const { return !left.is_none(); }
+};
+
+inline Value Value::str(std::string s) {
+    StringData data;
+    data.size = s.size();
+    data.flat = std::move(s);
+    Value v;
+    v.set_heap(Kind::String, new Boxed<StringData>(std::move(data)));
+    return v;
+}
+
+inline const std::string& Value::as_string() const {
+    StringData& data = unbox<StringData>();
+    if (data.is_rope()) flatten(data);
+    return data.flat;
+}
+
+inline size_t Value::string_size() const { return unbox<StringData>().size; }
+
+inline InstanceData& Value::as_instance() { return unbox<InstanceData>(); }
+inline const InstanceData& Value::as_instance() const { return unbox<InstanceData>(); }
+
+inline void Value::destroy() {
+    switch (kind_) {
+        case Kind::Number:   delete static_cast<Boxed<BigInt>*>(payload_.cell); break;
+        case Kind::String:   destroy_string(); break;
+        case Kind::Array:    delete static_cast<Boxed<ArrayStorage>*>(payload_.cell); break;
+        case Kind::Tuple:    delete static_cast<Boxed<TupleStorage>*>(payload_.cell); break;
+        case Kind::Instance: destroy_instance(); break;
+        default: break;
+    }
+}
+
 } // namespace collie
 
 #endif // COLLIE_INTERPRETER_VALUE_H
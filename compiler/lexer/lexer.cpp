@@ -7,11 +7,57 @@
 #include "utf_convert.h"
 #include <stdexcept>
 #include <algorithm>
+#include <cstdint>
 
 namespace collie {
 
+namespace {
+
+// 字节分类表：内联前导扫描用，与扫描内核的判定一致
+enum CharClass : uint8_t {
+    CC_WHITESPACE = 1 << 0,  // ' ' '\t' '\r' '\n'
+    CC_IDENTIFIER = 1 << 1,  // [A-Za-z0-9_]
+    CC_STRING = 1 << 2,      // 单行字符串中可整段跳过的字节
+};
+
+struct CharClassTable {
+    uint8_t flags[256] = {};
+    constexpr CharClassTable() {
+        for (int c = 0; c < 256; ++c) {
+            uint8_t f = 0;
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') f |= CC_WHITESPACE;
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                c == '_') {
+                f |= CC_IDENTIFIER;
+            }
+            if (c < 0x80 && c != '"' && c != '\\' && c != '\n') f |= CC_STRING;
+            flags[c] = f;
+        }
+    }
+};
+
+constexpr CharClassTable char_classes;
+
+/**
+ * @brief 跳过连续属于某类的字节
+ *
+ * 先内联检查至多 16 字节，段更长时才调用扫描内核：
+ * 代码中的空白与标识符大多很短，省去间接调用；注释、长字符串等长段由内核按块处理。
+ */
+const char* skip_class(const char* p, const char* end, uint8_t cls,
+                       const char* (*kernel)(const char*, const char*)) {
+    const char* limit = end - p > 16 ? p + 16 : end;
+    while (p < limit && (char_classes.flags[static_cast<unsigned char>(*p)] & cls)) {
+        ++p;
+    }
+    return (p == limit && p != end) ? kernel(p, end) : p;
+}
+
+} // namespace
+
 Lexer::Lexer(std::string_view source, Encoding encoding)
-    : source_(source), position_(0), line_(1), column_(1), encoding_(encoding) {
+    : source_(source), position_(0), line_(1), column_(1), scan_(&scan::kernels()),
+      encoding_(encoding) {
     if (encoding == Encoding::UTF16) {
         try {
             source_utf16_ = utf8_to_utf16(source);
@@ -106,8 +152,17 @@ Token Lexer::scan_identifier() {
     size_t start_pos = position_;
     size_t start_col = column_;
 
-    // 逐个 UTF-8 码点读取，支持中文等多字节标识符
+    const char* end = source_end();
     while (!is_at_end()) {
+        // ASCII 部分按块跳过
+        const char* run = cursor();
+        const char* stop = skip_class(run, end, CC_IDENTIFIER, scan_->skip_identifier);
+        advance_columns(static_cast<size_t>(stop - run));
+        if (stop == end || static_cast<unsigned char>(*stop) < 0x80) {
+            break;
+        }
+
+        // 非 ASCII：按 UTF-8 码点读取，支持中文等多字节标识符
         size_t cur_pos = position_;
         size_t cur_col = column_;
         char32_t cp;
@@ -125,7 +180,7 @@ Token Lexer::scan_identifier() {
         }
     }
 
-    std::string identifier = source_.substr(start_pos, position_ - start_pos);
+    std::string_view identifier = source_.substr(start_pos, position_ - start_pos);
     if (identifier.empty()) {
         // 起始码点不是合法标识符字符：消费它并报错，避免死循环
         try { nextUtf8Char(); } catch (const LexError&) { advance(); }
@@ -136,7 +191,19 @@ Token Lexer::scan_identifier() {
 }
 
 Token Lexer::next_token() {
-    skip_whitespace();
+    // 多数 token 紧跟在前一个之后或只隔一个空格，先在此判断以免进入完整的空白扫描
+    if (!is_at_end()) {
+        char first = source_[position_];
+        if (first == ' ' && position_ + 1 < source_.size() &&
+            !(char_classes.flags[static_cast<unsigned char>(source_[position_ + 1])] &
+              CC_WHITESPACE) &&
+            source_[position_ + 1] != '/') {
+            advance_columns(1);
+        } else if (char_classes.flags[static_cast<unsigned char>(first)] & CC_WHITESPACE ||
+                   first == '/') {
+            skip_whitespace();
+        }
+    }
 
     if (is_at_end()) {
         return Token(TokenType::END_OF_FILE, "", line_, column_);
@@ -169,18 +236,20 @@ Token Lexer::next_token() {
                      peek_next() == '_')) {
         size_t start_col = column_;
         advance(); // 消费 '@'
-        std::string name;
+        size_t name_start = position_;
         while (!is_at_end() &&
                (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '_')) {
-            name += advance();
+            advance();
         }
-        return Token(TokenType::ANNOTATION, name, line_, start_col);
+        return Token(TokenType::ANNOTATION, source_.substr(name_start, position_ - name_start),
+                     line_, start_col);
     }
     if (c == '\'') {
         return scan_character();
     }
 
-    c = advance();  // 消费单字符运算符/分隔符
+    // 消费单字符运算符/分隔符（空白已跳过，c 不会是换行）
+    advance_columns(1);
     switch (c) {
         // 单字符 token
         case '(': return Token(TokenType::DELIMITER_LPAREN, "(", line_, start_column);
@@ -248,32 +317,23 @@ Token Lexer::next_token() {
 }
 
 void Lexer::skip_whitespace() {
+    const char* end = source_end();
     while (!is_at_end()) {
-        char c = peek();
-        switch (c) {
-            case ' ':
-            case '\t':
-            case '\r':
-                advance();
-                break;
-            case '\n':
-                advance();
-                break;
-            case '/':  // 处理注释
-                if (peek_next() == '/') {
-                    advance(); // 消费第一个 '/'
-                    advance(); // 消费第二个 '/'
-                    skip_line_comment();
-                } else if (peek_next() == '*') {
-                    advance(); // 消费 '/'
-                    advance(); // 消费 '*'
-                    skip_block_comment();
-                } else {
-                    return;
-                }
-                break;
-            default:
-                return;
+        const char* run = cursor();
+        const char* stop = skip_class(run, end, CC_WHITESPACE, scan_->skip_whitespace);
+        advance_lines(static_cast<size_t>(stop - run));
+        if (stop == end || *stop != '/') {
+            return;
+        }
+        // 处理注释
+        if (peek_next() == '/') {
+            advance_columns(2); // 消费 "//"
+            skip_line_comment();
+        } else if (peek_next() == '*') {
+            advance_columns(2); // 消费 "/*"
+            skip_block_comment();
+        } else {
+            return;
         }
     }
 }
@@ -297,6 +357,8 @@ Token Lexer::peek_token() {
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    // 按常见代码密度（平均每 token 约 6 字节）预留，避免大文件反复扩容搬移
+    tokens.reserve((source_.size() - position_) / 6 + 1);
     while (true) {
         Token token = next_token();
         tokens.push_back(token);
@@ -334,9 +396,41 @@ bool Lexer::is_at_end() const {
     return position_ >= source_.length();
 }
 
+void Lexer::advance_columns(size_t count) {
+    position_ += count;
+    column_ += count;
+}
+
+void Lexer::advance_lines(size_t count) {
+    const char* begin = cursor();
+    const char* end = begin + count;
+    // 空白段通常很短，直接逐字节处理；长段（如块注释）交给内核统计换行
+    size_t newlines = 0;
+    if (count < 32) {
+        for (const char* p = begin; p < end; ++p) {
+            newlines += *p == '\n';
+        }
+    } else {
+        newlines = scan_->count_newlines(begin, end);
+    }
+
+    if (newlines == 0) {
+        column_ += count;
+    } else {
+        const char* line_start = end;
+        while (line_start[-1] != '\n') {
+            --line_start;
+        }
+        line_ += newlines;
+        column_ = 1 + static_cast<size_t>(end - line_start);
+    }
+    position_ += count;
+}
+
 bool Lexer::match(char expected) {
-    if (is_at_end() || peek() != expected) return false;
-    advance();
+    // 只用于匹配运算符的后续字符，不会是换行
+    if (is_at_end() || source_[position_] != expected) return false;
+    advance_columns(1);
     return true;
 }
 
@@ -353,26 +447,33 @@ bool Lexer::is_alphanumeric(char c) const {
 }
 
 Token Lexer::make_error_token(const std::string& message) {
-    return Token(TokenType::INVALID, message, line_, column_);
+    return Token(TokenType::INVALID, pool_.intern(message), line_, column_);
 }
 
 void Lexer::skip_line_comment() {
-    while (!is_at_end() && peek() != '\n') {
-        advance();
-    }
+    const char* run = cursor();
+    advance_columns(static_cast<size_t>(scan_->find_newline(run, source_end()) - run));
 }
 
 void Lexer::skip_block_comment() {
+    const char* end = source_end();
     int nesting = 1;
     while (!is_at_end() && nesting > 0) {
+        // 只在 '*' 与 '/' 处停下判断嵌套，其间的字节整段跳过
+        const char* run = cursor();
+        const char* stop = scan_->find_comment_special(run, end);
+        advance_lines(static_cast<size_t>(stop - run));
+        if (stop == end) {
+            break;
+        }
         if (peek() == '/' && peek_next() == '*') {
-            advance(); advance();
+            advance_columns(2);
             nesting++;
         } else if (peek() == '*' && peek_next() == '/') {
-            advance(); advance();
+            advance_columns(2);
             nesting--;
         } else {
-            advance();
+            advance_columns(1);
         }
     }
 }
@@ -398,8 +499,7 @@ Token Lexer::scan_number() {
         while (!is_at_end() && is_hex_digit(peek())) {
             advance();
         }
-        std::string_view hex = std::string_view(source_).substr(
-            start_pos, position_ - start_pos);
+        std::string_view hex = source_.substr(start_pos, position_ - start_pos);
         return Token(TokenType::LITERAL_NUMBER, hex, line_, start_col);
     }
 
@@ -447,7 +547,7 @@ Token Lexer::scan_number() {
     }
     size_t end_pos = position_;
 
-    std::string_view number = std::string_view(source_).substr(start_pos, end_pos - start_pos);
+    std::string_view number = source_.substr(start_pos, end_pos - start_pos);
     return Token(TokenType::LITERAL_NUMBER, number, line_, start_col);
 }
 
@@ -470,25 +570,44 @@ Token Lexer::scan_string() {
     }
 
     if (is_multiline) {
-        // 逐行收集原始内容，直到结束的三引号
-        std::vector<std::string> lines;
-        std::string current;
+        // 只定位内容范围并校验缩进，去缩进后的文本由 decode_lexeme 按需还原
+        size_t content_start = position_;
+        size_t line_start = position_;
+        size_t base_indent = 0;
+        bool first_line = true;
         bool closed = false;
 
+        const char* end = source_end();
         while (!is_at_end()) {
+            // 引号与换行之间的字节整段跳过
+            const char* run = cursor();
+            const char* stop = scan_->find_multiline_special(run, end);
+            advance_columns(static_cast<size_t>(stop - run));
+            if (stop == end) {
+                break;
+            }
             if (peek() == '"' && peek_next() == '"' &&
                 position_ + 2 < source_.length() && source_[position_ + 2] == '"') {
-                advance(); advance(); advance(); // 消费结束的三引号
                 closed = true;
                 break;
             }
-            char c = peek();
-            if (c == '\n') {
-                lines.push_back(current);
-                current.clear();
+            if (peek() == '\n') {
+                // 一行结束：以首行缩进为基准，非空行的缩进不得小于它
+                std::string_view line = source_.substr(line_start, position_ - line_start);
+                size_t indent = 0;
+                while (indent < line.size() && (line[indent] == ' ' || line[indent] == '\t')) {
+                    ++indent;
+                }
+                if (first_line) {
+                    base_indent = indent;
+                    first_line = false;
+                } else if (indent != line.size() && indent < base_indent) {
+                    return make_error_token("Invalid indentation in multiline string");
+                }
                 advance();
+                line_start = position_;
             } else {
-                current += advance();
+                advance();
             }
         }
 
@@ -496,51 +615,37 @@ Token Lexer::scan_string() {
             return make_error_token("Unterminated multiline string");
         }
 
-        // 以首行缩进为基准，去除每行的公共前导缩进
-        auto leading_ws = [](const std::string& s) {
-            size_t n = 0;
-            while (n < s.size() && (s[n] == ' ' || s[n] == '\t')) ++n;
-            return n;
-        };
-
-        size_t base_indent = lines.empty() ? 0 : leading_ws(lines[0]);
-        std::string value;
-        for (const std::string& ln : lines) {
-            size_t indent = leading_ws(ln);
-            bool blank = (indent == ln.size());
-            if (!blank && indent < base_indent) {
-                return make_error_token("Invalid indentation in multiline string");
-            }
-            size_t strip = std::min(base_indent, ln.size());
-            value += ln.substr(strip);
-            value += '\n';
-        }
-
-        return Token(TokenType::LITERAL_STRING, value, line_, start_col);
+        std::string_view content = source_.substr(content_start, position_ - content_start);
+        advance(); advance(); advance(); // 消费结束的三引号
+        return Token(TokenType::LITERAL_STRING, content, line_, start_col, LexemeForm::Indented);
     }
 
-    // 单行字符串
-    std::string value;
-    while (!is_at_end() && peek() != '"') {
-        char c = peek();
+    // 单行字符串：lexeme 为引号内原文，含转义时由 decode_lexeme 按需解码
+    size_t content_start = position_;
+    bool escaped = false;
+    const char* end = source_end();
+    while (!is_at_end()) {
+        // 普通 ASCII 字节整段跳过，只在引号、转义、换行与非 ASCII 处停下
+        const char* run = cursor();
+        const char* stop = skip_class(run, end, CC_STRING, scan_->find_string_special);
+        advance_columns(static_cast<size_t>(stop - run));
+        if (stop == end || *stop == '"') {
+            break;
+        }
+        char c = *stop;
         if (c == '\\') {
             advance();
             switch (peek()) {
-                case '"': value += '"'; break;
-                case '\\': value += '\\'; break;
-                case 'n': value += '\n'; break;
-                case 't': value += '\t'; break;
-                case 'r': value += '\r'; break;
+                case '"': case '\\': case 'n': case 't': case 'r': break;
                 default: return make_error_token("Invalid escape sequence");
             }
             advance();
+            escaped = true;
         } else if (static_cast<unsigned char>(c) >= 0x80) {
-            // 校验并原样保留一个完整的 UTF-8 码点（非法序列会抛 LexError）
-            size_t cp_start = position_;
+            // 校验一个完整的 UTF-8 码点（非法序列会抛 LexError）
             nextUtf8Char();
-            value.append(source_.substr(cp_start, position_ - cp_start));
         } else {
-            value += advance();
+            advance();
         }
     }
 
@@ -548,8 +653,10 @@ Token Lexer::scan_string() {
         return make_error_token("Unterminated string");
     }
 
+    std::string_view content = source_.substr(content_start, position_ - content_start);
     advance(); // 消费结束的引号
-    return Token(TokenType::LITERAL_STRING, value, line_, start_col);
+    return Token(TokenType::LITERAL_STRING, content, line_, start_col,
+                 escaped ? LexemeForm::Escaped : LexemeForm::Exact);
 }
 
 Token Lexer::scan_interpolated_string() {
@@ -560,7 +667,7 @@ Token Lexer::scan_interpolated_string() {
     advance(); // 消费 '@'
     advance(); // 消费开始的引号
 
-    std::string raw;
+    size_t raw_start = position_;
     while (!is_at_end() && peek() != '"') {
         char c = peek();
         if (c == '\n') {
@@ -568,16 +675,14 @@ Token Lexer::scan_interpolated_string() {
         }
         if (c == '\\') {
             // 转义序列原样保留两个字符，合法性由 parser 解码时校验
-            raw += advance();
+            advance();
             if (is_at_end()) break;
-            raw += advance();
+            advance();
         } else if (static_cast<unsigned char>(c) >= 0x80) {
-            // 校验并原样保留一个完整的 UTF-8 码点（非法序列会抛 LexError）
-            size_t cp_start = position_;
+            // 校验一个完整的 UTF-8 码点（非法序列会抛 LexError）
             nextUtf8Char();
-            raw.append(source_.substr(cp_start, position_ - cp_start));
         } else {
-            raw += advance();
+            advance();
         }
     }
 
@@ -585,6 +690,7 @@ Token Lexer::scan_interpolated_string() {
         return make_error_token("Unterminated interpolated string");
     }
 
+    std::string_view raw = source_.substr(raw_start, position_ - raw_start);
     advance(); // 消费结束的引号
     return Token(TokenType::LITERAL_INTERPOLATED_STRING, raw, line_, start_col);
 }
@@ -598,33 +704,30 @@ Token Lexer::scan_character() {
         return make_error_token("Unterminated character literal");
     }
 
-    std::string value;
+    size_t value_start = position_;
+    LexemeForm form = LexemeForm::Exact;
     bool multibyte = false;
 
     if (peek() == '\\') {
         advance();
         switch (peek()) {
-            case '\'': value = "'"; break;
-            case '\\': value = "\\"; break;
-            case 'n': value = "\n"; break;
-            case 't': value = "\t"; break;
-            case 'r': value = "\r"; break;
+            case '\'': case '\\': case 'n': case 't': case 'r': break;
             default: return make_error_token("Invalid escape sequence");
         }
         advance();
+        form = LexemeForm::Escaped;
     } else if (static_cast<unsigned char>(peek()) >= 0x80) {
         // 非 ASCII：按一个完整 UTF-8 码点读取（存为 UTF-8 字节）
-        size_t cp_start = position_;
         try {
             nextUtf8Char();
         } catch (const LexError&) {
             return make_error_token("Invalid character literal");
         }
-        value = source_.substr(cp_start, position_ - cp_start);
         multibyte = true;
     } else {
-        value = std::string(1, advance());
+        advance();
     }
+    std::string_view value = source_.substr(value_start, position_ - value_start);
 
     if (peek() != '\'') {
         return make_error_token("Unterminated character literal");
@@ -632,7 +735,7 @@ Token Lexer::scan_character() {
     advance(); // 消费结束的单引号
 
     TokenType type = multibyte ? TokenType::LITERAL_CHARACTER : TokenType::LITERAL_CHAR;
-    return Token(type, value, line_, start_col);
+    return Token(type, value, line_, start_col, form);
 }
 
 char16_t Lexer::peek_utf16() const {
@@ -719,7 +822,7 @@ Token Lexer::scan_utf16_character() {
         return make_error_token("Invalid UTF-16 sequence");
     }
 
-    return Token(TokenType::LITERAL_CHARACTER, utf8_value, line_, start_col);
+    return Token(TokenType::LITERAL_CHARACTER, pool_.intern(utf8_value), line_, start_col);
 }
 
 std::string utf16_to_utf8(const std::u16string& utf16str) {
@@ -744,7 +847,7 @@ Token Lexer::handle_number_state() {
 
     number = source_.substr(start_pos, position_ - start_pos);
     current_state_ = State::START;
-    return Token(TokenType::LITERAL_NUMBER, number, line_, start_col);
+    return Token(TokenType::LITERAL_NUMBER, pool_.intern(number), line_, start_col);
 }
 
 /**
@@ -787,7 +890,7 @@ Token Lexer::handle_identifier_state() {
 
     current_state_ = State::START;
     TokenType type = get_identifier_type(identifier);
-    return Token(type, identifier, line_, start_col);
+    return Token(type, pool_.intern(identifier), line_, start_col);
 }
 
 /**
@@ -826,7 +929,7 @@ Token Lexer::handle_string_state() {
 
     advance(); // 消费结束的引号
     current_state_ = State::START;
-    return Token(TokenType::LITERAL_STRING, value, line_, start_col);
+    return Token(TokenType::LITERAL_STRING, pool_.intern(value), line_, start_col);
 }
 
 /**
@@ -840,7 +943,8 @@ Token Lexer::handle_multiline_string_state() {
     size_t indent = column_ - 1;
 
     while (!is_at_end()) {
-        if (peek() == '"' && peek_next() == '"' && source_[position_ + 2] == '"') {
+        if (peek() == '"' && peek_next() == '"' &&
+            position_ + 2 < source_.length() && source_[position_ + 2] == '"') {
             // 检查结束引号的缩进
             size_t current_indent = 0;
             size_t pos = position_;
@@ -865,7 +969,7 @@ Token Lexer::handle_multiline_string_state() {
     }
 
     current_state_ = State::START;
-    return Token(TokenType::LITERAL_STRING, value, line_, start_col);
+    return Token(TokenType::LITERAL_STRING, pool_.intern(value), line_, start_col);
 }
 
 /**
@@ -13,6 +13,9 @@
 #include <vector>
 #include <stdexcept>
 #include "token.h"
+#include "string_pool.h"
+#include "source_file.h"
+#include "scan_kernels.h"
 
 namespace collie {
 
@@ -47,11 +50,22 @@ class Lexer {
 public:
     /**
      * @brief 构造词法分析器
-     * @param source 源代码字符串
+     * @param source 源代码文本；不复制，token 词素直接指向它，
+     *        因此 source 必须比 Lexer 产出的所有 token 活得久
      * @param encoding 源代码编码类型，默认为 UTF8
      */
     explicit Lexer(std::string_view source, Encoding encoding = Encoding::UTF8);
 
+    /// @brief 扫描源文件（token 词素为 file.text() 的切片）
+    explicit Lexer(const SourceFile& file, Encoding encoding = Encoding::UTF8)
+        : Lexer(file.text(), encoding) {}
+
+    explicit Lexer(const char* source, Encoding encoding = Encoding::UTF8)
+        : Lexer(std::string_view(source), encoding) {}
+
+    // 传入临时字符串会使 token 词素立即悬空
+    explicit Lexer(std::string&& source, Encoding encoding = Encoding::UTF8) = delete;
+
     // 获取下一个 token
     Token next_token();
 
@@ -67,10 +81,12 @@ public:
 
 private:
     // 源代码相关
-    std::string source_;          // 源代码
+    std::string_view source_;     // 源代码（调用方持有）
     size_t position_;             // 当前位置
     size_t line_;                 // 当前行号
     size_t column_;               // 当前列号
+    StringPool pool_;             // 不在源码中的词素（错误信息、UTF-16 字符）的存储
+    const scan::ScanKernels* scan_; // 批量扫描内核（构造时按 CPU 选定）
 
     // 辅助方法
     char peek() const;           // 预览当前字符
@@ -78,6 +94,12 @@ private:
     char advance();              // 移动到下一个字符并返回当前字符
     bool is_at_end() const;      // 是否到达源码末尾
 
+    // 批量前进：行列号规则与逐个 advance() 相同（每字节一列，换行后回到第 1 列）
+    const char* cursor() const { return source_.data() + position_; }
+    const char* source_end() const { return source_.data() + source_.size(); }
+    void advance_columns(size_t count);  // 跳过 count 个不含换行的字节
+    void advance_lines(size_t count);    // 跳过 count 个字节（可含换行）
+
     // Token 解析方法
     Token scan_token();          // 扫描下一个 token
     Token scan_identifier();     // 扫描标识符
@@ -166,7 +188,7 @@ private:
      * @return 创建的 token
      */
     Token make_token(TokenType type, const std::string& lexeme) {
-        return Token(type, lexeme, line_, column_);
+        return Token(type, pool_.intern(lexeme), line_, column_);
     }
 };
 
@@ -0,0 +1,328 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词法扫描内核实现：标量与 SSE2 版本，以及运行期指令集选择
+ */
+#include "scan_kernels.h"
+
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLLIE_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 版本的尾部依赖 SSE2 版本
+#if defined(COLLIE_SCAN_AVX2) && !defined(COLLIE_SCAN_SSE2)
+#undef COLLIE_SCAN_AVX2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace collie {
+namespace scan {
+
+#ifdef COLLIE_SCAN_AVX2
+// AVX2 内核（scan_kernels_avx2.cpp，单独以 AVX2 编译）：只处理完整的 32 字节块，
+// 返回第一个命中字节，或剩余不足一块时的位置，由 SSE2/标量版本收尾
+namespace avx2 {
+const char* skip_whitespace(const char* p, const char* end);
+const char* skip_identifier(const char* p, const char* end);
+const char* find_string_special(const char* p, const char* end);
+const char* find_multiline_special(const char* p, const char* end);
+const char* find_comment_special(const char* p, const char* end);
+const char* find_newline(const char* p, const char* end);
+size_t count_newlines(const char*& p, const char* end);
+} // namespace avx2
+#endif
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// 标量版本：也负责 SIMD 版本剩余不足一块的尾部
+// -----------------------------------------------------------------------------
+
+bool is_whitespace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool is_identifier(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_';
+}
+
+template <typename Stop>
+const char* scalar_find(const char* p, const char* end, Stop stop) {
+    while (p < end && !stop(static_cast<unsigned char>(*p))) {
+        ++p;
+    }
+    return p;
+}
+
+const char* scalar_skip_whitespace(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) { return !is_whitespace(c); });
+}
+
+const char* scalar_skip_identifier(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) { return !is_identifier(c); });
+}
+
+const char* scalar_find_string_special(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) {
+        return c == '"' || c == '\\' || c == '\n' || c >= 0x80;
+    });
+}
+
+const char* scalar_find_multiline_special(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) { return c == '"' || c == '\n'; });
+}
+
+const char* scalar_find_comment_special(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) { return c == '*' || c == '/'; });
+}
+
+const char* scalar_find_newline(const char* p, const char* end) {
+    return scalar_find(p, end, [](unsigned char c) { return c == '\n'; });
+}
+
+size_t scalar_count_newlines(const char* p, const char* end) {
+    size_t count = 0;
+    for (; p < end; ++p) {
+        count += *p == '\n';
+    }
+    return count;
+}
+
+const ScanKernels scalar_kernels = {
+    scalar_skip_whitespace,
+    scalar_skip_identifier,
+    scalar_find_string_special,
+    scalar_find_multiline_special,
+    scalar_find_comment_special,
+    scalar_find_newline,
+    scalar_count_newlines,
+};
+
+#ifdef COLLIE_SCAN_SSE2
+// -----------------------------------------------------------------------------
+// SSE2 版本：每块 16 字节，把命中条件做成位掩码后取最低位
+// -----------------------------------------------------------------------------
+
+unsigned first_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/**
+ * @brief 按 16 字节块查找第一个命中字节
+ * @param hits 由一块数据计算命中掩码（第 i 位对应第 i 个字节）
+ * @param tail 不足一块的尾部使用的标量版本
+ */
+template <typename Hits>
+const char* sse2_find(const char* p, const char* end, Hits hits,
+                      const char* (*tail)(const char*, const char*)) {
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = hits(block);
+        if (mask != 0) {
+            return p + first_bit(mask);
+        }
+        p += 16;
+    }
+    return tail(p, end);
+}
+
+unsigned eq_mask(__m128i block, char c) {
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+}
+
+// 有符号比较下 lo <= c <= hi（非 ASCII 字节为负数，恒不在 ASCII 区间内）
+__m128i in_range(__m128i block, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+const char* sse2_skip_whitespace(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) {
+        unsigned ws = eq_mask(b, ' ') | eq_mask(b, '\t') | eq_mask(b, '\r') | eq_mask(b, '\n');
+        return ~ws & 0xFFFFu;
+    }, scalar_skip_whitespace);
+}
+
+const char* sse2_skip_identifier(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) {
+        // 或上 0x20 把大写字母折叠为小写，再与数字、下划线合并
+        __m128i lower = _mm_or_si128(b, _mm_set1_epi8(0x20));
+        __m128i ident = _mm_or_si128(
+            _mm_or_si128(in_range(lower, 'a', 'z'), in_range(b, '0', '9')),
+            _mm_cmpeq_epi8(b, _mm_set1_epi8('_')));
+        return ~static_cast<unsigned>(_mm_movemask_epi8(ident)) & 0xFFFFu;
+    }, scalar_skip_identifier);
+}
+
+const char* sse2_find_string_special(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) {
+        // 最高位即非 ASCII，movemask 直接取出
+        return eq_mask(b, '"') | eq_mask(b, '\\') | eq_mask(b, '\n') |
+               static_cast<unsigned>(_mm_movemask_epi8(b));
+    }, scalar_find_string_special);
+}
+
+const char* sse2_find_multiline_special(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) { return eq_mask(b, '"') | eq_mask(b, '\n'); },
+                     scalar_find_multiline_special);
+}
+
+const char* sse2_find_comment_special(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) { return eq_mask(b, '*') | eq_mask(b, '/'); },
+                     scalar_find_comment_special);
+}
+
+const char* sse2_find_newline(const char* p, const char* end) {
+    return sse2_find(p, end, [](__m128i b) { return eq_mask(b, '\n'); }, scalar_find_newline);
+}
+
+size_t sse2_count_newlines(const char* p, const char* end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    while (end - p >= 16) {
+        // 每个字节位累加命中次数（cmpeq 为 -1，相减即 +1），最多 255 块后用 SAD 横向求和
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < 255 && end - p >= 16; ++i, p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(block, newline));
+        }
+        __m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) +
+                 static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    }
+    return count + scalar_count_newlines(p, end);
+}
+
+const ScanKernels sse2_kernels = {
+    sse2_skip_whitespace,
+    sse2_skip_identifier,
+    sse2_find_string_special,
+    sse2_find_multiline_special,
+    sse2_find_comment_special,
+    sse2_find_newline,
+    sse2_count_newlines,
+};
+#endif // COLLIE_SCAN_SSE2
+
+#ifdef COLLIE_SCAN_AVX2
+// AVX2 内核处理整块，剩余部分交给 SSE2 版本
+const ScanKernels avx2_kernels = {
+    [](const char* p, const char* end) {
+        return sse2_skip_whitespace(avx2::skip_whitespace(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        return sse2_skip_identifier(avx2::skip_identifier(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        return sse2_find_string_special(avx2::find_string_special(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        return sse2_find_multiline_special(avx2::find_multiline_special(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        return sse2_find_comment_special(avx2::find_comment_special(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        return sse2_find_newline(avx2::find_newline(p, end), end);
+    },
+    [](const char* p, const char* end) {
+        size_t count = avx2::count_newlines(p, end);
+        return count + sse2_count_newlines(p, end);
+    },
+};
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    // CPUID.7.EBX[5] 为 AVX2；还需操作系统保存 YMM 状态（OSXSAVE 且 XCR0 的 bit 1、2 置位）
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // COLLIE_SCAN_AVX2
+
+const ScanKernels& table_for(ScanLevel level) {
+    switch (level) {
+#ifdef COLLIE_SCAN_AVX2
+        case ScanLevel::AVX2: return avx2_kernels;
+#endif
+#ifdef COLLIE_SCAN_SSE2
+        case ScanLevel::SSE2: return sse2_kernels;
+#endif
+        default: return scalar_kernels;
+    }
+}
+
+struct Active {
+    ScanLevel level;
+    const ScanKernels* table;
+};
+
+Active& active() {
+    static Active current = {best_level(), &table_for(best_level())};
+    return current;
+}
+
+} // namespace
+
+const ScanKernels& kernels() {
+    return *active().table;
+}
+
+ScanLevel level() {
+    return active().level;
+}
+
+ScanLevel best_level() {
+#ifdef COLLIE_SCAN_AVX2
+    static const bool avx2 = cpu_has_avx2();
+    if (avx2) return ScanLevel::AVX2;
+#endif
+#ifdef COLLIE_SCAN_SSE2
+    return ScanLevel::SSE2;
+#else
+    return ScanLevel::Scalar;
+#endif
+}
+
+ScanLevel set_level(ScanLevel level) {
+    ScanLevel best = best_level();
+    if (static_cast<int>(level) > static_cast<int>(best)) {
+        level = best;
+    }
+    active() = {level, &table_for(level)};
+    return level;
+}
+
+const char* level_name(ScanLevel level) {
+    switch (level) {
+        case ScanLevel::AVX2: return "avx2";
+        case ScanLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+} // namespace scan
+} // namespace collie
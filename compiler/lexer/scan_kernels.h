@@ -0,0 +1,69 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词法扫描内核：按块分类字节，供 Lexer 批量跳过空白、标识符、字符串与注释
+ */
+#ifndef COLLIE_SCAN_KERNELS_H
+#define COLLIE_SCAN_KERNELS_H
+
+#include <cstddef>
+
+namespace collie {
+namespace scan {
+
+/**
+ * @brief 扫描内核使用的指令集
+ *
+ * 启动时按 CPU 支持情况选择最高可用级别；非 x86 平台只有 Scalar。
+ */
+enum class ScanLevel {
+    Scalar,  // 逐字节
+    SSE2,    // 每次 16 字节
+    AVX2     // 每次 32 字节
+};
+
+/**
+ * @brief 一组扫描内核
+ *
+ * 所有 find/skip 内核都在 [p, end) 中查找第一个满足条件的字节，找不到时返回 end；
+ * 内核只做字节分类，行列号由调用方根据跳过的字节更新。
+ */
+struct ScanKernels {
+    /// @brief 第一个不是空白（' ' '\t' '\r' '\n'）的字节
+    const char* (*skip_whitespace)(const char* p, const char* end);
+    /// @brief 第一个不是 ASCII 标识符字符（[A-Za-z0-9_]）的字节
+    const char* (*skip_identifier)(const char* p, const char* end);
+    /// @brief 单行字符串中第一个需要单独处理的字节：'"'、'\\'、'\n' 或非 ASCII
+    const char* (*find_string_special)(const char* p, const char* end);
+    /// @brief 多行字符串中第一个 '"' 或 '\n'
+    const char* (*find_multiline_special)(const char* p, const char* end);
+    /// @brief 块注释中第一个 '*' 或 '/'
+    const char* (*find_comment_special)(const char* p, const char* end);
+    /// @brief 第一个 '\n'
+    const char* (*find_newline)(const char* p, const char* end);
+    /// @brief [p, end) 中 '\n' 的个数
+    size_t (*count_newlines)(const char* p, const char* end);
+};
+
+/// @brief 当前选用的内核
+const ScanKernels& kernels();
+
+/// @brief 当前选用的指令集级别
+ScanLevel level();
+
+/// @brief CPU 支持的最高级别
+ScanLevel best_level();
+
+/**
+ * @brief 指定内核级别（供基准与测试对比各实现）
+ * @return 实际生效的级别：超出 CPU 支持时降为 best_level()
+ */
+ScanLevel set_level(ScanLevel level);
+
+/// @brief 级别名称（"scalar" / "sse2" / "avx2"）
+const char* level_name(ScanLevel level);
+
+} // namespace scan
+} // namespace collie
+
+#endif // COLLIE_SCAN_KERNELS_H
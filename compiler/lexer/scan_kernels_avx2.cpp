@@ -0,0 +1,114 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词法扫描内核的 AVX2 版本（本文件单独以 AVX2 指令集编译，只在运行期检测到 AVX2 时调用）
+ *
+ * 只处理完整的 32 字节块：返回第一个命中字节，或剩余不足一块时的位置，
+ * 尾部由 scan_kernels.cpp 中的 SSE2/标量版本处理。辅助函数全部位于匿名命名空间，
+ * 避免以 AVX2 编译的内联函数被链接器合并到其他翻译单元。
+ */
+#include <cstddef>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace collie {
+namespace scan {
+namespace avx2 {
+
+namespace {
+
+unsigned first_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+template <typename Hits>
+const char* find_blocks(const char* p, const char* end, Hits hits) {
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = hits(block);
+        if (mask != 0) {
+            return p + first_bit(mask);
+        }
+        p += 32;
+    }
+    return p;
+}
+
+unsigned eq_mask(__m256i block, char c) {
+    return static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c))));
+}
+
+// 有符号比较下 lo <= c <= hi（非 ASCII 字节为负数，恒不在 ASCII 区间内）
+__m256i in_range(__m256i block, char lo, char hi) {
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(block, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), block));
+}
+
+} // namespace
+
+const char* skip_whitespace(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) {
+        return ~(eq_mask(b, ' ') | eq_mask(b, '\t') | eq_mask(b, '\r') | eq_mask(b, '\n'));
+    });
+}
+
+const char* skip_identifier(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) {
+        __m256i lower = _mm256_or_si256(b, _mm256_set1_epi8(0x20));
+        __m256i ident = _mm256_or_si256(
+            _mm256_or_si256(in_range(lower, 'a', 'z'), in_range(b, '0', '9')),
+            _mm256_cmpeq_epi8(b, _mm256_set1_epi8('_')));
+        return ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+    });
+}
+
+const char* find_string_special(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) {
+        return eq_mask(b, '"') | eq_mask(b, '\\') | eq_mask(b, '\n') |
+               static_cast<unsigned>(_mm256_movemask_epi8(b));
+    });
+}
+
+const char* find_multiline_special(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) { return eq_mask(b, '"') | eq_mask(b, '\n'); });
+}
+
+const char* find_comment_special(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) { return eq_mask(b, '*') | eq_mask(b, '/'); });
+}
+
+const char* find_newline(const char* p, const char* end) {
+    return find_blocks(p, end, [](__m256i b) { return eq_mask(b, '\n'); });
+}
+
+size_t count_newlines(const char*& p, const char* end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    while (end - p >= 32) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int i = 0; i < 255 && end - p >= 32; ++i, p += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(block, newline));
+        }
+        __m256i sums = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+        count += static_cast<size_t>(_mm256_extract_epi64(sums, 0)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 1)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 2)) +
+                 static_cast<size_t>(_mm256_extract_epi64(sums, 3));
+    }
+    return count;
+}
+
+} // namespace avx2
+} // namespace scan
+} // namespace collie
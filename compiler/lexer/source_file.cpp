@@ -0,0 +1,182 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 源文件实现
+ */
+#include "source_file.h"
+
+#include <cstdint>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace collie {
+
+namespace {
+
+/// @brief 路径指向的对象类别
+enum class PathKind { Missing, Regular, Other };
+
+/**
+ * @brief 查询路径类别：不存在（或无法查询）/ 普通文件 / 目录、设备、管道等其他对象
+ */
+PathKind path_kind(const std::string& path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES) {
+        return PathKind::Missing;
+    }
+    if (attributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE)) {
+        return PathKind::Other;
+    }
+    return PathKind::Regular;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return PathKind::Missing;
+    }
+    return S_ISREG(info.st_mode) ? PathKind::Regular : PathKind::Other;
+#endif
+}
+
+/**
+ * @brief 只读映射一个普通文件
+ * @return 映射地址；文件不是普通文件、为空或系统不支持映射时返回 nullptr（由调用方退回读入）
+ */
+void* map_file(const std::string& path, size_t& size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    void* view = nullptr;
+    LARGE_INTEGER file_size;
+    if (GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &file_size) &&
+        file_size.QuadPart > 0 &&
+        static_cast<unsigned long long>(file_size.QuadPart) <= SIZE_MAX) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            // 视图独立于两个句柄存活，关闭句柄后映射仍然有效
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            size = static_cast<size_t>(file_size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+    return view;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* view = nullptr;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        size = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            // 词法分析从头到尾顺序扫描一遍：提示内核积极预读
+            madvise(address, size, MADV_SEQUENTIAL);
+            view = address;
+        }
+    }
+    close(fd);
+    return view;
+#endif
+}
+
+void unmap_file(void* mapping, size_t size) {
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, size);
+#endif
+}
+
+} // namespace
+
+SourceFile::SourceFile(std::string text, std::string path)
+    : path_(std::move(path)), buffer_(std::move(text)), text_(buffer_) {
+    skip_bom();
+}
+
+SourceFile::SourceFile(std::string path, void* mapping, size_t mapped_size)
+    : path_(std::move(path)), mapping_(mapping), mapped_size_(mapped_size),
+      text_(static_cast<const char*>(mapping), mapped_size) {
+    skip_bom();
+}
+
+SourceFile::~SourceFile() {
+    if (mapping_ != nullptr) {
+        unmap_file(mapping_, mapped_size_);
+    }
+}
+
+void SourceFile::skip_bom() {
+    if (text_.size() >= 3 &&
+        static_cast<unsigned char>(text_[0]) == 0xEF &&
+        static_cast<unsigned char>(text_[1]) == 0xBB &&
+        static_cast<unsigned char>(text_[2]) == 0xBF) {
+        text_.remove_prefix(3);
+    }
+}
+
+std::unique_ptr<SourceFile> SourceFile::read(const std::string& path, std::string& error) {
+    // 只接受普通文件：目录等对象在部分平台上也能以 ifstream 打开，
+    // 其 tellg 结果没有意义，不能拿来分配缓冲区
+    switch (path_kind(path)) {
+        case PathKind::Missing:
+            error = "Cannot open file " + path;
+            return nullptr;
+        case PathKind::Other:
+            error = "Cannot read file " + path;
+            return nullptr;
+        case PathKind::Regular:
+            break;
+    }
+
+    size_t mapped_size = 0;
+    if (void* mapping = map_file(path, mapped_size)) {
+        return std::unique_ptr<SourceFile>(new SourceFile(path, mapping, mapped_size));
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Cannot open file " + path;
+        return nullptr;
+    }
+
+    // 按文件大小一次分配，直接读入最终缓冲区
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    if (size < 0) {
+        error = "Cannot read file " + path;
+        return nullptr;
+    }
+    std::string buffer;
+    if (size > 0) {
+        buffer.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        file.read(&buffer[0], size);
+        if (!file) {
+            error = "Error reading file " + path;
+            return nullptr;
+        }
+    }
+    return std::make_unique<SourceFile>(std::move(buffer), path);
+}
+
+} // namespace collie
@@ -0,0 +1,68 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 源文件：整个编译流程中唯一持有源码文本的对象
+ */
+#ifndef COLLIE_SOURCE_FILE_H
+#define COLLIE_SOURCE_FILE_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace collie {
+
+/**
+ * @brief 源文件
+ *
+ * 源码只在这里保存一份：Lexer 直接扫描 text()，产出的 token 词素是其中的切片。
+ * 对象不可拷贝、不可移动，保证 text() 的地址在其生命周期内不变；
+ * token 序列（及保留这些 token 的一切结构）不得比它活得久。
+ *
+ * read() 对普通文件做只读内存映射，BOM 以偏移跳过，从打开文件到开始词法分析不复制源码；
+ * 无法映射的来源（管道、设备等）退回一次性读入。映射期间文件被其他进程截断属于未定义行为。
+ */
+class SourceFile {
+public:
+    /// @brief 接管内存中的源码文本（跳过 UTF-8 BOM）
+    explicit SourceFile(std::string text, std::string path = "<memory>");
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    ~SourceFile();
+
+    /**
+     * @brief 打开整个文件：只读映射，不支持映射时以二进制方式读入
+     *
+     * 只接受普通文件；目录、设备、管道等返回 "Cannot read file <path>"。
+     * @param error 失败时写入错误描述
+     * @return 失败时返回 nullptr
+     */
+    static std::unique_ptr<SourceFile> read(const std::string& path, std::string& error);
+
+    const std::string& path() const { return path_; }
+
+    /// @brief 源码文本（不含 BOM）
+    std::string_view text() const { return text_; }
+
+    size_t size() const { return text_.size(); }
+
+    /// @brief 文本是否直接指向文件的内存映射
+    bool is_mapped() const { return mapping_ != nullptr; }
+
+private:
+    /// @brief 接管一段只读映射（析构时解除映射）
+    SourceFile(std::string path, void* mapping, size_t mapped_size);
+
+    void skip_bom();
+
+    std::string path_;
+    std::string buffer_;          // 读入内存的原始字节（未映射时）
+    void* mapping_ = nullptr;     // 文件映射的起始地址
+    size_t mapped_size_ = 0;
+    std::string_view text_;       // 去掉 BOM 后的源码
+};
+
+} // namespace collie
+
+#endif // COLLIE_SOURCE_FILE_H
@@ -0,0 +1,80 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词素驻留池实现
+ */
+#include "string_pool.h"
+
+#include <cstring>
+
+namespace collie {
+
+namespace {
+
+// 每次取 8 字节做乘法混合：词素通常很短，逐字节的哈希在这里反而是主要开销
+uint64_t hash_text(std::string_view text) {
+    const char* p = text.data();
+    size_t n = text.size();
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 31;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, n);
+    h = (h ^ tail) * 0x94D049BB133111EBull;
+    h ^= h >> 29;
+    return h;
+}
+
+constexpr size_t initial_slots = 256;
+
+} // namespace
+
+std::string_view StringPool::intern(std::string_view text) {
+    if (text.empty()) return std::string_view("");
+
+    if ((size_ + 1) * 2 > slots_.size()) {
+        grow();
+    }
+
+    uint64_t hash = hash_text(text);
+    uint32_t tag = static_cast<uint32_t>(hash);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = static_cast<size_t>(hash >> 32) & mask;; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.data == nullptr) {
+            char* data = static_cast<char*>(arena_.allocate(text.size(), 1));
+            std::memcpy(data, text.data(), text.size());
+            slot = {data, static_cast<uint32_t>(text.size()), tag};
+            ++size_;
+            return std::string_view(data, text.size());
+        }
+        if (slot.hash == tag && slot.size == text.size() &&
+            std::memcmp(slot.data, text.data(), text.size()) == 0) {
+            return std::string_view(slot.data, slot.size);
+        }
+    }
+}
+
+void StringPool::grow() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? initial_slots : old.size() * 2, Slot{});
+    size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.data == nullptr) continue;
+        // 槽位只存了哈希低 32 位，重新计算完整哈希以确定新位置
+        uint64_t hash = hash_text(std::string_view(slot.data, slot.size));
+        size_t i = static_cast<size_t>(hash >> 32) & mask;
+        while (slots_[i].data != nullptr) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+} // namespace collie
@@ -0,0 +1,61 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 词素驻留池：相同文本只存一份，返回稳定的 string_view
+ */
+#ifndef COLLIE_STRING_POOL_H
+#define COLLIE_STRING_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../utils/arena.h"
+
+namespace collie {
+
+/**
+ * @brief 字符串驻留池
+ *
+ * intern 返回的视图指向池内存储，在池析构前一直有效；同一文本多次驻留得到
+ * 同一地址。存储来自 Arena，池析构时整体释放，不逐个回收。
+ * 索引是线性探测的开放寻址表（槽位连续存放，保存完整哈希值），
+ * 语法分析每个 token 都要驻留一次，查找路径上不做节点分配与指针跳转。
+ */
+class StringPool {
+public:
+    StringPool() : arena_(16 * 1024) {}
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    StringPool(StringPool&&) noexcept = default;
+    StringPool& operator=(StringPool&&) noexcept = default;
+
+    /// @brief 驻留 text，返回池内等值字符串的视图
+    std::string_view intern(std::string_view text);
+
+    /// @brief 不同字符串的个数
+    size_t size() const { return size_; }
+
+    /// @brief 池存储占用的字节数（含索引）
+    size_t bytes_reserved() const {
+        return arena_.bytes_reserved() + slots_.capacity() * sizeof(Slot);
+    }
+
+private:
+    struct Slot {
+        const char* data = nullptr;  // nullptr 表示空槽
+        uint32_t size = 0;
+        uint32_t hash = 0;           // 哈希值低 32 位，比较文本前先比较它
+    };
+
+    void grow();
+
+    Arena arena_;
+    std::vector<Slot> slots_;  // 容量为 2 的幂，装载率不超过 1/2
+    size_t size_ = 0;
+};
+
+} // namespace collie
+
+#endif // COLLIE_STRING_POOL_H
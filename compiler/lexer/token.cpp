@@ -3,12 +3,20 @@
  * @Date: 2025-01-05
  */
 #include "token.h"
-#include <unordered_map>
+#include <algorithm>
+#include <cstddef>
 
 namespace collie {
 
-// 关键字映射表
-static const std::unordered_map<std::string_view, TokenType> keywords = {
+namespace {
+
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+// 关键字表
+constexpr Keyword keyword_list[] = {
     // 类型关键字
     {"object", TokenType::KW_OBJECT},
     {"none", TokenType::KW_NONE},
@@ -62,9 +70,112 @@ static const std::unordered_map<std::string_view, TokenType> keywords = {
     {"NaN", TokenType::LITERAL_NUMBER}
 };
 
+/**
+ * 关键字完美哈希：取首两个字节、末字节与长度的线性组合落到 128 个槽位，
+ * 系数保证表中关键字互不冲突（下方 static_assert 在编译期校验）。
+ * 查找只需一次哈希与一次比较，长度不在关键字范围内的标识符直接跳过。
+ */
+constexpr size_t keyword_slots = 128;
+
+constexpr size_t keyword_hash(std::string_view text) {
+    return (static_cast<unsigned char>(text[0]) * 2u + static_cast<unsigned char>(text[1]) * 6u +
+            static_cast<unsigned char>(text[text.size() - 1]) + text.size() * 23u) &
+           (keyword_slots - 1);
+}
+
+struct KeywordTable {
+    Keyword slots[keyword_slots] = {};
+    size_t min_length = static_cast<size_t>(-1);
+    size_t max_length = 0;
+    bool collision = false;
+};
+
+constexpr KeywordTable build_keyword_table() {
+    KeywordTable table;
+    for (const Keyword& keyword : keyword_list) {
+        table.min_length = std::min(table.min_length, keyword.text.size());
+        table.max_length = std::max(table.max_length, keyword.text.size());
+        Keyword& slot = table.slots[keyword_hash(keyword.text)];
+        if (!slot.text.empty()) {
+            table.collision = true;
+        }
+        slot = keyword;
+    }
+    return table;
+}
+
+constexpr KeywordTable keyword_table = build_keyword_table();
+
+static_assert(!keyword_table.collision, "关键字哈希冲突：请调整 keyword_hash 的系数");
+static_assert(keyword_table.min_length >= 2, "keyword_hash 要求关键字至少两个字节");
+
+} // namespace
+
 TokenType get_identifier_type(std::string_view identifier) {
-    auto it = keywords.find(identifier);
-    return it != keywords.end() ? it->second : TokenType::IDENTIFIER;
+    if (identifier.size() < keyword_table.min_length ||
+        identifier.size() > keyword_table.max_length) {
+        return TokenType::IDENTIFIER;
+    }
+    const Keyword& slot = keyword_table.slots[keyword_hash(identifier)];
+    return slot.text == identifier ? slot.type : TokenType::IDENTIFIER;
+}
+
+namespace {
+
+// 反斜杠转义解码（单行字符串与字符字面量共用；合法性已由词法分析器校验）
+std::string decode_escapes(std::string_view raw) {
+    std::string out;
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\' || i + 1 >= raw.size()) {
+            out += raw[i];
+            continue;
+        }
+        switch (raw[++i]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            default: out += raw[i]; break;  // \" \' \\ 取字符本身
+        }
+    }
+    return out;
+}
+
+// 多行字符串去缩进：只取以换行结尾的完整行，以首行缩进为基准去除每行的公共前导缩进
+std::string decode_indented(std::string_view raw) {
+    auto leading_ws = [](std::string_view line) {
+        size_t n = 0;
+        while (n < line.size() && (line[n] == ' ' || line[n] == '\t')) ++n;
+        return n;
+    };
+
+    std::string out;
+    out.reserve(raw.size());
+    size_t base_indent = 0;
+    bool first = true;
+    size_t start = 0;
+    for (size_t nl = raw.find('\n'); nl != std::string_view::npos;
+         start = nl + 1, nl = raw.find('\n', start)) {
+        std::string_view line = raw.substr(start, nl - start);
+        if (first) {
+            base_indent = leading_ws(line);
+            first = false;
+        }
+        out += line.substr(std::min(base_indent, line.size()));
+        out += '\n';
+    }
+    return out;
+}
+
+} // namespace
+
+std::string decode_lexeme(const Token& token) {
+    switch (token.form()) {
+        case LexemeForm::Escaped: return decode_escapes(token.lexeme());
+        case LexemeForm::Indented: return decode_indented(token.lexeme());
+        case LexemeForm::Exact: break;
+    }
+    return std::string(token.lexeme());
 }
 
 } // namespace collie
@@ -5,6 +5,7 @@
 #ifndef COLLIE_TOKEN_H
 #define COLLIE_TOKEN_H
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include "utf_convert.h"
@@ -132,17 +133,42 @@ enum class TokenType {
 
 };
 
+/**
+ * @brief 词素的书写形式：lexeme 是否就是字面值本身
+ *
+ * 词法分析器只记录源码切片，不在扫描时构造解码后的文本；需要解码的字面量
+ * 由 decode_lexeme 按需还原（Parser 把 token 驻留进 AST 时统一还原一次）。
+ */
+enum class LexemeForm : uint8_t {
+    Exact,     // lexeme 即字面值
+    Escaped,   // 字符串/字符字面量的引号内原文，含反斜杠转义
+    Indented,  // 三引号多行字符串的原文，需逐行去除公共前导缩进
+};
+
 // Token 类
+//
+// lexeme 只是视图，不持有文本：词法分析器产出的 token 直接指向源码缓冲区
+// （见 SourceFile），AST 中的 token 指向 AstContext 的驻留池（见 parser/ast_context.h），
+// 因此 token 可以随意按值拷贝。构造时传入的文本必须比 token 活得久。
 class Token {
 public:
-    Token() : type_(TokenType::INVALID), lexeme_(""), line_(0), column_(0) {}
+    Token() : lexeme_(""), line_(0), column_(0), type_(TokenType::INVALID) {}
+
+    Token(TokenType type, std::string_view lexeme, size_t line, size_t column,
+          LexemeForm form = LexemeForm::Exact)
+        : lexeme_(lexeme), line_(static_cast<uint32_t>(line)),
+          column_(static_cast<uint32_t>(column)), type_(type), form_(form) {}
 
-    Token(TokenType type, std::string_view lexeme, size_t line, size_t column)
-        : type_(type), lexeme_(lexeme), line_(line), column_(column) {}
+    Token(TokenType type, const char* lexeme, size_t line, size_t column)
+        : Token(type, std::string_view(lexeme), line, column) {}
+
+    // 临时字符串构造出的视图会立即悬空：须先驻留
+    Token(TokenType type, std::string&& lexeme, size_t line, size_t column) = delete;
 
     // Getters
     TokenType type() const { return type_; }
     std::string_view lexeme() const { return lexeme_; }
+    LexemeForm form() const { return form_; }
     size_t line() const { return line_; }
     size_t column() const { return column_; }
 
@@ -157,12 +183,22 @@ public:
     }
 
 private:
-    TokenType type_;         // token 类型
-    std::string lexeme_;     // token 的字面值
-    size_t line_;            // token 所在行号
-    size_t column_;          // token 所在列号
+    // 成员按大小排列并以 32 位保存行列号，使 Token 保持 32 字节：大文件的 token 数组更紧凑
+    std::string_view lexeme_; // token 的字面值（源码或驻留池中的视图）
+    uint32_t line_;           // token 所在行号
+    uint32_t column_;         // token 所在列号
+    TokenType type_;          // token 类型
+    LexemeForm form_ = LexemeForm::Exact; // lexeme 的书写形式
 };
 
+/**
+ * @brief 还原 token 的字面值（转义解码、多行字符串去缩进）
+ *
+ * 词法分析器已校验过转义与缩进的合法性，这里不再报错。
+ * form 为 Exact 时直接复制 lexeme。
+ */
+std::string decode_lexeme(const Token& token);
+
 // Helper functions
 TokenType get_identifier_type(std::string_view identifier);
 
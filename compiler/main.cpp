@@ -5,22 +5,27 @@
  */
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <memory>
 #include <ostream>
 #include <streambuf>
 #ifdef _WIN32
+// windows.h 的 min/max 宏会污染 LLVM 头文件（--jit 经 codegen/jit_executor.h 间接引入）
+#define NOMINMAX
 #include <Windows.h>
 #endif
 #include "lexer/lexer.h"
+#include "lexer/source_file.h"
 #include "parser/parser.h"
 #include "semantic/semantic_analyzer.h"
 #include "interpreter/interpreter.h"
+#include "interpreter/bytecode/vm.h"
 #include "utils/token_utils.h"
 #include "utils/version_info.h"
+#ifdef COLLIE_HAVE_JIT
+#include "codegen/jit_executor.h"
+#endif
 
 namespace {
 // 丢弃一切写入的空缓冲区：非 verbose 模式下用于静默编译流水线的诊断信息，
@@ -37,21 +42,67 @@ void flush_output() {
 }
 
 int main(int argc, char* argv[]) {
-    // 命令行：collie [-v|--verbose] <source_file>
+    // 命令行：collie [-v|--verbose] [--engine=tree|vm] [--jit] [--cache-stats] [--max-depth=N] [--jobs=N] <source_file>
     // 默认安静模式：标准输出仅包含程序的 print 输出；诊断信息仅在 verbose 下打印。
+    // --engine 选择执行引擎：tree 为树遍历解释器（默认，参考实现），vm 为字节码虚拟机。
+    // --jit 经 LLVM 代码生成后在进程内惰性编译执行（需以 COLLIE_ENABLE_LLVM 构建）；
+    // 程序含 codegen 尚不支持的构造时在标准错误提示一行，回退到 --engine 所选引擎。
+    // --cache-stats 在程序结束后向标准错误输出内联缓存命中统计。
+    // --max-depth 设置调用深度上限（默认 2^20），超限报运行时错误而非崩溃。
+    // --jobs 设置语义分析并行检查函数体/类体的线程数（默认取硬件并发数）。
     bool verbose = false;
+    bool use_vm = false;
+    bool use_jit = false;
+    bool cache_stats = false;
+    size_t max_depth = collie::kDefaultMaxCallDepth;
+    size_t jobs = 0;
     std::string filename;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "-v" || arg == "--verbose") {
             verbose = true;
+        } else if (arg == "--engine=vm") {
+            use_vm = true;
+        } else if (arg == "--engine=tree") {
+            use_vm = false;
+        } else if (arg == "--jit") {
+            use_jit = true;
+        } else if (arg == "--cache-stats") {
+            cache_stats = true;
+        } else if (arg.rfind("--max-depth=", 0) == 0) {
+            const std::string value = arg.substr(12);
+            // 至多 18 位十进制数字，保证 stoull 不溢出
+            if (value.empty() || value.size() > 18 ||
+                value.find_first_not_of("0123456789") != std::string::npos ||
+                (max_depth = std::stoull(value)) == 0) {
+                std::cerr << "Error: Invalid --max-depth value '" << value
+                          << "' (expected a positive integer)" << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            const std::string value = arg.substr(7);
+            if (value.empty() || value.size() > 4 ||
+                value.find_first_not_of("0123456789") != std::string::npos ||
+                (jobs = std::stoul(value)) == 0) {
+                std::cerr << "Error: Invalid --jobs value '" << value
+                          << "' (expected a positive integer)" << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--engine=", 0) == 0) {
+            std::cerr << "Error: Unknown engine '" << arg.substr(9)
+                      << "' (expected 'tree' or 'vm')" << std::endl;
+            return 1;
         } else if (filename.empty()) {
             filename = arg;
         }
     }
 
     if (filename.empty()) {
-        std::cerr << "Usage: " << argv[0] << " [-v|--verbose] <source_file>" << std::endl;
+        std::cerr << "Usage: " << argv[0]
+                  << " [-v|--verbose] [--engine=tree|vm] [--jit] [--cache-stats] [--max-depth=N]"
+                  << " [--jobs=N]"
+                  << " <source_file>"
+                  << std::endl;
         std::cerr << "Example: " << argv[0] << " example.collie" << std::endl;
         return 1;
     }
@@ -76,54 +127,37 @@ int main(int argc, char* argv[]) {
 
         // 以二进制方式读取源文件，直接按 UTF-8 字节流处理（跨平台、无需编码转换）
         diag << "Reading file: " << filename << std::endl;
-        std::ifstream file(filename, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "Error: Cannot open file " << filename << std::endl;
-            flush_output();
-            return 1;
-        }
-
-        std::ostringstream ss;
-        ss << file.rdbuf();
-        if (file.bad()) {
-            std::cerr << "Error reading file content" << std::endl;
+        std::string read_error;
+        std::unique_ptr<collie::SourceFile> source = collie::SourceFile::read(filename, read_error);
+        if (!source) {
+            std::cerr << "Error: " << read_error << std::endl;
             flush_output();
             return 1;
         }
-        file.close();
-
-        std::string source = ss.str();
-
-        // 跳过可能存在的 UTF-8 BOM
-        if (source.size() >= 3 &&
-            static_cast<unsigned char>(source[0]) == 0xEF &&
-            static_cast<unsigned char>(source[1]) == 0xBB &&
-            static_cast<unsigned char>(source[2]) == 0xBF) {
-            source.erase(0, 3);
-        }
 
         std::string equalSigns(20, '=');
         diag << std::endl;
         diag << "Source code:" << std::endl;
         diag << equalSigns << " START OF FILE " << equalSigns << std::endl;
-        diag << source << std::endl;
+        diag << source->text() << std::endl;
         diag << equalSigns << "  END OF FILE  " << equalSigns << std::endl;
         diag << std::endl;
 
-        // 词法分析
-        diag << "Starting lexical analysis..." << std::endl;
-        collie::Lexer lexer(source);
+        // 词法分析：默认不单独进行，由语法分析器边解析边从 Lexer 拉取 token，
+        // 不生成完整的 token 数组；verbose 模式要打印全部 token，才先完整 tokenize
+        collie::Lexer lexer(*source);
         std::vector<collie::Token> tokens;
-        try {
-            tokens = lexer.tokenize();
-        } catch (const std::exception& e) {
-            std::cerr << "Error during tokenization: " << e.what() << std::endl;
-            flush_output();
-            return 1;
-        }
-
-        diag << "Tokenization completed. Token count: " << tokens.size() << std::endl;
         if (verbose) {
+            diag << "Starting lexical analysis..." << std::endl;
+            try {
+                tokens = lexer.tokenize();
+            } catch (const std::exception& e) {
+                std::cerr << "Error during tokenization: " << e.what() << std::endl;
+                flush_output();
+                return 1;
+            }
+
+            diag << "Tokenization completed. Token count: " << tokens.size() << std::endl;
             diag << "Tokens:" << std::endl;
             for (const auto& token : tokens) {
                 diag << "  Type: " << token_type_to_string(token.type())
@@ -132,14 +166,14 @@ int main(int argc, char* argv[]) {
                      << "', Line: " << token.line()
                      << ", Column: " << token.column() << std::endl;
             }
+            diag << "Lexical analysis completed." << std::endl;
+            diag << std::endl;
         }
-        diag << "Lexical analysis completed." << std::endl;
-        diag << std::endl;
 
         // 语法分析
         diag << "Starting syntax analysis..." << std::endl;
-        collie::Parser parser(tokens);
-        std::vector<std::unique_ptr<collie::Stmt>> stmts;
+        collie::Parser parser = verbose ? collie::Parser(tokens) : collie::Parser(lexer);
+        collie::ParsedProgram stmts;
         try {
             stmts = parser.parse_program();
             if (stmts.empty()) {
@@ -147,6 +181,11 @@ int main(int argc, char* argv[]) {
                 flush_output();
                 return 1;
             }
+        } catch (const collie::LexError& e) {
+            // 流式解析时词法错误在拉取 token 时抛出
+            std::cerr << "Error during tokenization: " << e.what() << std::endl;
+            flush_output();
+            return 1;
         } catch (const std::exception& e) {
             std::cerr << "Error during parsing: " << e.what() << std::endl;
             flush_output();
@@ -171,6 +210,7 @@ int main(int argc, char* argv[]) {
         // 语义分析
         diag << "Starting semantic analysis..." << std::endl;
         collie::SemanticAnalyzer analyzer;
+        analyzer.set_jobs(jobs);
         try {
             analyzer.analyze(stmts);
         } catch (const std::exception& e) {
@@ -195,19 +235,62 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        // JIT 执行：生成 LLVM IR 后交给 ORC 在进程内编译运行，不落盘、不起外部进程。
+        // 代码生成或 JIT 建立失败时尚未执行任何用户代码，回退到解释器
+        if (use_jit) {
+#ifdef COLLIE_HAVE_JIT
+            collie::CodeGenerator codegen;
+            try {
+                codegen.generate(stmts, filename);
+                diag << "Running program (JIT)..." << std::endl;
+                std::cout.flush();
+                const int exit_code = collie::JitExecutor().run(codegen);
+                flush_output();
+                return exit_code;
+            } catch (const collie::CodeGenError& e) {
+                std::cerr << "Note: --jit falling back to the interpreter: " << e.what()
+                          << std::endl;
+            }
+#else
+            std::cerr << "Note: --jit is unavailable in this build (configure with "
+                      << "-DCOLLIE_ENABLE_LLVM=ON); using the interpreter" << std::endl;
+#endif
+        }
+
         // 解释执行：程序的 print 输出写入标准输出（与诊断信息分离）
         diag << "Running program..." << std::endl;
+        // 两个引擎构造都很轻，放在 try 之外，出错退出时也能读取内联缓存统计
+        collie::Interpreter interpreter(std::cout);
+        collie::bytecode::VM vm(std::cout);
+        interpreter.set_max_call_depth(max_depth);
+        interpreter.set_expr_types(&analyzer.expr_types());
+        vm.set_max_call_depth(max_depth);
+        auto report_cache_stats = [&]() {
+            if (!cache_stats) return;
+            const collie::InlineCacheStats& stats =
+                use_vm ? vm.cache_stats() : interpreter.cache_stats();
+            std::cout.flush();
+            std::cerr << "Inline cache: method hits=" << stats.method_hits
+                      << " misses=" << stats.method_misses
+                      << ", field hits=" << stats.field_hits
+                      << " misses=" << stats.field_misses << std::endl;
+        };
         try {
-            collie::Interpreter interpreter(std::cout);
-            interpreter.interpret(stmts);
+            if (use_vm) {
+                vm.interpret(stmts);
+            } else {
+                interpreter.interpret(stmts);
+            }
         } catch (const collie::RuntimeError& e) {
             std::cout.flush();
             std::cerr << "Runtime error at line " << e.line()
                       << ", column " << e.column() << ": " << e.what() << std::endl;
+            report_cache_stats();
             flush_output();
             return 1;
         }
 
+        report_cache_stats();
         flush_output();
         return 0;
 
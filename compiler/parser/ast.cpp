@@ -136,16 +136,16 @@ void TupleExpr::accept(ExprVisitor& visitor) const {
 }
 
 // 构造函数实现
-CallExpr::CallExpr(std::unique_ptr<Expr> callee,
+CallExpr::CallExpr(ExprPtr callee,
                    Token paren,
-                   std::vector<std::unique_ptr<Expr>> arguments)
+                   std::vector<ExprPtr> arguments)
     : callee_(std::move(callee)),
       paren_(paren),
       arguments_(std::move(arguments)) {}
 
 FunctionStmt::FunctionStmt(Token type, Token name,
                           std::vector<Parameter> parameters,
-                          std::unique_ptr<BlockStmt> body,
+                          AstPtr<BlockStmt> body,
                           bool is_override)
     : return_type_(type),
       name_(name),
@@ -6,7 +6,9 @@
 #ifndef COLLIE_AST_H
 #define COLLIE_AST_H
 
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 #include <string>
 #include "../lexer/token.h"
@@ -53,13 +55,89 @@ class BasicType;
 class ArrayType;
 class TupleType;
 
+/**
+ * @brief AST 子节点句柄（不持有所有权）
+ *
+ * 所有节点都由 AstContext 在线性分配器上创建、随其一次性析构（见 ast_context.h），
+ * 父节点只记录指针。接口与 unique_ptr 的只读部分一致（get / -> / * / 判空），
+ * 且可按值拷贝；派生类句柄可隐式转换为基类句柄。
+ */
+template <typename T>
+class AstPtr {
+public:
+    AstPtr() = default;
+    AstPtr(std::nullptr_t) {}
+    explicit AstPtr(T* node) : node_(node) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    AstPtr(const AstPtr<U>& other) : node_(other.get()) {}
+
+    T* get() const { return node_; }
+    T* operator->() const { return node_; }
+    T& operator*() const { return *node_; }
+    explicit operator bool() const { return node_ != nullptr; }
+
+    friend bool operator==(const AstPtr& p, std::nullptr_t) { return p.node_ == nullptr; }
+    friend bool operator!=(const AstPtr& p, std::nullptr_t) { return p.node_ != nullptr; }
+
+private:
+    T* node_ = nullptr;
+};
+
+class Type;
+class Expr;
+class Stmt;
+using TypePtr = AstPtr<Type>;
+using ExprPtr = AstPtr<Expr>;
+using StmtPtr = AstPtr<Stmt>;
+
 /**
  * @brief 类型的基类
+ *
+ * 节点基类的析构函数为受保护的非虚函数：节点只由 AstContext 按具体类型析构，
+ * 只含 token、句柄与标量成员的节点因此是平凡可析构的，释放时无需逐个访问。
  */
 class Type {
 public:
-    virtual ~Type() = default;
     virtual void accept(TypeVisitor& visitor) const = 0;
+
+protected:
+    ~Type() = default;
+};
+
+/**
+ * @brief 变量引用的静态解析结果（由解释器的 Resolver 回填，见 interpreter/resolver.h）
+ *
+ * global 为 true 时 slot 直接索引全局帧；否则 depth 为沿词法外层跨越的函数帧数
+ * （0 为当前帧），slot 为帧内槽位。slot < 0 表示未解析（如类体成员名），
+ * 运行期按未定义变量处理。
+ */
+struct VarSlot {
+    int depth = 0;
+    int slot = -1;
+    bool global = false;
+
+    bool resolved() const { return slot >= 0; }
+};
+
+/**
+ * @brief 内建函数（由 Resolver 按调用处名字回填到 CallExpr，执行期按枚举分派）
+ */
+enum class BuiltinFunction : uint8_t { None, Print, Len, ToString, ToNumber };
+
+/**
+ * @brief 内建方法（由 Resolver 按方法名回填到 MethodCallExpr，执行期按枚举分派）
+ *
+ * None 表示不是内建方法名（实例上的用户方法；非实例值上报 Unknown method）。
+ */
+enum class BuiltinMethod : uint8_t {
+    None,
+    Get,                                         // tuple
+    ToString, ToNumber,                          // 通用
+    IsTrue, IsFalse, IsUnset,                    // tribool
+    Trim, TrimLeft, TrimRight, SubString,        // string
+    Abs, IntegerPart, DecimalPart,               // number
+    IsInteger, IsDecimal, IsNaN, IsInfinity, IsFinite, IsPositive, IsNegative,
 };
 
 /**
@@ -68,8 +146,17 @@ public:
  */
 class Expr {
 public:
-    virtual ~Expr() = default;
     virtual void accept(ExprVisitor& visitor) const = 0;
+
+    /// @brief 静态类型（由 Resolver 依语义分析导出的类型表回填，见 expr_types.h；INVALID 为动态）
+    TokenType static_type() const { return static_type_; }
+    void set_static_type(TokenType type) const { static_type_ = type; }
+
+protected:
+    ~Expr() = default;
+
+private:
+    mutable TokenType static_type_ = TokenType::INVALID;
 };
 
 /**
@@ -87,7 +174,6 @@ enum class AccessLevel {
  */
 class Stmt {
 public:
-    virtual ~Stmt() = default;
     virtual void accept(StmtVisitor& visitor) const = 0;
 
     /**
@@ -105,6 +191,8 @@ public:
     AccessLevel access() const { return access_; }
 
 protected:
+    ~Stmt() = default;
+
     AccessLevel access_ = AccessLevel::PUBLIC;  // 默认为公有访问权限
 };
 
@@ -118,8 +206,13 @@ public:
     void accept(ExprVisitor& visitor) const override;
     const Token& token() const { return token_; }
 
+    /// 字面量常量池下标（Resolver 回填，-1 表示未解析）
+    int constant() const { return constant_; }
+    void set_constant(int index) const { constant_ = index; }
+
 private:
     Token token_;
+    mutable int constant_ = -1;
 };
 
 /**
@@ -132,8 +225,13 @@ public:
     void accept(ExprVisitor& visitor) const override;
     const Token& name() const { return name_; }
 
+    /// 变量槽位（Resolver 回填，AST 其余部分保持只读）
+    const VarSlot& slot() const { return slot_; }
+    void set_slot(const VarSlot& slot) const { slot_ = slot; }
+
 private:
     Token name_;
+    mutable VarSlot slot_;
 };
 
 /**
@@ -142,7 +240,7 @@ private:
  */
 class BinaryExpr : public Expr {
 public:
-    BinaryExpr(std::unique_ptr<Expr> left, Token op, std::unique_ptr<Expr> right)
+    BinaryExpr(ExprPtr left, Token op, ExprPtr right)
         : left_(std::move(left)), operator_(op), right_(std::move(right)) {}
 
     void accept(ExprVisitor& visitor) const override;
@@ -152,9 +250,9 @@ public:
     const Expr* right() const { return right_.get(); }
 
 private:
-    std::unique_ptr<Expr> left_;
+    ExprPtr left_;
     Token operator_;
-    std::unique_ptr<Expr> right_;
+    ExprPtr right_;
 };
 
 /**
@@ -163,7 +261,7 @@ private:
  */
 class UnaryExpr : public Expr {
 public:
-    UnaryExpr(Token op, std::unique_ptr<Expr> operand)
+    UnaryExpr(Token op, ExprPtr operand)
         : operator_(op), operand_(std::move(operand)) {}
 
     void accept(ExprVisitor& visitor) const override;
@@ -173,7 +271,7 @@ public:
 
 private:
     Token operator_;
-    std::unique_ptr<Expr> operand_;
+    ExprPtr operand_;
 };
 
 /**
@@ -186,14 +284,14 @@ public:
      * @brief 构造表达式语句
      * @param expression 要执行的表达式
      */
-    explicit ExpressionStmt(std::unique_ptr<Expr> expression)
+    explicit ExpressionStmt(ExprPtr expression)
         : expression_(std::move(expression)) {}
 
     void accept(StmtVisitor& visitor) const override;
     const Expr* expression() const { return expression_.get(); }
 
 private:
-    std::unique_ptr<Expr> expression_;
+    ExprPtr expression_;
 };
 
 /**
@@ -208,7 +306,7 @@ public:
      * @param name 变量名
      * @param initializer 初始化表达式（可选）
      */
-    VarDeclStmt(Token type, Token name, std::unique_ptr<Expr> initializer = nullptr,
+    VarDeclStmt(Token type, Token name, ExprPtr initializer = nullptr,
                 bool is_const = false)
         : type_(type), name_(name), initializer_(std::move(initializer)),
           is_const_(is_const) {}
@@ -219,11 +317,16 @@ public:
     const Expr* initializer() const { return initializer_.get(); }
     bool is_const() const { return is_const_; }
 
+    /// 所在帧内的槽位（Resolver 回填；类字段不占槽，保持 -1）
+    int slot() const { return slot_; }
+    void set_slot(int slot) const { slot_ = slot; }
+
 private:
     Token type_;
     Token name_;
-    std::unique_ptr<Expr> initializer_;
+    ExprPtr initializer_;
     bool is_const_;
+    mutable int slot_ = -1;
 };
 
 /**
@@ -236,14 +339,14 @@ public:
      * @brief 构造块语句
      * @param statements 块中的语句列表
      */
-    explicit BlockStmt(std::vector<std::unique_ptr<Stmt>> statements)
+    explicit BlockStmt(std::vector<StmtPtr> statements)
         : statements_(std::move(statements)) {}
 
     void accept(StmtVisitor& visitor) const override;
-    const std::vector<std::unique_ptr<Stmt>>& statements() const { return statements_; }
+    const std::vector<StmtPtr>& statements() const { return statements_; }
 
 private:
-    std::vector<std::unique_ptr<Stmt>> statements_;
+    std::vector<StmtPtr> statements_;
 };
 
 /**
@@ -257,7 +360,7 @@ public:
      * @param name 被赋值的变量名
      * @param value 要赋的值
      */
-    AssignExpr(Token name, std::unique_ptr<Expr> value)
+    AssignExpr(Token name, ExprPtr value)
         : name_(name), value_(std::move(value)) {}
 
     void accept(ExprVisitor& visitor) const override;
@@ -265,9 +368,14 @@ public:
     const Token& name() const { return name_; }
     const Expr* value() const { return value_.get(); }
 
+    /// 被赋值变量的槽位（Resolver 回填）
+    const VarSlot& slot() const { return slot_; }
+    void set_slot(const VarSlot& slot) const { slot_ = slot; }
+
 private:
     Token name_;
-    std::unique_ptr<Expr> value_;
+    ExprPtr value_;
+    mutable VarSlot slot_;
 };
 
 /**
@@ -278,11 +386,11 @@ private:
  */
 class TernaryExpr : public Expr {
 public:
-    TernaryExpr(std::unique_ptr<Expr> condition,
+    TernaryExpr(ExprPtr condition,
                 Token question_token,
-                std::unique_ptr<Expr> then_expr,
-                std::unique_ptr<Expr> else_expr,
-                std::unique_ptr<Expr> unset_expr = nullptr)
+                ExprPtr then_expr,
+                ExprPtr else_expr,
+                ExprPtr unset_expr = nullptr)
         : condition_(std::move(condition)),
           question_token_(question_token),
           then_expr_(std::move(then_expr)),
@@ -299,11 +407,11 @@ public:
     const Expr* unset_expr() const { return unset_expr_.get(); }
 
 private:
-    std::unique_ptr<Expr> condition_;
+    ExprPtr condition_;
     Token question_token_;
-    std::unique_ptr<Expr> then_expr_;
-    std::unique_ptr<Expr> else_expr_;
-    std::unique_ptr<Expr> unset_expr_;
+    ExprPtr then_expr_;
+    ExprPtr else_expr_;
+    ExprPtr unset_expr_;
 };
 
 /**
@@ -316,13 +424,13 @@ class MultiMatchExpr : public Expr {
 public:
     /// 单个匹配分支：候选值组（至少 1 个）→ 结果表达式
     struct Branch {
-        std::vector<std::unique_ptr<Expr>> values;
-        std::unique_ptr<Expr> result;
+        std::vector<ExprPtr> values;
+        ExprPtr result;
     };
 
-    MultiMatchExpr(std::unique_ptr<Expr> target, Token op,
+    MultiMatchExpr(ExprPtr target, Token op,
                    std::vector<Branch> branches,
-                   std::unique_ptr<Expr> default_expr)
+                   ExprPtr default_expr)
         : target_(std::move(target)), op_(op),
           branches_(std::move(branches)),
           default_expr_(std::move(default_expr)) {}
@@ -336,10 +444,10 @@ public:
     const Expr* default_expr() const { return default_expr_.get(); }
 
 private:
-    std::unique_ptr<Expr> target_;
+    ExprPtr target_;
     Token op_;  // '==?' token，用于错误报告
     std::vector<Branch> branches_;
-    std::unique_ptr<Expr> default_expr_;
+    ExprPtr default_expr_;
 };
 
 /**
@@ -348,16 +456,16 @@ private:
  */
 class ArrayLiteralExpr : public Expr {
 public:
-    ArrayLiteralExpr(std::vector<std::unique_ptr<Expr>> elements, Token bracket)
+    ArrayLiteralExpr(std::vector<ExprPtr> elements, Token bracket)
         : elements_(std::move(elements)), bracket_(bracket) {}
 
     void accept(ExprVisitor& visitor) const override;
 
-    const std::vector<std::unique_ptr<Expr>>& elements() const { return elements_; }
+    const std::vector<ExprPtr>& elements() const { return elements_; }
     const Token& bracket() const { return bracket_; }
 
 private:
-    std::vector<std::unique_ptr<Expr>> elements_;
+    std::vector<ExprPtr> elements_;
     Token bracket_;  // 左方括号位置，用于错误报告
 };
 
@@ -367,8 +475,8 @@ private:
  */
 class IndexExpr : public Expr {
 public:
-    IndexExpr(std::unique_ptr<Expr> object, Token bracket,
-              std::unique_ptr<Expr> index)
+    IndexExpr(ExprPtr object, Token bracket,
+              ExprPtr index)
         : object_(std::move(object)), bracket_(bracket),
           index_(std::move(index)) {}
 
@@ -379,14 +487,14 @@ public:
     const Expr* index() const { return index_.get(); }
 
     /// @brief 转移对象子表达式所有权（仅供 parser 重组为索引赋值节点使用）
-    std::unique_ptr<Expr> take_object() { return std::move(object_); }
+    ExprPtr take_object() { return std::move(object_); }
     /// @brief 转移索引子表达式所有权（仅供 parser 重组为索引赋值节点使用）
-    std::unique_ptr<Expr> take_index() { return std::move(index_); }
+    ExprPtr take_index() { return std::move(index_); }
 
 private:
-    std::unique_ptr<Expr> object_;
+    ExprPtr object_;
     Token bracket_;  // 左方括号位置，用于错误报告
-    std::unique_ptr<Expr> index_;
+    ExprPtr index_;
 };
 
 /**
@@ -395,8 +503,8 @@ private:
  */
 class IndexAssignExpr : public Expr {
 public:
-    IndexAssignExpr(std::unique_ptr<Expr> object, Token bracket,
-                    std::unique_ptr<Expr> index, std::unique_ptr<Expr> value)
+    IndexAssignExpr(ExprPtr object, Token bracket,
+                    ExprPtr index, ExprPtr value)
         : object_(std::move(object)), bracket_(bracket),
           index_(std::move(index)), value_(std::move(value)) {}
 
@@ -408,10 +516,10 @@ public:
     const Expr* value() const { return value_.get(); }
 
 private:
-    std::unique_ptr<Expr> object_;
+    ExprPtr object_;
     Token bracket_;  // 左方括号位置，用于错误报告
-    std::unique_ptr<Expr> index_;
-    std::unique_ptr<Expr> value_;
+    ExprPtr index_;
+    ExprPtr value_;
 };
 
 /**
@@ -420,8 +528,8 @@ private:
  */
 class MethodCallExpr : public Expr {
 public:
-    MethodCallExpr(std::unique_ptr<Expr> object, Token name,
-                   std::vector<std::unique_ptr<Expr>> arguments)
+    MethodCallExpr(ExprPtr object, Token name,
+                   std::vector<ExprPtr> arguments)
         : object_(std::move(object)), name_(name),
           arguments_(std::move(arguments)) {}
 
@@ -429,12 +537,17 @@ public:
 
     const Expr* object() const { return object_.get(); }
     const Token& name() const { return name_; }
-    const std::vector<std::unique_ptr<Expr>>& arguments() const { return arguments_; }
+    const std::vector<ExprPtr>& arguments() const { return arguments_; }
+
+    /// 方法名对应的内建方法（Resolver 回填；接收者为实例时仍先查用户方法）
+    BuiltinMethod builtin() const { return builtin_; }
+    void set_builtin(BuiltinMethod builtin) const { builtin_ = builtin; }
 
 private:
-    std::unique_ptr<Expr> object_;
+    ExprPtr object_;
     Token name_;  // 方法名 token，用于分发与错误报告
-    std::vector<std::unique_ptr<Expr>> arguments_;
+    std::vector<ExprPtr> arguments_;
+    mutable BuiltinMethod builtin_ = BuiltinMethod::None;
 };
 
 /**
@@ -443,7 +556,7 @@ private:
  */
 class PropertyExpr : public Expr {
 public:
-    PropertyExpr(std::unique_ptr<Expr> object, Token name)
+    PropertyExpr(ExprPtr object, Token name)
         : object_(std::move(object)), name_(name) {}
 
     void accept(ExprVisitor& visitor) const override;
@@ -452,10 +565,10 @@ public:
     const Token& name() const { return name_; }
 
     /// @brief 转移对象子表达式所有权（仅供 parser 重组为属性赋值节点使用）
-    std::unique_ptr<Expr> take_object() { return std::move(object_); }
+    ExprPtr take_object() { return std::move(object_); }
 
 private:
-    std::unique_ptr<Expr> object_;
+    ExprPtr object_;
     Token name_;  // 属性名 token，用于分发与错误报告
 };
 
@@ -465,8 +578,8 @@ private:
  */
 class PropertyAssignExpr : public Expr {
 public:
-    PropertyAssignExpr(std::unique_ptr<Expr> object, Token name,
-                       std::unique_ptr<Expr> value)
+    PropertyAssignExpr(ExprPtr object, Token name,
+                       ExprPtr value)
         : object_(std::move(object)), name_(name), value_(std::move(value)) {}
 
     void accept(ExprVisitor& visitor) const override;
@@ -476,9 +589,9 @@ public:
     const Expr* value() const { return value_.get(); }
 
 private:
-    std::unique_ptr<Expr> object_;
+    ExprPtr object_;
     Token name_;  // 属性名 token，用于分发与错误报告
-    std::unique_ptr<Expr> value_;
+    ExprPtr value_;
 };
 
 /**
@@ -487,17 +600,17 @@ private:
  */
 class NewExpr : public Expr {
 public:
-    NewExpr(Token class_name, std::vector<std::unique_ptr<Expr>> arguments)
+    NewExpr(Token class_name, std::vector<ExprPtr> arguments)
         : class_name_(class_name), arguments_(std::move(arguments)) {}
 
     void accept(ExprVisitor& visitor) const override;
 
     const Token& class_name() const { return class_name_; }
-    const std::vector<std::unique_ptr<Expr>>& arguments() const { return arguments_; }
+    const std::vector<ExprPtr>& arguments() const { return arguments_; }
 
 private:
     Token class_name_;  // 类名 token，用于查找类与错误报告
-    std::vector<std::unique_ptr<Expr>> arguments_;
+    std::vector<ExprPtr> arguments_;
 };
 
 /**
@@ -512,8 +625,13 @@ public:
 
     const Token& keyword() const { return keyword_; }
 
+    /// 方法帧内 this 的槽位（Resolver 回填）
+    const VarSlot& slot() const { return slot_; }
+    void set_slot(const VarSlot& slot) const { slot_ = slot; }
+
 private:
     Token keyword_;  // this 关键字 token，用于错误报告
+    mutable VarSlot slot_;
 };
 
 /**
@@ -523,17 +641,22 @@ private:
  */
 class BaseCallExpr : public Expr {
 public:
-    BaseCallExpr(Token keyword, std::vector<std::unique_ptr<Expr>> arguments)
+    BaseCallExpr(Token keyword, std::vector<ExprPtr> arguments)
         : keyword_(keyword), arguments_(std::move(arguments)) {}
 
     void accept(ExprVisitor& visitor) const override;
 
     const Token& keyword() const { return keyword_; }
-    const std::vector<std::unique_ptr<Expr>>& arguments() const { return arguments_; }
+    const std::vector<ExprPtr>& arguments() const { return arguments_; }
+
+    /// 构造器帧内 this 的槽位（Resolver 回填）
+    const VarSlot& this_slot() const { return this_slot_; }
+    void set_this_slot(const VarSlot& slot) const { this_slot_ = slot; }
 
 private:
     Token keyword_;  // base 关键字 token，用于错误报告
-    std::vector<std::unique_ptr<Expr>> arguments_;
+    std::vector<ExprPtr> arguments_;
+    mutable VarSlot this_slot_;
 };
 
 /**
@@ -544,19 +667,24 @@ private:
 class BaseMethodCallExpr : public Expr {
 public:
     BaseMethodCallExpr(Token keyword, Token method,
-                       std::vector<std::unique_ptr<Expr>> arguments)
+                       std::vector<ExprPtr> arguments)
         : keyword_(keyword), method_(method), arguments_(std::move(arguments)) {}
 
     void accept(ExprVisitor& visitor) const override;
 
     const Token& keyword() const { return keyword_; }
     const Token& method() const { return method_; }
-    const std::vector<std::unique_ptr<Expr>>& arguments() const { return arguments_; }
+    const std::vector<ExprPtr>& arguments() const { return arguments_; }
+
+    /// 方法帧内 this 的槽位（Resolver 回填）
+    const VarSlot& this_slot() const { return this_slot_; }
+    void set_this_slot(const VarSlot& slot) const { this_slot_ = slot; }
 
 private:
     Token keyword_;  // base 关键字 token，用于错误报告
     Token method_;   // 方法名 token
-    std::vector<std::unique_ptr<Expr>> arguments_;
+    std::vector<ExprPtr> arguments_;
+    mutable VarSlot this_slot_;
 };
 
 /**
@@ -573,9 +701,9 @@ public:
      * @param else_branch else 分支语句（可选）
      */
     IfStmt(Token if_token,
-           std::unique_ptr<Expr> condition,
-           std::unique_ptr<Stmt> then_branch,
-           std::unique_ptr<Stmt> else_branch = nullptr)
+           ExprPtr condition,
+           StmtPtr then_branch,
+           StmtPtr else_branch = nullptr)
         : if_token_(if_token),
           condition_(std::move(condition)),
           then_branch_(std::move(then_branch)),
@@ -590,9 +718,9 @@ public:
 
 private:
     Token if_token_;
-    std::unique_ptr<Expr> condition_;
-    std::unique_ptr<Stmt> then_branch_;
-    std::unique_ptr<Stmt> else_branch_;
+    ExprPtr condition_;
+    StmtPtr then_branch_;
+    StmtPtr else_branch_;
 };
 
 /**
@@ -608,8 +736,8 @@ public:
      * @param body 循环体
      */
     WhileStmt(Token while_token,
-              std::unique_ptr<Expr> condition,
-              std::unique_ptr<Stmt> body)
+              ExprPtr condition,
+              StmtPtr body)
         : while_token_(while_token),
           condition_(std::move(condition)),
           body_(std::move(body)) {}
@@ -622,8 +750,8 @@ public:
 
 private:
     Token while_token_;
-    std::unique_ptr<Expr> condition_;
-    std::unique_ptr<Stmt> body_;
+    ExprPtr condition_;
+    StmtPtr body_;
 };
 
 /**
@@ -641,10 +769,10 @@ public:
      * @param body 循环体
      */
     ForStmt(Token for_token,
-            std::unique_ptr<Stmt> initializer,
-            std::unique_ptr<Expr> condition,
-            std::unique_ptr<Expr> increment,
-            std::unique_ptr<Stmt> body)
+            StmtPtr initializer,
+            ExprPtr condition,
+            ExprPtr increment,
+            StmtPtr body)
         : for_token_(for_token),
           initializer_(std::move(initializer)),
           condition_(std::move(condition)),
@@ -661,10 +789,10 @@ public:
 
 private:
     Token for_token_;
-    std::unique_ptr<Stmt> initializer_;  // 可以是变量声明或表达式语句
-    std::unique_ptr<Expr> condition_;    // 可以为空
-    std::unique_ptr<Expr> increment_;    // 可以为空
-    std::unique_ptr<Stmt> body_;
+    StmtPtr initializer_;  // 可以是变量声明或表达式语句
+    ExprPtr condition_;    // 可以为空
+    ExprPtr increment_;    // 可以为空
+    StmtPtr body_;
 };
 
 /**
@@ -674,8 +802,8 @@ private:
 class DoWhileStmt : public Stmt {
 public:
     DoWhileStmt(Token do_token,
-                std::unique_ptr<Stmt> body,
-                std::unique_ptr<Expr> condition)
+                StmtPtr body,
+                ExprPtr condition)
         : do_token_(do_token),
           body_(std::move(body)),
           condition_(std::move(condition)) {}
@@ -688,8 +816,8 @@ public:
 
 private:
     Token do_token_;
-    std::unique_ptr<Stmt> body_;
-    std::unique_ptr<Expr> condition_;
+    StmtPtr body_;
+    ExprPtr condition_;
 };
 
 /**
@@ -697,8 +825,8 @@ private:
  * Collie 语法：无 case 关键字，值直接跟 {} 块
  */
 struct SwitchCase {
-    std::vector<std::unique_ptr<Expr>> values; ///< 匹配值列表（空表示 default）
-    std::unique_ptr<Stmt> body;                ///< 执行体（块语句）
+    std::vector<ExprPtr> values; ///< 匹配值列表（空表示 default）
+    StmtPtr body;                ///< 执行体（块语句）
     bool is_default = false;                   ///< 是否为 default 分支
 };
 
@@ -709,7 +837,7 @@ struct SwitchCase {
 class SwitchStmt : public Stmt {
 public:
     SwitchStmt(Token switch_token,
-               std::unique_ptr<Expr> condition,
+               ExprPtr condition,
                std::vector<SwitchCase> cases)
         : switch_token_(switch_token),
           condition_(std::move(condition)),
@@ -723,7 +851,7 @@ public:
 
 private:
     Token switch_token_;
-    std::unique_ptr<Expr> condition_;
+    ExprPtr condition_;
     std::vector<SwitchCase> cases_;
 };
 
@@ -750,7 +878,7 @@ public:
      */
     FunctionStmt(Token type, Token name,
                 std::vector<Parameter> parameters,
-                std::unique_ptr<BlockStmt> body,
+                AstPtr<BlockStmt> body,
                 bool is_override = false);
 
     void accept(StmtVisitor& visitor) const override;
@@ -761,12 +889,30 @@ public:
     const BlockStmt* body() const { return body_.get(); }
     bool is_override() const { return is_override_; }
 
+    // ---- 帧布局（Resolver 回填）----
+    // 形参依次占帧内槽位 0..n-1；类方法/构造器 this 占槽位 0，形参顺延为 1..n
+
+    /// 函数名在声明所在帧内的槽位（类方法不占槽，保持 -1）
+    int slot() const { return slot_; }
+    /// 一次调用所需的帧槽位数（形参 + 体内全部局部变量，块间复用）
+    int frame_size() const { return frame_size_; }
+    /// 词法外层函数（顶层函数/顶层类的方法为 nullptr，外层帧即全局帧）
+    const FunctionStmt* enclosing() const { return enclosing_; }
+    void set_layout(int slot, int frame_size, const FunctionStmt* enclosing) const {
+        slot_ = slot;
+        frame_size_ = frame_size;
+        enclosing_ = enclosing;
+    }
+
 private:
     Token return_type_;
     Token name_;
     std::vector<Parameter> parameters_;
-    std::unique_ptr<BlockStmt> body_;
+    AstPtr<BlockStmt> body_;
     bool is_override_;  // @override 标注（覆写校验由语义层执行）
+    mutable int slot_ = -1;
+    mutable int frame_size_ = 0;
+    mutable const FunctionStmt* enclosing_ = nullptr;
 };
 
 /**
@@ -781,20 +927,25 @@ public:
      * @param paren 右括号的位置（用于错误报告）
      * @param arguments 参数列表
      */
-    CallExpr(std::unique_ptr<Expr> callee,
+    CallExpr(ExprPtr callee,
             Token paren,
-            std::vector<std::unique_ptr<Expr>> arguments);
+            std::vector<ExprPtr> arguments);
 
     void accept(ExprVisitor& visitor) const override;
 
     const Expr* callee() const { return callee_.get(); }
     const Token& paren() const { return paren_; }
-    const std::vector<std::unique_ptr<Expr>>& arguments() const { return arguments_; }
+    const std::vector<ExprPtr>& arguments() const { return arguments_; }
+
+    /// 被调名字对应的内建函数（Resolver 回填；None 为用户函数调用）
+    BuiltinFunction builtin() const { return builtin_; }
+    void set_builtin(BuiltinFunction builtin) const { builtin_ = builtin; }
 
 private:
-    std::unique_ptr<Expr> callee_;
+    ExprPtr callee_;
     Token paren_;
-    std::vector<std::unique_ptr<Expr>> arguments_;
+    std::vector<ExprPtr> arguments_;
+    mutable BuiltinFunction builtin_ = BuiltinFunction::None;
 };
 
 /**
@@ -807,7 +958,7 @@ public:
      * @param keyword return 关键字的 token，用于错误报告
      * @param value 返回值表达式（可选）
      */
-    ReturnStmt(Token keyword, std::unique_ptr<Expr> value)
+    ReturnStmt(Token keyword, ExprPtr value)
         : keyword_(keyword), value_(std::move(value)) {}
 
     void accept(StmtVisitor& visitor) const override;
@@ -815,9 +966,14 @@ public:
     const Token& keyword() const { return keyword_; }
     const Expr* value() const { return value_.get(); }
 
+    /// 是否为尾调用 return f(...)（Resolver 回填：仅普通函数体内、返回值为用户函数调用）
+    bool tail_call() const { return tail_call_; }
+    void set_tail_call(bool tail_call) const { tail_call_ = tail_call; }
+
 private:
     Token keyword_;
-    std::unique_ptr<Expr> value_;
+    ExprPtr value_;
+    mutable bool tail_call_ = false;
 };
 
 /**
@@ -966,7 +1122,7 @@ public:
      * @param members 类成员列表
      */
     ClassStmt(Token name, Token superclass,
-              std::vector<std::unique_ptr<Stmt>> members)
+              std::vector<StmtPtr> members)
         : name_(name), superclass_(superclass), members_(std::move(members)) {}
     void accept(StmtVisitor& visitor) const override;
     const Token& name() const { return name_; }
@@ -974,12 +1130,12 @@ public:
     bool has_superclass() const {
         return superclass_.type() != TokenType::INVALID;
     }
-    const std::vector<std::unique_ptr<Stmt>>& members() const { return members_; }
+    const std::vector<StmtPtr>& members() const { return members_; }
 
 private:
     Token name_;                                    // 类名
     Token superclass_;                              // 父类名（可选）
-    std::vector<std::unique_ptr<Stmt>> members_;   // 类成员列表
+    std::vector<StmtPtr> members_;   // 类成员列表
 };
 
 /**
@@ -1028,7 +1184,7 @@ private:
  */
 class ArrayType : public Type {
 public:
-    ArrayType(std::unique_ptr<Type> element_type)
+    ArrayType(TypePtr element_type)
         : element_type_(std::move(element_type)) {}
     void accept(TypeVisitor& visitor) const override {
         visitor.visitArrayType(*this);
@@ -1036,7 +1192,7 @@ public:
     const Type& element_type() const { return *element_type_; }
 
 private:
-    std::unique_ptr<Type> element_type_;
+    TypePtr element_type_;
 };
 
 /**
@@ -1044,17 +1200,17 @@ private:
  */
 class TupleType : public Type {
 public:
-    TupleType(std::vector<std::unique_ptr<Type>> element_types)
+    TupleType(std::vector<TypePtr> element_types)
         : element_types_(std::move(element_types)) {}
     void accept(TypeVisitor& visitor) const override {
         visitor.visitTupleType(*this);
     }
-    const std::vector<std::unique_ptr<Type>>& element_types() const {
+    const std::vector<TypePtr>& element_types() const {
         return element_types_;
     }
 
 private:
-    std::vector<std::unique_ptr<Type>> element_types_;
+    std::vector<TypePtr> element_types_;
 };
 
 // 元组表达式节点（t45，见 03-tuple.md）
@@ -1064,12 +1220,12 @@ private:
 // 均复用现有 Index/Property/MethodCall 节点，不再有专用成员节点。
 class TupleExpr : public Expr {
 public:
-    TupleExpr(std::vector<std::unique_ptr<Expr>> elements,
+    TupleExpr(std::vector<ExprPtr> elements,
               std::vector<std::string> names, const Token& paren)
         : elements_(std::move(elements)), names_(std::move(names)),
           paren_(paren) {}
 
-    const std::vector<std::unique_ptr<Expr>>& elements() const {
+    const std::vector<ExprPtr>& elements() const {
         return elements_;
     }
     /// 元素名字（与 elements 等长；无名元素为空串）
@@ -1079,7 +1235,7 @@ public:
     void accept(ExprVisitor& visitor) const override;
 
 private:
-    std::vector<std::unique_ptr<Expr>> elements_;
+    std::vector<ExprPtr> elements_;
     std::vector<std::string> names_;
     Token paren_;  // 左括号位置，用于错误报告
 };
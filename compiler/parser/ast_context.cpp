@@ -0,0 +1,17 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: AST 上下文实现
+ */
+#include "ast_context.h"
+
+namespace collie {
+
+AstContext::~AstContext() {
+    // 节点析构只释放自身成员（子节点句柄列表等），不访问其他节点；逆序只为与创建对称
+    for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+        it->destroy(it->node);
+    }
+}
+
+} // namespace collie
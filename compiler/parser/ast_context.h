@@ -0,0 +1,117 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: AST 的内存归属：节点线性分配、词素驻留，整棵树一次释放
+ */
+#ifndef COLLIE_AST_CONTEXT_H
+#define COLLIE_AST_CONTEXT_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "../lexer/string_pool.h"
+#include "../utils/arena.h"
+
+namespace collie {
+
+/**
+ * @brief AST 上下文：一棵语法树所有节点与词素的唯一所有者
+ *
+ * 节点在 Arena 上就地构造，只有带非平凡成员（如子节点列表）的节点才登记析构函数；
+ * 销毁时按创建的逆序调用这些析构函数后整体归还内存块，不再沿树递归逐个 delete。
+ * 节点内的 token 词素驻留在本上下文的字符串池中，与源码缓冲区及词法分析器无关。
+ */
+class AstContext {
+public:
+    AstContext() = default;
+    ~AstContext();
+
+    AstContext(const AstContext&) = delete;
+    AstContext& operator=(const AstContext&) = delete;
+
+    /// @brief 在上下文中创建节点
+    template <typename T, typename... Args>
+    AstPtr<T> make(Args&&... args) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            // 先扩容再构造：构造成功后的登记不得失败
+            if (destructors_.size() == destructors_.capacity()) {
+                destructors_.reserve(destructors_.empty() ? 64 : destructors_.capacity() * 2);
+            }
+        }
+        void* memory = arena_.allocate(sizeof(T), alignof(T));
+        T* node = new (memory) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            destructors_.push_back({node, [](void* p) { static_cast<T*>(p)->~T(); }});
+        }
+        ++node_count_;
+        return AstPtr<T>(node);
+    }
+
+    /// @brief 驻留一段文本，返回在本上下文存续期间有效的视图
+    std::string_view intern(std::string_view text) { return strings_.intern(text); }
+
+    /// @brief 返回词素已驻留到本上下文的 token 副本；需解码的字面量在此还原为字面值
+    Token intern(const Token& token) {
+        std::string_view text = token.form() == LexemeForm::Exact
+                                    ? strings_.intern(token.lexeme())
+                                    : strings_.intern(decode_lexeme(token));
+        return Token(token.type(), text, token.line(), token.column());
+    }
+
+    /// @brief 已创建的节点数
+    size_t node_count() const { return node_count_; }
+
+    /// @brief 节点与词素占用的内存字节数
+    size_t bytes_reserved() const {
+        return arena_.bytes_reserved() + strings_.bytes_reserved();
+    }
+
+private:
+    struct Destructor {
+        void* node;
+        void (*destroy)(void*);
+    };
+
+    Arena arena_;
+    StringPool strings_;
+    std::vector<Destructor> destructors_;
+    size_t node_count_ = 0;
+};
+
+/**
+ * @brief 解析结果：顶层语句列表及其所属的 AST 上下文
+ *
+ * 可直接当作 const std::vector<StmtPtr>& 传给语义分析、解释器与代码生成。
+ * 上下文以 shared_ptr 持有：Parser 与解析结果共享同一棵树，任一方存活时节点都有效。
+ */
+class ParsedProgram {
+public:
+    ParsedProgram() = default;
+    ParsedProgram(std::shared_ptr<AstContext> context, std::vector<StmtPtr> statements)
+        : context_(std::move(context)), statements_(std::move(statements)) {}
+
+    const std::vector<StmtPtr>& statements() const { return statements_; }
+    operator const std::vector<StmtPtr>&() const { return statements_; }
+
+    std::vector<StmtPtr>::const_iterator begin() const { return statements_.begin(); }
+    std::vector<StmtPtr>::const_iterator end() const { return statements_.end(); }
+    size_t size() const { return statements_.size(); }
+    bool empty() const { return statements_.empty(); }
+    const StmtPtr& operator[](size_t index) const { return statements_[index]; }
+
+    /// @brief 所属的 AST 上下文（空程序时可能为空）
+    const std::shared_ptr<AstContext>& context() const { return context_; }
+
+private:
+    std::shared_ptr<AstContext> context_;  // 须先于 statements_ 声明：后析构
+    std::vector<StmtPtr> statements_;
+};
+
+} // namespace collie
+
+#endif // COLLIE_AST_CONTEXT_H
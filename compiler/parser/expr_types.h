@@ -0,0 +1,120 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 表达式静态类型表：语义分析的类型结论按 AST 节点导出，供执行引擎选择专用路径
+ */
+#ifndef COLLIE_EXPR_TYPES_H
+#define COLLIE_EXPR_TYPES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "../lexer/token.h"
+
+namespace collie {
+
+/**
+ * @brief 表达式静态类型表（AST 节点 -> 类型关键字，如 KW_NUMBER / KW_STRING）
+ *
+ * 由 SemanticAnalyzer 在分析时填写，只收录运行期值的种类可由静态规则保证的表达式：
+ * 字面量、声明时已初始化的受检类型变量与形参、受检返回类型的函数调用，以及由它们
+ * 组成的算术/比较/逻辑运算等。数值类型（number/integer/decimal/byte/word）只保证
+ * 值为 number，不保证整数或小数表示；object、类名与未收录的表达式按动态类型处理。
+ *
+ * 表只在所属 AST 存活期间有效；Resolver 把它回填到各节点（Expr::static_type），
+ * 执行期不再查表。
+ *
+ * 存储为以节点地址为键的开放寻址表（线性探测，容量为 2 的幂，装载率不超过 3/4）：
+ * 几乎每个表达式节点都要登记一次，比逐个分配结点的 unordered_map 省去大量分配；
+ * 并行分析时各线程各填一张表，最后用 merge 合并。
+ */
+class ExprTypeTable {
+public:
+    void record(const Expr& expr, TokenType type) {
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            grow();
+        }
+        Slot& slot = slots_[probe(&expr)];
+        if (slot.expr == nullptr) {
+            slot.expr = &expr;
+            ++size_;
+        }
+        slot.type = type;
+    }
+
+    /// @brief 节点的静态类型，未收录时返回 INVALID
+    TokenType type_of(const Expr* expr) const {
+        if (size_ == 0 || expr == nullptr) {
+            return TokenType::INVALID;
+        }
+        const Slot& slot = slots_[probe(expr)];
+        return slot.expr == expr ? slot.type : TokenType::INVALID;
+    }
+
+    /// @brief 并入另一张表的全部记录（同一节点以 other 为准）
+    void merge(const ExprTypeTable& other) {
+        // 先扩到足够容量：按槽位顺序（即散列顺序）插入更小的表会形成长探测串
+        reserve(size_ + other.size_);
+        for (const Slot& slot : other.slots_) {
+            if (slot.expr != nullptr) {
+                record(*slot.expr, slot.type);
+            }
+        }
+    }
+
+    size_t size() const { return size_; }
+    void clear() {
+        slots_.clear();
+        size_ = 0;
+    }
+
+private:
+    struct Slot {
+        const Expr* expr = nullptr;  // nullptr 表示空槽
+        TokenType type = TokenType::INVALID;
+    };
+
+    // 节点所在的槽位，或探测序列上遇到的第一个空槽
+    size_t probe(const Expr* expr) const {
+        // 节点按 8 字节对齐分配，低位恒为 0：乘法散列取高位
+        uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(expr)) *
+                        0x9E3779B97F4A7C15ull;
+        size_t mask = slots_.size() - 1;
+        for (size_t i = static_cast<size_t>(hash >> 32) & mask;; i = (i + 1) & mask) {
+            if (slots_[i].expr == expr || slots_[i].expr == nullptr) {
+                return i;
+            }
+        }
+    }
+
+    void reserve(size_t count) {
+        size_t capacity = slots_.empty() ? 1024 : slots_.size();
+        while (count * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+        if (capacity != slots_.size()) {
+            rehash(capacity);
+        }
+    }
+
+    void grow() { rehash(slots_.empty() ? 1024 : slots_.size() * 2); }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(capacity, Slot{});
+        for (const Slot& slot : old) {
+            if (slot.expr != nullptr) {
+                slots_[probe(slot.expr)] = slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+} // namespace collie
+
+#endif // COLLIE_EXPR_TYPES_H
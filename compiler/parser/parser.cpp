@@ -12,17 +12,12 @@
  * statement   → exprStmt | block | ifStmt | whileStmt | forStmt
  *             | returnStmt | breakStmt | continueStmt
  *
- * 表达式的优先级（从高到低）：
+ * 表达式使用优先级爬升（Pratt）解析，中缀运算符的优先级见下方 infix_rules 表
+ * （从低到高）：赋值、三元 / ==?、||、&&、|、^、&、相等、关系、移位、加减、乘除；
+ * 其上为一元运算与后缀链：
  * primary     → NUMBER | STRING | BOOL | IDENTIFIER | "(" expression ")"
- * unary       → ("!" | "-") unary | primary
- * factor      → unary (("*" | "/" | "%") unary)*
- * term        → factor (("+" | "-") factor)*
- * comparison  → term ((">" | ">=" | "<" | "<=") term)*
- * equality    → comparison (("==" | "!=") comparison)*
- * logicalAnd  → equality ("&&" equality)*
- * logicalOr   → logicalAnd ("||" logicalAnd)*
- * assignment  → IDENTIFIER "=" assignment | logicalOr
- * expression  → assignment
+ * unary       → ("!" | "-" | "~") unary | primary ("[" expression "]" | "." IDENTIFIER call?)*
+ * expression  → unary (infixOp expression)*
  */
 #include "parser.h"
 #include <cassert>
@@ -44,8 +39,19 @@ namespace collie {
  * 程序由一系列声明和语句组成，直到文件结束。
  * 每个声明或语句都可能产生错误，但解析器会尝试继续处理后续内容。
  */
-std::vector<std::unique_ptr<Stmt>> Parser::parse_program() {
-    std::vector<std::unique_ptr<Stmt>> statements;
+Parser::Parser(const std::vector<Token>& tokens)
+    : Parser(tokens, std::make_shared<AstContext>()) {}
+
+Parser::Parser(const std::vector<Token>& tokens, std::shared_ptr<AstContext> context)
+    : context_(std::move(context)), tokens_(tokens, *context_), current_(0), nesting_depth_(0),
+      in_panic_mode_(false) {}
+
+Parser::Parser(Lexer& lexer)
+    : context_(std::make_shared<AstContext>()), tokens_(lexer, *context_), current_(0),
+      nesting_depth_(0), in_panic_mode_(false) {}
+
+ParsedProgram Parser::parse_program() {
+    std::vector<StmtPtr> statements;
 
     while (!is_at_end()) {
         // 记录本轮开始前的游标位置，用于死循环防护
@@ -68,7 +74,7 @@ std::vector<std::unique_ptr<Stmt>> Parser::parse_program() {
         }
     }
 
-    return statements;
+    return ParsedProgram(context_, std::move(statements));
 }
 
 // -----------------------------------------------------------------------------
@@ -84,7 +90,7 @@ std::vector<std::unique_ptr<Stmt>> Parser::parse_program() {
  * 2. 函数声明（以 function 开头）
  * 3. 其他语句
  */
-std::unique_ptr<Stmt> Parser::parse_declaration() {
+StmtPtr Parser::parse_declaration() {
     try {
         // const 前缀：`const number x = 42;`
         bool is_const = match(TokenType::KW_CONST);
@@ -151,7 +157,7 @@ std::unique_ptr<Stmt> Parser::parse_declaration() {
  * @brief 解析类型声明语句
  * @return 变量声明的AST节点
  */
-std::unique_ptr<Stmt> Parser::parse_type_declaration(bool is_const) {
+StmtPtr Parser::parse_type_declaration(bool is_const) {
     try {
         // 记录类型 token
         Token type = previous();
@@ -160,7 +166,7 @@ std::unique_ptr<Stmt> Parser::parse_type_declaration(bool is_const) {
         Token name = consume(TokenType::IDENTIFIER, "Expect variable name.");
 
         // 解析可选的初始化表达式
-        std::unique_ptr<Expr> initializer = nullptr;
+        ExprPtr initializer = nullptr;
         if (match(TokenType::OP_ASSIGN)) {
             initializer = parse_expression();
             if (!initializer) {
@@ -174,7 +180,7 @@ std::unique_ptr<Stmt> Parser::parse_type_declaration(bool is_const) {
         // 确保语句以分号结束
         consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after variable declaration.");
 
-        return std::make_unique<VarDeclStmt>(type, name, std::move(initializer), is_const);
+        return make<VarDeclStmt>(type, name, std::move(initializer), is_const);
 
     } catch (const ParseError& error) {
         report_error(error);
@@ -187,24 +193,87 @@ std::unique_ptr<Stmt> Parser::parse_type_declaration(bool is_const) {
 // 表达式解析方法
 // -----------------------------------------------------------------------------
 
+namespace {
+
+/// 中缀运算符表项：优先级与缺少右操作数时的报错文本
+struct InfixRule {
+    Precedence precedence = Precedence::None;
+    const char* operand_error = nullptr;
+};
+
+struct InfixEntry {
+    TokenType type;
+    InfixRule rule;
+};
+
+// 位运算优先级（t47，与 C 家族一致）：`|` < `^` < `&` < 相等比较；
+// 移位 `<< >>` 另居关系比较与加减之间
+constexpr InfixEntry infix_list[] = {
+    {TokenType::OP_ASSIGN,          {Precedence::Assignment, "Expect expression after '='."}},
+    {TokenType::OP_PLUS_ASSIGN,     {Precedence::Assignment, "Expect expression after compound assignment operator."}},
+    {TokenType::OP_MINUS_ASSIGN,    {Precedence::Assignment, "Expect expression after compound assignment operator."}},
+    {TokenType::OP_MULTIPLY_ASSIGN, {Precedence::Assignment, "Expect expression after compound assignment operator."}},
+    {TokenType::OP_DIVIDE_ASSIGN,   {Precedence::Assignment, "Expect expression after compound assignment operator."}},
+    {TokenType::OP_MODULO_ASSIGN,   {Precedence::Assignment, "Expect expression after compound assignment operator."}},
+    {TokenType::OP_QUESTION,        {Precedence::Ternary, "Expect expression after '?'."}},
+    {TokenType::OP_EQ_QUESTION,     {Precedence::Ternary, "Expect expression in '==?' expression."}},
+    {TokenType::OP_OR,              {Precedence::LogicalOr, "Expect expression after '||'."}},
+    {TokenType::OP_AND,             {Precedence::LogicalAnd, "Expect expression after '&&'."}},
+    {TokenType::OP_BIT_OR,          {Precedence::BitOr, "Expect expression after '|'."}},
+    {TokenType::OP_BIT_XOR,         {Precedence::BitXor, "Expect expression after '^'."}},
+    {TokenType::OP_BIT_AND,         {Precedence::BitAnd, "Expect expression after '&'."}},
+    {TokenType::OP_EQUAL,           {Precedence::Equality, "Expect expression after equality operator."}},
+    {TokenType::OP_NOT_EQUAL,       {Precedence::Equality, "Expect expression after equality operator."}},
+    {TokenType::OP_GREATER,         {Precedence::Comparison, "Expect expression after comparison operator."}},
+    {TokenType::OP_GREATER_EQ,      {Precedence::Comparison, "Expect expression after comparison operator."}},
+    {TokenType::OP_LESS,            {Precedence::Comparison, "Expect expression after comparison operator."}},
+    {TokenType::OP_LESS_EQ,         {Precedence::Comparison, "Expect expression after comparison operator."}},
+    {TokenType::OP_BIT_LSHIFT,      {Precedence::Shift, "Expect expression after shift operator."}},
+    {TokenType::OP_BIT_RSHIFT,      {Precedence::Shift, "Expect expression after shift operator."}},
+    {TokenType::OP_PLUS,            {Precedence::Term, "Expect expression after '+' or '-'."}},
+    {TokenType::OP_MINUS,           {Precedence::Term, "Expect expression after '+' or '-'."}},
+    {TokenType::OP_MULTIPLY,        {Precedence::Factor, "Expect expression after '*', '/' or '%'."}},
+    {TokenType::OP_DIVIDE,          {Precedence::Factor, "Expect expression after '*', '/' or '%'."}},
+    {TokenType::OP_MODULO,          {Precedence::Factor, "Expect expression after '*', '/' or '%'."}},
+};
+
+// 按 TokenType 直接索引（DELIMITER_DOT 为枚举的最后一项）
+constexpr size_t token_type_count = static_cast<size_t>(TokenType::DELIMITER_DOT) + 1;
+
+struct InfixTable {
+    InfixRule rules[token_type_count] = {};
+};
+
+constexpr InfixTable build_infix_table() {
+    InfixTable table;
+    for (const InfixEntry& entry : infix_list) {
+        table.rules[static_cast<size_t>(entry.type)] = entry.rule;
+    }
+    return table;
+}
+
+constexpr InfixTable infix_table = build_infix_table();
+
+constexpr const InfixRule& infix_rule(TokenType type) {
+    return infix_table.rules[static_cast<size_t>(type)];
+}
+
+// 左结合运算符的右操作数只吸收更高一级的运算符
+constexpr Precedence next_precedence(Precedence precedence) {
+    return static_cast<Precedence>(static_cast<unsigned char>(precedence) + 1);
+}
+
+} // namespace
+
 /**
  * @brief 解析表达式
  * @return 表达式的AST节点
  *
- * 表达式解析遵循运算符优先级规则：
- * 1. 赋值
- * 2. 逻辑或
- * 3. 逻辑与
- * 4. 相等性比较
- * 5. 关系比较
- * 6. 加减
- * 7. 乘除
- * 8. 一元运算
- * 9. 基本表达式
+ * 从最低优先级（赋值）开始按优先级爬升解析，见 parse_precedence。
  */
-std::unique_ptr<Expr> Parser::parse_expression() {
+ExprPtr Parser::parse_expression() {
     try {
-        auto expr = parse_assignment();
+        auto expr = parse_precedence(Precedence::Assignment);
         if (!expr) {
             throw error(peek(), "Expect expression.");
         }
@@ -217,109 +286,121 @@ std::unique_ptr<Expr> Parser::parse_expression() {
     }
 }
 
-std::unique_ptr<Expr> Parser::parse_assignment() {
-    auto expr = parse_ternary();
+ExprPtr Parser::parse_precedence(Precedence min_precedence) {
+    auto expr = parse_unary();
     if (!expr) {
         throw error(peek(), "Expect expression.");
     }
 
-    if (match(TokenType::OP_ASSIGN)) {
-        Token equals = previous();
-        auto value = parse_assignment();
-        if (!value) {
-            throw error(peek(), "Expect expression after '='.");
+    while (true) {
+        const InfixRule& rule = infix_rule(peek().type());
+        if (rule.precedence == Precedence::None || rule.precedence < min_precedence) {
+            break;
         }
 
-        if (auto* identifier = dynamic_cast<IdentifierExpr*>(expr.get())) {
+        switch (rule.precedence) {
+            case Precedence::Assignment:
+                // 赋值右结合且不能再作为其他运算符的左操作数
+                return finish_assignment(std::move(expr));
+            case Precedence::Ternary:
+                expr = finish_ternary(std::move(expr));
+                break;
+            default: {
+                Token op = advance();
+                auto right = parse_precedence(next_precedence(rule.precedence));
+                if (!right) {
+                    throw error(peek(), rule.operand_error);
+                }
+                expr = make<BinaryExpr>(std::move(expr), op, std::move(right));
+                break;
+            }
+        }
+    }
+
+    return expr;
+}
+
+ExprPtr Parser::finish_assignment(ExprPtr target) {
+    Token op_token = advance();
+    auto value = parse_precedence(Precedence::Assignment);
+    if (!value) {
+        throw error(peek(), infix_rule(op_token.type()).operand_error);
+    }
+
+    if (op_token.type() == TokenType::OP_ASSIGN) {
+        if (auto* identifier = dynamic_cast<IdentifierExpr*>(target.get())) {
             Token name = identifier->name();
-            return std::make_unique<AssignExpr>(name, std::move(value));
+            return make<AssignExpr>(name, std::move(value));
         }
 
         // 索引赋值：arr[i] = value
-        if (auto* index = dynamic_cast<IndexExpr*>(expr.get())) {
+        if (auto* index = dynamic_cast<IndexExpr*>(target.get())) {
             // 从原 IndexExpr 中取回子表达式的所有权，重组为 IndexAssignExpr。
             Token bracket = index->bracket();
             auto object = index->take_object();
             auto index_expr = index->take_index();
-            return std::make_unique<IndexAssignExpr>(
+            return make<IndexAssignExpr>(
                 std::move(object), bracket, std::move(index_expr),
                 std::move(value));
         }
 
         // 属性赋值：obj.name = value（如 this.name = n）
-        if (auto* property = dynamic_cast<PropertyExpr*>(expr.get())) {
+        if (auto* property = dynamic_cast<PropertyExpr*>(target.get())) {
             // 从原 PropertyExpr 中取回对象子表达式，重组为 PropertyAssignExpr。
             Token name = property->name();
             auto object = property->take_object();
-            return std::make_unique<PropertyAssignExpr>(
+            return make<PropertyAssignExpr>(
                 std::move(object), name, std::move(value));
         }
 
-        throw error(equals, "Invalid assignment target.");
+        throw error(op_token, "Invalid assignment target.");
     }
 
     // 复合赋值运算符：+=, -=, *=, /=, %=
     // 脱糖为 x = x op expr
-    if (match({TokenType::OP_PLUS_ASSIGN, TokenType::OP_MINUS_ASSIGN,
-               TokenType::OP_MULTIPLY_ASSIGN, TokenType::OP_DIVIDE_ASSIGN,
-               TokenType::OP_MODULO_ASSIGN})) {
-        Token op_token = previous();
-        auto value = parse_assignment();
-        if (!value) {
-            throw error(peek(), "Expect expression after compound assignment operator.");
-        }
-
-        if (auto* identifier = dynamic_cast<IdentifierExpr*>(expr.get())) {
-            Token name = identifier->name();
-
-            // 确定对应的二元运算符
-            TokenType binary_op;
-            std::string_view op_lexeme;
-            switch (op_token.type()) {
-                case TokenType::OP_PLUS_ASSIGN:     binary_op = TokenType::OP_PLUS; op_lexeme = "+"; break;
-                case TokenType::OP_MINUS_ASSIGN:    binary_op = TokenType::OP_MINUS; op_lexeme = "-"; break;
-                case TokenType::OP_MULTIPLY_ASSIGN: binary_op = TokenType::OP_MULTIPLY; op_lexeme = "*"; break;
-                case TokenType::OP_DIVIDE_ASSIGN:   binary_op = TokenType::OP_DIVIDE; op_lexeme = "/"; break;
-                case TokenType::OP_MODULO_ASSIGN:   binary_op = TokenType::OP_MODULO; op_lexeme = "%"; break;
-                default: throw error(op_token, "Unknown compound assignment operator.");
-            }
-
-            // 构造 BinaryExpr: identifier op value
-            Token bin_op(binary_op, op_lexeme, op_token.line(), op_token.column());
-            auto lhs = std::make_unique<IdentifierExpr>(name);
-            auto binary = std::make_unique<BinaryExpr>(std::move(lhs), bin_op, std::move(value));
+    if (auto* identifier = dynamic_cast<IdentifierExpr*>(target.get())) {
+        Token name = identifier->name();
 
-            return std::make_unique<AssignExpr>(name, std::move(binary));
+        // 确定对应的二元运算符
+        TokenType binary_op;
+        std::string_view op_lexeme;
+        switch (op_token.type()) {
+            case TokenType::OP_PLUS_ASSIGN:     binary_op = TokenType::OP_PLUS; op_lexeme = "+"; break;
+            case TokenType::OP_MINUS_ASSIGN:    binary_op = TokenType::OP_MINUS; op_lexeme = "-"; break;
+            case TokenType::OP_MULTIPLY_ASSIGN: binary_op = TokenType::OP_MULTIPLY; op_lexeme = "*"; break;
+            case TokenType::OP_DIVIDE_ASSIGN:   binary_op = TokenType::OP_DIVIDE; op_lexeme = "/"; break;
+            case TokenType::OP_MODULO_ASSIGN:   binary_op = TokenType::OP_MODULO; op_lexeme = "%"; break;
+            default: throw error(op_token, "Unknown compound assignment operator.");
         }
 
-        throw error(op_token, "Invalid compound assignment target.");
+        // 构造 BinaryExpr: identifier op value
+        Token bin_op(binary_op, op_lexeme, op_token.line(), op_token.column());
+        auto lhs = make<IdentifierExpr>(name);
+        auto binary = make<BinaryExpr>(std::move(lhs), bin_op, std::move(value));
+
+        return make<AssignExpr>(name, std::move(binary));
     }
 
-    return expr;
+    throw error(op_token, "Invalid compound assignment target.");
 }
 
-std::unique_ptr<Expr> Parser::parse_ternary() {
-    auto expr = parse_logical_or();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
+ExprPtr Parser::finish_ternary(ExprPtr condition) {
     // `==?` 多路匹配（t44）：target ==? v1, v2: r1, v3: r2, default_r
     // 末尾裸表达式 = 默认分支；其余裸值与后面最近的「值: 结果」归组
     if (match(TokenType::OP_EQ_QUESTION)) {
         Token op = previous();
         std::vector<MultiMatchExpr::Branch> branches;
-        std::unique_ptr<Expr> default_expr;
-        std::vector<std::unique_ptr<Expr>> pending;  // 待归组的裸值
+        ExprPtr default_expr;
+        std::vector<ExprPtr> pending;  // 待归组的裸值
         while (true) {
-            auto item = parse_ternary();
+            auto item = parse_precedence(Precedence::Ternary);
             if (!item) {
                 throw error(peek(), "Expect expression in '==?' expression.");
             }
             if (match(TokenType::OP_COLON)) {
                 // item 与之前的裸值归为一组候选值
                 pending.push_back(std::move(item));
-                auto result = parse_ternary();
+                auto result = parse_precedence(Precedence::Ternary);
                 if (!result) {
                     throw error(peek(), "Expect result expression after ':' in '==?'.");
                 }
@@ -349,234 +430,43 @@ std::unique_ptr<Expr> Parser::parse_ternary() {
         if (branches.empty()) {
             throw error(op, "Expect at least one 'value: result' branch in '==?'.");
         }
-        return std::make_unique<MultiMatchExpr>(std::move(expr), op,
+        return make<MultiMatchExpr>(std::move(condition), op,
                                                 std::move(branches),
                                                 std::move(default_expr));
     }
 
-    if (match(TokenType::OP_QUESTION)) {
-        Token question = previous();
-        auto then_expr = parse_ternary();  // 右结合
-        if (!then_expr) {
-            throw error(peek(), "Expect expression after '?'.");
-        }
-        consume(TokenType::OP_COLON, "Expect ':' in ternary expression.");
-        auto else_expr = parse_ternary();  // 右结合
-        if (!else_expr) {
-            throw error(peek(), "Expect expression after ':'.");
-        }
-        // tribool 三分支形式（t43）：cond ? then : else : unset；
-        // 第二个 ':' 贪心归属最内层三元
-        std::unique_ptr<Expr> unset_expr;
-        if (match(TokenType::OP_COLON)) {
-            unset_expr = parse_ternary();
-            if (!unset_expr) {
-                throw error(peek(), "Expect expression after second ':'.");
-            }
-        }
-        return std::make_unique<TernaryExpr>(std::move(expr), question,
-                                             std::move(then_expr), std::move(else_expr),
-                                             std::move(unset_expr));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_logical_or() {
-    auto expr = parse_logical_and();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
+    Token question = consume(TokenType::OP_QUESTION, "Expect '?' in ternary expression.");
+    auto then_expr = parse_precedence(Precedence::Ternary);  // 右结合
+    if (!then_expr) {
+        throw error(peek(), "Expect expression after '?'.");
     }
-
-    while (match(TokenType::OP_OR)) {
-        Token op = previous();
-        auto right = parse_logical_and();
-        if (!right) {
-            throw error(peek(), "Expect expression after '||'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
+    consume(TokenType::OP_COLON, "Expect ':' in ternary expression.");
+    auto else_expr = parse_precedence(Precedence::Ternary);  // 右结合
+    if (!else_expr) {
+        throw error(peek(), "Expect expression after ':'.");
     }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_logical_and() {
-    auto expr = parse_bit_or();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match(TokenType::OP_AND)) {
-        Token op = previous();
-        auto right = parse_bit_or();
-        if (!right) {
-            throw error(peek(), "Expect expression after '&&'.");
+    // tribool 三分支形式（t43）：cond ? then : else : unset；
+    // 第二个 ':' 贪心归属最内层三元
+    ExprPtr unset_expr;
+    if (match(TokenType::OP_COLON)) {
+        unset_expr = parse_precedence(Precedence::Ternary);
+        if (!unset_expr) {
+            throw error(peek(), "Expect expression after second ':'.");
         }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
     }
-
-    return expr;
-}
-
-// 位运算优先级（t47，与 C 家族一致）：`|` < `^` < `&` < 相等比较；
-// 移位 `<< >>` 另居关系比较与加减之间（见 parse_shift）
-std::unique_ptr<Expr> Parser::parse_bit_or() {
-    auto expr = parse_bit_xor();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match(TokenType::OP_BIT_OR)) {
-        Token op = previous();
-        auto right = parse_bit_xor();
-        if (!right) {
-            throw error(peek(), "Expect expression after '|'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
+    return make<TernaryExpr>(std::move(condition), question,
+                                         std::move(then_expr), std::move(else_expr),
+                                         std::move(unset_expr));
 }
 
-std::unique_ptr<Expr> Parser::parse_bit_xor() {
-    auto expr = parse_bit_and();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match(TokenType::OP_BIT_XOR)) {
-        Token op = previous();
-        auto right = parse_bit_and();
-        if (!right) {
-            throw error(peek(), "Expect expression after '^'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_bit_and() {
-    auto expr = parse_equality();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match(TokenType::OP_BIT_AND)) {
-        Token op = previous();
-        auto right = parse_equality();
-        if (!right) {
-            throw error(peek(), "Expect expression after '&'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_equality() {
-    auto expr = parse_comparison();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match({TokenType::OP_EQUAL, TokenType::OP_NOT_EQUAL})) {
-        Token op = previous();
-        auto right = parse_comparison();
-        if (!right) {
-            throw error(peek(), "Expect expression after equality operator.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_comparison() {
-    auto expr = parse_shift();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match({
-        TokenType::OP_GREATER,
-        TokenType::OP_GREATER_EQ,
-        TokenType::OP_LESS,
-        TokenType::OP_LESS_EQ
-    })) {
-        Token op = previous();
-        auto right = parse_shift();
-        if (!right) {
-            throw error(peek(), "Expect expression after comparison operator.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_shift() {
-    auto expr = parse_term();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match({TokenType::OP_BIT_LSHIFT, TokenType::OP_BIT_RSHIFT})) {
-        Token op = previous();
-        auto right = parse_term();
-        if (!right) {
-            throw error(peek(), "Expect expression after shift operator.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_term() {
-    auto expr = parse_factor();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match({TokenType::OP_PLUS, TokenType::OP_MINUS})) {
-        Token op = previous();
-        auto right = parse_factor();
-        if (!right) {
-            throw error(peek(), "Expect expression after '+' or '-'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_factor() {
-    auto expr = parse_unary();
-    if (!expr) {
-        throw error(peek(), "Expect expression.");
-    }
-
-    while (match({TokenType::OP_MULTIPLY, TokenType::OP_DIVIDE, TokenType::OP_MODULO})) {
-        Token op = previous();
-        auto right = parse_unary();
-        if (!right) {
-            throw error(peek(), "Expect expression after '*', '/' or '%'.");
-        }
-        expr = std::make_unique<BinaryExpr>(std::move(expr), op, std::move(right));
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::parse_unary() {
+ExprPtr Parser::parse_unary() {
     if (match({TokenType::OP_NOT, TokenType::OP_MINUS, TokenType::OP_BIT_NOT})) {
         Token op = previous();
         auto right = parse_unary();
         if (!right) {
             throw error(peek(), "Expect expression after unary operator.");
         }
-        return std::make_unique<UnaryExpr>(op, std::move(right));
+        return make<UnaryExpr>(op, std::move(right));
     }
 
     auto expr = parse_primary();
@@ -594,7 +484,7 @@ std::unique_ptr<Expr> Parser::parse_unary() {
                 throw error(peek(), "Expect index expression inside '[]'.");
             }
             consume(TokenType::DELIMITER_RBRACKET, "Expect ']' after index expression.");
-            expr = std::make_unique<IndexExpr>(std::move(expr), bracket,
+            expr = make<IndexExpr>(std::move(expr), bracket,
                                                std::move(index));
             continue;
         }
@@ -603,11 +493,11 @@ std::unique_ptr<Expr> Parser::parse_unary() {
             Token name = consume(TokenType::IDENTIFIER, "Expect member name after '.'.");
             // 带括号为方法调用，无括号为属性访问（如 str.length）
             if (!check(TokenType::DELIMITER_LPAREN)) {
-                expr = std::make_unique<PropertyExpr>(std::move(expr), name);
+                expr = make<PropertyExpr>(std::move(expr), name);
                 continue;
             }
             advance(); // 消费 '('
-            std::vector<std::unique_ptr<Expr>> arguments;
+            std::vector<ExprPtr> arguments;
             if (!check(TokenType::DELIMITER_RPAREN)) {
                 do {
                     auto argument = parse_expression();
@@ -618,7 +508,7 @@ std::unique_ptr<Expr> Parser::parse_unary() {
                 } while (match(TokenType::DELIMITER_COMMA));
             }
             consume(TokenType::DELIMITER_RPAREN, "Expect ')' after method arguments.");
-            expr = std::make_unique<MethodCallExpr>(std::move(expr), name,
+            expr = make<MethodCallExpr>(std::move(expr), name,
                                                     std::move(arguments));
             continue;
         }
@@ -628,15 +518,15 @@ std::unique_ptr<Expr> Parser::parse_unary() {
     return expr;
 }
 
-std::unique_ptr<Expr> Parser::parse_primary() {
+ExprPtr Parser::parse_primary() {
     if (match(TokenType::LITERAL_NUMBER)) {
-        return std::make_unique<LiteralExpr>(previous());
+        return make<LiteralExpr>(previous());
     }
 
     // 数组字面量：[a, b, c]，允许尾逗号，空数组为 []
     if (check(TokenType::DELIMITER_LBRACKET)) {
         Token bracket = advance();
-        std::vector<std::unique_ptr<Expr>> elements;
+        std::vector<ExprPtr> elements;
         if (!check(TokenType::DELIMITER_RBRACKET)) {
             do {
                 // 尾逗号：逗号后直接遇到 ']' 则结束
@@ -651,16 +541,16 @@ std::unique_ptr<Expr> Parser::parse_primary() {
             } while (match(TokenType::DELIMITER_COMMA));
         }
         consume(TokenType::DELIMITER_RBRACKET, "Expect ']' after array elements.");
-        return std::make_unique<ArrayLiteralExpr>(std::move(elements), bracket);
+        return make<ArrayLiteralExpr>(std::move(elements), bracket);
     }
 
     if (match(TokenType::LITERAL_STRING)) {
-        return std::make_unique<LiteralExpr>(previous());
+        return make<LiteralExpr>(previous());
     }
 
     // 字符字面量 'a'（含 UTF-16 多字节字符，t47）
     if (match(TokenType::LITERAL_CHAR) || match(TokenType::LITERAL_CHARACTER)) {
-        return std::make_unique<LiteralExpr>(previous());
+        return make<LiteralExpr>(previous());
     }
 
     // 插值字符串 @"...{expr}..."：脱糖为文本段与 toString(expr) 的 '+' 拼接
@@ -670,14 +560,14 @@ std::unique_ptr<Expr> Parser::parse_primary() {
 
     if (match(TokenType::LITERAL_BOOL) || match(TokenType::KW_TRUE) || match(TokenType::KW_FALSE) ||
         match(TokenType::KW_UNSET)) {
-        return std::make_unique<LiteralExpr>(previous());
+        return make<LiteralExpr>(previous());
     }
 
     // 对象实例化：new ClassName(arguments)
     if (match(TokenType::KW_NEW)) {
         Token class_name = consume(TokenType::IDENTIFIER, "Expect class name after 'new'.");
         consume(TokenType::DELIMITER_LPAREN, "Expect '(' after class name.");
-        std::vector<std::unique_ptr<Expr>> arguments;
+        std::vector<ExprPtr> arguments;
         if (!check(TokenType::DELIMITER_RPAREN)) {
             do {
                 auto argument = parse_expression();
@@ -688,12 +578,12 @@ std::unique_ptr<Expr> Parser::parse_primary() {
             } while (match(TokenType::DELIMITER_COMMA));
         }
         consume(TokenType::DELIMITER_RPAREN, "Expect ')' after constructor arguments.");
-        return std::make_unique<NewExpr>(class_name, std::move(arguments));
+        return make<NewExpr>(class_name, std::move(arguments));
     }
 
     // this：类方法/构造器体内引用当前实例
     if (match(TokenType::KW_THIS)) {
-        return std::make_unique<ThisExpr>(previous());
+        return make<ThisExpr>(previous());
     }
 
     // base.method(args)：显式父类方法调用（C# 语义）；base 不是一等值，
@@ -704,7 +594,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
         Token method = consume(TokenType::IDENTIFIER,
                                "Expect method name after 'base.'.");
         consume(TokenType::DELIMITER_LPAREN, "Expect '(' after base method name.");
-        std::vector<std::unique_ptr<Expr>> arguments;
+        std::vector<ExprPtr> arguments;
         if (!check(TokenType::DELIMITER_RPAREN)) {
             do {
                 if (arguments.size() >= 255) {
@@ -718,7 +608,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
             } while (match(TokenType::DELIMITER_COMMA));
         }
         consume(TokenType::DELIMITER_RPAREN, "Expect ')' after base method arguments.");
-        return std::make_unique<BaseMethodCallExpr>(keyword, method,
+        return make<BaseMethodCallExpr>(keyword, method,
                                                     std::move(arguments));
     }
 
@@ -727,7 +617,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
         // 检查是否是函数调用
         if (check(TokenType::DELIMITER_LPAREN)) {
             consume(TokenType::DELIMITER_LPAREN, "Expect '(' after function name.");
-            std::vector<std::unique_ptr<Expr>> arguments;
+            std::vector<ExprPtr> arguments;
 
             // 解析参数列表
             if (!check(TokenType::DELIMITER_RPAREN)) {
@@ -744,14 +634,14 @@ std::unique_ptr<Expr> Parser::parse_primary() {
             }
 
             Token paren = consume(TokenType::DELIMITER_RPAREN, "Expect ')' after arguments.");
-            return std::make_unique<CallExpr>(
-                std::make_unique<IdentifierExpr>(name),
+            return make<CallExpr>(
+                make<IdentifierExpr>(name),
                 paren,
                 std::move(arguments)
             );
         }
 
-        return std::make_unique<IdentifierExpr>(name);
+        return make<IdentifierExpr>(name);
     }
 
     if (match(TokenType::DELIMITER_LPAREN)) {
@@ -760,14 +650,14 @@ std::unique_ptr<Expr> Parser::parse_primary() {
         // 空括号 () 解析为空元组
         if (check(TokenType::DELIMITER_RPAREN)) {
             advance();  // 消费 ')'
-            return std::make_unique<TupleExpr>(
-                std::vector<std::unique_ptr<Expr>>{},
+            return make<TupleExpr>(
+                std::vector<ExprPtr>{},
                 std::vector<std::string>{}, left_paren);
         }
 
         // 命名元素前瞻：IDENTIFIER ':' 开头即为命名元组（t45，经作者确认）
         // 读取一个「可选名字 + 表达式」元素，无名元素名字为空串
-        auto parse_tuple_element = [&](std::string& name) -> std::unique_ptr<Expr> {
+        auto parse_tuple_element = [&](std::string& name) -> ExprPtr {
             name.clear();
             if (check(TokenType::IDENTIFIER) &&
                 peek_next().type() == TokenType::OP_COLON) {
@@ -784,7 +674,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
         std::string first_name;
         auto first = parse_tuple_element(first_name);
         if (!first_name.empty() || check(TokenType::DELIMITER_COMMA)) {
-            std::vector<std::unique_ptr<Expr>> elements;
+            std::vector<ExprPtr> elements;
             std::vector<std::string> names;
             elements.push_back(std::move(first));
             names.push_back(std::move(first_name));
@@ -797,7 +687,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
                 }
             }
             consume(TokenType::DELIMITER_RPAREN, "Expect ')' after tuple elements.");
-            return std::make_unique<TupleExpr>(
+            return make<TupleExpr>(
                 std::move(elements), std::move(names), left_paren);
         }
 
@@ -808,7 +698,7 @@ std::unique_ptr<Expr> Parser::parse_primary() {
     throw error(peek(), "Expect expression.");
 }
 
-std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
+ExprPtr Parser::desugar_interpolated_string(const Token& token) {
     // 脱糖规则（见设计文档 03-character.md）：@"a{x}b" → "a" + toString(x) + "b"。
     // lexeme 为引号内原文（转义未解码）：文本段在此解码，额外支持 \{ \} 输出
     // 字面花括号；插值段用子 Lexer/Parser 解析，段内 \" 解码为引号后再喂给子
@@ -843,11 +733,12 @@ std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
         return out;
     };
 
-    std::vector<std::unique_ptr<Expr>> parts;
+    std::vector<ExprPtr> parts;
     auto flush_text = [&](std::string& text) {
         if (text.empty()) return;
-        parts.push_back(std::make_unique<LiteralExpr>(
-            Token(TokenType::LITERAL_STRING, decode_text(text), line, column)));
+        parts.push_back(make<LiteralExpr>(
+            Token(TokenType::LITERAL_STRING, context_->intern(decode_text(text)), line,
+                  column)));
         text.clear();
     };
 
@@ -892,7 +783,7 @@ std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
         flush_text(text);
 
         // 子解析插值表达式；子解析器的错误统一映射到外层 token 位置
-        std::unique_ptr<Expr> inner;
+        ExprPtr inner;
         try {
             Lexer sub_lexer(expr_src);
             std::vector<Token> sub_tokens = sub_lexer.tokenize();
@@ -901,7 +792,7 @@ std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
                     throw ParseError("lex error", t.line(), t.column());
                 }
             }
-            Parser sub_parser(sub_tokens);
+            Parser sub_parser(sub_tokens, context_);
             inner = sub_parser.parse_expression();
             if (!inner || !sub_parser.is_at_end()) {
                 throw ParseError("incomplete expression", line, column);
@@ -911,10 +802,10 @@ std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
         }
 
         // 包一层 toString(...)，保证段类型为 string（与内建函数行为一致）
-        std::vector<std::unique_ptr<Expr>> args;
+        std::vector<ExprPtr> args;
         args.push_back(std::move(inner));
-        parts.push_back(std::make_unique<CallExpr>(
-            std::make_unique<IdentifierExpr>(
+        parts.push_back(make<CallExpr>(
+            make<IdentifierExpr>(
                 Token(TokenType::IDENTIFIER, "toString", line, column)),
             Token(TokenType::DELIMITER_RPAREN, ")", line, column),
             std::move(args)));
@@ -923,21 +814,21 @@ std::unique_ptr<Expr> Parser::desugar_interpolated_string(const Token& token) {
 
     // 空串或纯文本退化为普通字符串字面量；多段用 '+' 左结合串接
     if (parts.empty()) {
-        return std::make_unique<LiteralExpr>(
+        return make<LiteralExpr>(
             Token(TokenType::LITERAL_STRING, "", line, column));
     }
-    std::unique_ptr<Expr> result = std::move(parts[0]);
+    ExprPtr result = std::move(parts[0]);
     Token plus(TokenType::OP_PLUS, "+", line, column);
     for (size_t k = 1; k < parts.size(); ++k) {
-        result = std::make_unique<BinaryExpr>(std::move(result), plus,
+        result = make<BinaryExpr>(std::move(result), plus,
                                               std::move(parts[k]));
     }
     return result;
 }
 
-std::unique_ptr<Expr> Parser::finish_call(const Token& callee) {
+ExprPtr Parser::finish_call(const Token& callee) {
     consume(TokenType::DELIMITER_LPAREN, "Expect '(' after function name.");
-    std::vector<std::unique_ptr<Expr>> arguments;
+    std::vector<ExprPtr> arguments;
 
     // 解析参数列表
     if (!check(TokenType::DELIMITER_RPAREN)) {
@@ -954,8 +845,8 @@ std::unique_ptr<Expr> Parser::finish_call(const Token& callee) {
     }
 
     Token paren = consume(TokenType::DELIMITER_RPAREN, "Expect ')' after arguments.");
-    return std::make_unique<CallExpr>(
-        std::make_unique<IdentifierExpr>(callee),
+    return make<CallExpr>(
+        make<IdentifierExpr>(callee),
         paren,
         std::move(arguments)
     );
@@ -974,8 +865,13 @@ bool Parser::match(TokenType type) {
 }
 
 bool Parser::match(std::initializer_list<TokenType> types) {
+    // 当前 token 类型只读一次，再与候选逐个比较
+    TokenType current = tokens_.at(current_).type();
+    if (current == TokenType::END_OF_FILE) {
+        return false;
+    }
     for (TokenType type : types) {
-        if (check(type)) {
+        if (current == type) {
             advance();
             return true;
         }
@@ -1009,32 +905,23 @@ Token Parser::consume_type_token(const std::string& message) {
 }
 
 bool Parser::check(TokenType type) const {
-    if (is_at_end()) {
-        return false;
-    }
-    bool result = peek().type() == type;
-    return result;
+    TokenType current = tokens_.at(current_).type();
+    return current != TokenType::END_OF_FILE && current == type;
 }
 
 bool Parser::is_at_end() const {
-    if (current_ >= tokens_.size()) {
-        return true;
-    }
-    return peek().type() == TokenType::END_OF_FILE;
+    return tokens_.at(current_).type() == TokenType::END_OF_FILE;
 }
 
 Token Parser::peek() const {
-    if (current_ >= tokens_.size()) {
-        return Token(TokenType::END_OF_FILE, "", 0, 0);
-    }
-    return tokens_[current_];
+    return tokens_.at(current_);
 }
 
 Token Parser::previous() const {
-    if (current_ <= 0 || current_ > tokens_.size()) {
+    if (current_ == 0) {
         return Token(TokenType::TOKEN_ERROR, "", 0, 0);
     }
-    return tokens_[current_ - 1];
+    return tokens_.at(current_ - 1);
 }
 
 Token Parser::advance() {
@@ -1111,7 +998,7 @@ void Parser::check_max_nesting_depth() {
  * - 块语句
  * - 表达式语句
  */
-std::unique_ptr<Stmt> Parser::parse_statement() {
+StmtPtr Parser::parse_statement() {
     try {
         if (match(TokenType::KW_IF)) {
             return parse_if_statement();
@@ -1149,7 +1036,7 @@ std::unique_ptr<Stmt> Parser::parse_statement() {
     }
 }
 
-std::unique_ptr<Stmt> Parser::parse_if_statement() {
+StmtPtr Parser::parse_if_statement() {
     // 记录开始位置用于错误报告
     Token if_token = previous();
 
@@ -1162,12 +1049,12 @@ std::unique_ptr<Stmt> Parser::parse_if_statement() {
     auto then_branch = parse_statement();
 
     // 解析可选的 else 分支
-    std::unique_ptr<Stmt> else_branch = nullptr;
+    StmtPtr else_branch = nullptr;
     if (match(TokenType::KW_ELSE)) {
         else_branch = parse_statement();
     }
 
-    return std::make_unique<IfStmt>(
+    return make<IfStmt>(
         if_token,
         std::move(condition),
         std::move(then_branch),
@@ -1175,7 +1062,7 @@ std::unique_ptr<Stmt> Parser::parse_if_statement() {
     );
 }
 
-std::unique_ptr<Stmt> Parser::parse_while_statement() {
+StmtPtr Parser::parse_while_statement() {
     // 记录开始位置用于错误报告
     Token while_token = previous();
 
@@ -1194,14 +1081,14 @@ std::unique_ptr<Stmt> Parser::parse_while_statement() {
     // 减少循环嵌套深度
     --nesting_depth_;
 
-    return std::make_unique<WhileStmt>(
+    return make<WhileStmt>(
         while_token,
         std::move(condition),
         std::move(body)
     );
 }
 
-std::unique_ptr<Stmt> Parser::parse_do_while_statement() {
+StmtPtr Parser::parse_do_while_statement() {
     Token do_token = previous(); // KW_DO 已被 match 消费
 
     // 增加循环嵌套深度
@@ -1222,14 +1109,14 @@ std::unique_ptr<Stmt> Parser::parse_do_while_statement() {
     consume(TokenType::DELIMITER_RPAREN, "Expect ')' after do-while condition.");
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after do-while statement.");
 
-    return std::make_unique<DoWhileStmt>(
+    return make<DoWhileStmt>(
         do_token,
         std::move(body),
         std::move(condition)
     );
 }
 
-std::unique_ptr<Stmt> Parser::parse_switch_statement() {
+StmtPtr Parser::parse_switch_statement() {
     Token switch_token = previous(); // KW_SWITCH 已被 match 消费
 
     // switch (expr)
@@ -1270,7 +1157,7 @@ std::unique_ptr<Stmt> Parser::parse_switch_statement() {
 
     consume(TokenType::DELIMITER_RBRACE, "Expect '}' after switch body.");
 
-    return std::make_unique<SwitchStmt>(
+    return make<SwitchStmt>(
         switch_token,
         std::move(condition),
         std::move(cases)
@@ -1286,8 +1173,8 @@ std::unique_ptr<Stmt> Parser::parse_switch_statement() {
  *
  * @throws ParseError 如果块语句语法不正确
  */
-std::unique_ptr<Stmt> Parser::parse_block_statement() {
-    std::vector<std::unique_ptr<Stmt>> statements;
+StmtPtr Parser::parse_block_statement() {
+    std::vector<StmtPtr> statements;
 
     // 增加嵌套深度
     ++nesting_depth_;
@@ -1313,7 +1200,7 @@ std::unique_ptr<Stmt> Parser::parse_block_statement() {
     --nesting_depth_;
 
     consume(TokenType::DELIMITER_RBRACE, "Expect '}' after block.");
-    return std::make_unique<BlockStmt>(std::move(statements));
+    return make<BlockStmt>(std::move(statements));
 }
 
 /**
@@ -1332,14 +1219,14 @@ std::unique_ptr<Stmt> Parser::parse_block_statement() {
  *
  * @throws ParseError 如果for循环语法不正确
  */
-std::unique_ptr<Stmt> Parser::parse_for_statement() {
+StmtPtr Parser::parse_for_statement() {
     // 记录开始位置用于错误报告
     Token for_token = previous();
 
     consume(TokenType::DELIMITER_LPAREN, "Expect '(' after 'for'.");
 
     // 解析初始化语句（类型关键字列表与 parse_declaration 对齐，t51 补齐 integer/decimal 等）
-    std::unique_ptr<Stmt> initializer;
+    StmtPtr initializer;
     if (match(TokenType::DELIMITER_SEMICOLON)) {
         initializer = nullptr;
     } else if (match({TokenType::KW_NUMBER,
@@ -1364,14 +1251,14 @@ std::unique_ptr<Stmt> Parser::parse_for_statement() {
     }
 
     // 解析条件表达式
-    std::unique_ptr<Expr> condition = nullptr;
+    ExprPtr condition = nullptr;
     if (!check(TokenType::DELIMITER_SEMICOLON)) {
         condition = parse_expression();
     }
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after loop condition.");
 
     // 解析递增表达式
-    std::unique_ptr<Expr> increment = nullptr;
+    ExprPtr increment = nullptr;
     if (!check(TokenType::DELIMITER_RPAREN)) {
         increment = parse_expression();
     }
@@ -1387,7 +1274,7 @@ std::unique_ptr<Stmt> Parser::parse_for_statement() {
     // 减少循环嵌套深度
     --nesting_depth_;
 
-    return std::make_unique<ForStmt>(
+    return make<ForStmt>(
         for_token,
         std::move(initializer),
         std::move(condition),
@@ -1405,16 +1292,16 @@ std::unique_ptr<Stmt> Parser::parse_for_statement() {
  *
  * @throws ParseError 如果return语句语法不正确
  */
-std::unique_ptr<Stmt> Parser::parse_return_statement() {
+StmtPtr Parser::parse_return_statement() {
     Token keyword = previous();
-    std::unique_ptr<Expr> value = nullptr;
+    ExprPtr value = nullptr;
 
     if (!check(TokenType::DELIMITER_SEMICOLON)) {
         value = parse_expression();
     }
 
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after return value.");
-    return std::make_unique<ReturnStmt>(keyword, std::move(value));
+    return make<ReturnStmt>(keyword, std::move(value));
 }
 
 /**
@@ -1423,10 +1310,10 @@ std::unique_ptr<Stmt> Parser::parse_return_statement() {
  *
  * @throws ParseError 如果break语句语法不正确或在循环外使用
  */
-std::unique_ptr<Stmt> Parser::parse_break_statement() {
+StmtPtr Parser::parse_break_statement() {
     Token keyword = previous();
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after 'break'.");
-    return std::make_unique<BreakStmt>(keyword);
+    return make<BreakStmt>(keyword);
 }
 
 /**
@@ -1435,10 +1322,10 @@ std::unique_ptr<Stmt> Parser::parse_break_statement() {
  *
  * @throws ParseError 如果continue语句语法不正确或在循环外使用
  */
-std::unique_ptr<Stmt> Parser::parse_continue_statement() {
+StmtPtr Parser::parse_continue_statement() {
     Token keyword = previous();
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after 'continue'.");
-    return std::make_unique<ContinueStmt>(keyword);
+    return make<ContinueStmt>(keyword);
 }
 
 /**
@@ -1449,13 +1336,13 @@ std::unique_ptr<Stmt> Parser::parse_continue_statement() {
  *
  * @throws ParseError 如果表达式语句语法不正确
  */
-std::unique_ptr<Stmt> Parser::parse_expression_statement() {
+StmtPtr Parser::parse_expression_statement() {
     auto expr = parse_expression();
     if (!expr) {
         throw error(peek(), "Expect expression.");
     }
     consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after expression.");
-    return std::make_unique<ExpressionStmt>(std::move(expr));
+    return make<ExpressionStmt>(std::move(expr));
 }
 
 // -----------------------------------------------------------------------------
@@ -1473,7 +1360,7 @@ std::unique_ptr<Stmt> Parser::parse_expression_statement() {
  *
  * @throws ParseError 如果函数声明语法不正确
  */
-std::unique_ptr<Stmt> Parser::parse_function_declaration(bool is_override) {
+StmtPtr Parser::parse_function_declaration(bool is_override) {
     // 记录开始位置用于错误报告
     Token func_token = previous();
 
@@ -1502,9 +1389,9 @@ std::unique_ptr<Stmt> Parser::parse_function_declaration(bool is_override) {
 
     // 解析函数体
     consume(TokenType::DELIMITER_LBRACE, "Expect '{' before function body.");
-    auto body = std::unique_ptr<BlockStmt>(dynamic_cast<BlockStmt*>(parse_block_statement().release()));
+    AstPtr<BlockStmt> body(dynamic_cast<BlockStmt*>(parse_block_statement().get()));
 
-    return std::make_unique<FunctionStmt>(return_type, name, std::move(parameters), std::move(body), is_override);
+    return make<FunctionStmt>(return_type, name, std::move(parameters), std::move(body), is_override);
 }
 
 /**
@@ -1513,7 +1400,7 @@ std::unique_ptr<Stmt> Parser::parse_function_declaration(bool is_override) {
  * 文法（Java/C# 风格最小子集，见 uncategorized.md 附录，经作者确认）：
  *   classDecl -> "class" IDENTIFIER ("extends" IDENTIFIER)? "{" classMember* "}"
  */
-std::unique_ptr<Stmt> Parser::parse_class_declaration() {
+StmtPtr Parser::parse_class_declaration() {
     Token name = consume(TokenType::IDENTIFIER, "Expect class name.");
 
     // 可选单继承：`extends 父类名`（无父类时用默认构造的 INVALID token 表示）
@@ -1524,7 +1411,7 @@ std::unique_ptr<Stmt> Parser::parse_class_declaration() {
 
     consume(TokenType::DELIMITER_LBRACE, "Expect '{' before class body.");
 
-    std::vector<std::unique_ptr<Stmt>> members;
+    std::vector<StmtPtr> members;
     while (!check(TokenType::DELIMITER_RBRACE) && !is_at_end()) {
         auto member = parse_class_member(name);
         if (member) {
@@ -1533,7 +1420,7 @@ std::unique_ptr<Stmt> Parser::parse_class_declaration() {
     }
 
     consume(TokenType::DELIMITER_RBRACE, "Expect '}' after class body.");
-    return std::make_unique<ClassStmt>(name, superclass, std::move(members));
+    return make<ClassStmt>(name, superclass, std::move(members));
 }
 
 /**
@@ -1547,7 +1434,7 @@ std::unique_ptr<Stmt> Parser::parse_class_declaration() {
  *   constructor -> 类名 IDENTIFIER "(" parameters? ")" (":" "base" "(" arguments? ")")? block
  *                  （与类名同名，无返回类型；base 委托脱糖为构造器体首条语句）
  */
-std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
+StmtPtr Parser::parse_class_member(const Token& class_name) {
     // 注解（可多个，在访问修饰符之前，见 uncategorized.md）：
     // @override 标记覆写（语义层校验父类链确有同名方法）；
     // @deprecated 接受但暂不生效（TODO：调用处告警）；其余报错
@@ -1570,7 +1457,7 @@ std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
         is_public = false;
     }
 
-    std::unique_ptr<Stmt> member;
+    StmtPtr member;
 
     if (match(TokenType::KW_FUNCTION)) {
         // 方法：复用函数声明文法
@@ -1599,12 +1486,12 @@ std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
 
         // 可选构造器委托：`: base(arguments)`（见 uncategorized.md 附录），
         // 脱糖为构造器体首条 ExpressionStmt(BaseCallExpr)
-        std::unique_ptr<Stmt> base_call_stmt;
+        StmtPtr base_call_stmt;
         if (match(TokenType::OP_COLON)) {
             Token base_keyword = consume(TokenType::KW_BASE,
                                          "Expect 'base' after ':' in constructor.");
             consume(TokenType::DELIMITER_LPAREN, "Expect '(' after 'base'.");
-            std::vector<std::unique_ptr<Expr>> base_args;
+            std::vector<ExprPtr> base_args;
             if (!check(TokenType::DELIMITER_RPAREN)) {
                 do {
                     if (base_args.size() >= 255) {
@@ -1618,14 +1505,14 @@ std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
                 } while (match(TokenType::DELIMITER_COMMA));
             }
             consume(TokenType::DELIMITER_RPAREN, "Expect ')' after base arguments.");
-            base_call_stmt = std::make_unique<ExpressionStmt>(
-                std::make_unique<BaseCallExpr>(base_keyword, std::move(base_args)));
+            base_call_stmt = make<ExpressionStmt>(
+                make<BaseCallExpr>(base_keyword, std::move(base_args)));
         }
 
         consume(TokenType::DELIMITER_LBRACE, "Expect '{' before constructor body.");
         // BlockStmt 构造后不可变，需先把 base 委托语句放入首位再收集体内语句，
         // 故不复用 parse_block_statement，手动展开同模式的驱动循环
-        std::vector<std::unique_ptr<Stmt>> body_statements;
+        std::vector<StmtPtr> body_statements;
         if (base_call_stmt) {
             body_statements.push_back(std::move(base_call_stmt));
         }
@@ -1643,16 +1530,16 @@ std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
             }
         }
         consume(TokenType::DELIMITER_RBRACE, "Expect '}' after constructor body.");
-        auto body = std::make_unique<BlockStmt>(std::move(body_statements));
+        auto body = make<BlockStmt>(std::move(body_statements));
         // 构造器不写返回类型，合成 none 类型 token 复用 FunctionStmt 节点
         Token return_type(TokenType::KW_NONE, "none", ctor_name.line(), ctor_name.column());
-        member = std::make_unique<FunctionStmt>(return_type, ctor_name,
+        member = make<FunctionStmt>(return_type, ctor_name,
                                                 std::move(parameters), std::move(body));
     } else {
         // 字段：`type name;` 或 `type name = expr;`
         Token type = consume_type_token("Expect field type in class body.");
         Token name = consume(TokenType::IDENTIFIER, "Expect field name.");
-        std::unique_ptr<Expr> initializer;
+        ExprPtr initializer;
         if (match(TokenType::OP_ASSIGN)) {
             initializer = parse_expression();
             if (!initializer) {
@@ -1660,7 +1547,7 @@ std::unique_ptr<Stmt> Parser::parse_class_member(const Token& class_name) {
             }
         }
         consume(TokenType::DELIMITER_SEMICOLON, "Expect ';' after field declaration.");
-        member = std::make_unique<VarDeclStmt>(type, name, std::move(initializer), false);
+        member = make<VarDeclStmt>(type, name, std::move(initializer), false);
     }
 
     member->set_access(is_public);
@@ -1724,16 +1611,16 @@ std::string Parser::format_error_message(
     }
 
     // 添加上下文信息
-    if (current_ > 0 && current_ < tokens_.size()) {
+    if (current_ > 0) {
         ss << "\nContext: ... ";
-        // 显示错误位置前后的 token
+        // 显示错误位置前后的 token（不越过文件末尾）
         size_t start = (current_ >= 2) ? current_ - 2 : 0;
-        size_t end = (current_ + 3 < tokens_.size()) ? current_ + 3 : tokens_.size();
-
-        for (size_t i = start; i < end; ++i) {
+        for (size_t i = start; i < current_ + 3; ++i) {
+            const Token& context_token = tokens_.at(i);
             if (i == current_) ss << ">>> ";
-            ss << tokens_[i].lexeme() << " ";
+            ss << context_token.lexeme() << " ";
             if (i == current_) ss << "<<< ";
+            if (context_token.is_eof()) break;
         }
         ss << "...";
     }
@@ -1765,9 +1652,6 @@ bool Parser::is_declaration_boundary() const {
 }
 
 Token Parser::peek_next() const {
-    if (current_ + 1 >= tokens_.size()) {
-        return Token(TokenType::END_OF_FILE, "", 0, 0);
-    }
-    return tokens_[current_ + 1];
+    return tokens_.at(current_ + 1);
 }
 } // namespace collie
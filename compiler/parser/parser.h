@@ -12,6 +12,8 @@
 #include <stdexcept>
 #include "../lexer/token.h"
 #include "ast.h"
+#include "ast_context.h"
+#include "token_stream.h"
 
 namespace collie {
 
@@ -46,25 +48,62 @@ private:
     size_t column_;
 };
 
+/**
+ * @brief 二元/三元/赋值运算符的优先级（从低到高）
+ *
+ * 中缀运算符的优先级与结合性由 parser.cpp 中按 TokenType 索引的表给出，
+ * 前缀一元运算与后缀链（索引、成员访问）的结合力高于所有中缀运算符。
+ */
+enum class Precedence : unsigned char {
+    None,        // 不是中缀运算符
+    Assignment,  // = += -= *= /= %=（右结合）
+    Ternary,     // ?: 与 ==?（右结合）
+    LogicalOr,   // ||
+    LogicalAnd,  // &&
+    BitOr,       // |
+    BitXor,      // ^
+    BitAnd,      // &
+    Equality,    // == !=
+    Comparison,  // < <= > >=
+    Shift,       // << >>
+    Term,        // + -
+    Factor,      // * / %
+};
+
 /**
  * @brief 语法分析器类
  */
 class Parser {
 public:
-    explicit Parser(const std::vector<Token>& tokens)
-        : tokens_(tokens), current_(0), nesting_depth_(0), in_panic_mode_(false) {}
+    /**
+     * @brief 构造语法分析器
+     * @param tokens 词法分析结果，须在解析期间保持有效；词素在读取时驻留到新的 AST 上下文，
+     *        解析结束后 tokens 与产生它的 Lexer 都可以先于 AST 销毁
+     */
+    explicit Parser(const std::vector<Token>& tokens);
+
+    // 解析期间按需读取 tokens，不能绑定临时序列
+    explicit Parser(std::vector<Token>&& tokens) = delete;
+
+    /**
+     * @brief 流式构造：解析时直接从 lexer 拉取 token，不生成完整的 token 数组
+     * @param lexer 词法分析器，须（连同其源码）在解析期间保持有效
+     *
+     * 词法错误（LexError）会从 parse_program 直接抛出。
+     */
+    explicit Parser(Lexer& lexer);
 
     /**
      * @brief 解析程序
-     * @return AST根节点列表
+     * @return AST根节点列表（与 parser 共享同一个 AST 上下文）
      */
-    std::vector<std::unique_ptr<Stmt>> parse_program();
+    ParsedProgram parse_program();
 
     /**
      * @brief 解析单个语句（用于测试）
      * @return 语句的AST节点
      */
-    std::unique_ptr<Stmt> parse() {
+    StmtPtr parse() {
         return parse_declaration();
     }
 
@@ -74,21 +113,33 @@ public:
      */
     const std::vector<ParseError>& get_errors() const { return errors_; }
 
+    /// @brief 本解析器创建的节点所属的 AST 上下文
+    const std::shared_ptr<AstContext>& context() const { return context_; }
+
 private:
+    /// @brief 在已有上下文中解析（插值字符串的子解析器与外层共享同一棵树）
+    Parser(const std::vector<Token>& tokens, std::shared_ptr<AstContext> context);
+
+    /// @brief 在 AST 上下文中创建节点
+    template <typename T, typename... Args>
+    AstPtr<T> make(Args&&... args) {
+        return context_->make<T>(std::forward<Args>(args)...);
+    }
+
     // 语句解析方法
     /**
      * @brief 解析声明语句
      * @return 声明语句的AST节点
      * @throws ParseError 如果声明语法不正确
      */
-    std::unique_ptr<Stmt> parse_declaration();
+    StmtPtr parse_declaration();
 
     /**
      * @brief 解析变量声明
      * @return 变量声明的AST节点
      * @throws ParseError 如果变量声明语法不正确
      */
-    std::unique_ptr<Stmt> parse_var_declaration();
+    StmtPtr parse_var_declaration();
 
     /**
      * @brief 解析函数声明
@@ -96,14 +147,14 @@ private:
      * @return 函数声明的AST节点
      * @throws ParseError 如果函数声明语法不正确
      */
-    std::unique_ptr<Stmt> parse_function_declaration(bool is_override = false);
+    StmtPtr parse_function_declaration(bool is_override = false);
 
     /**
      * @brief 解析类声明（`class` 已消费）
      * @return 类声明的AST节点
      * @throws ParseError 如果类声明语法不正确
      */
-    std::unique_ptr<Stmt> parse_class_declaration();
+    StmtPtr parse_class_declaration();
 
     /**
      * @brief 解析单个类成员（字段/方法/构造器，含可选访问修饰符）
@@ -111,7 +162,7 @@ private:
      * @return 类成员的AST节点
      * @throws ParseError 如果成员语法不正确
      */
-    std::unique_ptr<Stmt> parse_class_member(const Token& class_name);
+    StmtPtr parse_class_member(const Token& class_name);
 
     /**
      * @brief 解析语句
@@ -128,7 +179,7 @@ private:
      * - 块语句
      * - 表达式语句
      */
-    std::unique_ptr<Stmt> parse_statement();
+    StmtPtr parse_statement();
 
     /**
      * @brief 解析if语句
@@ -138,7 +189,7 @@ private:
      * if语句语法：
      * if (condition) thenBranch [else elseBranch]?
      */
-    std::unique_ptr<Stmt> parse_if_statement();
+    StmtPtr parse_if_statement();
 
     /**
      * @brief 解析while循环语句
@@ -148,13 +199,13 @@ private:
      * while语句语法：
      * while (condition) body
      */
-    std::unique_ptr<Stmt> parse_while_statement();
+    StmtPtr parse_while_statement();
 
     /// @brief 解析 do-while 语句
-    std::unique_ptr<Stmt> parse_do_while_statement();
+    StmtPtr parse_do_while_statement();
 
     /// @brief 解析 switch 语句
-    std::unique_ptr<Stmt> parse_switch_statement();
+    StmtPtr parse_switch_statement();
 
     /**
      * @brief 解析for循环语句
@@ -164,7 +215,7 @@ private:
      * for语句语法：
      * for (initializer; condition; increment) body
      */
-    std::unique_ptr<Stmt> parse_for_statement();
+    StmtPtr parse_for_statement();
 
     /**
      * @brief 解析块语句
@@ -174,7 +225,7 @@ private:
      * 块语句语法：
      * { statements* }
      */
-    std::unique_ptr<Stmt> parse_block_statement();
+    StmtPtr parse_block_statement();
 
     /**
      * @brief 解析return语句
@@ -184,21 +235,21 @@ private:
      * return语句语法：
      * return [expression]? ;
      */
-    std::unique_ptr<Stmt> parse_return_statement();
+    StmtPtr parse_return_statement();
 
     /**
      * @brief 解析break语句
      * @return break语句的AST节点
      * @throws ParseError 如果break语句语法不正确或在循环外使用
      */
-    std::unique_ptr<Stmt> parse_break_statement();
+    StmtPtr parse_break_statement();
 
     /**
      * @brief 解析continue语句
      * @return continue语句的AST节点
      * @throws ParseError 如果continue语句语法不正确或在循环外使用
      */
-    std::unique_ptr<Stmt> parse_continue_statement();
+    StmtPtr parse_continue_statement();
 
     /**
      * @brief 解析表达式语句
@@ -208,7 +259,7 @@ private:
      * 表达式语句语法：
      * expression ;
      */
-    std::unique_ptr<Stmt> parse_expression_statement();
+    StmtPtr parse_expression_statement();
 
     // 表达式解析方法
     /**
@@ -216,137 +267,44 @@ private:
      * @return 表达式的AST节点
      * @throws ParseError 如果表达式语法不正确
      *
-     * 表达式解析遵循运算符优先级规则：
-     * 1. 赋值
-     * 2. 逻辑或
-     * 3. 逻辑与
-     * 4. 相等性比较
-     * 5. 关系比较
-     * 6. 加减
-     * 7. 乘除
-     * 8. 一元运算
-     * 9. 基本表达式
-     */
-    std::unique_ptr<Expr> parse_expression();
-
-    /**
-     * @brief 解析赋值表达式
-     * @return 赋值表达式的AST节点
-     * @throws ParseError 如果赋值表达式语法不正确
-     *
-     * 赋值表达式语法：
-     * IDENTIFIER "=" assignment
-     */
-    std::unique_ptr<Expr> parse_assignment();
-
-    /**
-     * @brief 解析三元条件表达式
-     * @return 三元表达式的AST节点
-     *
-     * 三元表达式语法：
-     * logicalOr ("?" ternary ":" ternary)?
-     */
-    std::unique_ptr<Expr> parse_ternary();
-
-    /**
-     * @brief 解析逻辑或表达式
-     * @return 逻辑或表达式的AST节点
-     * @throws ParseError 如果逻辑或表达式语法不正确
-     *
-     * 逻辑或表达式语法：
-     * logicalAnd ("||" logicalAnd)*
+     * 从最低优先级（赋值）开始调用 parse_precedence，出错时报告并同步。
      */
-    std::unique_ptr<Expr> parse_logical_or();
+    ExprPtr parse_expression();
 
     /**
-     * @brief 解析逻辑与表达式
-     * @return 逻辑与表达式的AST节点
-     * @throws ParseError 如果逻辑与表达式语法不正确
-     *
-     * 逻辑与表达式语法：
-     * bitOr ("&&" bitOr)*
-     */
-    std::unique_ptr<Expr> parse_logical_and();
-
-    /**
-     * @brief 解析按位或表达式（t47，优先级低于 `^`，高于 `&&`）
-     * @return 按位或表达式的AST节点
-     * @throws ParseError 如果按位或表达式语法不正确
-     *
-     * 按位或表达式语法：
-     * bitXor ("|" bitXor)*
-     */
-    std::unique_ptr<Expr> parse_bit_or();
-
-    /**
-     * @brief 解析按位异或表达式（t47）
-     * @return 按位异或表达式的AST节点
-     * @throws ParseError 如果按位异或表达式语法不正确
-     *
-     * 按位异或表达式语法：
-     * bitAnd ("^" bitAnd)*
-     */
-    std::unique_ptr<Expr> parse_bit_xor();
-
-    /**
-     * @brief 解析按位与表达式（t47，优先级低于相等比较，与 C 家族一致）
-     * @return 按位与表达式的AST节点
-     * @throws ParseError 如果按位与表达式语法不正确
-     *
-     * 按位与表达式语法：
-     * equality ("&" equality)*
-     */
-    std::unique_ptr<Expr> parse_bit_and();
-
-    /**
-     * @brief 解析相等性比较表达式
-     * @return 相等性比较表达式的AST节点
-     * @throws ParseError 如果相等性比较表达式语法不正确
-     *
-     * 相等性比较表达式语法：
-     * comparison (("==" | "!=") comparison)*
-     */
-    std::unique_ptr<Expr> parse_equality();
-
-    /**
-     * @brief 解析关系比较表达式
-     * @return 关系比较表达式的AST节点
-     * @throws ParseError 如果关系比较表达式语法不正确
-     *
-     * 关系比较表达式语法：
-     * shift ((">" | ">=" | "<" | "<=") shift)*
-     */
-    std::unique_ptr<Expr> parse_comparison();
-
-    /**
-     * @brief 解析移位表达式（t47，优先级高于关系比较、低于加减）
-     * @return 移位表达式的AST节点
-     * @throws ParseError 如果移位表达式语法不正确
+     * @brief 按优先级爬升解析表达式（Pratt 解析）
+     * @param min_precedence 本次只吸收优先级不低于它的中缀运算符
+     * @return 表达式的AST节点
+     * @throws ParseError 如果表达式语法不正确
      *
-     * 移位表达式语法：
-     * term (("<<" | ">>") term)*
+     * 先解析一个一元表达式，再循环查表吸收后续中缀运算符：左结合运算符的右操作数
+     * 以更高一级优先级递归解析，赋值与三元运算以同级递归实现右结合。
+     * 每层括号只经过常数层调用，不再逐级穿过每个优先级的解析函数。
      */
-    std::unique_ptr<Expr> parse_shift();
+    ExprPtr parse_precedence(Precedence min_precedence);
 
     /**
-     * @brief 解析加减表达式
-     * @return 加减表达式的AST节点
-     * @throws ParseError 如果加减表达式语法不正确
+     * @brief 解析赋值运算符及其右侧（当前 token 为 '=' 或复合赋值运算符）
+     * @param target 已解析的赋值目标
+     * @return 赋值表达式的AST节点
+     * @throws ParseError 如果赋值目标非法
      *
-     * 加减表达式语法：
-     * factor (("+" | "-") factor)*
+     * 赋值表达式语法：
+     * (IDENTIFIER | index | property) "=" assignment
+     * IDENTIFIER ("+=" | "-=" | "*=" | "/=" | "%=") assignment
      */
-    std::unique_ptr<Expr> parse_term();
+    ExprPtr finish_assignment(ExprPtr target);
 
     /**
-     * @brief 解析乘除表达式
-     * @return 乘除表达式的AST节点
-     * @throws ParseError 如果乘除表达式语法不正确
+     * @brief 解析三元条件或 `==?` 多路匹配的其余部分（当前 token 为 '?' 或 '==?'）
+     * @param condition 已解析的条件或匹配目标
+     * @return 三元表达式或多路匹配表达式的AST节点
      *
-     * 乘除表达式语法：
-     * unary (("*" | "/" | "%") unary)*
+     * 三元表达式语法：
+     * logicalOr "?" ternary ":" ternary (":" ternary)?
+     * logicalOr "==?" (ternary ("," ternary)* ":" ternary ",")* ternary?
      */
-    std::unique_ptr<Expr> parse_factor();
+    ExprPtr finish_ternary(ExprPtr condition);
 
     /**
      * @brief 解析一元表达式
@@ -356,7 +314,7 @@ private:
      * 一元表达式语法：
      * ("!" | "-" | "~") unary | primary
      */
-    std::unique_ptr<Expr> parse_unary();
+    ExprPtr parse_unary();
 
     /**
      * @brief 解析基本表达式
@@ -366,7 +324,7 @@ private:
      * 基本表达式语法：
      * NUMBER | STRING | BOOL | IDENTIFIER | "(" expression ")"
      */
-    std::unique_ptr<Expr> parse_primary();
+    ExprPtr parse_primary();
 
     /**
      * @brief 将插值字符串 token 脱糖为拼接表达式
@@ -374,7 +332,7 @@ private:
      * @return 脱糖后的表达式：文本段与 toString(插值表达式) 用 '+' 串接
      * @throws ParseError 插值表达式非法、花括号不匹配或转义序列非法时
      */
-    std::unique_ptr<Expr> desugar_interpolated_string(const Token& token);
+    ExprPtr desugar_interpolated_string(const Token& token);
 
     /**
      * @brief 完成函数调用的解析
@@ -385,7 +343,7 @@ private:
      * 函数调用语法：
      * IDENTIFIER "(" arguments? ")"
      */
-    std::unique_ptr<Expr> finish_call(const Token& callee);
+    ExprPtr finish_call(const Token& callee);
 
     // 错误处理辅助方法
     /**
@@ -518,7 +476,7 @@ private:
      * @brief 解析类型声明语句
      * @return 变量声明的AST节点
      */
-    std::unique_ptr<Stmt> parse_type_declaration(bool is_const = false);
+    StmtPtr parse_type_declaration(bool is_const = false);
 
     /**
      * @brief 获取下一个token
@@ -527,7 +485,8 @@ private:
     Token peek_next() const;
 
 private:
-    const std::vector<Token>& tokens_;
+    std::shared_ptr<AstContext> context_;
+    mutable TokenStream tokens_;  ///< token 来源（按需拉取，词素驻留到 context_）
     size_t current_;
     size_t nesting_depth_;
     bool in_panic_mode_;  // 是否处于恐慌模式
@@ -0,0 +1,49 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: token 流实现
+ */
+#include "token_stream.h"
+
+#include <cassert>
+#include "ast_context.h"
+#include "../lexer/lexer.h"
+
+namespace collie {
+
+TokenStream::TokenStream(const std::vector<Token>& tokens, AstContext& context)
+    : context_(context), tokens_(&tokens) {}
+
+TokenStream::TokenStream(Lexer& lexer, AstContext& context)
+    : context_(context), lexer_(&lexer) {}
+
+void TokenStream::fill(size_t index) {
+    // 请求的位置不能把仍可能被回看的 token 挤出窗口
+    assert(index < pulled_ + WINDOW);
+    while (pulled_ <= index) {
+        window_[pulled_ % WINDOW] = next_from_source();
+        ++pulled_;
+    }
+}
+
+Token TokenStream::next_from_source() {
+    if (exhausted_) {
+        return Token(TokenType::END_OF_FILE, "", 0, 0);
+    }
+    Token token;
+    if (tokens_) {
+        if (source_pos_ >= tokens_->size()) {
+            exhausted_ = true;
+            return Token(TokenType::END_OF_FILE, "", 0, 0);
+        }
+        token = (*tokens_)[source_pos_++];
+    } else {
+        token = lexer_->next_token();
+    }
+    if (token.is_eof()) {
+        exhausted_ = true;
+    }
+    return context_.intern(token);
+}
+
+} // namespace collie
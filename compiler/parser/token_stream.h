@@ -0,0 +1,71 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 语法分析器的 token 来源：按需拉取，只保留固定大小的前后窗口
+ */
+#ifndef COLLIE_TOKEN_STREAM_H
+#define COLLIE_TOKEN_STREAM_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include "../lexer/token.h"
+
+namespace collie {
+
+class AstContext;
+class Lexer;
+
+/**
+ * @brief token 流
+ *
+ * 从已有的 token 序列或直接从 Lexer 按下标顺序拉取 token，词素在拉取时驻留到 AST 上下文，
+ * 存放在一个固定大小的环形窗口中。语法分析器只向前看两个 token、出错时向回看两个 token，
+ * 窗口足以覆盖；因此流式解析不再需要完整的 token 数组，峰值内存只随 AST 增长。
+ *
+ * 来源耗尽后（或 Lexer 产出 END_OF_FILE 之后）继续读取得到 END_OF_FILE。
+ */
+class TokenStream {
+public:
+    /// @brief 可访问的最大窗口：当前位置之前与之后合计的 token 数
+    static constexpr size_t WINDOW = 8;
+
+    /// @brief 读取已有的 token 序列（须在解析期间保持有效）
+    TokenStream(const std::vector<Token>& tokens, AstContext& context);
+
+    /// @brief 边解析边从 Lexer 取 token（Lexer 及其源码须在解析期间保持有效）
+    TokenStream(Lexer& lexer, AstContext& context);
+
+    /**
+     * @brief 第 index 个 token（从 0 起）
+     *
+     * 需要时从来源继续拉取；index 不得早于已拉取的最新 token 之前 WINDOW - 1 个位置，
+     * 否则对应槽位已被更新的 token 覆盖（调试构建下断言）。
+     */
+    const Token& at(size_t index) {
+        if (index >= pulled_) {
+            fill(index);
+        }
+        assert(index + WINDOW >= pulled_);
+        return window_[index % WINDOW];
+    }
+
+    /// @brief 已从来源拉取的 token 数
+    size_t pulled() const { return pulled_; }
+
+private:
+    void fill(size_t index);
+    Token next_from_source();
+
+    AstContext& context_;
+    const std::vector<Token>* tokens_ = nullptr;  // 批量来源
+    Lexer* lexer_ = nullptr;                      // 流式来源
+    size_t source_pos_ = 0;
+    bool exhausted_ = false;  // 来源已给出 END_OF_FILE
+    Token window_[WINDOW];
+    size_t pulled_ = 0;
+};
+
+} // namespace collie
+
+#endif // COLLIE_TOKEN_STREAM_H
@@ -5,11 +5,16 @@
  */
 #include "semantic_analyzer.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <exception>
 #include <sstream>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 #include "../utils/token_utils.h"
@@ -29,12 +34,24 @@ class SymbolTable;
 // 公共接口实现
 // -----------------------------------------------------------------------------
 
-void SemanticAnalyzer::analyze(const std::vector<std::unique_ptr<Stmt>>& statements) {
+void SemanticAnalyzer::analyze(const std::vector<StmtPtr>& statements) {
     // 清理之前的状态
     reset_state();
 
-    // 分析每个顶层语句
-    for (const auto& stmt : statements) {
+    // 第一阶段：先登记全部顶层类与函数签名
+    declare_signatures(statements);
+
+    // 再按源码顺序分析其余顶层语句；顶层函数体/类体只记下此处的全局符号栈高度，
+    // 第二阶段检查时只看得到声明之前定义的全局变量（与顺序分析一致）
+    size_t next_task = 0;
+    for (position_ = 0; position_ < statements.size(); ++position_) {
+        const Stmt* stmt = statements[position_].get();
+        if (dynamic_cast<const FunctionStmt*>(stmt) || dynamic_cast<const ClassStmt*>(stmt)) {
+            if (next_task < tasks_.size() && tasks_[next_task].position == position_) {
+                tasks_[next_task++].visible = symbols_.height();
+            }
+            continue;
+        }
         try {
             stmt->accept(*this);
         } catch (const SemanticError& error) {
@@ -45,6 +62,329 @@ void SemanticAnalyzer::analyze(const std::vector<std::unique_ptr<Stmt>>& stateme
             }
         }
     }
+
+    // 第二阶段：并行检查顶层函数体与类体
+    run_body_tasks();
+    untype_early_bodies();
+    finish_diagnostics();
+}
+
+// -----------------------------------------------------------------------------
+// 两阶段分析
+// -----------------------------------------------------------------------------
+
+void SemanticAnalyzer::declare_signatures(const std::vector<StmtPtr>& statements) {
+    // 类先于函数登记：函数签名中的类名参数/返回类型按 object 处理，需要先知道全部类名；
+    // 父类仍须在子类之前声明（单继承链按源码顺序建立）
+    for (position_ = 0; position_ < statements.size(); ++position_) {
+        if (auto* klass = dynamic_cast<const ClassStmt*>(statements[position_].get())) {
+            if (declare_class(*klass)) {
+                tasks_.push_back(BodyTask{klass, nullptr, position_, 0});
+            }
+        }
+    }
+    for (position_ = 0; position_ < statements.size(); ++position_) {
+        auto* fn = dynamic_cast<const FunctionStmt*>(statements[position_].get());
+        if (!fn) {
+            continue;
+        }
+        try {
+            symbols_.define(make_function_symbol(*fn));
+            // 函数允许重载：新定义的符号总在同名遮蔽链的链头
+            tasks_.push_back(BodyTask{fn, symbols_.resolve(fn->name().lexeme()), position_, 0});
+        } catch (const SemanticError& error) {
+            record_error(error);
+            if (!in_panic_mode_) {
+                enter_panic_mode();
+                synchronize();
+            }
+        }
+    }
+
+    std::sort(tasks_.begin(), tasks_.end(), [](const BodyTask& a, const BodyTask& b) {
+        return a.position < b.position;
+    });
+    first_task_position_ = tasks_.empty() ? SIZE_MAX : tasks_.front().position;
+    for (size_t i = 0; i < tasks_.size(); ++i) {
+        if (tasks_[i].function) {
+            function_tasks_.emplace(tasks_[i].function, i);
+        } else {
+            class_tasks_.emplace(static_cast<const ClassStmt*>(tasks_[i].stmt), i);
+        }
+    }
+}
+
+void SemanticAnalyzer::run_body_tasks() {
+    if (tasks_.empty()) {
+        return;
+    }
+    size_t jobs = jobs_ != 0 ? jobs_ : std::thread::hardware_concurrency();
+    jobs = std::max<size_t>(1, std::min(jobs, tasks_.size()));
+
+    // 每个线程一个工作分析器：有自己的局部符号表、错误列表与类型表，
+    // 全局符号和顶层类只读访问本分析器
+    std::vector<std::unique_ptr<SemanticAnalyzer>> workers;
+    workers.reserve(jobs);
+    for (size_t i = 0; i < jobs; ++i) {
+        auto worker = std::make_unique<SemanticAnalyzer>();
+        worker->parent_ = this;
+        worker->tokens_ = tokens_;
+        worker->first_task_position_ = first_task_position_;
+        // 只有一个工作分析器时直接写入本分析器的类型表，省去合并
+        worker->type_sink_ = jobs == 1 ? &expr_types_ : &worker->expr_types_;
+        workers.push_back(std::move(worker));
+    }
+
+    std::atomic<size_t> next{0};
+    auto work = [&](SemanticAnalyzer& worker) {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < tasks_.size();) {
+            worker.run_task(i);
+        }
+    };
+
+    if (jobs == 1) {
+        work(*workers.front());
+    } else {
+        std::mutex failure_mutex;
+        std::exception_ptr failure;
+        auto guarded = [&](SemanticAnalyzer& worker) {
+            try {
+                work(worker);
+            } catch (...) {
+                // 非语义错误（如内存不足）：停止派发剩余任务，汇合后在调用线程重新抛出
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                next.store(tasks_.size(), std::memory_order_relaxed);
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(jobs - 1);
+        for (size_t i = 1; i < jobs; ++i) {
+            threads.emplace_back(guarded, std::ref(*workers[i]));
+        }
+        guarded(*workers.front());
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    for (auto& worker : workers) {
+        diagnostics_.insert(diagnostics_.end(),
+                            std::make_move_iterator(worker->diagnostics_.begin()),
+                            std::make_move_iterator(worker->diagnostics_.end()));
+        global_assignments_.insert(global_assignments_.end(),
+                                   worker->global_assignments_.begin(),
+                                   worker->global_assignments_.end());
+        task_runs_.insert(task_runs_.end(), worker->task_runs_.begin(), worker->task_runs_.end());
+        typed_globals_.insert(typed_globals_.end(), worker->typed_globals_.begin(),
+                              worker->typed_globals_.end());
+        if (jobs > 1) {
+            expr_types_.merge(worker->expr_types_);
+        }
+    }
+}
+
+void SemanticAnalyzer::run_task(size_t index) {
+    // 每个任务从干净的上下文开始，结果不随任务落在哪个线程、排在谁之后而变
+    const BodyTask& task = parent_->tasks_[index];
+    current_task_ = index;
+    typed_global_limit_ = 0;
+    position_ = task.position;
+    visible_globals_ = task.visible;
+    assigned_globals_.clear();
+    in_panic_mode_ = false;
+    current_token_index_ = 0;
+    current_type_ = TokenType::INVALID;
+    array_element_type_ = TokenType::INVALID;
+    has_return_ = false;
+    loop_depth_ = 0;
+    in_class_ = false;
+    current_function_ = nullptr;
+
+    try {
+        if (task.function) {
+            check_function_body(static_cast<const FunctionStmt&>(*task.stmt), *task.function);
+        } else {
+            check_class_body(static_cast<const ClassStmt&>(*task.stmt));
+        }
+    } catch (const SemanticError& error) {
+        record_error(error);
+        if (!in_panic_mode_) {
+            enter_panic_mode();
+            synchronize();
+        }
+    }
+    if (typed_global_limit_ != 0) {
+        typed_globals_.emplace_back(index, typed_global_limit_);
+    }
+}
+
+void SemanticAnalyzer::note_runs(size_t task) {
+    if (parent_) {
+        task_runs_.emplace_back(current_task_, task);
+    } else {
+        top_level_runs_.emplace_back(position_, task);
+    }
+}
+
+void SemanticAnalyzer::note_call(const std::vector<const Symbol*>& overloads) {
+    const SemanticAnalyzer& owner = parent_ ? *parent_ : *this;
+    for (const Symbol* overload : overloads) {
+        auto found = owner.function_tasks_.find(overload);
+        if (found != owner.function_tasks_.end()) {
+            note_runs(found->second);
+        }
+    }
+}
+
+void SemanticAnalyzer::note_instantiation(const ClassStmt* klass) {
+    // 父类须先于子类声明，继承链无环
+    const SemanticAnalyzer& owner = parent_ ? *parent_ : *this;
+    for (; klass; klass = klass->has_superclass() ? find_class(klass->superclass().lexeme())
+                                                 : nullptr) {
+        auto found = owner.class_tasks_.find(klass);
+        if (found != owner.class_tasks_.end()) {
+            note_runs(found->second);
+        }
+    }
+}
+
+void SemanticAnalyzer::untype_early_bodies() {
+    if (typed_globals_.empty()) {
+        return;
+    }
+
+    // 各任务最早可能运行的顶层语句：顶层语句直接运行的任务取该语句下标，
+    // 再沿调用关系传给被调任务（按位置从小到大扩展，每个任务只定一次）
+    std::vector<size_t> earliest(tasks_.size(), SIZE_MAX);
+    std::vector<std::vector<size_t>> callees(tasks_.size());
+    for (const auto& [caller, callee] : task_runs_) {
+        callees[caller].push_back(callee);
+    }
+    using Reach = std::pair<size_t, size_t>;  // (最早位置, 任务下标)
+    std::priority_queue<Reach, std::vector<Reach>, std::greater<Reach>> queue;
+    for (const auto& [position, task] : top_level_runs_) {
+        if (position < earliest[task]) {
+            earliest[task] = position;
+            queue.emplace(position, task);
+        }
+    }
+    while (!queue.empty()) {
+        auto [position, task] = queue.top();
+        queue.pop();
+        if (position != earliest[task]) {
+            continue;
+        }
+        for (size_t callee : callees[task]) {
+            if (position < earliest[callee]) {
+                earliest[callee] = position;
+                queue.emplace(position, callee);
+            }
+        }
+    }
+
+    for (const auto& [task, limit] : typed_globals_) {
+        if (earliest[task] >= limit) {
+            continue;
+        }
+        // 重新检查一遍：类型表保持第一遍的结果，分析走的分支与第一遍相同；
+        // record_type 只收集节点，诊断随临时分析器丢弃
+        std::vector<const Expr*> nodes;
+        SemanticAnalyzer worker;
+        worker.parent_ = this;
+        worker.tokens_ = tokens_;
+        worker.first_task_position_ = first_task_position_;
+        worker.type_sink_ = &expr_types_;
+        worker.untyped_sink_ = &nodes;
+        worker.run_task(task);
+        for (const Expr* node : nodes) {
+            expr_types_.record(*node, TokenType::INVALID);
+        }
+    }
+}
+
+void SemanticAnalyzer::finish_diagnostics() {
+    // 顺序分析时函数体先于其后的语句检查，体内对全局变量的赋值让后续读取不再报未初始化：
+    // 按每个全局变量最早被哪个函数体/类体赋值，撤销其后位置上的待定诊断
+    std::unordered_map<const Symbol*, size_t> first_assigned;
+    for (const auto& [symbol, position] : global_assignments_) {
+        auto [it, inserted] = first_assigned.emplace(symbol, position);
+        if (!inserted) {
+            it->second = std::min(it->second, position);
+        }
+    }
+
+    // 同一顶层语句内保持记录顺序（签名错误在前，函数体错误在后）
+    std::stable_sort(diagnostics_.begin(), diagnostics_.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) {
+                         return a.position < b.position;
+                     });
+    errors_.clear();
+    errors_.reserve(diagnostics_.size());
+    for (auto& diagnostic : diagnostics_) {
+        if (diagnostic.global) {
+            auto found = first_assigned.find(diagnostic.global);
+            if (found != first_assigned.end() && found->second < diagnostic.position) {
+                continue;
+            }
+        }
+        errors_.push_back(std::move(diagnostic.error));
+    }
+    diagnostics_.clear();
+    global_assignments_.clear();
+}
+
+const Symbol* SemanticAnalyzer::lookup(std::string_view name) const {
+    if (const Symbol* symbol = symbols_.resolve_at(name, symbols_.height())) {
+        return symbol;
+    }
+    return parent_ ? parent_->symbols_.resolve_at(name, visible_globals_) : nullptr;
+}
+
+std::vector<const Symbol*> SemanticAnalyzer::lookup_overloads(std::string_view name) const {
+    std::vector<const Symbol*> overloads = symbols_.resolve_overloads(name);
+    if (parent_) {
+        std::vector<const Symbol*> globals =
+            parent_->symbols_.resolve_overloads_at(name, visible_globals_);
+        overloads.insert(overloads.end(), globals.begin(), globals.end());
+    }
+    return overloads;
+}
+
+const ClassStmt* SemanticAnalyzer::find_class(std::string_view name) const {
+    const std::string key(name);
+    for (const SemanticAnalyzer* analyzer = this; analyzer; analyzer = analyzer->parent_) {
+        auto found = analyzer->declared_classes_.find(key);
+        if (found != analyzer->declared_classes_.end()) {
+            return found->second;
+        }
+    }
+    return nullptr;
+}
+
+bool SemanticAnalyzer::is_initialized_here(const Symbol& symbol) const {
+    if (symbol.kind != SymbolKind::VARIABLE) {
+        return true;
+    }
+    // 本分析器自己的符号（含第一阶段的全局变量）：初始化状态随分析进度更新
+    if (!parent_ || symbol.scope_level != 0) {
+        return symbol.is_initialized;
+    }
+    // 工作分析器读全局变量（局部符号表里没有全局作用域的符号）：共享符号反映的是
+    // 第一阶段结束时的状态，须按赋值位置判断
+    if (symbol.has_initializer) {
+        return true;
+    }
+    auto found = parent_->global_initialized_at_.find(&symbol);
+    if (found != parent_->global_initialized_at_.end() && found->second < position_) {
+        return true;
+    }
+    return assigned_globals_.count(&symbol) != 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -52,7 +392,7 @@ void SemanticAnalyzer::analyze(const std::vector<std::unique_ptr<Stmt>>& stateme
 // -----------------------------------------------------------------------------
 
 void SemanticAnalyzer::record_error(const SemanticError& error) {
-    errors_.push_back(error);
+    diagnostics_.push_back(Diagnostic{error, position_});
 }
 
 void SemanticAnalyzer::enter_panic_mode() {
@@ -68,7 +408,7 @@ void SemanticAnalyzer::synchronize() {
     while (in_panic_mode_) {
         // 若没有可用的 token 序列（例如未调用 set_tokens），或已到达序列末尾，
         // 则无法继续同步，直接退出恢复模式，避免死循环。
-        if (tokens_.empty() || current_token_index_ >= tokens_.size() - 1) {
+        if (tokens().empty() || current_token_index_ >= tokens().size() - 1) {
             exit_panic_mode();
             return;
         }
@@ -164,23 +504,43 @@ void SemanticAnalyzer::visitLiteral(const LiteralExpr& expr) {
             throw SemanticError(message, expr.token().line(), expr.token().column());
         }
     }
+    record_type(expr, current_type_);
 }
 
 void SemanticAnalyzer::visitIdentifier(const IdentifierExpr& expr) {
-    std::string name(expr.name().lexeme());
-    Symbol* symbol = symbols_.resolve(name);
+    std::string_view name = expr.name().lexeme();
+    const Symbol* symbol = lookup(name);
     if (!symbol) {
-        std::string message = std::string("Undefined variable '") + name + "'";
+        std::string message = std::string("Undefined variable '") + std::string(name) + "'";
         throw SemanticError(message, expr.name().line(), expr.name().column());
     }
 
-    if (symbol->kind == SymbolKind::VARIABLE && !symbol->is_initialized) {
-        std::string message = std::string("Variable '") + name +
-                            "' is used before initialization";
-        throw SemanticError(message, expr.name().line(), expr.name().column());
+    if (!is_initialized_here(*symbol)) {
+        SemanticError error(std::string("Variable '") + std::string(name) +
+                                "' is used before initialization",
+                            expr.name().line(), expr.name().column());
+        // 全局变量可能已在此前的函数体/类体中赋值（顺序分析时它们先于此处检查），
+        // 这要等第二阶段才知道：先记为待定诊断，按已初始化继续分析
+        if (symbol->scope_level != 0 || position_ <= first_task_position_) {
+            throw error;
+        }
+        diagnostics_.push_back(Diagnostic{error, position_, symbol});
     }
 
     current_type_ = symbol->type.type();
+    // 形参与带初始化声明的变量：运行期绑定与赋值都按声明类型强制，值的种类确定；
+    // 未带初始化的变量在首次赋值前为 none，不收录
+    if (symbol->kind == SymbolKind::PARAMETER ||
+        (symbol->kind == SymbolKind::VARIABLE && symbol->has_initializer)) {
+        record_type(expr, current_type_);
+        // 函数体/类体读全局变量：前向引用可能让体在其初始化之前运行，记下声明位置待查
+        if (parent_ && is_enforced_type(current_type_)) {
+            auto found = parent_->global_declared_at_.find(symbol);
+            if (found != parent_->global_declared_at_.end()) {
+                typed_global_limit_ = std::max(typed_global_limit_, found->second + 1);
+            }
+        }
+    }
 }
 
 void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
@@ -202,6 +562,11 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                             expr.op().line(), expr.op().column());
                     }
                     current_type_ = TokenType::KW_STRING;
+                    // 只有一侧确定为字符串时运行期才必然走拼接
+                    if (recorded_type(expr.left()) == TokenType::KW_STRING ||
+                        recorded_type(expr.right()) == TokenType::KW_STRING) {
+                        record_type(expr, TokenType::KW_STRING);
+                    }
                     return;
                 }
                 [[fallthrough]];
@@ -226,6 +591,10 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                 } else {
                     current_type_ = common_type(left_type, right_type);
                 }
+                if (is_numeric_type(recorded_type(expr.left())) &&
+                    is_numeric_type(recorded_type(expr.right()))) {
+                    record_type(expr, current_type_);
+                }
                 break;
 
             case TokenType::OP_EQUAL:
@@ -236,6 +605,7 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = TokenType::KW_BOOL;
+                record_type(expr, current_type_);
                 break;
 
             case TokenType::OP_GREATER:
@@ -250,6 +620,7 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = TokenType::KW_BOOL;
+                record_type(expr, current_type_);
                 break;
 
             case TokenType::OP_AND:
@@ -267,6 +638,11 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                                  right_type == TokenType::KW_TRIBOOL)
                     ? TokenType::KW_TRIBOOL
                     : TokenType::KW_BOOL;
+                // 两侧确定为 bool 时结果才确定为 bool（object 可能在运行期为 tribool）
+                if (recorded_type(expr.left()) == TokenType::KW_BOOL &&
+                    recorded_type(expr.right()) == TokenType::KW_BOOL) {
+                    record_type(expr, TokenType::KW_BOOL);
+                }
                 break;
 
             case TokenType::OP_BIT_AND:
@@ -279,6 +655,10 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = common_type(left_type, right_type);
+                // 位运算结果恒为整数（否则抛运行期错误）
+                if (is_numeric_type(current_type_)) {
+                    record_type(expr, current_type_);
+                }
                 break;
 
             case TokenType::OP_BIT_LSHIFT:
@@ -293,6 +673,9 @@ void SemanticAnalyzer::visitBinary(const BinaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = left_type;
+                if (is_numeric_type(current_type_)) {
+                    record_type(expr, current_type_);
+                }
                 break;
 
             default:
@@ -327,8 +710,7 @@ void SemanticAnalyzer::visitVarDecl(const VarDeclStmt& stmt) {
             // 如果是标识符，尝试将其解析为类型
             type_token = get_identifier_type(stmt.type().lexeme());
             // 已声明的类名作为类型：按 object 动态处理（如 `Animal a = ...`）
-            if (type_token == TokenType::IDENTIFIER &&
-                declared_classes_.count(std::string(stmt.type().lexeme())) != 0) {
+            if (type_token == TokenType::IDENTIFIER && find_class(stmt.type().lexeme())) {
                 type_token = TokenType::KW_OBJECT;
             }
         }
@@ -377,10 +759,14 @@ void SemanticAnalyzer::visitVarDecl(const VarDeclStmt& stmt) {
 
             // 标记变量已初始化
             symbol.is_initialized = true;
+            symbol.has_initializer = true;
         }
 
         // 将符号添加到符号表
         symbols_.define(symbol);
+        if (!parent_ && symbol.scope_level == 0 && symbol.has_initializer) {
+            global_declared_at_.emplace(symbols_.resolve(symbol.name.lexeme()), position_);
+        }
 
     } catch (const SemanticError& error) {
         record_error(error);
@@ -576,115 +962,118 @@ void SemanticAnalyzer::visitSwitch(const SwitchStmt& stmt) {
 
 void SemanticAnalyzer::visitFunction(const FunctionStmt& stmt) {
     try {
-        // 检查函数是否已在当前作用域中定义
-        std::string name(stmt.name().lexeme());
-
-        // 获取所有同名函数
-        std::vector<Symbol*> overloads = symbols_.resolve_overloads(name);
-
-        // 检查是否有完全相同的函数签名
-        for (const auto* overload : overloads) {
-            if (is_same_signature(*overload, stmt)) {
-                throw SemanticError("Function '" + name + "' with same signature is already defined",
-                    stmt.name().line(), stmt.name().column());
-            }
+        // 先在当前作用域定义函数（此时已有完整参数列表）——允许递归调用
+        Symbol function = make_function_symbol(stmt);
+        symbols_.define(function);
+        check_function_body(stmt, function);
+    } catch (const SemanticError& error) {
+        record_error(error);
+        if (!in_panic_mode_) {
+            enter_panic_mode();
+            synchronize();
         }
+    }
+}
 
-        // 创建函数符号；返回类型为已声明类名时按 object 动态处理
-        // （与 visitVarDecl 的类名→object 映射同规则，t61 实例作返回值）
-        Token return_type = stmt.return_type();
-        if (return_type.type() == TokenType::IDENTIFIER &&
-            declared_classes_.count(std::string(return_type.lexeme())) != 0) {
-            return_type = Token(TokenType::KW_OBJECT, return_type.lexeme(),
-                                return_type.line(), return_type.column());
-        }
-        Symbol function{
-            SymbolKind::FUNCTION,
-            return_type,
-            stmt.name(),
-            symbols_.current_scope_level(),
-            true,  // 函数定义时就认为是已初始化的
-            false, // 不是常量
-            {}     // 参数列表先为空
-        };
+Symbol SemanticAnalyzer::make_function_symbol(const FunctionStmt& stmt) {
+    std::string_view name = stmt.name().lexeme();
 
-        // 先收集参数列表（检查重名），填充函数符号的 parameters
-        std::vector<Symbol> param_symbols;
-        for (const auto& param : stmt.parameters()) {
-            // 检查参数名是否重复（在已收集的参数中查找）
-            for (const auto& prev : param_symbols) {
-                if (prev.name.lexeme() == param.name.lexeme()) {
-                    throw SemanticError("Duplicate parameter name '" +
-                        std::string(param.name.lexeme()) + "'",
-                        param.name.line(), param.name.column());
-                }
-            }
+    // 检查是否有完全相同的函数签名（同名函数允许重载）
+    for (const auto* overload : lookup_overloads(name)) {
+        if (is_same_signature(*overload, stmt)) {
+            throw SemanticError("Function '" + std::string(name) +
+                                    "' with same signature is already defined",
+                stmt.name().line(), stmt.name().column());
+        }
+    }
 
-            // 创建参数符号；类型为已声明类名时按 object 动态处理
-            // （t61 实例作参数，方法/字段访问走 object 动态放行）
-            Token param_type = param.type;
-            if (param_type.type() == TokenType::IDENTIFIER &&
-                declared_classes_.count(std::string(param_type.lexeme())) != 0) {
-                param_type = Token(TokenType::KW_OBJECT, param_type.lexeme(),
-                                   param_type.line(), param_type.column());
+    // 创建函数符号；返回类型为已声明类名时按 object 动态处理
+    // （与 visitVarDecl 的类名→object 映射同规则，t61 实例作返回值）
+    Token return_type = stmt.return_type();
+    if (return_type.type() == TokenType::IDENTIFIER && find_class(return_type.lexeme())) {
+        return_type = Token(TokenType::KW_OBJECT, return_type.lexeme(),
+                            return_type.line(), return_type.column());
+    }
+    Symbol function{
+        SymbolKind::FUNCTION,
+        return_type,
+        stmt.name(),
+        symbols_.current_scope_level(),
+        true,  // 函数定义时就认为是已初始化的
+        false, // 不是常量
+        {}     // 参数列表先为空
+    };
+
+    // 先收集参数列表（检查重名），填充函数符号的 parameters
+    auto param_symbols = std::make_shared<std::vector<Symbol>>();
+    param_symbols->reserve(stmt.parameters().size());
+    for (const auto& param : stmt.parameters()) {
+        // 检查参数名是否重复（在已收集的参数中查找）
+        for (const auto& prev : *param_symbols) {
+            if (prev.name.lexeme() == param.name.lexeme()) {
+                throw SemanticError("Duplicate parameter name '" +
+                    std::string(param.name.lexeme()) + "'",
+                    param.name.line(), param.name.column());
             }
-            Symbol param_symbol{
-                SymbolKind::PARAMETER,
-                param_type,
-                param.name,
-                symbols_.current_scope_level() + 1,  // 将在函数作用域内
-                true  // 参数总是已初始化的
-            };
-
-            function.parameters.push_back(param_symbol);
-            param_symbols.push_back(param_symbol);
         }
 
-        // 在当前作用域定义函数（此时已有完整参数列表）——允许递归调用
-        symbols_.define(function);
+        // 创建参数符号；类型为已声明类名时按 object 动态处理
+        // （t61 实例作参数，方法/字段访问走 object 动态放行）
+        Token param_type = param.type;
+        if (param_type.type() == TokenType::IDENTIFIER && find_class(param_type.lexeme())) {
+            param_type = Token(TokenType::KW_OBJECT, param_type.lexeme(),
+                               param_type.line(), param_type.column());
+        }
+        Symbol param_symbol{
+            SymbolKind::PARAMETER,
+            param_type,
+            param.name,
+            symbols_.current_scope_level() + 1,  // 将在函数作用域内
+            true  // 参数总是已初始化的
+        };
 
-        // 保存当前函数以供 return 语句检查
-        Symbol* previous_function = current_function_;
-        current_function_ = &function;
+        param_symbols->push_back(param_symbol);
+    }
+    function.parameters = param_symbols;
+    return function;
+}
 
-        // 进入函数作用域
-        symbols_.begin_scope();
+void SemanticAnalyzer::check_function_body(const FunctionStmt& stmt, const Symbol& function) {
+    // 保存当前函数以供 return 语句检查
+    const Symbol* previous_function = current_function_;
+    current_function_ = &function;
 
-        // 重置返回值标记
-        has_return_ = false;
+    // 进入函数作用域
+    symbols_.begin_scope();
 
-        // 将参数符号注册到函数作用域
-        for (const auto& ps : param_symbols) {
-            symbols_.define(ps);
-        }
+    // 重置返回值标记
+    has_return_ = false;
 
-        // 分析函数体
-        stmt.body()->accept(*this);
+    // 将参数符号注册到函数作用域
+    for (size_t i = 0; i < function.parameter_count(); ++i) {
+        symbols_.define(function.parameter(i));
+    }
 
-        // 返回值路径检查结果先记下，待作用域闭合后再抛出，
-        // 避免异常路径跳过 end_scope 造成作用域泄漏（参数溢出到外层，
-        // 后续顶层声明误报重复定义）
-        bool missing_return =
-            stmt.return_type().type() != TokenType::KW_NONE && !has_return_;
+    // 分析函数体
+    stmt.body()->accept(*this);
 
-        // 退出函数作用域
-        symbols_.end_scope();
+    // 返回值路径检查结果先记下，待作用域闭合后再抛出，
+    // 避免异常路径跳过 end_scope 造成作用域泄漏（参数溢出到外层，
+    // 后续顶层声明误报重复定义）
+    bool missing_return =
+        stmt.return_type().type() != TokenType::KW_NONE && !has_return_;
 
-        // 恢复之前的函数上下文
-        current_function_ = previous_function;
+    // 退出函数作用域
+    symbols_.end_scope();
 
-        // 检查是否所有路径都有返回值
-        if (missing_return) {
-            throw SemanticError("Function '" + name + "' must return a value in all code paths",
-                stmt.name().line(), stmt.name().column());
-        }
+    // 恢复之前的函数上下文
+    current_function_ = previous_function;
 
-    } catch (const SemanticError& error) {
-        record_error(error);
-        if (!in_panic_mode_) {
-            enter_panic_mode();
-            synchronize();
-        }
+    // 检查是否所有路径都有返回值
+    if (missing_return) {
+        throw SemanticError("Function '" + std::string(stmt.name().lexeme()) +
+                                "' must return a value in all code paths",
+            stmt.name().line(), stmt.name().column());
     }
 }
 
@@ -728,6 +1117,7 @@ void SemanticAnalyzer::visitCall(const CallExpr& expr) {
                 } else {
                     current_type_ = TokenType::KW_NUMBER;
                 }
+                record_type(expr, current_type_);
                 return;
             }
         }
@@ -750,15 +1140,17 @@ void SemanticAnalyzer::visitCall(const CallExpr& expr) {
         }
 
         std::string func_name(callee->name().lexeme());
-        auto overloads = symbols_.resolve_overloads(func_name);
+        auto overloads = lookup_overloads(func_name);
 
         if (overloads.empty()) {
             throw SemanticError("Undefined function '" + func_name + "'",
                 callee->name().line(), callee->name().column());
         }
 
+        note_call(overloads);
+
         // 查找最匹配的重载函数
-        Symbol* best_match = find_best_overload(overloads, arg_types, expr.paren());
+        const Symbol* best_match = find_best_overload(overloads, arg_types, expr.paren());
         if (!best_match) {
             std::string message = "No matching overload for function '" + func_name + "'";
             throw SemanticError(message, expr.paren().line(), expr.paren().column());
@@ -779,13 +1171,13 @@ void SemanticAnalyzer::visitCall(const CallExpr& expr) {
 // 辅助方法：检查函数签名是否相同
 bool SemanticAnalyzer::is_same_signature(const Symbol& func1, const FunctionStmt& func2) {
     // 检查参数数量
-    if (func1.parameters.size() != func2.parameters().size()) {
+    if (func1.parameter_count() != func2.parameters().size()) {
         return false;
     }
 
     // 检查每个参数的类型
-    for (size_t i = 0; i < func1.parameters.size(); ++i) {
-        if (func1.parameters[i].type.type() != func2.parameters()[i].type.type()) {
+    for (size_t i = 0; i < func1.parameter_count(); ++i) {
+        if (func1.parameter(i).type.type() != func2.parameters()[i].type.type()) {
             return false;
         }
     }
@@ -795,15 +1187,15 @@ bool SemanticAnalyzer::is_same_signature(const Symbol& func1, const FunctionStmt
 }
 
 // 辅助方法：查找最匹配的重载函数
-Symbol* SemanticAnalyzer::find_best_overload(
-    const std::vector<Symbol*>& overloads,
+const Symbol* SemanticAnalyzer::find_best_overload(
+    const std::vector<const Symbol*>& overloads,
     const std::vector<TokenType>& arg_types,
     const Token& error_location) {
 
-    Symbol* best_match = nullptr;
+    const Symbol* best_match = nullptr;
     int best_score = -1;
 
-    for (Symbol* overload : overloads) {
+    for (const Symbol* overload : overloads) {
         int score = calculate_overload_score(*overload, arg_types);
         if (score > best_score) {
             best_score = score;
@@ -818,13 +1210,13 @@ int SemanticAnalyzer::calculate_overload_score(
     const Symbol& func,
     const std::vector<TokenType>& arg_types) {
 
-    if (func.parameters.size() != arg_types.size()) {
+    if (func.parameter_count() != arg_types.size()) {
         return -1;
     }
 
     int score = 0;
     for (size_t i = 0; i < arg_types.size(); ++i) {
-        TokenType param_type = func.parameters[i].type.type();
+        TokenType param_type = func.parameter(i).type.type();
         TokenType arg_type = arg_types[i];
 
         if (param_type == arg_type) {
@@ -843,7 +1235,8 @@ void SemanticAnalyzer::visitAssign(const AssignExpr& expr) {
     try {
         // 先检查变量是否存在
         std::string name(expr.name().lexeme());
-        Symbol* symbol = symbols_.resolve(name);
+        Symbol* local = symbols_.resolve(name);
+        const Symbol* symbol = local ? local : lookup(name);
         if (!symbol) {
             throw SemanticError("Undefined variable '" + name + "'",
                 expr.name().line(), expr.name().column());
@@ -868,11 +1261,20 @@ void SemanticAnalyzer::visitAssign(const AssignExpr& expr) {
         }
 
         // 标记变量已初始化和被修改
-        symbol->is_initialized = true;
-        symbol->is_modified = true;
+        if (local) {
+            if (!local->is_initialized && local->scope_level == 0) {
+                global_initialized_at_.emplace(local, position_);
+            }
+            local->is_initialized = true;
+            local->is_modified = true;
+        } else if (assigned_globals_.insert(symbol).second) {
+            // 工作分析器不改动共享的全局符号：赋值记在任务内，合并诊断时再生效
+            global_assignments_.emplace_back(symbol, position_);
+        }
 
-        // 赋值表达式的类型是被赋值的变量的类型
+        // 赋值表达式的类型是被赋值的变量的类型（所赋的值已按声明类型强制）
         current_type_ = symbol->type.type();
+        record_type(expr, current_type_);
 
     } catch (const SemanticError& error) {
         record_error(error);
@@ -896,6 +1298,9 @@ void SemanticAnalyzer::visitUnary(const UnaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = operand_type;
+                if (is_numeric_type(recorded_type(expr.operand()))) {
+                    record_type(expr, current_type_);
+                }
                 break;
 
             case TokenType::OP_NOT:
@@ -906,6 +1311,9 @@ void SemanticAnalyzer::visitUnary(const UnaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = operand_type;
+                if (recorded_type(expr.operand()) == TokenType::KW_BOOL) {
+                    record_type(expr, TokenType::KW_BOOL);
+                }
                 break;
 
             case TokenType::OP_BIT_NOT:
@@ -914,6 +1322,7 @@ void SemanticAnalyzer::visitUnary(const UnaryExpr& expr) {
                         expr.op().line(), expr.op().column());
                 }
                 current_type_ = operand_type;
+                record_type(expr, current_type_);
                 break;
 
             default:
@@ -976,6 +1385,29 @@ bool SemanticAnalyzer::is_numeric_type(TokenType type) const {
     }
 }
 
+bool SemanticAnalyzer::is_enforced_type(TokenType type) const {
+    switch (type) {
+        case TokenType::KW_BOOL:
+        case TokenType::KW_TRIBOOL:
+        case TokenType::KW_STRING:
+        case TokenType::KW_ARRAY:
+        case TokenType::KW_TUPLE:
+            return true;
+        default:
+            return is_numeric_type(type);
+    }
+}
+
+void SemanticAnalyzer::record_type(const Expr& expr, TokenType type) {
+    if (untyped_sink_) {
+        untyped_sink_->push_back(&expr);
+        return;
+    }
+    if (is_enforced_type(type)) {
+        type_sink_->record(expr, type);
+    }
+}
+
 bool SemanticAnalyzer::is_numeric_convertible(TokenType type) const {
     return is_numeric_type(type) || type == TokenType::KW_CHAR;
 }
@@ -1283,41 +1715,46 @@ bool SemanticAnalyzer::is_synchronization_point() const {
 }
 
 // 添加 token 访问辅助方法
+const std::vector<Token>& SemanticAnalyzer::tokens() const {
+    static const std::vector<Token> empty_tokens;  // 未调用 set_tokens 时视为空序列
+    return tokens_ ? *tokens_ : empty_tokens;
+}
+
 const Token& SemanticAnalyzer::current_token() const {
-    if (tokens_.empty()) {
+    if (tokens().empty()) {
         static Token empty_token;  // 返回一个静态的空 token
         return empty_token;
     }
-    if (current_token_index_ >= tokens_.size()) {
-        return tokens_.back();  // 返回 EOF token
+    if (current_token_index_ >= tokens().size()) {
+        return tokens().back();  // 返回 EOF token
     }
-    return tokens_[current_token_index_];
+    return tokens()[current_token_index_];
 }
 
 const Token& SemanticAnalyzer::previous_token() const {
-    if (tokens_.empty()) {
+    if (tokens().empty()) {
         static Token empty_token;  // 返回一个静态的空 token
         return empty_token;
     }
     if (current_token_index_ == 0) {
-        return tokens_[0];
+        return tokens()[0];
     }
-    return tokens_[current_token_index_ - 1];
+    return tokens()[current_token_index_ - 1];
 }
 
 const Token& SemanticAnalyzer::peek_next() const {
-    if (tokens_.empty()) {
+    if (tokens().empty()) {
         static Token empty_token;  // 返回一个静态的空 token
         return empty_token;
     }
-    if (current_token_index_ + 1 >= tokens_.size()) {
-        return tokens_.back();  // 返回 EOF token
+    if (current_token_index_ + 1 >= tokens().size()) {
+        return tokens().back();  // 返回 EOF token
     }
-    return tokens_[current_token_index_ + 1];
+    return tokens()[current_token_index_ + 1];
 }
 
 void SemanticAnalyzer::advance_token() {
-    if (!tokens_.empty() && current_token_index_ < tokens_.size() - 1) {
+    if (!tokens().empty() && current_token_index_ < tokens().size() - 1) {
         ++current_token_index_;
     }
 }
@@ -1332,6 +1769,7 @@ void SemanticAnalyzer::visitTuple(const TupleExpr& expr) {
 
         // 设置当前类型为元组类型
         current_type_ = TokenType::KW_TUPLE;
+        record_type(expr, current_type_);
 
     } catch (const SemanticError& error) {
         record_error(error);
@@ -1392,6 +1830,13 @@ void SemanticAnalyzer::visitTernary(const TernaryExpr& expr) {
 
         // 结果类型取 then 分支类型
         current_type_ = then_type;
+        // 各分支兼容不等于种类相同：只在所有分支都确定为同一类型时收录
+        TokenType branch_type = recorded_type(expr.then_expr());
+        if (branch_type == recorded_type(expr.else_expr()) &&
+            (expr.unset_expr() == nullptr ||
+             branch_type == recorded_type(expr.unset_expr()))) {
+            record_type(expr, branch_type);
+        }
 
     } catch (const SemanticError& error) {
         record_error(error);
@@ -1495,6 +1940,7 @@ void SemanticAnalyzer::visitArrayLiteral(const ArrayLiteralExpr& expr) {
             element->accept(*this);
         }
         current_type_ = TokenType::KW_ARRAY;
+        record_type(expr, current_type_);
 
     } catch (const SemanticError& error) {
         record_error(error);
@@ -1810,12 +2256,19 @@ void SemanticAnalyzer::visitArrayType(const ArrayType& type) {
 }
 
 void SemanticAnalyzer::visitClass(const ClassStmt& stmt) {
+    // 顶层类在第一阶段登记、第二阶段检查类体；此处只处理嵌套在语句块中的类声明
+    if (declare_class(stmt)) {
+        check_class_body(stmt);
+    }
+}
+
+bool SemanticAnalyzer::declare_class(const ClassStmt& stmt) {
     // 最小子集（Java/C# 风格，经作者确认）：登记类名，类体在独立作用域内
     // 分析；字段/方法的细粒度类型检查按 object 动态放行，运行期再检查。
     // TODO(semantic): 待类型系统闭环后建立正式的类符号表（字段/方法签名）。
     try {
         const std::string name(stmt.name().lexeme());
-        if (declared_classes_.count(name) != 0) {
+        if (find_class(name)) {
             throw SemanticError(
                 "Class '" + name + "' is already defined",
                 stmt.name().line(), stmt.name().column());
@@ -1829,7 +2282,7 @@ void SemanticAnalyzer::visitClass(const ClassStmt& stmt) {
                     "Class '" + name + "' cannot extend itself",
                     stmt.superclass().line(), stmt.superclass().column());
             }
-            if (declared_classes_.count(super_name) == 0) {
+            if (!find_class(super_name)) {
                 throw SemanticError(
                     "Undefined superclass '" + super_name + "'",
                     stmt.superclass().line(), stmt.superclass().column());
@@ -1843,18 +2296,13 @@ void SemanticAnalyzer::visitClass(const ClassStmt& stmt) {
             enter_panic_mode();
             synchronize();
         }
-        return;
+        return false;
     }
 
     // @override 校验：标注的方法在父类链上必须存在同名方法
     // （仅记录错误不中断，类体其余成员照常分析）
-    const ClassStmt* superclass = nullptr;
-    if (stmt.has_superclass()) {
-        auto it = declared_classes_.find(std::string(stmt.superclass().lexeme()));
-        if (it != declared_classes_.end()) {
-            superclass = it->second;
-        }
-    }
+    const ClassStmt* superclass =
+        stmt.has_superclass() ? find_class(stmt.superclass().lexeme()) : nullptr;
     for (const auto& member : stmt.members()) {
         auto* method = dynamic_cast<const FunctionStmt*>(member.get());
         if (!method || !method->is_override()) {
@@ -1870,7 +2318,10 @@ void SemanticAnalyzer::visitClass(const ClassStmt& stmt) {
                 method->name().line(), method->name().column()));
         }
     }
+    return true;
+}
 
+void SemanticAnalyzer::check_class_body(const ClassStmt& stmt) {
     // 类体内分析期间放行 this（各成员 visit 内部自行捕获错误）
     bool prev_in_class = in_class_;
     in_class_ = true;
@@ -1910,11 +2361,13 @@ void SemanticAnalyzer::visitPropertyAssign(const PropertyAssignExpr& expr) {
 void SemanticAnalyzer::visitNew(const NewExpr& expr) {
     try {
         const std::string name(expr.class_name().lexeme());
-        if (declared_classes_.count(name) == 0) {
+        const ClassStmt* klass = find_class(name);
+        if (!klass) {
             throw SemanticError(
                 "Undefined class '" + name + "'",
                 expr.class_name().line(), expr.class_name().column());
         }
+        note_instantiation(klass);
 
         // 构造器元数运行期检查，此处仅分析实参表达式
         for (const auto& argument : expr.arguments()) {
@@ -2002,7 +2455,7 @@ void SemanticAnalyzer::visitBaseMethodCall(const BaseMethodCallExpr& expr) {
 // -----------------------------------------------------------------------------
 
 const FunctionStmt* SemanticAnalyzer::find_method_in_hierarchy(
-    const ClassStmt* klass, const std::string& name) const {
+    const ClassStmt* klass, std::string_view name) const {
     // 沿继承链自子向父查找（父类必已声明，链有限无环）
     for (const ClassStmt* c = klass; c != nullptr; ) {
         for (const auto& member : c->members()) {
@@ -2015,13 +2468,13 @@ const FunctionStmt* SemanticAnalyzer::find_method_in_hierarchy(
         if (!c->has_superclass()) {
             break;
         }
-        auto it = declared_classes_.find(std::string(c->superclass().lexeme()));
-        c = (it != declared_classes_.end()) ? it->second : nullptr;
+        c = find_class(c->superclass().lexeme());
     }
     return nullptr;
 }
 
 void SemanticAnalyzer::reset_state() {
+    symbols_ = SymbolTable();
     errors_.clear();
     in_panic_mode_ = false;
     current_token_index_ = 0;
@@ -2032,6 +2485,20 @@ void SemanticAnalyzer::reset_state() {
     array_element_type_ = TokenType::INVALID;
     declared_classes_.clear();
     in_class_ = false;
+    expr_types_.clear();
+    type_sink_ = &expr_types_;
+    position_ = 0;
+    first_task_position_ = SIZE_MAX;
+    tasks_.clear();
+    diagnostics_.clear();
+    global_initialized_at_.clear();
+    global_assignments_.clear();
+    function_tasks_.clear();
+    class_tasks_.clear();
+    global_declared_at_.clear();
+    top_level_runs_.clear();
+    task_runs_.clear();
+    typed_globals_.clear();
 }
 
 template<typename Func>
@@ -6,20 +6,35 @@
 #ifndef COLLIE_SEMANTIC_ANALYZER_H
 #define COLLIE_SEMANTIC_ANALYZER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include "semantic_common.h"
 #include "symbol_table.h"
 #include "../parser/ast.h"
+#include "../parser/expr_types.h"
 #include "../lexer/token.h"
 
 namespace collie {
 
 /**
  * @brief 语义分析器类，负责类型检查和语义错误检测
+ *
+ * 分两个阶段：
+ * 1. 按源码顺序登记全部顶层类与函数签名（此后任何位置都可引用，支持前向引用与相互递归），
+ *    再按源码顺序检查其余顶层语句；顶层函数体/类体只记下声明处可见的全局符号。
+ * 2. 在线程池上并行检查顶层函数体与类体。全局符号此时只读，各任务的错误按所属顶层语句
+ *    的源码顺序合并，诊断与线程数无关。
+ *
+ * 前向引用使函数体可能在它读取的全局变量初始化之前运行（如顶层先调用 h，h 再调用其后
+ * 声明的 f）。分析时记下调用关系，算出每个函数体/类体最早可能运行的顶层语句；早于所读
+ * 全局变量初始化的，撤销该体内的静态类型（执行引擎照常做运行期检查）。
  */
 class SemanticAnalyzer : public ExprVisitor, public StmtVisitor, public TypeVisitor {
 public:
@@ -29,16 +44,23 @@ public:
      * @brief 分析AST，执行语义检查
      * @param statements AST根节点列表
      */
-    void analyze(const std::vector<std::unique_ptr<Stmt>>& statements);
+    void analyze(const std::vector<StmtPtr>& statements);
 
     /**
      * @brief 设置词法分析器生成的 token 序列
-     * @param tokens token 序列
+     * @param tokens token 序列，只引用不复制，须在分析期间保持有效
      */
     void set_tokens(const std::vector<Token>& tokens) {
-        tokens_ = tokens;
+        tokens_ = &tokens;
         current_token_index_ = 0;
     }
+    void set_tokens(std::vector<Token>&&) = delete;  // 禁止绑定临时序列
+
+    /**
+     * @brief 设置并行检查顶层函数体/类体的线程数
+     * @param jobs 线程数；0（默认）取硬件并发数，1 在当前线程内依次检查
+     */
+    void set_jobs(size_t jobs) { jobs_ = jobs; }
 
     /**
      * @brief 获取分析过程中收集的错误
@@ -52,6 +74,12 @@ public:
      */
     bool has_errors() const { return !errors_.empty(); }
 
+    /**
+     * @brief 获取分析得出的表达式静态类型表（供执行引擎省去运行期检查）
+     * @return 类型表的常量引用，随下一次 analyze 重建；只在无错误时可信
+     */
+    const ExprTypeTable& expr_types() const { return expr_types_; }
+
 private:
     // -----------------------------------------------------------------------------
     // 访问者模式实现
@@ -121,6 +149,96 @@ private:
      */
     void record_error(const SemanticError& error);
 
+    // -----------------------------------------------------------------------------
+    // 两阶段分析
+    // -----------------------------------------------------------------------------
+
+    /// @brief 待并行检查的顶层函数体或类体
+    struct BodyTask {
+        const Stmt* stmt;         ///< 顶层函数或类声明
+        const Symbol* function;   ///< 顶层函数的符号（类为 nullptr）
+        size_t position;          ///< 所在顶层语句下标
+        size_t visible;           ///< 声明处的全局符号栈高度（只看得到此前定义的全局符号）
+    };
+
+    /// @brief 带合并排序键的错误
+    struct Diagnostic {
+        SemanticError error;
+        size_t position;                 ///< 所属顶层语句下标
+        const Symbol* global = nullptr;  ///< 非空：读取尚未初始化的全局变量，若先前的函数体/类体给它赋过值则撤销
+    };
+
+    /**
+     * @brief 第一阶段：按源码顺序登记全部顶层类与函数签名，并为其体建立检查任务
+     * @param statements 顶层语句
+     */
+    void declare_signatures(const std::vector<StmtPtr>& statements);
+
+    /**
+     * @brief 建立函数符号：检查同签名重载与参数重名，收集参数列表
+     * @param stmt 函数声明
+     * @return 尚未定义到符号表的函数符号
+     * @throw SemanticError 签名重复或参数重名时
+     */
+    Symbol make_function_symbol(const FunctionStmt& stmt);
+
+    /**
+     * @brief 在函数作用域内检查函数体与返回值路径
+     * @param stmt 函数声明
+     * @param function 函数符号（提供返回类型与参数列表）
+     * @throw SemanticError 非 none 函数存在未返回的路径时
+     */
+    void check_function_body(const FunctionStmt& stmt, const Symbol& function);
+
+    /**
+     * @brief 登记类声明并校验继承与 @override
+     * @return 登记失败（重名/父类非法）时返回 false，类体不再检查
+     */
+    bool declare_class(const ClassStmt& stmt);
+
+    /// @brief 在类作用域内检查类体成员
+    void check_class_body(const ClassStmt& stmt);
+
+    /// @brief 第二阶段：在线程池上检查全部顶层函数体/类体，并合并各线程的结果
+    void run_body_tasks();
+
+    /// @brief 在工作分析器上检查第 index 个任务（只读访问 parent_ 的全局符号）
+    void run_task(size_t index);
+
+    /// @brief 记下当前代码（顶层语句或任务）可能运行第 task 个任务
+    void note_runs(size_t task);
+
+    /// @brief 函数调用可能运行同名的任一顶层函数（运行期按实参再选重载）
+    void note_call(const std::vector<const Symbol*>& overloads);
+
+    /// @brief new 运行该类及各祖先类的类体代码（字段初始值、构造器），此后方法才可调用
+    void note_instantiation(const ClassStmt* klass);
+
+    /**
+     * @brief 撤销可能早于所读全局变量初始化运行的函数体/类体的静态类型
+     * 按调用关系求各任务最早可能运行的顶层语句；读过其后才初始化的全局变量的任务，
+     * 重新检查一遍收集它登记过类型的节点并置为未知
+     */
+    void untype_early_bodies();
+
+    /// @brief 按顶层语句顺序合并诊断，撤销被先前函数体赋值覆盖的未初始化读取，生成 errors_
+    void finish_diagnostics();
+
+    /// @brief 按名字解析符号：先查本分析器的符号表，并行阶段再查声明处可见的全局符号
+    const Symbol* lookup(std::string_view name) const;
+
+    /// @brief 同名函数重载（由内层到外层），并行阶段含声明处可见的全局函数
+    std::vector<const Symbol*> lookup_overloads(std::string_view name) const;
+
+    /// @brief 按名字查找已登记的类（并行阶段含顶层类）
+    const ClassStmt* find_class(std::string_view name) const;
+
+    /**
+     * @brief 变量在此处是否已初始化
+     * 并行阶段的全局变量：带初始化声明，或在此前的顶层语句、本任务中先被赋值
+     */
+    bool is_initialized_here(const Symbol& symbol) const;
+
     /**
      * @brief 沿继承链（含起点类）查找同名方法，用于 @override 覆写校验
      * @param klass 起点类（传父类则不含子类自身）
@@ -128,7 +246,7 @@ private:
      * @return 命中的方法声明，未找到返回 nullptr
      */
     const FunctionStmt* find_method_in_hierarchy(const ClassStmt* klass,
-                                                 const std::string& name) const;
+                                                 std::string_view name) const;
 
     /**
      * @brief 进入错误恢复模式
@@ -162,6 +280,23 @@ private:
      */
     bool is_numeric_type(TokenType type) const;
 
+    /**
+     * @brief 检查类型是否由运行期按声明类型强制（值的种类可由类型保证）
+     * @param type 要检查的类型
+     * @return 数值、bool、tribool、string、array、Tuple 返回 true；object/类名等动态类型返回 false
+     */
+    bool is_enforced_type(TokenType type) const;
+
+    /**
+     * @brief 把表达式的静态类型记入类型表（仅收录 is_enforced_type 的类型）
+     * @param expr 表达式节点
+     * @param type 静态类型
+     */
+    void record_type(const Expr& expr, TokenType type);
+
+    /// @brief 已记入类型表的静态类型，未收录时返回 INVALID
+    TokenType recorded_type(const Expr* expr) const { return type_sink_->type_of(expr); }
+
     /**
      * @brief 检查类型是否可以转换为数值类型
      * @param type 要检查的类型
@@ -228,8 +363,8 @@ private:
      * @param error_location 错误位置信息
      * @return 最匹配的函数符号指针，如果没有匹配返回 nullptr
      */
-    Symbol* find_best_overload(
-        const std::vector<Symbol*>& overloads,
+    const Symbol* find_best_overload(
+        const std::vector<const Symbol*>& overloads,
         const std::vector<TokenType>& arg_types,
         const Token& error_location);
 
@@ -246,6 +381,7 @@ private:
     // -----------------------------------------------------------------------------
     // Token 处理相关方法
     // -----------------------------------------------------------------------------
+    const std::vector<Token>& tokens() const;
     const Token& current_token() const;
     const Token& previous_token() const;
     const Token& peek_next() const;
@@ -274,14 +410,39 @@ private:
     std::vector<SemanticError> errors_;        ///< 错误列表
     bool in_panic_mode_ = false;               ///< 是否在错误恢复模式
     TokenType current_type_ = TokenType::INVALID; ///< 当前表达式的类型
-    Symbol* current_function_ = nullptr;        ///< 当前正在分析的函数
+    const Symbol* current_function_ = nullptr;  ///< 当前正在分析的函数
     bool has_return_ = false;                  ///< 当前路径是否有返回值
     int loop_depth_ = 0;                       ///< 循环嵌套深度
-    std::vector<Token> tokens_;                ///< token 序列
+    const std::vector<Token>* tokens_ = nullptr; ///< token 序列（调用方持有）
     size_t current_token_index_ = 0;           ///< 当前 token 索引
     TokenType array_element_type_ = TokenType::INVALID; ///< 当前数组的元素类型
     std::unordered_map<std::string, const ClassStmt*> declared_classes_;  ///< 已声明的类（名字 -> 声明节点，供继承链/覆写校验查询）
     bool in_class_ = false;                    ///< 是否正在分析类体（放行 this）
+    ExprTypeTable expr_types_;                 ///< 运行期种类可静态保证的表达式类型
+    ExprTypeTable* type_sink_ = nullptr;       ///< 本分析器登记类型的表（单个工作分析器直接写父分析器的表）
+    std::vector<const Expr*>* untyped_sink_ = nullptr;  ///< 非空时 record_type 只收集节点（撤销静态类型用）
+
+    // 两阶段分析状态
+    size_t jobs_ = 0;                          ///< 并行线程数，0 为硬件并发数
+    size_t position_ = 0;                      ///< 当前所在顶层语句下标
+    size_t first_task_position_ = SIZE_MAX;    ///< 第一个函数体/类体任务的下标
+    std::vector<BodyTask> tasks_;              ///< 第二阶段任务（按下标排序）
+    std::vector<Diagnostic> diagnostics_;      ///< 分析期间的错误（合并后生成 errors_）
+    const SemanticAnalyzer* parent_ = nullptr; ///< 工作分析器：全局符号与顶层类所在的分析器（只读）
+    size_t visible_globals_ = 0;               ///< 工作分析器：当前任务可见的全局符号栈高度
+    std::unordered_map<const Symbol*, size_t> global_initialized_at_;  ///< 未带初始化的全局变量首次被顶层语句赋值的位置
+    std::unordered_set<const Symbol*> assigned_globals_;               ///< 工作分析器：当前任务已赋值的全局变量
+    std::vector<std::pair<const Symbol*, size_t>> global_assignments_; ///< 函数体/类体给全局变量赋值（符号, 任务下标）
+
+    // 函数体/类体最早可能运行的位置
+    std::unordered_map<const Symbol*, size_t> function_tasks_;     ///< 顶层函数符号 -> 任务下标
+    std::unordered_map<const ClassStmt*, size_t> class_tasks_;     ///< 顶层类 -> 任务下标
+    std::unordered_map<const Symbol*, size_t> global_declared_at_; ///< 带初始化的全局变量 -> 声明所在的顶层语句下标
+    std::vector<std::pair<size_t, size_t>> top_level_runs_;  ///< 顶层语句可能运行的任务（语句下标, 任务下标）
+    std::vector<std::pair<size_t, size_t>> task_runs_;       ///< 任务可能运行的任务（调用方任务下标, 任务下标）
+    std::vector<std::pair<size_t, size_t>> typed_globals_;   ///< 任务内登记了类型的全局变量读取（任务下标, 最晚声明位置 + 1）
+    size_t current_task_ = 0;                 ///< 工作分析器：当前任务下标
+    size_t typed_global_limit_ = 0;           ///< 工作分析器：当前任务登记类型的全局变量读取的最晚声明位置 + 1，0 为没有
 
     // -----------------------------------------------------------------------------
     // 错误处理相关方法
@@ -4,87 +4,147 @@
  */
 #include "symbol_table.h"
 
+#include <functional>
+
 namespace collie {
 
-void Scope::define(const Symbol& symbol) {
-    std::string name(symbol.name.lexeme());
-
-    // 如果是函数，支持重载
-    if (symbol.kind == SymbolKind::FUNCTION) {
-        symbols_.emplace(name, symbol);
-    } else {
-        // 非函数符号，先删除已存在的，再插入新的
-        auto range = symbols_.equal_range(name);
-        symbols_.erase(range.first, range.second);
-        symbols_.emplace(name, symbol);
+namespace {
+
+constexpr size_t initial_slots = 256;
+
+uint64_t hash_name(std::string_view name) {
+    return std::hash<std::string_view>{}(name);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// SymbolInterner
+// -----------------------------------------------------------------------------
+size_t SymbolInterner::probe(std::string_view name, uint64_t hash) const {
+    uint32_t tag = static_cast<uint32_t>(hash);
+    size_t mask = slots_.size() - 1;
+    for (size_t i = static_cast<size_t>(hash >> 32) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots_[i];
+        if (slot.id == kInvalidSymbolId ||
+            (slot.hash == tag && names_[slot.id] == name)) {
+            return i;
+        }
     }
 }
 
-Symbol* Scope::resolve(const std::string& name) {
-    auto it = symbols_.find(name);
-    if (it != symbols_.end()) {
-        return &(it->second);
+SymbolId SymbolInterner::intern(std::string_view name) {
+    if ((names_.size() + 1) * 2 > slots_.size()) {
+        grow();
+    }
+    uint64_t hash = hash_name(name);
+    Slot& slot = slots_[probe(name, hash)];
+    if (slot.id == kInvalidSymbolId) {
+        slot.id = static_cast<SymbolId>(names_.size());
+        slot.hash = static_cast<uint32_t>(hash);
+        names_.push_back(pool_.intern(name));
     }
-    return nullptr;
+    return slot.id;
 }
 
-bool Scope::is_defined(const std::string& name) const {
-    return symbols_.find(name) != symbols_.end();
+SymbolId SymbolInterner::find(std::string_view name) const {
+    if (slots_.empty()) {
+        return kInvalidSymbolId;
+    }
+    return slots_[probe(name, hash_name(name))].id;
 }
 
+void SymbolInterner::grow() {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? initial_slots : old.size() * 2, Slot{});
+    size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == kInvalidSymbolId) continue;
+        // 槽位只存了哈希低 32 位，重新计算完整哈希以确定新位置
+        uint64_t hash = hash_name(names_[slot.id]);
+        size_t i = static_cast<size_t>(hash >> 32) & mask;
+        while (slots_[i].id != kInvalidSymbolId) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = slot;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// SymbolTable
+// -----------------------------------------------------------------------------
 void SymbolTable::begin_scope() {
-    scopes_.emplace_back(scopes_.size());
+    scope_marks_.push_back(entries_.size());
 }
 
 void SymbolTable::end_scope() {
-    if (!scopes_.empty()) {
-        scopes_.pop_back();
+    if (scope_marks_.empty()) {
+        return;
+    }
+    size_t mark = scope_marks_.back();
+    scope_marks_.pop_back();
+    // 逆序撤销：同名符号在同一作用域内多次定义时，最终恢复到进入作用域前的链头
+    while (entries_.size() > mark) {
+        const Entry& entry = entries_.back();
+        heads_[entry.id] = entry.previous_head;
+        entries_.pop_back();
     }
 }
 
 void SymbolTable::define(const Symbol& symbol) {
-    if (!scopes_.empty()) {
-        scopes_.back().define(symbol);
+    if (scope_marks_.empty()) {
+        return;
+    }
+    SymbolId id = names_.intern(symbol.name.lexeme());
+    if (id >= heads_.size()) {
+        heads_.resize(static_cast<size_t>(id) + 1, kNoEntry);
     }
-}
 
-Symbol* SymbolTable::resolve(const std::string& name) {
-    // 从内层作用域向外层查找
-    for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-        if (Symbol* symbol = it->resolve(name)) {
-            return symbol;
+    uint32_t head = heads_[id];
+    uint32_t shadowed = head;
+    // 函数支持重载，与当前作用域的同名函数并存；
+    // 非函数符号覆盖当前作用域内的同名符号（含函数），链直接接到外层
+    if (symbol.kind != SymbolKind::FUNCTION) {
+        size_t mark = scope_marks_.back();
+        while (shadowed != kNoEntry && shadowed >= mark) {
+            shadowed = entries_[shadowed].shadowed;
         }
     }
-    return nullptr;
+    entries_.push_back(Entry{symbol, id, shadowed, head});
+    heads_[id] = static_cast<uint32_t>(entries_.size() - 1);
 }
 
-bool SymbolTable::is_defined_in_current_scope(const std::string& name) const {
-    if (!scopes_.empty()) {
-        return scopes_.back().is_defined(name);
-    }
-    return false;
+Symbol* SymbolTable::resolve(std::string_view name) {
+    return resolve(names_.find(name));
 }
 
-std::vector<Symbol*> SymbolTable::resolve_overloads(const std::string& name) {
-    std::vector<Symbol*> overloads;
+Symbol* SymbolTable::resolve(SymbolId id) {
+    uint32_t head = head_of(id);
+    return head == kNoEntry ? nullptr : &entries_[head].symbol;
+}
 
-    // 从内层作用域向外层查找
-    for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-        auto symbols = it->resolve_overloads(name);
-        overloads.insert(overloads.end(), symbols.begin(), symbols.end());
+bool SymbolTable::is_defined_in_current_scope(std::string_view name) const {
+    if (scope_marks_.empty()) {
+        return false;
     }
+    uint32_t head = head_of(names_.find(name));
+    return head != kNoEntry && head >= scope_marks_.back();
+}
 
-    return overloads;
+const Symbol* SymbolTable::resolve_at(std::string_view name, size_t height) const {
+    uint32_t head = head_at(names_.find(name), height);
+    return head == kNoEntry ? nullptr : &entries_[head].symbol;
 }
 
-std::vector<Symbol*> Scope::resolve_overloads(const std::string& name) {
-    std::vector<Symbol*> overloads;
+std::vector<const Symbol*> SymbolTable::resolve_overloads_at(std::string_view name,
+                                                            size_t height) const {
+    std::vector<const Symbol*> overloads;
 
-    // 在当前作用域中查找所有同名函数
-    auto range = symbols_.equal_range(name);
-    for (auto it = range.first; it != range.second; ++it) {
-        if (it->second.kind == SymbolKind::FUNCTION) {
-            overloads.push_back(&(it->second));
+    // 沿遮蔽链由内层向外层收集
+    for (uint32_t i = head_at(names_.find(name), height); i != kNoEntry;
+         i = entries_[i].shadowed) {
+        if (entries_[i].symbol.kind == SymbolKind::FUNCTION) {
+            overloads.push_back(&entries_[i].symbol);
         }
     }
 
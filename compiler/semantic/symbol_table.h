@@ -6,14 +6,22 @@
 #ifndef COLLIE_SYMBOL_TABLE_H
 #define COLLIE_SYMBOL_TABLE_H
 
-#include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include "../lexer/token.h"
+#include "../lexer/string_pool.h"
 
 namespace collie {
 
+// 符号名的稠密编号（由 SymbolInterner 分配，从 0 连续增长）
+using SymbolId = uint32_t;
+constexpr SymbolId kInvalidSymbolId = UINT32_MAX;
+
 // 符号类型
 enum class SymbolKind {
     VARIABLE,    // 变量
@@ -30,9 +38,10 @@ struct Symbol {
     bool is_initialized;      // 是否已初始化
     bool is_const;           // 是否是常量
     bool is_modified;        // 是否被修改过
+    bool has_initializer = false;  // 变量声明自带初始化（此后一定持有声明类型的值）
 
-    // 函数特有信息
-    std::vector<Symbol> parameters;  // 函数参数列表
+    // 函数特有信息：参数列表（同一函数的各份符号共享，define 时不再深拷贝）
+    std::shared_ptr<const std::vector<Symbol>> parameters;
 
     // 添加默认构造函数
     Symbol() : kind(SymbolKind::VARIABLE), scope_level(0),
@@ -40,35 +49,53 @@ struct Symbol {
 
     // 添加完整的构造函数
     Symbol(SymbolKind k, Token t, Token n, size_t level, bool init,
-           bool is_const = false, const std::vector<Symbol>& params = {})
+           bool is_const = false,
+           std::shared_ptr<const std::vector<Symbol>> params = nullptr)
         : kind(k), type(t), name(n), scope_level(level),
           is_initialized(init), is_const(is_const), is_modified(false),
-          parameters(params) {}
+          parameters(std::move(params)) {}
+
+    // 参数个数与第 i 个参数（非函数符号的参数个数为 0）
+    size_t parameter_count() const { return parameters ? parameters->size() : 0; }
+    const Symbol& parameter(size_t i) const { return (*parameters)[i]; }
 };
 
-// 作用域
-class Scope {
+// 符号名驻留表：相同名字只存一份，映射到稠密的 SymbolId
+class SymbolInterner {
 public:
-    explicit Scope(size_t level) : level_(level) {}
-
-    // 添加符号
-    void define(const Symbol& symbol);
+    // 驻留名字并返回其编号（已存在时返回原编号）
+    SymbolId intern(std::string_view name);
 
-    // 查找符号
-    Symbol* resolve(const std::string& name);
+    // 查找名字的编号，从未驻留过时返回 kInvalidSymbolId
+    SymbolId find(std::string_view name) const;
 
-    // 判断符号是否已在当前作用域中定义
-    bool is_defined(const std::string& name) const;
+    // 编号对应的名字
+    std::string_view name(SymbolId id) const { return names_[id]; }
 
-    // 获取所有同名的函数重载
-    std::vector<Symbol*> resolve_overloads(const std::string& name);
+    // 已驻留的名字个数
+    size_t size() const { return names_.size(); }
 
 private:
-    size_t level_;  // 作用域层级
-    std::unordered_multimap<std::string, Symbol> symbols_;  // 符号表，支持重载
+    struct Slot {
+        SymbolId id = kInvalidSymbolId;  // kInvalidSymbolId 表示空槽
+        uint32_t hash = 0;               // 哈希值低 32 位，比较文本前先比较它
+    };
+
+    // 名字所在的槽位，或探测序列上遇到的第一个空槽
+    size_t probe(std::string_view name, uint64_t hash) const;
+    void grow();
+
+    StringPool pool_;                     // 名字文本的存储
+    std::vector<std::string_view> names_;  // SymbolId -> 名字
+    std::vector<Slot> slots_;             // 线性探测的开放寻址表，容量为 2 的幂，装载率不超过 1/2
 };
 
 // 符号表
+//
+// 作用域不各自建表：所有可见符号按定义顺序压在同一个栈里，每个名字的最内层符号
+// 记在按 SymbolId 下标的链头数组中，同名的外层符号（及同一作用域中的先前重载）
+// 经 shadowed 串成遮蔽链。查找只需一次驻留表查找加一次下标访问，与作用域深度无关；
+// 退出作用域时按栈顶各符号记下的旧链头依次撤销。
 class SymbolTable {
 public:
     SymbolTable() { begin_scope(); }  // 创建全局作用域
@@ -79,17 +106,56 @@ public:
 
     // 符号管理
     void define(const Symbol& symbol);  // 定义新符号
-    Symbol* resolve(const std::string& name);  // 查找符号
-    bool is_defined_in_current_scope(const std::string& name) const;  // 检查当前作用域
+    Symbol* resolve(std::string_view name);  // 查找符号
+    Symbol* resolve(SymbolId id);  // 按编号查找符号
+    bool is_defined_in_current_scope(std::string_view name) const;  // 检查当前作用域
 
     // 获取当前作用域层级
-    size_t current_scope_level() const { return scopes_.size() - 1; }
+    size_t current_scope_level() const { return scope_marks_.size() - 1; }
+
+    // 获取所有同名的函数重载（由内层到外层，同一作用域内后定义的在前）
+    std::vector<const Symbol*> resolve_overloads(std::string_view name) const {
+        return resolve_overloads_at(name, height());
+    }
+
+    // 符号栈高度（已定义且尚未随作用域撤销的符号个数）
+    size_t height() const { return entries_.size(); }
+
+    // 只读查找：按符号栈高度为 height 时的可见状态解析（只看此前定义的符号）。
+    // 不修改任何状态，其他线程可在表不再变动后并发调用
+    const Symbol* resolve_at(std::string_view name, size_t height) const;
+    std::vector<const Symbol*> resolve_overloads_at(std::string_view name, size_t height) const;
 
-    // 获取所有同名的函数重载
-    std::vector<Symbol*> resolve_overloads(const std::string& name);
+    // 名字的编号（首次出现时分配）
+    SymbolId intern(std::string_view name) { return names_.intern(name); }
 
 private:
-    std::vector<Scope> scopes_;  // 作用域栈
+    static constexpr uint32_t kNoEntry = UINT32_MAX;
+
+    struct Entry {
+        Symbol symbol;
+        SymbolId id;
+        uint32_t shadowed;       // 遮蔽链上的下一个同名符号，kNoEntry 为链尾
+        uint32_t previous_head;  // 定义前该名字的链头，退出作用域时据此撤销
+    };
+
+    uint32_t head_of(SymbolId id) const {
+        return id < heads_.size() ? heads_[id] : kNoEntry;
+    }
+
+    // 符号栈高度为 height 时该名字的链头：沿 previous_head 退回到更早定义的符号
+    uint32_t head_at(SymbolId id, size_t height) const {
+        uint32_t head = head_of(id);
+        while (head != kNoEntry && head >= height) {
+            head = entries_[head].previous_head;
+        }
+        return head;
+    }
+
+    SymbolInterner names_;
+    std::deque<Entry> entries_;        // 可见符号栈（deque：后续定义不会使已返回的 Symbol* 失效）
+    std::vector<uint32_t> heads_;      // SymbolId -> 最内层同名符号在 entries_ 中的下标
+    std::vector<size_t> scope_marks_;  // 各层作用域在 entries_ 中的起点
 };
 
 } // namespace collie
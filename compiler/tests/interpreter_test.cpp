@@ -14,9 +14,32 @@
 #include "../parser/parser.h"
 #include "../semantic/semantic_analyzer.h"
 #include "../interpreter/interpreter.h"
+#include "../interpreter/bytecode/vm.h"
 
 namespace {
 
+/// 执行引擎：每个用例分别在树遍历解释器与字节码 VM 上运行，两者输出须一致
+enum class Engine { Tree, Vm };
+
+Engine g_engine = Engine::Tree;
+
+// 用当前用例选定的引擎执行已通过语义检查的程序
+void run_program(const std::vector<collie::StmtPtr>& stmts,
+                 std::ostream& out,
+                 size_t max_call_depth = collie::kDefaultMaxCallDepth,
+                 const collie::ExprTypeTable* types = nullptr) {
+    if (g_engine == Engine::Vm) {
+        collie::bytecode::VM vm(out);
+        vm.set_max_call_depth(max_call_depth);
+        vm.interpret(stmts);
+    } else {
+        collie::Interpreter interpreter(out);
+        interpreter.set_max_call_depth(max_call_depth);
+        interpreter.set_expr_types(types);
+        interpreter.interpret(stmts);
+    }
+}
+
 // 将源码完整跑通编译流水线并解释执行，返回程序的标准输出内容。
 // 若语义分析报错，则以断言失败并附带首条错误信息。
 std::string run_source(const std::string& source) {
@@ -24,7 +47,7 @@ std::string run_source(const std::string& source) {
     std::vector<collie::Token> tokens = lexer.tokenize();
 
     collie::Parser parser(tokens);
-    std::vector<std::unique_ptr<collie::Stmt>> stmts = parser.parse_program();
+    collie::ParsedProgram stmts = parser.parse_program();
 
     collie::SemanticAnalyzer analyzer;
     analyzer.analyze(stmts);
@@ -36,70 +59,143 @@ std::string run_source(const std::string& source) {
     }
 
     std::ostringstream out;
+    run_program(stmts, out, collie::kDefaultMaxCallDepth, &analyzer.expr_types());
+    return out.str();
+}
+
+// 用当前引擎执行源码（须通过语义检查），返回内联缓存命中统计
+collie::InlineCacheStats run_cache_stats(const std::string& source) {
+    collie::Lexer lexer(source);
+    std::vector<collie::Token> tokens = lexer.tokenize();
+    collie::Parser parser(tokens);
+    collie::ParsedProgram stmts = parser.parse_program();
+    collie::SemanticAnalyzer analyzer;
+    analyzer.analyze(stmts);
+    EXPECT_FALSE(analyzer.has_errors());
+
+    std::ostringstream out;
+    if (g_engine == Engine::Vm) {
+        collie::bytecode::VM vm(out);
+        vm.interpret(stmts);
+        return vm.cache_stats();
+    }
     collie::Interpreter interpreter(out);
     interpreter.interpret(stmts);
-    return out.str();
+    return interpreter.cache_stats();
 }
 
 }  // namespace
 
+class InterpreterEndToEnd : public ::testing::TestWithParam<Engine> {
+protected:
+    void SetUp() override { g_engine = GetParam(); }
+};
+
+INSTANTIATE_TEST_SUITE_P(Engines, InterpreterEndToEnd,
+                         ::testing::Values(Engine::Tree, Engine::Vm),
+                         [](const ::testing::TestParamInfo<Engine>& info) {
+                             return info.param == Engine::Vm ? "Vm" : "Tree";
+                         });
+
 // 里程碑基线：跑通 Hello, World!
-TEST(InterpreterEndToEnd, HelloWorld) {
+TEST_P(InterpreterEndToEnd, HelloWorld) {
     EXPECT_EQ(run_source(R"(print("Hello, World!");)"), "Hello, World!\n");
 }
 
-TEST(InterpreterEndToEnd, StringEscapes) {
+TEST_P(InterpreterEndToEnd, StringEscapes) {
     // 词法器已解码 \n \t \\ \"，解释器原样输出
     EXPECT_EQ(run_source(R"(print("a\tb\\c\"d");)"), "a\tb\\c\"d\n");
 }
 
-TEST(InterpreterEndToEnd, ArithmeticPrecedence) {
+TEST_P(InterpreterEndToEnd, ArithmeticPrecedence) {
     EXPECT_EQ(run_source("number a = 1 + 2 * 3; print(a);"), "7\n");
 }
 
-TEST(InterpreterEndToEnd, StringConcatenation) {
+TEST_P(InterpreterEndToEnd, StringConcatenation) {
     EXPECT_EQ(run_source(R"(string s = "foo" + "bar"; print(s);)"), "foobar\n");
 }
 
-TEST(InterpreterEndToEnd, VariableReassignment) {
+TEST_P(InterpreterEndToEnd, LongConcatenationKeepsEarlierValues) {
+    // 长串拼接走就地追加/rope：先前取得的值不受后续拼接影响，左右两侧累积结果一致
+    EXPECT_EQ(run_source(R"(
+        string s = "";
+        string snapshot = "";
+        string prefix = "";
+        for (number i = 0; i < 300; i = i + 1) {
+            s = s + "ab";
+            prefix = "c" + prefix;
+            if (i == 99) { snapshot = s; }
+        }
+        string mixed = s + 1 + true + prefix;
+        print(s.length, snapshot.length, prefix.length, mixed.length);
+        print(s[-1], snapshot.subString(0, 4), mixed[600], mixed[605]);
+        print(s == snapshot + s.subString(200, 600), s != snapshot);
+    )"), "600 200 300 905\nb abab 1 c\ntrue true\n");
+}
+
+TEST_P(InterpreterEndToEnd, LiteralValuesAreSharedButNotMutated) {
+    // 字面量只求值一次、各次执行共享同一值：就地拼接不得改写常量本身
+    EXPECT_EQ(run_source(R"(
+        string all = "";
+        for (number i = 0; i < 3; i = i + 1) {
+            string s = "ab";
+            s = s + "c";
+            all = all + s + 123456789012345678901234567890;
+        }
+        print(all);
+    )"), "abc123456789012345678901234567890abc123456789012345678901234567890"
+         "abc123456789012345678901234567890\n");
+}
+
+TEST_P(InterpreterEndToEnd, UnreachedInvalidLiteralDoesNotFail) {
+    // 预解析字面量时转换失败只留下未解析标记：从未执行到的字面量不报错
+    EXPECT_EQ(run_source(R"(
+        function tiny() number { return 5e-324; }
+        print(1);
+        if (false) { print(tiny()); }
+        print(2);
+    )"), "1\n2\n");
+}
+
+TEST_P(InterpreterEndToEnd, VariableReassignment) {
     EXPECT_EQ(run_source("number a = 1; a = a + 4; print(a);"), "5\n");
 }
 
-TEST(InterpreterEndToEnd, PrintMultipleArguments) {
+TEST_P(InterpreterEndToEnd, PrintMultipleArguments) {
     EXPECT_EQ(run_source(R"(print("x", 1, true);)"), "x 1 true\n");
 }
 
-TEST(InterpreterEndToEnd, IfElseBranch) {
+TEST_P(InterpreterEndToEnd, IfElseBranch) {
     EXPECT_EQ(run_source(
                   "number x = 7; if (x > 5) { print(\"big\"); } else { print(\"small\"); }"),
               "big\n");
 }
 
-TEST(InterpreterEndToEnd, WhileLoopSum) {
+TEST_P(InterpreterEndToEnd, WhileLoopSum) {
     EXPECT_EQ(run_source(
                   "number i = 0; number sum = 0; while (i < 5) { sum = sum + i; i = i + 1; } print(sum);"),
               "10\n");
 }
 
-TEST(InterpreterEndToEnd, ForLoopSum) {
+TEST_P(InterpreterEndToEnd, ForLoopSum) {
     EXPECT_EQ(run_source(
                   "number total = 0; for (number k = 0; k < 3; k = k + 1) { total = total + k; } print(total);"),
               "3\n");
 }
 
-TEST(InterpreterEndToEnd, BreakStopsLoop) {
+TEST_P(InterpreterEndToEnd, BreakStopsLoop) {
     EXPECT_EQ(run_source(
                   "number i = 0; while (i < 10) { if (i == 3) { break; } i = i + 1; } print(i);"),
               "3\n");
 }
 
-TEST(InterpreterEndToEnd, LogicalShortCircuit) {
+TEST_P(InterpreterEndToEnd, LogicalShortCircuit) {
     EXPECT_EQ(run_source("bool b = true && false; print(b);"), "false\n");
 }
 
 // ---- 用户自定义函数 (t11) ----
 
-TEST(InterpreterEndToEnd, BasicFunctionCall) {
+TEST_P(InterpreterEndToEnd, BasicFunctionCall) {
     EXPECT_EQ(run_source(R"(
         function add(a number, b number) number {
             return a + b;
@@ -108,7 +204,7 @@ TEST(InterpreterEndToEnd, BasicFunctionCall) {
     )"), "7\n");
 }
 
-TEST(InterpreterEndToEnd, FunctionReturnString) {
+TEST_P(InterpreterEndToEnd, FunctionReturnString) {
     EXPECT_EQ(run_source(R"(
         function greet(name string) string {
             return "Hello, " + name + "!";
@@ -117,7 +213,7 @@ TEST(InterpreterEndToEnd, FunctionReturnString) {
     )"), "Hello, World!\n");
 }
 
-TEST(InterpreterEndToEnd, RecursiveFactorial) {
+TEST_P(InterpreterEndToEnd, RecursiveFactorial) {
     EXPECT_EQ(run_source(R"(
         function factorial(n number) number {
             if (n <= 1) {
@@ -129,7 +225,55 @@ TEST(InterpreterEndToEnd, RecursiveFactorial) {
     )"), "120\n");
 }
 
-TEST(InterpreterEndToEnd, NestedFunctionCalls) {
+TEST_P(InterpreterEndToEnd, DeepRecursionBeyondNativeStack) {
+    // 尾调用 return f(...) 复用当前帧：百万层尾递归不增长调用深度；
+    // 非尾递归深度远超默认线程栈（约万层）时也不崩溃
+    EXPECT_EQ(run_source(R"(
+        function countDown(n number, acc number) number {
+            if (n <= 0) {
+                return acc;
+            }
+            return countDown(n - 1, acc + 1);
+        }
+        function sumTo(n number) number {
+            if (n <= 0) {
+                return 0;
+            }
+            return n + sumTo(n - 1);
+        }
+        print(countDown(1000000, 0));
+        print(sumTo(100000));
+    )"), "1000000\n5000050000\n");
+}
+
+TEST_P(InterpreterEndToEnd, CallDepthLimitRaisesRuntimeError) {
+    // 超过调用深度上限抛 RuntimeError，而不是耗尽原生栈崩溃；已产生的输出保留
+    collie::Lexer lexer(R"(
+        function forever(n number) number {
+            return 1 + forever(n + 1);
+        }
+        print("start");
+        print(forever(0));
+    )");
+    std::vector<collie::Token> tokens = lexer.tokenize();
+    collie::Parser parser(tokens);
+    auto stmts = parser.parse_program();
+    collie::SemanticAnalyzer analyzer;
+    analyzer.analyze(stmts);
+    ASSERT_FALSE(analyzer.has_errors());
+    std::ostringstream out;
+    try {
+        run_program(stmts, out, 500);
+        ADD_FAILURE() << "Expected RuntimeError";
+    } catch (const collie::RuntimeError& e) {
+        EXPECT_EQ(std::string(e.what()),
+                  "Maximum call depth of 500 exceeded (infinite recursion?)");
+        EXPECT_EQ(e.line(), 3u);
+    }
+    EXPECT_EQ(out.str(), "start\n");
+}
+
+TEST_P(InterpreterEndToEnd, NestedFunctionCalls) {
     EXPECT_EQ(run_source(R"(
         function double_val(x number) number {
             return x * 2;
@@ -141,7 +285,7 @@ TEST(InterpreterEndToEnd, NestedFunctionCalls) {
     )"), "8\n");
 }
 
-TEST(InterpreterEndToEnd, VoidFunction) {
+TEST_P(InterpreterEndToEnd, VoidFunction) {
     // 返回类型为 none 的函数，无显式 return
     EXPECT_EQ(run_source(R"(
         function say_hi() none {
@@ -151,7 +295,7 @@ TEST(InterpreterEndToEnd, VoidFunction) {
     )"), "hi\n");
 }
 
-TEST(InterpreterEndToEnd, FunctionWithLocalVariables) {
+TEST_P(InterpreterEndToEnd, FunctionWithLocalVariables) {
     EXPECT_EQ(run_source(R"(
         function sum_range(n number) number {
             number total = 0;
@@ -166,7 +310,7 @@ TEST(InterpreterEndToEnd, FunctionWithLocalVariables) {
     )"), "55\n");
 }
 
-TEST(InterpreterEndToEnd, EarlyReturn) {
+TEST_P(InterpreterEndToEnd, EarlyReturn) {
     EXPECT_EQ(run_source(R"(
         function abs_val(x number) number {
             if (x < 0) {
@@ -181,16 +325,16 @@ TEST(InterpreterEndToEnd, EarlyReturn) {
 
 // ---- const 变量保护 (t14) ----
 
-TEST(InterpreterEndToEnd, ConstVariableDeclaration) {
+TEST_P(InterpreterEndToEnd, ConstVariableDeclaration) {
     // const 变量可以正常声明并读取
     EXPECT_EQ(run_source("const number x = 42; print(x);"), "42\n");
 }
 
-TEST(InterpreterEndToEnd, ConstStringVariable) {
+TEST_P(InterpreterEndToEnd, ConstStringVariable) {
     EXPECT_EQ(run_source(R"(const string msg = "hello"; print(msg);)"), "hello\n");
 }
 
-TEST(InterpreterEndToEnd, ConstAssignmentError) {
+TEST_P(InterpreterEndToEnd, ConstAssignmentError) {
     // const 变量不允许重新赋值——语义层即拦截
     const std::string source = "const number x = 42; x = 99; print(x);";
     collie::Lexer lexer(source);
@@ -202,7 +346,7 @@ TEST(InterpreterEndToEnd, ConstAssignmentError) {
     EXPECT_TRUE(analyzer.has_errors()) << "semantic should reject const reassignment";
 }
 
-TEST(InterpreterEndToEnd, MutableVariableStillWorks) {
+TEST_P(InterpreterEndToEnd, MutableVariableStillWorks) {
     // 非 const 变量仍可正常重新赋值
     EXPECT_EQ(run_source("number x = 1; x = 2; print(x);"), "2\n");
 }
@@ -211,7 +355,7 @@ TEST(InterpreterEndToEnd, MutableVariableStillWorks) {
 // do-while 循环（t18）
 // =============================================================================
 
-TEST(InterpreterEndToEnd, DoWhileBasic) {
+TEST_P(InterpreterEndToEnd, DoWhileBasic) {
     // 基本 do-while：至少执行一次
     EXPECT_EQ(run_source(R"(
         number x = 0;
@@ -222,7 +366,7 @@ TEST(InterpreterEndToEnd, DoWhileBasic) {
     )"), "3\n");
 }
 
-TEST(InterpreterEndToEnd, DoWhileRunsAtLeastOnce) {
+TEST_P(InterpreterEndToEnd, DoWhileRunsAtLeastOnce) {
     // 条件初始为 false 时仍执行一次循环体
     EXPECT_EQ(run_source(R"(
         number x = 10;
@@ -233,7 +377,7 @@ TEST(InterpreterEndToEnd, DoWhileRunsAtLeastOnce) {
     )"), "11\n");
 }
 
-TEST(InterpreterEndToEnd, DoWhileBreak) {
+TEST_P(InterpreterEndToEnd, DoWhileBreak) {
     // break 在 do-while 中正常工作
     EXPECT_EQ(run_source(R"(
         number x = 0;
@@ -245,7 +389,7 @@ TEST(InterpreterEndToEnd, DoWhileBreak) {
     )"), "2\n");
 }
 
-TEST(InterpreterEndToEnd, DoWhileContinue) {
+TEST_P(InterpreterEndToEnd, DoWhileContinue) {
     // continue 在 do-while 中跳过后续语句但仍检查条件
     EXPECT_EQ(run_source(R"(
         number sum = 0;
@@ -263,7 +407,7 @@ TEST(InterpreterEndToEnd, DoWhileContinue) {
 // switch 语句（t19）
 // =============================================================================
 
-TEST(InterpreterEndToEnd, SwitchBasic) {
+TEST_P(InterpreterEndToEnd, SwitchBasic) {
     // 基本 switch 匹配
     EXPECT_EQ(run_source(R"(
         number x = 2;
@@ -275,7 +419,7 @@ TEST(InterpreterEndToEnd, SwitchBasic) {
     )"), "two\n");
 }
 
-TEST(InterpreterEndToEnd, SwitchDefault) {
+TEST_P(InterpreterEndToEnd, SwitchDefault) {
     // 无匹配时执行 default
     EXPECT_EQ(run_source(R"(
         number x = 99;
@@ -287,7 +431,7 @@ TEST(InterpreterEndToEnd, SwitchDefault) {
     )"), "other\n");
 }
 
-TEST(InterpreterEndToEnd, SwitchMultiValue) {
+TEST_P(InterpreterEndToEnd, SwitchMultiValue) {
     // 多值匹配（逗号分隔）
     EXPECT_EQ(run_source(R"(
         number x = 3;
@@ -299,7 +443,7 @@ TEST(InterpreterEndToEnd, SwitchMultiValue) {
     )"), "medium\n");
 }
 
-TEST(InterpreterEndToEnd, SwitchString) {
+TEST_P(InterpreterEndToEnd, SwitchString) {
     // 字符串匹配
     EXPECT_EQ(run_source(R"(
         string lang = "collie";
@@ -311,7 +455,7 @@ TEST(InterpreterEndToEnd, SwitchString) {
     )"), "shepherd\n");
 }
 
-TEST(InterpreterEndToEnd, SwitchNoMatchNoDefault) {
+TEST_P(InterpreterEndToEnd, SwitchNoMatchNoDefault) {
     // 无匹配且无 default：不执行任何分支
     EXPECT_EQ(run_source(R"(
         number x = 5;
@@ -325,7 +469,7 @@ TEST(InterpreterEndToEnd, SwitchNoMatchNoDefault) {
 
 // ===== 复合赋值运算符 =====
 
-TEST(InterpreterEndToEnd, CompoundAssignPlus) {
+TEST_P(InterpreterEndToEnd, CompoundAssignPlus) {
     EXPECT_EQ(run_source(R"(
         number x = 10;
         x += 5;
@@ -333,7 +477,7 @@ TEST(InterpreterEndToEnd, CompoundAssignPlus) {
     )"), "15\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignMinus) {
+TEST_P(InterpreterEndToEnd, CompoundAssignMinus) {
     EXPECT_EQ(run_source(R"(
         number x = 10;
         x -= 3;
@@ -341,7 +485,7 @@ TEST(InterpreterEndToEnd, CompoundAssignMinus) {
     )"), "7\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignMultiply) {
+TEST_P(InterpreterEndToEnd, CompoundAssignMultiply) {
     EXPECT_EQ(run_source(R"(
         number x = 4;
         x *= 3;
@@ -349,7 +493,7 @@ TEST(InterpreterEndToEnd, CompoundAssignMultiply) {
     )"), "12\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignDivide) {
+TEST_P(InterpreterEndToEnd, CompoundAssignDivide) {
     EXPECT_EQ(run_source(R"(
         number x = 20;
         x /= 4;
@@ -357,7 +501,7 @@ TEST(InterpreterEndToEnd, CompoundAssignDivide) {
     )"), "5\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignModulo) {
+TEST_P(InterpreterEndToEnd, CompoundAssignModulo) {
     EXPECT_EQ(run_source(R"(
         number x = 17;
         x %= 5;
@@ -366,7 +510,7 @@ TEST(InterpreterEndToEnd, CompoundAssignModulo) {
 }
 
 // 取模为 floor 语义（Python 风格），三个用例均出自设计文档 04-numeric.md
-TEST(InterpreterEndToEnd, FloorModuloSemantics) {
+TEST_P(InterpreterEndToEnd, FloorModuloSemantics) {
     EXPECT_EQ(run_source(R"(
         print(-1 % 5);
         print(-1 % -5);
@@ -375,7 +519,7 @@ TEST(InterpreterEndToEnd, FloorModuloSemantics) {
 }
 
 // floor 取模同样适用于小数操作数
-TEST(InterpreterEndToEnd, FloorModuloDecimal) {
+TEST_P(InterpreterEndToEnd, FloorModuloDecimal) {
     EXPECT_EQ(run_source(R"(
         print(5.5 % 2);
         print(-5.5 % 2);
@@ -383,7 +527,7 @@ TEST(InterpreterEndToEnd, FloorModuloDecimal) {
 }
 
 // 前导点小数与 f 后缀字面量（见设计文档 04-numeric.md）
-TEST(InterpreterEndToEnd, NumberLiteralForms) {
+TEST_P(InterpreterEndToEnd, NumberLiteralForms) {
     EXPECT_EQ(run_source(R"(
         number a = .5;
         number b = 2f;
@@ -392,7 +536,7 @@ TEST(InterpreterEndToEnd, NumberLiteralForms) {
     )"), "0.75\n2\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignStringConcat) {
+TEST_P(InterpreterEndToEnd, CompoundAssignStringConcat) {
     // += 用于字符串拼接
     EXPECT_EQ(run_source(R"(
         string s = "hello";
@@ -401,7 +545,7 @@ TEST(InterpreterEndToEnd, CompoundAssignStringConcat) {
     )"), "hello world\n");
 }
 
-TEST(InterpreterEndToEnd, CompoundAssignInLoop) {
+TEST_P(InterpreterEndToEnd, CompoundAssignInLoop) {
     // 在循环中使用复合赋值
     EXPECT_EQ(run_source(R"(
         number sum = 0;
@@ -416,7 +560,7 @@ TEST(InterpreterEndToEnd, CompoundAssignInLoop) {
 
 // ===== 三元条件运算符 =====
 
-TEST(InterpreterEndToEnd, TernaryBasicTrue) {
+TEST_P(InterpreterEndToEnd, TernaryBasicTrue) {
     EXPECT_EQ(run_source(R"(
         number x = 10;
         number y = x > 5 ? 100 : 200;
@@ -424,7 +568,7 @@ TEST(InterpreterEndToEnd, TernaryBasicTrue) {
     )"), "100\n");
 }
 
-TEST(InterpreterEndToEnd, TernaryBasicFalse) {
+TEST_P(InterpreterEndToEnd, TernaryBasicFalse) {
     EXPECT_EQ(run_source(R"(
         number x = 3;
         number y = x > 5 ? 100 : 200;
@@ -432,7 +576,7 @@ TEST(InterpreterEndToEnd, TernaryBasicFalse) {
     )"), "200\n");
 }
 
-TEST(InterpreterEndToEnd, TernaryString) {
+TEST_P(InterpreterEndToEnd, TernaryString) {
     EXPECT_EQ(run_source(R"(
         bool ok = true;
         string msg = ok ? "yes" : "no";
@@ -440,7 +584,7 @@ TEST(InterpreterEndToEnd, TernaryString) {
     )"), "yes\n");
 }
 
-TEST(InterpreterEndToEnd, TernaryNested) {
+TEST_P(InterpreterEndToEnd, TernaryNested) {
     // 嵌套三元（右结合）：x=15 命中第二分支
     EXPECT_EQ(run_source(R"(
         number x = 15;
@@ -449,7 +593,7 @@ TEST(InterpreterEndToEnd, TernaryNested) {
     )"), "medium\n");
 }
 
-TEST(InterpreterEndToEnd, TernaryInExpression) {
+TEST_P(InterpreterEndToEnd, TernaryInExpression) {
     // 三元作为子表达式参与算术
     EXPECT_EQ(run_source(R"(
         number a = 7;
@@ -458,7 +602,7 @@ TEST(InterpreterEndToEnd, TernaryInExpression) {
     )"), "11\n");
 }
 
-TEST(InterpreterEndToEnd, TernaryLazyEvaluation) {
+TEST_P(InterpreterEndToEnd, TernaryLazyEvaluation) {
     // 未命中的分支不求值（否则除零会报运行时错误）
     EXPECT_EQ(run_source(R"(
         number x = 5;
@@ -469,58 +613,58 @@ TEST(InterpreterEndToEnd, TernaryLazyEvaluation) {
 
 // ===== 内建函数 len / toString / toNumber =====
 
-TEST(InterpreterEndToEnd, BuiltinLenAscii) {
+TEST_P(InterpreterEndToEnd, BuiltinLenAscii) {
     EXPECT_EQ(run_source(R"(
         print(len("hello"));
     )"), "5\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinLenUnicode) {
+TEST_P(InterpreterEndToEnd, BuiltinLenUnicode) {
     // 中文按码点计数（非字节数）
     EXPECT_EQ(run_source(R"(
         print(len("牛羊犬"));
     )"), "3\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinLenEmpty) {
+TEST_P(InterpreterEndToEnd, BuiltinLenEmpty) {
     EXPECT_EQ(run_source(R"(
         print(len(""));
     )"), "0\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinToString) {
+TEST_P(InterpreterEndToEnd, BuiltinToString) {
     EXPECT_EQ(run_source(R"(
         string s = toString(42);
         print(s + "!");
     )"), "42!\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinToStringBool) {
+TEST_P(InterpreterEndToEnd, BuiltinToStringBool) {
     EXPECT_EQ(run_source(R"(
         print(toString(true));
     )"), "true\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinToNumber) {
+TEST_P(InterpreterEndToEnd, BuiltinToNumber) {
     EXPECT_EQ(run_source(R"(
         number n = toNumber("123");
         print(n + 1);
     )"), "124\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinToNumberDecimal) {
+TEST_P(InterpreterEndToEnd, BuiltinToNumberDecimal) {
     EXPECT_EQ(run_source(R"(
         print(toNumber("3.5") * 2);
     )"), "7\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinToNumberBool) {
+TEST_P(InterpreterEndToEnd, BuiltinToNumberBool) {
     EXPECT_EQ(run_source(R"(
         print(toNumber(true) + toNumber(false));
     )"), "1\n");
 }
 
-TEST(InterpreterEndToEnd, BuiltinChained) {
+TEST_P(InterpreterEndToEnd, BuiltinChained) {
     // 组合使用：len(toString(12345)) = 5
     EXPECT_EQ(run_source(R"(
         print(len(toString(12345)));
@@ -529,14 +673,14 @@ TEST(InterpreterEndToEnd, BuiltinChained) {
 
 // ===== 数组字面量与索引 =====
 
-TEST(InterpreterEndToEnd, ArrayLiteralPrint) {
+TEST_P(InterpreterEndToEnd, ArrayLiteralPrint) {
     EXPECT_EQ(run_source(R"(
         array a = [1, 2, 3];
         print(a);
     )"), "[1, 2, 3]\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayIndexRead) {
+TEST_P(InterpreterEndToEnd, ArrayIndexRead) {
     // 索引读取，并可赋给具体类型变量
     EXPECT_EQ(run_source(R"(
         array a = [10, 20, 30];
@@ -545,7 +689,7 @@ TEST(InterpreterEndToEnd, ArrayIndexRead) {
     )"), "10 30\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayNegativeIndex) {
+TEST_P(InterpreterEndToEnd, ArrayNegativeIndex) {
     // 负索引：-1 为最后一个元素
     EXPECT_EQ(run_source(R"(
         array a = [1, 2, 3];
@@ -553,7 +697,7 @@ TEST(InterpreterEndToEnd, ArrayNegativeIndex) {
     )"), "3 1\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayIndexAssign) {
+TEST_P(InterpreterEndToEnd, ArrayIndexAssign) {
     EXPECT_EQ(run_source(R"(
         array a = [1, 2, 3];
         a[1] = 42;
@@ -561,21 +705,21 @@ TEST(InterpreterEndToEnd, ArrayIndexAssign) {
     )"), "[1, 42, 3]\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayLen) {
+TEST_P(InterpreterEndToEnd, ArrayLen) {
     EXPECT_EQ(run_source(R"(
         array a = [5, 6, 7, 8];
         print(len(a));
     )"), "4\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayEmpty) {
+TEST_P(InterpreterEndToEnd, ArrayEmpty) {
     EXPECT_EQ(run_source(R"(
         array e = [];
         print(len(e), e);
     )"), "0 []\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayNestedIndex) {
+TEST_P(InterpreterEndToEnd, ArrayNestedIndex) {
     // 嵌套数组与链式索引
     EXPECT_EQ(run_source(R"(
         array m = [[1, 2], [3, 4]];
@@ -583,7 +727,7 @@ TEST(InterpreterEndToEnd, ArrayNestedIndex) {
     )"), "2 3\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayReferenceSemantics) {
+TEST_P(InterpreterEndToEnd, ArrayReferenceSemantics) {
     // 数组为引用语义：赋值后共享同一底层存储
     EXPECT_EQ(run_source(R"(
         array a = [1, 2];
@@ -593,7 +737,7 @@ TEST(InterpreterEndToEnd, ArrayReferenceSemantics) {
     )"), "9\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayTrailingComma) {
+TEST_P(InterpreterEndToEnd, ArrayTrailingComma) {
     // 尾逗号（语言设计稿约定支持）
     EXPECT_EQ(run_source(R"(
         array a = [1, 2, 3,];
@@ -601,7 +745,7 @@ TEST(InterpreterEndToEnd, ArrayTrailingComma) {
     )"), "3\n");
 }
 
-TEST(InterpreterEndToEnd, ArraySumInLoop) {
+TEST_P(InterpreterEndToEnd, ArraySumInLoop) {
     // 循环遍历累加
     EXPECT_EQ(run_source(R"(
         array a = [10, 20, 30];
@@ -613,7 +757,7 @@ TEST(InterpreterEndToEnd, ArraySumInLoop) {
     )"), "60\n");
 }
 
-TEST(InterpreterEndToEnd, ArrayIndexOutOfRange) {
+TEST_P(InterpreterEndToEnd, ArrayIndexOutOfRange) {
     // 越界访问抛运行时错误
     collie::Lexer lexer("array a = [1, 2, 3]; print(a[3]);");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -623,29 +767,28 @@ TEST(InterpreterEndToEnd, ArrayIndexOutOfRange) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
 // ---------------------------------------------------------------------------
 // 字符串索引（t24）：按 UTF-8 码点索引，返回单字符子串；支持负索引
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, StringIndexRead) {
+TEST_P(InterpreterEndToEnd, StringIndexRead) {
     EXPECT_EQ(run_source(R"(string s = "hello"; print(s[0], s[4]);)"), "h o\n");
 }
 
-TEST(InterpreterEndToEnd, StringNegativeIndex) {
+TEST_P(InterpreterEndToEnd, StringNegativeIndex) {
     EXPECT_EQ(run_source(R"(string s = "hello"; print(s[-1], s[-5]);)"), "o h\n");
 }
 
-TEST(InterpreterEndToEnd, StringIndexUnicode) {
+TEST_P(InterpreterEndToEnd, StringIndexUnicode) {
     // 按码点而非字节索引：中文字符占 3 字节但算 1 个字符
     EXPECT_EQ(run_source(R"(string s = "牛→犬a"; print(s[0], s[1], s[2], s[3]);)"),
               "牛 → 犬 a\n");
 }
 
-TEST(InterpreterEndToEnd, StringIndexInExpression) {
+TEST_P(InterpreterEndToEnd, StringIndexInExpression) {
     // 索引结果是 string，可参与拼接与比较
     EXPECT_EQ(run_source(R"(
         string s = "abc";
@@ -655,7 +798,7 @@ TEST(InterpreterEndToEnd, StringIndexInExpression) {
               "cba true\n");
 }
 
-TEST(InterpreterEndToEnd, StringIndexLoop) {
+TEST_P(InterpreterEndToEnd, StringIndexLoop) {
     // 配合 len 遍历字符串
     EXPECT_EQ(run_source(R"(
         string s = "dog";
@@ -668,7 +811,7 @@ TEST(InterpreterEndToEnd, StringIndexLoop) {
               "d.o.g.\n");
 }
 
-TEST(InterpreterEndToEnd, StringIndexOutOfRange) {
+TEST_P(InterpreterEndToEnd, StringIndexOutOfRange) {
     collie::Lexer lexer(R"(string s = "abc"; print(s[3]);)");
     std::vector<collie::Token> tokens = lexer.tokenize();
     collie::Parser parser(tokens);
@@ -677,11 +820,10 @@ TEST(InterpreterEndToEnd, StringIndexOutOfRange) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, StringIndexAssignRejected) {
+TEST_P(InterpreterEndToEnd, StringIndexAssignRejected) {
     // 字符串不可变：索引赋值在语义层报错
     collie::Lexer lexer(R"(string s = "abc"; s[0] = "x";)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -693,7 +835,7 @@ TEST(InterpreterEndToEnd, StringIndexAssignRejected) {
 }
 
 // 以下方法调用用例见设计文档 04-numeric.md
-TEST(InterpreterEndToEnd, MethodCallNumberPredicates) {
+TEST_P(InterpreterEndToEnd, MethodCallNumberPredicates) {
     EXPECT_EQ(run_source(R"(
         number n = 2025;
         print(n.isInteger());
@@ -711,7 +853,7 @@ false
 )");
 }
 
-TEST(InterpreterEndToEnd, MethodCallAbsAndParts) {
+TEST_P(InterpreterEndToEnd, MethodCallAbsAndParts) {
     EXPECT_EQ(run_source(R"(
         number d = -123.456;
         print(d.abs());
@@ -720,7 +862,7 @@ TEST(InterpreterEndToEnd, MethodCallAbsAndParts) {
     )"), "123.456\n-123\n-0.456\n");
 }
 
-TEST(InterpreterEndToEnd, MethodCallToStringToNumber) {
+TEST_P(InterpreterEndToEnd, MethodCallToStringToNumber) {
     // 与内建函数 toString/toNumber 行为一致；支持字面量接收者
     EXPECT_EQ(run_source(R"(
         number n = 42;
@@ -730,7 +872,7 @@ TEST(InterpreterEndToEnd, MethodCallToStringToNumber) {
     )"), "42!\n4.5\n12\n");
 }
 
-TEST(InterpreterEndToEnd, MethodCallChainedAndIndexed) {
+TEST_P(InterpreterEndToEnd, MethodCallChainedAndIndexed) {
     // 链式调用与索引混合：数字字面量.方法().方法()、数组元素.方法()
     EXPECT_EQ(run_source(R"(
         print(3.7.integerPart().toString() + "|");
@@ -741,7 +883,7 @@ TEST(InterpreterEndToEnd, MethodCallChainedAndIndexed) {
 
 // ===== Infinity / NaN 字面量与相关语义（见设计文档 04-numeric.md） =====
 
-TEST(InterpreterEndToEnd, InfinityNaNLiteralsToString) {
+TEST_P(InterpreterEndToEnd, InfinityNaNLiteralsToString) {
     // toString 格式：+Infinity / -Infinity / NaN
     EXPECT_EQ(run_source(R"(
         print(Infinity);
@@ -756,7 +898,7 @@ NaN
 )");
 }
 
-TEST(InterpreterEndToEnd, InfinityPredicates) {
+TEST_P(InterpreterEndToEnd, InfinityPredicates) {
     EXPECT_EQ(run_source(R"(
         number p = Infinity;
         print(p.isInfinity());
@@ -781,7 +923,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, NaNPredicatesAndComparison) {
+TEST_P(InterpreterEndToEnd, NaNPredicatesAndComparison) {
     // NaN 的所有谓词除 isNaN 外均为 false；NaN 与自身比较不相等（IEEE 754）
     EXPECT_EQ(run_source(R"(
         number n = NaN;
@@ -802,7 +944,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, InfinityArithmetic) {
+TEST_P(InterpreterEndToEnd, InfinityArithmetic) {
     // 无穷参与算术运算遵循 IEEE 754：Inf+1=Inf、Inf-Inf=NaN、Inf*-1=-Inf
     EXPECT_EQ(run_source(R"(
         number inf = Infinity;
@@ -813,7 +955,7 @@ TEST(InterpreterEndToEnd, InfinityArithmetic) {
     )"), "+Infinity\n-Infinity\ntrue\n");
 }
 
-TEST(InterpreterEndToEnd, ToNumberInfinityForms) {
+TEST_P(InterpreterEndToEnd, ToNumberInfinityForms) {
     // 字符串转数字的特殊形式严格大小写匹配；不可解析返回 NaN 而非报错
     EXPECT_EQ(run_source(R"(
         print(toNumber("Infinity"));
@@ -831,7 +973,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, DivisionByZeroIEEE754) {
+TEST_P(InterpreterEndToEnd, DivisionByZeroIEEE754) {
     // 除零遵循 IEEE 754（经作者确认）：1/0 → +Infinity、-1/0 → -Infinity、
     // 0/0 → NaN；取模除数为 0 → NaN（不再报运行时错误）
     EXPECT_EQ(run_source(R"(
@@ -850,7 +992,7 @@ true
 
 // ===== 字符串插值 @"...{expr}..."（见设计文档 03-character.md） =====
 
-TEST(InterpreterEndToEnd, StringInterpolationBasic) {
+TEST_P(InterpreterEndToEnd, StringInterpolationBasic) {
     // 文档示例：变量插值
     EXPECT_EQ(run_source(R"(
         string name = "Lily";
@@ -861,7 +1003,7 @@ TEST(InterpreterEndToEnd, StringInterpolationBasic) {
     )"), "Lily is 18-year-old girl.\n");
 }
 
-TEST(InterpreterEndToEnd, StringInterpolationExpressions) {
+TEST_P(InterpreterEndToEnd, StringInterpolationExpressions) {
     // 插值段支持任意表达式：算术、方法调用、属性、三元
     EXPECT_EQ(run_source(R"(
         number n = 6;
@@ -870,7 +1012,7 @@ TEST(InterpreterEndToEnd, StringInterpolationExpressions) {
     )"), "42 and 5 and big\n");
 }
 
-TEST(InterpreterEndToEnd, StringInterpolationEscapes) {
+TEST_P(InterpreterEndToEnd, StringInterpolationEscapes) {
     // \{ \} 输出字面花括号；常规转义与普通字符串一致；纯文本/空串退化
     EXPECT_EQ(run_source(R"(
         number x = 1;
@@ -880,7 +1022,7 @@ TEST(InterpreterEndToEnd, StringInterpolationEscapes) {
     )"), "{x} = 1\nplain\nempty\n");
 }
 
-TEST(InterpreterEndToEnd, StringInterpolationTypeIsString) {
+TEST_P(InterpreterEndToEnd, StringInterpolationTypeIsString) {
     // 脱糖结果为 string 类型：可参与拼接与方法调用
     EXPECT_EQ(run_source(R"(
         number n = 3;
@@ -890,7 +1032,7 @@ TEST(InterpreterEndToEnd, StringInterpolationTypeIsString) {
     )"), "n=3!\n3\n");
 }
 
-TEST(InterpreterEndToEnd, StringInterpolationInvalidExprRejected) {
+TEST_P(InterpreterEndToEnd, StringInterpolationInvalidExprRejected) {
     // 插值段非法表达式：解析期报错
     collie::Lexer lexer("string s = @\"{1 +}\";");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -899,7 +1041,7 @@ TEST(InterpreterEndToEnd, StringInterpolationInvalidExprRejected) {
     EXPECT_FALSE(parser.get_errors().empty());
 }
 
-TEST(InterpreterEndToEnd, UnknownMethodRejected) {
+TEST_P(InterpreterEndToEnd, UnknownMethodRejected) {
     // 未知方法在语义层报错
     collie::Lexer lexer(R"(number n = 1; n.foo();)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -910,7 +1052,7 @@ TEST(InterpreterEndToEnd, UnknownMethodRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, MethodCallWrongReceiverRejected) {
+TEST_P(InterpreterEndToEnd, MethodCallWrongReceiverRejected) {
     // number 专属方法用在字符串上：语义层报错
     collie::Lexer lexer(R"(string s = "abc"; s.abs();)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -922,7 +1064,7 @@ TEST(InterpreterEndToEnd, MethodCallWrongReceiverRejected) {
 }
 
 // 以下属性/字符串方法用例见设计文档 03-character.md
-TEST(InterpreterEndToEnd, LengthProperty) {
+TEST_P(InterpreterEndToEnd, LengthProperty) {
     // string 按 UTF-8 码点计数，array 按元素数
     EXPECT_EQ(run_source(R"(
         string s = "héllo";
@@ -936,7 +1078,7 @@ TEST(InterpreterEndToEnd, LengthProperty) {
 )");
 }
 
-TEST(InterpreterEndToEnd, StringTrimMethods) {
+TEST_P(InterpreterEndToEnd, StringTrimMethods) {
     EXPECT_EQ(run_source(R"(
         string s = "  hi  ";
         print("|" + s.trim() + "|");
@@ -948,7 +1090,7 @@ TEST(InterpreterEndToEnd, StringTrimMethods) {
 )");
 }
 
-TEST(InterpreterEndToEnd, StringSubString) {
+TEST_P(InterpreterEndToEnd, StringSubString) {
     // [start, end) 码点区间；end 缺省/-1 取 length；start >= end 为空串
     EXPECT_EQ(run_source(R"(
         string str = "hello world";
@@ -965,7 +1107,7 @@ world
 )");
 }
 
-TEST(InterpreterEndToEnd, PropertyAndMethodChained) {
+TEST_P(InterpreterEndToEnd, PropertyAndMethodChained) {
     EXPECT_EQ(run_source(R"(
         print("  collie  ".trim().length);
         print("hello".subString(1, 4).length.toString() + "!");
@@ -974,7 +1116,7 @@ TEST(InterpreterEndToEnd, PropertyAndMethodChained) {
 )");
 }
 
-TEST(InterpreterEndToEnd, UnknownPropertyRejected) {
+TEST_P(InterpreterEndToEnd, UnknownPropertyRejected) {
     // 未知属性在语义层报错
     collie::Lexer lexer(R"(string s = "abc"; number n = s.foo;)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -985,7 +1127,7 @@ TEST(InterpreterEndToEnd, UnknownPropertyRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, LengthWrongReceiverRejected) {
+TEST_P(InterpreterEndToEnd, LengthWrongReceiverRejected) {
     // length 用在 number 上：语义层报错
     collie::Lexer lexer(R"(number n = 1; number m = n.length;)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -996,7 +1138,7 @@ TEST(InterpreterEndToEnd, LengthWrongReceiverRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, SubStringArityRejected) {
+TEST_P(InterpreterEndToEnd, SubStringArityRejected) {
     // subString 元数错误（0 参）：语义层报错
     collie::Lexer lexer(R"(string s = "abc"; s.subString();)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -1012,7 +1154,7 @@ TEST(InterpreterEndToEnd, SubStringArityRejected) {
 // 见 uncategorized.md 附录，经作者确认）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, ClassBasics) {
+TEST_P(InterpreterEndToEnd, ClassBasics) {
     // 字段（含初始化/缺省）+ 构造器 + 方法 + this 读写字段 + 外部属性读写
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1052,7 +1194,7 @@ Max makes a sound
 )");
 }
 
-TEST(InterpreterEndToEnd, ClassWithoutConstructor) {
+TEST_P(InterpreterEndToEnd, ClassWithoutConstructor) {
     // 无构造器：new 0 实参，字段按初始化表达式/none 缺省
     EXPECT_EQ(run_source(R"(
         class Counter {
@@ -1070,7 +1212,7 @@ TEST(InterpreterEndToEnd, ClassWithoutConstructor) {
     )"), "2\n");
 }
 
-TEST(InterpreterEndToEnd, ClassInstanceReferenceSemantics) {
+TEST_P(InterpreterEndToEnd, ClassInstanceReferenceSemantics) {
     // 实例为引用语义：赋值后两个变量共享同一对象
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1084,7 +1226,7 @@ TEST(InterpreterEndToEnd, ClassInstanceReferenceSemantics) {
     )"), "Max\n");
 }
 
-TEST(InterpreterEndToEnd, ClassMethodCallsMethod) {
+TEST_P(InterpreterEndToEnd, ClassMethodCallsMethod) {
     // 方法内通过 this 调用同类其他方法；方法带参数
     // （字段名避开 base：t38 起 base 为保留关键字）
     EXPECT_EQ(run_source(R"(
@@ -1108,7 +1250,7 @@ TEST(InterpreterEndToEnd, ClassMethodCallsMethod) {
 )");
 }
 
-TEST(InterpreterEndToEnd, ClassUndefinedFieldRejected) {
+TEST_P(InterpreterEndToEnd, ClassUndefinedFieldRejected) {
     // 未声明字段的读取：运行期报错（语义层对 object 动态放行）
     collie::Lexer lexer(R"(
         class Animal { public string name; }
@@ -1122,11 +1264,10 @@ TEST(InterpreterEndToEnd, ClassUndefinedFieldRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, ClassConstructorArityRejected) {
+TEST_P(InterpreterEndToEnd, ClassConstructorArityRejected) {
     // 构造器实参数量不匹配：运行期报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1142,11 +1283,10 @@ TEST(InterpreterEndToEnd, ClassConstructorArityRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, UndefinedClassRejected) {
+TEST_P(InterpreterEndToEnd, UndefinedClassRejected) {
     // new 未声明的类：语义层报错
     collie::Lexer lexer(R"(object a = new Ghost();)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -1157,7 +1297,7 @@ TEST(InterpreterEndToEnd, UndefinedClassRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, ThisOutsideClassRejected) {
+TEST_P(InterpreterEndToEnd, ThisOutsideClassRejected) {
     // 类外使用 this：语义层报错
     collie::Lexer lexer(R"(print(this);)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -1172,7 +1312,7 @@ TEST(InterpreterEndToEnd, ThisOutsideClassRejected) {
 // 运行期声明类型校验与隐式转换（t35）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, StringImplicitConversionOnDecl) {
+TEST_P(InterpreterEndToEnd, StringImplicitConversionOnDecl) {
     // 语义层允许 number/bool 隐式转 string，运行期真正转为字符串
     //（此前变量实际绑定的仍是 number，s.length 会误报）
     EXPECT_EQ(run_source(R"(
@@ -1187,7 +1327,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, StringImplicitConversionOnAssign) {
+TEST_P(InterpreterEndToEnd, StringImplicitConversionOnAssign) {
     // 赋值同样按声明类型隐式转换
     EXPECT_EQ(run_source(R"(
         string s = "a";
@@ -1199,7 +1339,7 @@ TEST(InterpreterEndToEnd, StringImplicitConversionOnAssign) {
 )");
 }
 
-TEST(InterpreterEndToEnd, ParamImplicitStringConversion) {
+TEST_P(InterpreterEndToEnd, ParamImplicitStringConversion) {
     // 实参 number 传给 string 形参：运行期转字符串后绑定
     EXPECT_EQ(run_source(R"(
         function tag(s string) string {
@@ -1210,7 +1350,7 @@ TEST(InterpreterEndToEnd, ParamImplicitStringConversion) {
 )");
 }
 
-TEST(InterpreterEndToEnd, DeclTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, DeclTypeMismatchRuntimeRejected) {
     // 动态路径（object）声明初始化：语义层放行，运行期拦截
     collie::Lexer lexer(R"(
         array a = [1, "x"];
@@ -1223,11 +1363,10 @@ TEST(InterpreterEndToEnd, DeclTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, AssignTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, AssignTypeMismatchRuntimeRejected) {
     // 动态路径赋值给 number 变量：运行期拦截
     collie::Lexer lexer(R"(
         array a = ["x"];
@@ -1241,11 +1380,10 @@ TEST(InterpreterEndToEnd, AssignTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, ParamTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, ParamTypeMismatchRuntimeRejected) {
     // 动态路径实参传给 number 形参：运行期拦截
     collie::Lexer lexer(R"(
         function twice(n number) number {
@@ -1261,11 +1399,50 @@ TEST(InterpreterEndToEnd, ParamTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, BoolDeclTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, StaticTypesKeepDeclaredConversions) {
+    // 语义层静态类型表生效时（run_source 传入），静态已满足的值免检，
+    // 表示/范围相关的 decimal 加宽、tribool 加宽与 string 转换照常执行
+    EXPECT_EQ(run_source(R"(
+        function wrap(s string, d decimal) string {
+            return s + ":" + d;
+        }
+        function flip(t tribool) tribool {
+            return !t;
+        }
+        number a = 6;
+        number b = a * 7 - 2;
+        decimal c = b;
+        print(wrap("v", a), wrap(b, 1), c, flip(true));
+    )"), "v:6 40:1 40 false\n");
+}
+
+TEST_P(InterpreterEndToEnd, StaticTypesKeepDynamicChecks) {
+    // 静态类型表只收录确定的表达式：object 参与的算术与实参仍在运行期检查
+    collie::Lexer lexer(R"(
+        function twice(n number) number {
+            return n * 2;
+        }
+        array a = ["x"];
+        number n = 1;
+        print(twice(n + 1));
+        print(n * a[0]);
+    )");
+    std::vector<collie::Token> tokens = lexer.tokenize();
+    collie::Parser parser(tokens);
+    auto stmts = parser.parse_program();
+    collie::SemanticAnalyzer analyzer;
+    analyzer.analyze(stmts);
+    ASSERT_FALSE(analyzer.has_errors());
+    std::ostringstream out;
+    EXPECT_THROW(run_program(stmts, out, collie::kDefaultMaxCallDepth, &analyzer.expr_types()),
+                 collie::RuntimeError);
+    EXPECT_EQ(out.str(), "4\n");
+}
+
+TEST_P(InterpreterEndToEnd, BoolDeclTypeMismatchRuntimeRejected) {
     // 动态路径初始化 bool 变量：运行期拦截（bool 无隐式转换）
     collie::Lexer lexer(R"(
         array a = [1];
@@ -1278,15 +1455,14 @@ TEST(InterpreterEndToEnd, BoolDeclTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
 // ---------------------------------------------------------------------------
 // 类字段类型运行期校验（t36）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, FieldImplicitStringConversion) {
+TEST_P(InterpreterEndToEnd, FieldImplicitStringConversion) {
     // 字段初始化与字段赋值均按字段声明类型隐式转换
     EXPECT_EQ(run_source(R"(
         class Tag {
@@ -1304,7 +1480,7 @@ true!
 )");
 }
 
-TEST(InterpreterEndToEnd, FieldCtorAssignImplicitConversion) {
+TEST_P(InterpreterEndToEnd, FieldCtorAssignImplicitConversion) {
     // 构造器内 this.x = 实参 同样经字段声明类型转换
     EXPECT_EQ(run_source(R"(
         class Box {
@@ -1320,7 +1496,7 @@ TEST(InterpreterEndToEnd, FieldCtorAssignImplicitConversion) {
 )");
 }
 
-TEST(InterpreterEndToEnd, FieldInitTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, FieldInitTypeMismatchRuntimeRejected) {
     // 字段初始化表达式动态路径类型不匹配：运行期拦截
     collie::Lexer lexer(R"(
         array a = ["x"];
@@ -1336,11 +1512,10 @@ TEST(InterpreterEndToEnd, FieldInitTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, FieldAssignTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, FieldAssignTypeMismatchRuntimeRejected) {
     // 字段赋值动态路径类型不匹配：运行期拦截
     collie::Lexer lexer(R"(
         class Counter {
@@ -1357,15 +1532,14 @@ TEST(InterpreterEndToEnd, FieldAssignTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
 // ---------------------------------------------------------------------------
 // 函数返回值类型运行期校验（t37）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, ReturnImplicitStringConversion) {
+TEST_P(InterpreterEndToEnd, ReturnImplicitStringConversion) {
     // 返回值按声明返回类型隐式转换：number → string
     EXPECT_EQ(run_source(R"(
         function label() string {
@@ -1378,7 +1552,7 @@ TEST(InterpreterEndToEnd, ReturnImplicitStringConversion) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MethodReturnImplicitStringConversion) {
+TEST_P(InterpreterEndToEnd, MethodReturnImplicitStringConversion) {
     // 类方法返回值同样按声明返回类型隐式转换
     EXPECT_EQ(run_source(R"(
         class Tag {
@@ -1392,7 +1566,7 @@ TEST(InterpreterEndToEnd, MethodReturnImplicitStringConversion) {
 )");
 }
 
-TEST(InterpreterEndToEnd, ReturnTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, ReturnTypeMismatchRuntimeRejected) {
     // 动态路径返回值与声明返回类型不匹配：运行期拦截
     collie::Lexer lexer(R"(
         function first(a array) number {
@@ -1407,15 +1581,14 @@ TEST(InterpreterEndToEnd, ReturnTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
 // ---------------------------------------------------------------------------
 // class 继承（t38：extends / base 构造器委托）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, InheritFieldAndMethod) {
+TEST_P(InterpreterEndToEnd, InheritFieldAndMethod) {
     // 子类继承父类字段与方法
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1437,7 +1610,7 @@ generic makes a sound
 )");
 }
 
-TEST(InterpreterEndToEnd, InheritMethodOverride) {
+TEST_P(InterpreterEndToEnd, InheritMethodOverride) {
     // 子类同名方法覆写父类实现（沿链查找子类优先）
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1461,7 +1634,39 @@ Woof!
 )");
 }
 
-TEST(InterpreterEndToEnd, BaseConstructorDelegation) {
+TEST_P(InterpreterEndToEnd, InlineCacheHitsPerReceiverClass) {
+    // 同一调用点/属性读写点按接收者类缓存：每个点上两个类各未命中一次，其余全部命中
+    collie::InlineCacheStats stats = run_cache_stats(R"(
+        class Animal {
+            public number calls;
+            public function speak() string {
+                return "...";
+            }
+        }
+
+        class Dog extends Animal {
+            public function speak() string {
+                return "Woof!";
+            }
+        }
+
+        function talk(a Animal) string {
+            a.calls = 1;
+            return a.speak() + a.calls;
+        }
+
+        for (number i = 0; i < 10; i = i + 1) {
+            talk(new Animal());
+            talk(new Dog());
+        }
+    )");
+    EXPECT_EQ(stats.method_misses, 2u);
+    EXPECT_EQ(stats.method_hits, 18u);
+    EXPECT_EQ(stats.field_misses, 4u);
+    EXPECT_EQ(stats.field_hits, 36u);
+}
+
+TEST_P(InterpreterEndToEnd, BaseConstructorDelegation) {
     // 构造器 `: base(args)` 委托：父类构造器先执行，初始化继承字段
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1488,7 +1693,7 @@ TEST(InterpreterEndToEnd, BaseConstructorDelegation) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiLevelInheritanceBaseChain) {
+TEST_P(InterpreterEndToEnd, MultiLevelInheritanceBaseChain) {
     // 多级继承：base 按“定义构造器的类”的父类解析，逐级委托不死循环
     EXPECT_EQ(run_source(R"(
         class A {
@@ -1517,7 +1722,7 @@ TEST(InterpreterEndToEnd, MultiLevelInheritanceBaseChain) {
 )");
 }
 
-TEST(InterpreterEndToEnd, InheritedFieldRuntimeTypeChecked) {
+TEST_P(InterpreterEndToEnd, InheritedFieldRuntimeTypeChecked) {
     // 继承字段的赋值同样沿链找到声明类型做运行期校验（number 字段拒绝数组）
     collie::Lexer lexer(R"(
         class Animal { public number age = 0; }
@@ -1532,11 +1737,10 @@ TEST(InterpreterEndToEnd, InheritedFieldRuntimeTypeChecked) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, BaseWithoutSuperclassRejected) {
+TEST_P(InterpreterEndToEnd, BaseWithoutSuperclassRejected) {
     // 无父类的类写 `: base()`：运行期报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1551,11 +1755,10 @@ TEST(InterpreterEndToEnd, BaseWithoutSuperclassRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, UndefinedSuperclassSemanticRejected) {
+TEST_P(InterpreterEndToEnd, UndefinedSuperclassSemanticRejected) {
     // 父类未声明：语义阶段报错
     collie::Lexer lexer(R"(
         class Dog extends Animal { }
@@ -1568,7 +1771,7 @@ TEST(InterpreterEndToEnd, UndefinedSuperclassSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, SelfExtendSemanticRejected) {
+TEST_P(InterpreterEndToEnd, SelfExtendSemanticRejected) {
     // 类不能继承自身：语义阶段报错
     collie::Lexer lexer(R"(
         class Dog extends Dog { }
@@ -1581,7 +1784,7 @@ TEST(InterpreterEndToEnd, SelfExtendSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallBypassesOverride) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallBypassesOverride) {
     // base.method()：覆写方法内显式调父类实现，绕过自身覆写
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1602,7 +1805,7 @@ TEST(InterpreterEndToEnd, BaseMethodCallBypassesOverride) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallWithArguments) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallWithArguments) {
     // base.method(args)：实参求值后传给父类方法，this 仍为当前实例
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1626,7 +1829,7 @@ TEST(InterpreterEndToEnd, BaseMethodCallWithArguments) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallMultiLevel) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallMultiLevel) {
     // 多级继承：base 按“定义当前方法的类”的父类解析，逐级上调不死循环
     EXPECT_EQ(run_source(R"(
         class A {
@@ -1653,7 +1856,7 @@ TEST(InterpreterEndToEnd, BaseMethodCallMultiLevel) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallSkipsIntermediateOverride) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallSkipsIntermediateOverride) {
     // base 从直接父类链查找：父类未覆写时命中祖父类实现
     EXPECT_EQ(run_source(R"(
         class A {
@@ -1676,7 +1879,7 @@ TEST(InterpreterEndToEnd, BaseMethodCallSkipsIntermediateOverride) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallUndefinedMethodThrows) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallUndefinedMethodThrows) {
     // 父类链上无该方法：运行期报错
     collie::Lexer lexer(R"(
         class Animal { }
@@ -1695,11 +1898,10 @@ TEST(InterpreterEndToEnd, BaseMethodCallUndefinedMethodThrows) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallWithoutSuperclassThrows) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallWithoutSuperclassThrows) {
     // 无父类的类方法内写 base.method()：运行期报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1717,11 +1919,10 @@ TEST(InterpreterEndToEnd, BaseMethodCallWithoutSuperclassThrows) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, BaseMethodCallOutsideClassSemanticRejected) {
+TEST_P(InterpreterEndToEnd, BaseMethodCallOutsideClassSemanticRejected) {
     // 类外写 base.method()：语义阶段报错
     collie::Lexer lexer(R"(
         base.speak();
@@ -1734,7 +1935,7 @@ TEST(InterpreterEndToEnd, BaseMethodCallOutsideClassSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, OverrideAnnotationAccepted) {
+TEST_P(InterpreterEndToEnd, OverrideAnnotationAccepted) {
     // @override 标注的覆写方法：父类链确有同名方法，正常运行
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1756,7 +1957,7 @@ TEST(InterpreterEndToEnd, OverrideAnnotationAccepted) {
 )");
 }
 
-TEST(InterpreterEndToEnd, OverrideAnnotationGrandparentMethod) {
+TEST_P(InterpreterEndToEnd, OverrideAnnotationGrandparentMethod) {
     // @override 命中祖父类方法（父类未覆写，沿链查找）
     EXPECT_EQ(run_source(R"(
         class A {
@@ -1780,7 +1981,7 @@ TEST(InterpreterEndToEnd, OverrideAnnotationGrandparentMethod) {
 )");
 }
 
-TEST(InterpreterEndToEnd, DeprecatedAnnotationAcceptedNoop) {
+TEST_P(InterpreterEndToEnd, DeprecatedAnnotationAcceptedNoop) {
     // @deprecated 接受但暂不生效：方法照常可调
     EXPECT_EQ(run_source(R"(
         class Animal {
@@ -1796,7 +1997,7 @@ TEST(InterpreterEndToEnd, DeprecatedAnnotationAcceptedNoop) {
 )");
 }
 
-TEST(InterpreterEndToEnd, OverrideWithoutSuperMethodSemanticRejected) {
+TEST_P(InterpreterEndToEnd, OverrideWithoutSuperMethodSemanticRejected) {
     // @override 但父类链上无同名方法：语义阶段报错
     collie::Lexer lexer(R"(
         class Animal { }
@@ -1815,7 +2016,7 @@ TEST(InterpreterEndToEnd, OverrideWithoutSuperMethodSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, OverrideWithoutSuperclassSemanticRejected) {
+TEST_P(InterpreterEndToEnd, OverrideWithoutSuperclassSemanticRejected) {
     // 无父类的类里写 @override：语义阶段报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1833,7 +2034,7 @@ TEST(InterpreterEndToEnd, OverrideWithoutSuperclassSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, OverrideOnFieldSyntaxRejected) {
+TEST_P(InterpreterEndToEnd, OverrideOnFieldSyntaxRejected) {
     // @override 用在字段上：语法阶段报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1847,7 +2048,7 @@ TEST(InterpreterEndToEnd, OverrideOnFieldSyntaxRejected) {
     EXPECT_FALSE(parser.get_errors().empty());
 }
 
-TEST(InterpreterEndToEnd, UnknownAnnotationSyntaxRejected) {
+TEST_P(InterpreterEndToEnd, UnknownAnnotationSyntaxRejected) {
     // 未知注解：语法阶段报错
     collie::Lexer lexer(R"(
         class Animal {
@@ -1867,7 +2068,7 @@ TEST(InterpreterEndToEnd, UnknownAnnotationSyntaxRejected) {
 // number/integer/decimal 三类型区分（t42：Python 式任意精度整数自动扩容）
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, BigIntegerExactArithmetic) {
+TEST_P(InterpreterEndToEnd, BigIntegerExactArithmetic) {
     // 超出 double 精度范围的整数精确算术（BigInt 自动扩容）
     EXPECT_EQ(run_source(R"(
         print(999999999999999999999 + 1);
@@ -1879,7 +2080,29 @@ TEST(InterpreterEndToEnd, BigIntegerExactArithmetic) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BigIntegerExactComparison) {
+TEST_P(InterpreterEndToEnd, Int64BoundaryPromotesToBigInteger) {
+    // int64 内联快速路径溢出时升格为 BigInt，结果回落 int64 范围后照常比较/取模
+    EXPECT_EQ(run_source(R"(
+        number max = 9223372036854775807;
+        number min = 0 - max - 1;
+        print(max + 1);
+        print(min - 1);
+        print(-min);
+        print(max * max);
+        print(min % -1);
+        print(max + 1 - 1 == max);
+        print(3037000500 * 3037000500 > max);
+    )"), R"(9223372036854775808
+-9223372036854775809
+9223372036854775808
+85070591730234615847396907784232501249
+0
+true
+true
+)");
+}
+
+TEST_P(InterpreterEndToEnd, BigIntegerExactComparison) {
     // 相邻超大整数精确区分（若经 double 会塔缩为相等）
     EXPECT_EQ(run_source(R"(
         print(999999999999999999999 == 999999999999999999998);
@@ -1889,7 +2112,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, IntegerDivisionProducesDecimal) {
+TEST_P(InterpreterEndToEnd, IntegerDivisionProducesDecimal) {
     // 除法恒产小数（Python 式 true division）；整除结果打印仍无小数点
     EXPECT_EQ(run_source(R"(
         print(1 / 2);
@@ -1902,7 +2125,7 @@ TEST(InterpreterEndToEnd, IntegerDivisionProducesDecimal) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BigIntegerFloorModulo) {
+TEST_P(InterpreterEndToEnd, BigIntegerFloorModulo) {
     // 整数取模走 BigInt floor 语义（结果符号与除数一致），超大整数同样精确
     EXPECT_EQ(run_source(R"(
         print(-1 % 5);
@@ -1914,7 +2137,7 @@ TEST(InterpreterEndToEnd, BigIntegerFloorModulo) {
 )");
 }
 
-TEST(InterpreterEndToEnd, IntegerDecimalDeclarations) {
+TEST_P(InterpreterEndToEnd, IntegerDecimalDeclarations) {
     // integer/decimal 声明；integer -> decimal 隐式加宽；number 为超类型
     EXPECT_EQ(run_source(R"(
         integer i = 123456789012345678901234567890;
@@ -1932,7 +2155,7 @@ TEST(InterpreterEndToEnd, IntegerDecimalDeclarations) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MixedIntegerDecimalArithmetic) {
+TEST_P(InterpreterEndToEnd, MixedIntegerDecimalArithmetic) {
     // 整数与小数混合运算：落到 double 路径，结果为 decimal
     EXPECT_EQ(run_source(R"(
         print(1 + 2.5);
@@ -1944,7 +2167,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, BigIntegerBuiltinMethods) {
+TEST_P(InterpreterEndToEnd, BigIntegerBuiltinMethods) {
     // 整数表示的 number 方法走 BigInt 精确路径（不受 double 饱和影响）
     EXPECT_EQ(run_source(R"(
         integer big = 999999999999999999999;
@@ -1959,7 +2182,7 @@ true
 )");
 }
 
-TEST(InterpreterEndToEnd, ToNumberBigIntegerStringExact) {
+TEST_P(InterpreterEndToEnd, ToNumberBigIntegerStringExact) {
     // 纯整数字符串转数字走 BigInt 精确转换，不经 double 不丢精度
     EXPECT_EQ(run_source(R"(
         print(toNumber("123456789012345678901234567890"));
@@ -1971,7 +2194,7 @@ TEST(InterpreterEndToEnd, ToNumberBigIntegerStringExact) {
 )");
 }
 
-TEST(InterpreterEndToEnd, DecimalToIntegerSemanticRejected) {
+TEST_P(InterpreterEndToEnd, DecimalToIntegerSemanticRejected) {
     // decimal 字面量赋给 integer：语义阶段拒绝（不可隐式窄化）
     collie::Lexer lexer(R"(
         integer i = 1.5;
@@ -1984,7 +2207,7 @@ TEST(InterpreterEndToEnd, DecimalToIntegerSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, NumberToIntegerRuntimeChecked) {
+TEST_P(InterpreterEndToEnd, NumberToIntegerRuntimeChecked) {
     // number -> integer 静态放行；运行期按实际表示校验：小数值拒绝
     collie::Lexer lexer(R"(
         function f() number {
@@ -1999,11 +2222,10 @@ TEST(InterpreterEndToEnd, NumberToIntegerRuntimeChecked) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, NumberToIntegerRuntimeAccepted) {
+TEST_P(InterpreterEndToEnd, NumberToIntegerRuntimeAccepted) {
     // number -> integer：运行期值确为整数表示时放行
     EXPECT_EQ(run_source(R"(
         function f() number {
@@ -2015,7 +2237,7 @@ TEST(InterpreterEndToEnd, NumberToIntegerRuntimeAccepted) {
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolUnsetLiteralAndWidening) {
+TEST_P(InterpreterEndToEnd, TriboolUnsetLiteralAndWidening) {
     // unset 字面量；bool -> tribool 隐式加宽（声明与重新赋值均生效）
     EXPECT_EQ(run_source(R"(
         tribool t = unset;
@@ -2032,7 +2254,7 @@ unset
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolKleeneLogic) {
+TEST_P(InterpreterEndToEnd, TriboolKleeneLogic) {
     // Kleene 三值逻辑真值表（t43，经作者确认）：
     // unset&&false=false、unset&&true=unset、unset||true=true、unset||false=unset、!unset=unset
     EXPECT_EQ(run_source(R"(
@@ -2052,7 +2274,7 @@ false
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolEqualityComparison) {
+TEST_P(InterpreterEndToEnd, TriboolEqualityComparison) {
     // tribool 与 bool/unset 等值比较：三态一致才相等
     EXPECT_EQ(run_source(R"(
         tribool t = unset;
@@ -2070,7 +2292,7 @@ false
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolIsTrueIsFalseIsUnset) {
+TEST_P(InterpreterEndToEnd, TriboolIsTrueIsFalseIsUnset) {
     // tribool 自带判定方法，返回 bool，可直接作 if 条件
     EXPECT_EQ(run_source(R"(
         tribool t = unset;
@@ -2084,7 +2306,7 @@ yes
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolTwoBranchTernaryUnsetTakesFalse) {
+TEST_P(InterpreterEndToEnd, TriboolTwoBranchTernaryUnsetTakesFalse) {
     // 两分支三元：unset 走 false 分支（见 uncategorized.md）
     EXPECT_EQ(run_source(R"(
         tribool t = unset;
@@ -2093,7 +2315,7 @@ TEST(InterpreterEndToEnd, TriboolTwoBranchTernaryUnsetTakesFalse) {
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolThreeBranchTernary) {
+TEST_P(InterpreterEndToEnd, TriboolThreeBranchTernary) {
     // 三分支三元 a ? x : y : z：true/false/unset 各取一支
     EXPECT_EQ(run_source(R"(
         tribool t = unset;
@@ -2108,7 +2330,7 @@ F
 )");
 }
 
-TEST(InterpreterEndToEnd, TriboolIfConditionSemanticRejected) {
+TEST_P(InterpreterEndToEnd, TriboolIfConditionSemanticRejected) {
     // if 条件必须是 bool：tribool 直接作条件在语义阶段拒绝（t43，经作者确认）
     collie::Lexer lexer(R"(
         tribool t = true;
@@ -2124,7 +2346,7 @@ TEST(InterpreterEndToEnd, TriboolIfConditionSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, ThreeBranchTernaryBoolConditionRejected) {
+TEST_P(InterpreterEndToEnd, ThreeBranchTernaryBoolConditionRejected) {
     // 三分支三元要求 tribool 条件：bool 条件在语义阶段拒绝
     collie::Lexer lexer(R"(
         bool b = true;
@@ -2138,7 +2360,7 @@ TEST(InterpreterEndToEnd, ThreeBranchTernaryBoolConditionRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, TriboolToBoolSemanticRejected) {
+TEST_P(InterpreterEndToEnd, TriboolToBoolSemanticRejected) {
     // tribool -> bool 反向收窄不允许（需 isTrue() 等显式判定）
     collie::Lexer lexer(R"(
         tribool t = true;
@@ -2152,7 +2374,7 @@ TEST(InterpreterEndToEnd, TriboolToBoolSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, TriboolMixedLogicResultWidens) {
+TEST_P(InterpreterEndToEnd, TriboolMixedLogicResultWidens) {
     // bool 与 tribool 混合逻辑运算：结果为 tribool；纯 bool 仍为 bool
     EXPECT_EQ(run_source(R"(
         tribool u = unset;
@@ -2165,7 +2387,7 @@ false
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchTriboolExhaustive) {
+TEST_P(InterpreterEndToEnd, MultiMatchTriboolExhaustive) {
     // ==? 多路匹配（t44）：tribool 穷尽三态，无需默认分支
     EXPECT_EQ(run_source(R"(
         tribool a = unset;
@@ -2180,7 +2402,7 @@ TEST(InterpreterEndToEnd, MultiMatchTriboolExhaustive) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchValueGrouping) {
+TEST_P(InterpreterEndToEnd, MultiMatchValueGrouping) {
     // 裸值与后面最近的「值: 结果」归组：unset, true 同组
     EXPECT_EQ(run_source(R"(
         tribool a = unset;
@@ -2192,7 +2414,7 @@ TEST(InterpreterEndToEnd, MultiMatchValueGrouping) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchTrailingDefault) {
+TEST_P(InterpreterEndToEnd, MultiMatchTrailingDefault) {
     // 末尾裸表达式 = 默认分支
     EXPECT_EQ(run_source(R"(
         tribool a = false;
@@ -2204,7 +2426,7 @@ TEST(InterpreterEndToEnd, MultiMatchTrailingDefault) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchGenericNumberString) {
+TEST_P(InterpreterEndToEnd, MultiMatchGenericNumberString) {
     // 通用多路匹配（不限 tribool）：number 目标 + string 结果
     EXPECT_EQ(run_source(R"(
         number n = 5;
@@ -2219,7 +2441,7 @@ other
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchFirstMatchWinsAndLazy) {
+TEST_P(InterpreterEndToEnd, MultiMatchFirstMatchWinsAndLazy) {
     // 命中第一个匹配分支；未命中分支的候选值/结果不求值
     // （[1][5] 若被求值会抛越界错误）
     EXPECT_EQ(run_source(R"(
@@ -2228,7 +2450,7 @@ TEST(InterpreterEndToEnd, MultiMatchFirstMatchWinsAndLazy) {
 )");
 }
 
-TEST(InterpreterEndToEnd, MultiMatchTriboolNotExhaustiveRejected) {
+TEST_P(InterpreterEndToEnd, MultiMatchTriboolNotExhaustiveRejected) {
     // tribool 无默认分支时必须字面量穷尽三态：缺 false 分支拒绝
     collie::Lexer lexer(R"(
         tribool t = true;
@@ -2242,7 +2464,7 @@ TEST(InterpreterEndToEnd, MultiMatchTriboolNotExhaustiveRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, MultiMatchNonTriboolNeedsDefaultRejected) {
+TEST_P(InterpreterEndToEnd, MultiMatchNonTriboolNeedsDefaultRejected) {
     // 非 tribool 目标必须有默认分支（末尾裸表达式）
     collie::Lexer lexer(R"(
         number n = 1;
@@ -2256,7 +2478,7 @@ TEST(InterpreterEndToEnd, MultiMatchNonTriboolNeedsDefaultRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, MultiMatchDefaultInFrontRejected) {
+TEST_P(InterpreterEndToEnd, MultiMatchDefaultInFrontRejected) {
     // 默认分支必须在末尾：前置裸值 2 会与 unset 归组，
     // 而 number 字面量与 tribool 目标不可比较 → 语义拒绝（原文档示例 5 已废弃）
     collie::Lexer lexer(R"(
@@ -2275,7 +2497,7 @@ TEST(InterpreterEndToEnd, MultiMatchDefaultInFrontRejected) {
 // tuple 最小闭环（t45，经作者确认）：字面量/命名字段/t[0]/t.name/t.get
 // ---------------------------------------------------------------------------
 
-TEST(InterpreterEndToEnd, TupleLiteralAndIndex) {
+TEST_P(InterpreterEndToEnd, TupleLiteralAndIndex) {
     // 无名元组字面量 + 0 起始索引 + 负索引
     EXPECT_EQ(run_source(R"(
         Tuple t = (1, 2, 3);
@@ -2283,7 +2505,7 @@ TEST(InterpreterEndToEnd, TupleLiteralAndIndex) {
     )"), "1 3 3\n");
 }
 
-TEST(InterpreterEndToEnd, TupleNamedFieldAccess) {
+TEST_P(InterpreterEndToEnd, TupleNamedFieldAccess) {
     // 命名元组：t.name 属性访问；命名元素同样支持位置索引
     EXPECT_EQ(run_source(R"(
         Tuple p = (name: "Alice", age: 18);
@@ -2291,7 +2513,7 @@ TEST(InterpreterEndToEnd, TupleNamedFieldAccess) {
     )"), "Alice 18 18\n");
 }
 
-TEST(InterpreterEndToEnd, TupleSingleNamedElement) {
+TEST_P(InterpreterEndToEnd, TupleSingleNamedElement) {
     // 单命名元素无逗号也是元组（区别于分组 (expr)）
     EXPECT_EQ(run_source(R"(
         Tuple s = (name: "x");
@@ -2299,7 +2521,7 @@ TEST(InterpreterEndToEnd, TupleSingleNamedElement) {
     )"), "x 1\n");
 }
 
-TEST(InterpreterEndToEnd, TupleGetDynamic) {
+TEST_P(InterpreterEndToEnd, TupleGetDynamic) {
     // get("key") 按名字动态获取；键可为运行期拼接的字符串
     EXPECT_EQ(run_source(R"(
         Tuple p = (name: "Alice", age: 18);
@@ -2308,7 +2530,7 @@ TEST(InterpreterEndToEnd, TupleGetDynamic) {
     )"), "Alice 18\n");
 }
 
-TEST(InterpreterEndToEnd, TupleLengthAndEmpty) {
+TEST_P(InterpreterEndToEnd, TupleLengthAndEmpty) {
     // length 属性；空元组 () 长度为 0
     EXPECT_EQ(run_source(R"(
         Tuple t = (1, 2, 3);
@@ -2317,7 +2539,7 @@ TEST(InterpreterEndToEnd, TupleLengthAndEmpty) {
     )"), "3 0\n");
 }
 
-TEST(InterpreterEndToEnd, TupleToString) {
+TEST_P(InterpreterEndToEnd, TupleToString) {
     // to_string：无名 (1, 2)；命名字段带名字
     EXPECT_EQ(run_source(R"(
         print((1, 2, 3));
@@ -2325,7 +2547,7 @@ TEST(InterpreterEndToEnd, TupleToString) {
     )"), "(1, 2, 3)\n(name: Alice, age: 18)\n");
 }
 
-TEST(InterpreterEndToEnd, TupleMixedNamedUnnamed) {
+TEST_P(InterpreterEndToEnd, TupleMixedNamedUnnamed) {
     // 混合命名/无名元素：无名位置只能索引，命名位置两种都行
     EXPECT_EQ(run_source(R"(
         Tuple t = (1, label: "x");
@@ -2333,7 +2555,7 @@ TEST(InterpreterEndToEnd, TupleMixedNamedUnnamed) {
     )"), "1 x x\n");
 }
 
-TEST(InterpreterEndToEnd, TupleEquality) {
+TEST_P(InterpreterEndToEnd, TupleEquality) {
     // 元素与名字表都一致才相等（名字不同则不相等）
     EXPECT_EQ(run_source(R"(
         print((1, 2) == (1, 2));
@@ -2342,7 +2564,7 @@ TEST(InterpreterEndToEnd, TupleEquality) {
     )"), "true\nfalse\nfalse\n");
 }
 
-TEST(InterpreterEndToEnd, TupleFromFunctionReturn) {
+TEST_P(InterpreterEndToEnd, TupleFromFunctionReturn) {
     // 函数返回元组（文档 uncategorized.md 多返回值示例）
     EXPECT_EQ(run_source(R"(
         function getPersonInfo() Tuple {
@@ -2353,14 +2575,14 @@ TEST(InterpreterEndToEnd, TupleFromFunctionReturn) {
     )"), "Alice 18\n");
 }
 
-TEST(InterpreterEndToEnd, GroupingUnaffectedByTuple) {
+TEST_P(InterpreterEndToEnd, GroupingUnaffectedByTuple) {
     // (expr) 仍是分组表达式，不被命名前瞻误判
     EXPECT_EQ(run_source(R"(
         print((1 + 2) * 3);
     )"), "9\n");
 }
 
-TEST(InterpreterEndToEnd, TupleIndexAssignSemanticRejected) {
+TEST_P(InterpreterEndToEnd, TupleIndexAssignSemanticRejected) {
     // 元组不可变：索引赋值在语义层报错
     collie::Lexer lexer(R"(Tuple t = (1, 2); t[0] = 9;)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2371,7 +2593,7 @@ TEST(InterpreterEndToEnd, TupleIndexAssignSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, TupleUnknownFieldThrows) {
+TEST_P(InterpreterEndToEnd, TupleUnknownFieldThrows) {
     // 访问不存在的命名字段：运行期报错
     collie::Lexer lexer(R"(Tuple p = (name: "Alice"); print(p.age);)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2381,11 +2603,10 @@ TEST(InterpreterEndToEnd, TupleUnknownFieldThrows) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, TupleIndexOutOfRangeThrows) {
+TEST_P(InterpreterEndToEnd, TupleIndexOutOfRangeThrows) {
     // 索引越界：运行期报错
     collie::Lexer lexer(R"(Tuple t = (1, 2); print(t[2]);)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2395,11 +2616,10 @@ TEST(InterpreterEndToEnd, TupleIndexOutOfRangeThrows) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, TupleGetOnNonTupleSemanticRejected) {
+TEST_P(InterpreterEndToEnd, TupleGetOnNonTupleSemanticRejected) {
     // get() 仅支持元组：对 number 调用在语义层报错
     collie::Lexer lexer(R"(number n = 1; n.get("x");)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2410,7 +2630,7 @@ TEST(InterpreterEndToEnd, TupleGetOnNonTupleSemanticRejected) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
-TEST(InterpreterEndToEnd, TupleDeclTypeMismatchRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, TupleDeclTypeMismatchRuntimeRejected) {
     // 声明为 Tuple 的变量接受非元组值（动态路径）：运行期拦截
     collie::Lexer lexer(R"(
         array a = [1];
@@ -2423,13 +2643,12 @@ TEST(InterpreterEndToEnd, TupleDeclTypeMismatchRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
 // ---------- t47：位运算符与 hex 字面量 ----------
 
-TEST(InterpreterEndToEnd, HexLiteralAndBitwiseOps) {
+TEST_P(InterpreterEndToEnd, HexLiteralAndBitwiseOps) {
     // hex 字面量按十进制输出；~ 走 BigInt 精确（~x = -x-1），其余 int64 域
     EXPECT_EQ(run_source(R"(
         print(0x10);
@@ -2451,7 +2670,7 @@ TEST(InterpreterEndToEnd, HexLiteralAndBitwiseOps) {
 )");
 }
 
-TEST(InterpreterEndToEnd, BitwisePrecedence) {
+TEST_P(InterpreterEndToEnd, BitwisePrecedence) {
     // 优先级（C 家族）：`|` < `^` < `&`；移位低于加减
     EXPECT_EQ(run_source(R"(
         print(1 | 2 ^ 3 & 4);
@@ -2460,7 +2679,7 @@ TEST(InterpreterEndToEnd, BitwisePrecedence) {
     )"), "3\n8\n255\n");
 }
 
-TEST(InterpreterEndToEnd, ByteWordDeclarationAndRange) {
+TEST_P(InterpreterEndToEnd, ByteWordDeclarationAndRange) {
     // integer 可窄化赋 byte/word（静态放行 + 运行期范围校验通过）
     EXPECT_EQ(run_source(R"(
         byte b = 0xFF & 0x0F;
@@ -2469,7 +2688,7 @@ TEST(InterpreterEndToEnd, ByteWordDeclarationAndRange) {
     )"), "15 65535\n");
 }
 
-TEST(InterpreterEndToEnd, ByteRangeOverflowRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, ByteRangeOverflowRuntimeRejected) {
     // byte 超上界（256 > 255）：静态放行（byte ← integer），运行期拦截
     collie::Lexer lexer(R"(byte b = 256;)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2479,11 +2698,10 @@ TEST(InterpreterEndToEnd, ByteRangeOverflowRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, ByteNegativeRuntimeRejected) {
+TEST_P(InterpreterEndToEnd, ByteNegativeRuntimeRejected) {
     // ~0xFF = -256：低于 byte 下界 0，运行期拦截
     collie::Lexer lexer(R"(byte b = ~0xFF;)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2493,11 +2711,10 @@ TEST(InterpreterEndToEnd, ByteNegativeRuntimeRejected) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
-TEST(InterpreterEndToEnd, ShiftCountOutOfRangeThrows) {
+TEST_P(InterpreterEndToEnd, ShiftCountOutOfRangeThrows) {
     // 移位数限 0-63（int64 域），越界报运行时错误而非静默截断
     collie::Lexer lexer(R"(print(1 << 64);)");
     std::vector<collie::Token> tokens = lexer.tokenize();
@@ -2507,7 +2724,219 @@ TEST(InterpreterEndToEnd, ShiftCountOutOfRangeThrows) {
     analyzer.analyze(stmts);
     ASSERT_FALSE(analyzer.has_errors());
     std::ostringstream out;
-    collie::Interpreter interpreter(out);
-    EXPECT_THROW(interpreter.interpret(stmts), collie::RuntimeError);
+    EXPECT_THROW(run_program(stmts, out), collie::RuntimeError);
 }
 
+
+TEST_P(InterpreterEndToEnd, OutOfRangeNumberLiteralFailsWhenEvaluated) {
+    // stod 放不下的字面量（次正规数 5e-324）不阻断编译：前面的语句照常执行，
+    // 执行到该字面量时两个引擎报同样的定位运行期错误
+    collie::Lexer lexer(R"(print(1);
+print(5e-324);
+print(2);)");
+    std::vector<collie::Token> tokens = lexer.tokenize();
+    collie::Parser parser(tokens);
+    auto stmts = parser.parse_program();
+    collie::SemanticAnalyzer analyzer;
+    analyzer.analyze(stmts);
+    ASSERT_FALSE(analyzer.has_errors());
+    std::ostringstream out;
+    try {
+        run_program(stmts, out);
+        FAIL() << "expected RuntimeError";
+    } catch (const collie::RuntimeError& e) {
+        EXPECT_EQ(std::string(e.what()), "Number literal '5e-324' is out of range");
+        EXPECT_EQ(e.line(), 2u);
+    }
+    EXPECT_EQ(out.str(), "1\n");
+}
+
+
+// ---------- 变量解析：词法作用域与槽位 ----------
+
+TEST_P(InterpreterEndToEnd, CalleeReadsGlobalNotCallerLocal) {
+    // 被调函数按词法作用域读全局 x，不会被调用方同名局部变量遮蔽
+    EXPECT_EQ(run_source(R"(
+        number x = 1;
+        function read_x() number {
+            return x;
+        }
+        function caller() number {
+            number x = 100;
+            return read_x() + x;
+        }
+        print(caller());
+    )"), "101\n");
+}
+
+TEST_P(InterpreterEndToEnd, ForwardReferencesAndMutualRecursion) {
+    // 顶层函数与类预先登记：可调用/实例化源码中位于其后的函数与类，支持相互递归
+    EXPECT_EQ(run_source(R"(
+        print(isEven(10), isOdd(7), new Box(3).size());
+        function isEven(n number) bool {
+            if (n == 0) {
+                return true;
+            }
+            return isOdd(n - 1);
+        }
+        function isOdd(n number) bool {
+            if (n == 0) {
+                return false;
+            }
+            return isEven(n - 1);
+        }
+        class Box {
+            public number side = 0;
+            public Box(n number) {
+                this.side = n;
+            }
+            public function size() number {
+                return this.side * this.side;
+            }
+        }
+    )"), "true true 9\n");
+}
+
+TEST_P(InterpreterEndToEnd, ForwardCallReadsGlobalBeforeInitialization) {
+    // 前向引用让 f 在全局变量 g 初始化之前运行：读到 none，两个引擎报同样的运行期错误，
+    // 而不是按静态类型走快路径得出错误结果
+    auto run_expecting_error = [](const std::string& source) {
+        collie::Lexer lexer(source);
+        std::vector<collie::Token> tokens = lexer.tokenize();
+        collie::Parser parser(tokens);
+        auto stmts = parser.parse_program();
+        collie::SemanticAnalyzer analyzer;
+        analyzer.analyze(stmts);
+        EXPECT_FALSE(analyzer.has_errors());
+        std::ostringstream out;
+        try {
+            run_program(stmts, out, collie::kDefaultMaxCallDepth, &analyzer.expr_types());
+        } catch (const collie::RuntimeError& e) {
+            return std::string(e.what());
+        }
+        return "no error; output: " + out.str();
+    };
+    EXPECT_EQ(run_expecting_error(R"(
+        function h() number { return f(); }
+        print(h());
+        number g = 1;
+        function f() number { return g + 1; }
+    )"), "Arithmetic operands must be numbers");
+    EXPECT_EQ(run_expecting_error(R"(
+        function h() string { return f(); }
+        print(h());
+        string g = "x";
+        function f() string { return g; }
+    )"), "Type mismatch: cannot assign none to 'string' variable");
+}
+
+TEST_P(InterpreterEndToEnd, StaticTypesDoNotMaskNoneValues) {
+    // 类型表声称未初始化变量的读取已定型时，树遍历解释器仍对 none 报错（与 VM 一致），
+    // 不把 none 的载荷当作数值、也不免检存入受检类型变量
+    auto run_with_claimed_types = [](const std::string& source, auto claim) {
+        collie::Lexer lexer(source);
+        std::vector<collie::Token> tokens = lexer.tokenize();
+        collie::Parser parser(tokens);
+        auto stmts = parser.parse_program();
+        collie::ExprTypeTable types;
+        claim(stmts, types);
+        std::ostringstream out;
+        try {
+            run_program(stmts, out, collie::kDefaultMaxCallDepth, &types);
+        } catch (const collie::RuntimeError& e) {
+            return std::string(e.what());
+        }
+        return "no error; output: " + out.str();
+    };
+    EXPECT_EQ(run_with_claimed_types("number g; print(g + 1);",
+                                     [](const auto& stmts, collie::ExprTypeTable& types) {
+        auto* print = dynamic_cast<const collie::ExpressionStmt*>(stmts[1].get());
+        auto* call = dynamic_cast<const collie::CallExpr*>(print->expression());
+        auto* sum = dynamic_cast<const collie::BinaryExpr*>(call->arguments()[0].get());
+        types.record(*sum->left(), collie::TokenType::KW_NUMBER);
+        types.record(*sum->right(), collie::TokenType::KW_INTEGER);
+    }), "Arithmetic operands must be numbers");
+    EXPECT_EQ(run_with_claimed_types("string t; string s = t;",
+                                     [](const auto& stmts, collie::ExprTypeTable& types) {
+        auto* decl = dynamic_cast<const collie::VarDeclStmt*>(stmts[1].get());
+        types.record(*decl->initializer(), collie::TokenType::KW_STRING);
+    }), "Type mismatch: cannot assign none to 'string' variable");
+}
+
+TEST_P(InterpreterEndToEnd, NestedFunctionRecursionAndOuterAccess) {
+    // 嵌套函数经外层帧链读写外层函数的局部变量，递归时外层帧保持不变
+    EXPECT_EQ(run_source(R"(
+        function outer(n number) number {
+            number calls = 0;
+            function fact(k number) number {
+                calls = calls + 1;
+                if (k <= 1) {
+                    return 1;
+                }
+                return k * fact(k - 1);
+            }
+            number r = fact(n);
+            return r * 100 + calls;
+        }
+        print(outer(5));
+    )"), "12005\n");
+}
+
+TEST_P(InterpreterEndToEnd, SiblingBlocksReuseSlots) {
+    // 兄弟块的局部变量复用同一槽位，每次进入块都重新初始化
+    EXPECT_EQ(run_source(R"(
+        number total = 0;
+        for (number i = 0; i < 3; i = i + 1) {
+            if (i == 1) {
+                number a = 10;
+                total = total + a;
+            } else {
+                number b = 1;
+                total = total + b + i;
+            }
+        }
+        {
+            number c = 5;
+            total = total + c;
+        }
+        print(total);
+    )"), "19\n");
+}
+
+// ---------- 控制流完成状态：break/continue/return 跨嵌套结构传递 ----------
+
+TEST_P(InterpreterEndToEnd, ReturnFromNestedLoopsAndSwitch) {
+    // return 穿过 switch 与两层循环直接结束函数；switch 内 break 作用于外层循环
+    EXPECT_EQ(run_source(R"(
+        function find(target number) number {
+            for (number i = 0; i < 10; i = i + 1) {
+                number j = 0;
+                while (true) {
+                    j = j + 1;
+                    if (j > 3) {
+                        break;
+                    }
+                    switch (i * 10 + j) {
+                        target {
+                            return i * 100 + j;
+                        }
+                    }
+                }
+            }
+            return -1;
+        }
+        number skipped = 0;
+        for (number k = 0; k < 5; k = k + 1) {
+            switch (k) {
+                2 {
+                    continue;
+                }
+                4 {
+                    break;
+                }
+            }
+            skipped = skipped + k;
+        }
+        print(find(42), find(99), skipped);
+    )"), "402 -1 4\n");
+}
@@ -3,6 +3,8 @@
  * @Date: 2025-01-05
  */
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #ifdef _WIN32
     #include <Windows.h>
@@ -11,6 +13,7 @@
 #endif
 
 #include "../lexer/lexer.h"
+#include "../lexer/source_file.h"
 
 using namespace collie;
 
@@ -231,6 +234,75 @@ TEST(LexerTest, UTF16Strings) {
     EXPECT_EQ(tokens[0].lexeme_utf16(), expected);
 }
 
+// token 词素是源码切片：扫描不复制文本，转义在 decode_lexeme 中按需解码
+TEST(LexerTest, LexemesAreSourceSlices) {
+    std::string source = "string s = \"a\\tb\"; character c = '\\n'; print(\"plain\");";
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+    const char* begin = source.data();
+    const char* end = source.data() + source.size();
+    for (const Token& token : tokens) {
+        // 运算符与分隔符的词素是静态字符串，只检查标识符与字面量
+        if (token.type() != TokenType::IDENTIFIER && token.type() != TokenType::LITERAL_STRING &&
+            token.type() != TokenType::LITERAL_CHAR) {
+            continue;
+        }
+        EXPECT_GE(token.lexeme().data(), begin) << token.lexeme();
+        EXPECT_LE(token.lexeme().data() + token.lexeme().size(), end) << token.lexeme();
+    }
+
+    EXPECT_EQ(tokens[3].lexeme(), "a\\tb");
+    EXPECT_EQ(tokens[3].form(), LexemeForm::Escaped);
+    EXPECT_EQ(decode_lexeme(tokens[3]), "a\tb");
+
+    EXPECT_EQ(tokens[8].type(), TokenType::LITERAL_CHAR);
+    EXPECT_EQ(decode_lexeme(tokens[8]), "\n");
+
+    EXPECT_EQ(tokens[12].lexeme(), "plain");
+    EXPECT_EQ(tokens[12].form(), LexemeForm::Exact);
+}
+
+// 普通文件按只读映射打开：BOM 以偏移跳过，token 词素直接指向映射
+TEST(LexerTest, SourceFileMapsRegularFiles) {
+    const std::string path = testing::TempDir() + "collie_source_file_test.collie";
+    // 文件恰好占满一页，末尾 token 紧贴映射边界
+    std::string body = "number answer = 42;\n";
+    body += std::string(4096 - 3 - body.size() - 1, ' ');
+    body += "x";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "\xEF\xBB\xBF" << body;
+    }
+
+    std::string error;
+    std::unique_ptr<SourceFile> file = SourceFile::read(path, error);
+    ASSERT_NE(file, nullptr) << error;
+    EXPECT_TRUE(file->is_mapped());
+    EXPECT_EQ(file->text(), body);
+
+    Lexer lexer(*file);
+    auto tokens = lexer.tokenize();
+    ASSERT_EQ(tokens.size(), 7u);
+    EXPECT_EQ(tokens[1].lexeme(), "answer");
+    EXPECT_EQ(tokens[1].lexeme().data(), file->text().data() + 7);
+    EXPECT_EQ(tokens[5].lexeme(), "x");
+    EXPECT_EQ(tokens[5].lexeme().data() + 1, file->text().data() + file->size());
+
+    file.reset();
+    std::remove(path.c_str());
+
+    EXPECT_EQ(SourceFile::read(path, error), nullptr);
+    EXPECT_EQ(error, "Cannot open file " + path);
+}
+
+// 目录等非普通文件在打开前就被拒绝，不按其 tellg 结果分配缓冲区
+TEST(LexerTest, SourceFileRejectsNonRegularFiles) {
+    std::string dir = testing::TempDir();
+    std::string error;
+    EXPECT_EQ(SourceFile::read(dir, error), nullptr);
+    EXPECT_EQ(error, "Cannot read file " + dir);
+}
+
 // 多行字符串测试
 TEST(LexerTest, MultilineStrings) {
     // 基本的多行字符串
@@ -245,7 +317,8 @@ TEST(LexerTest, MultilineStrings) {
     auto tokens = lexer.tokenize(); // [tokens] const, text, =, string_literal, ;
     ASSERT_EQ(tokens.size() - 1, 5);
     EXPECT_EQ(tokens[3].type(), TokenType::LITERAL_STRING);
-    EXPECT_EQ(tokens[3].lexeme(), "Hello,\nWorld!\n");
+    EXPECT_EQ(tokens[3].form(), LexemeForm::Indented);  // 去缩进延后到 decode_lexeme
+    EXPECT_EQ(decode_lexeme(tokens[3]), "Hello,\nWorld!\n");
 
     // 测试缩进对齐
     source = R"(
@@ -256,7 +329,7 @@ TEST(LexerTest, MultilineStrings) {
     )";
     lexer = Lexer(source, Encoding::UTF8);
     tokens = lexer.tokenize();
-    EXPECT_EQ(tokens[3].lexeme(), "Hello,\n    World!\n");
+    EXPECT_EQ(decode_lexeme(tokens[3]), "Hello,\n    World!\n");
 
     // 测试错误的缩进
     source = R"(
@@ -313,6 +386,90 @@ TEST(LexerTest, ChineseIdentifiers) {
     EXPECT_EQ(token.lexeme(), "变量名");
 }
 
+// 关键字完美哈希：全部关键字命中，形近的标识符不误判
+TEST(LexerTest, KeywordLookup) {
+    EXPECT_EQ(get_identifier_type("function"), TokenType::KW_FUNCTION);
+    EXPECT_EQ(get_identifier_type("protected"), TokenType::KW_PROTECTED);
+    EXPECT_EQ(get_identifier_type("Tuple"), TokenType::KW_TUPLE);
+    EXPECT_EQ(get_identifier_type("if"), TokenType::KW_IF);
+    EXPECT_EQ(get_identifier_type("NaN"), TokenType::LITERAL_NUMBER);
+    EXPECT_EQ(get_identifier_type("tuple"), TokenType::IDENTIFIER);
+    EXPECT_EQ(get_identifier_type("functions"), TokenType::IDENTIFIER);
+    EXPECT_EQ(get_identifier_type("fi"), TokenType::IDENTIFIER);
+    EXPECT_EQ(get_identifier_type("x"), TokenType::IDENTIFIER);
+    EXPECT_EQ(get_identifier_type("characterx"), TokenType::IDENTIFIER);
+}
+
+// 各级扫描内核与标量版本结果一致（覆盖块边界、尾部与非 ASCII 字节）
+TEST(LexerTest, ScanKernelsAgree) {
+    std::string buffer;
+    unsigned seed = 12345;
+    const char alphabet[] = "  \t\r\nab_Z09\"\\*/{}\xE4\xB8\xAD";
+    for (int i = 0; i < 4096; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        // 偏向长段：重复上一个字节，制造跨越多个块的同类字节
+        if (!buffer.empty() && (seed >> 16) % 4 != 0) {
+            buffer += buffer.back();
+        } else {
+            buffer += alphabet[(seed >> 16) % (sizeof(alphabet) - 1)];
+        }
+    }
+
+    scan::ScanLevel original = scan::level();
+    scan::set_level(scan::ScanLevel::Scalar);
+    const scan::ScanKernels scalar = scan::kernels();
+    for (scan::ScanLevel level : {scan::ScanLevel::SSE2, scan::ScanLevel::AVX2}) {
+        if (scan::set_level(level) != level) continue;
+        const scan::ScanKernels& simd = scan::kernels();
+        const char* end = buffer.data() + buffer.size();
+        for (size_t offset = 0; offset < buffer.size(); offset += 7) {
+            const char* p = buffer.data() + offset;
+            ASSERT_EQ(simd.skip_whitespace(p, end), scalar.skip_whitespace(p, end));
+            ASSERT_EQ(simd.skip_identifier(p, end), scalar.skip_identifier(p, end));
+            ASSERT_EQ(simd.find_string_special(p, end), scalar.find_string_special(p, end));
+            ASSERT_EQ(simd.find_multiline_special(p, end), scalar.find_multiline_special(p, end));
+            ASSERT_EQ(simd.find_comment_special(p, end), scalar.find_comment_special(p, end));
+            ASSERT_EQ(simd.find_newline(p, end), scalar.find_newline(p, end));
+            ASSERT_EQ(simd.count_newlines(p, end), scalar.count_newlines(p, end));
+        }
+    }
+    scan::set_level(original);
+}
+
+// 换用不同扫描内核时 token 序列（含行列号）不变
+TEST(LexerTest, TokensIndependentOfScanLevel) {
+    std::string source =
+        "/* 块注释 /* 嵌套 */ 仍在注释内\n   第三行 */\n"
+        "function accumulate_weighted_samples(number count) number {  // 行注释到行尾\n"
+        "\t\tstring s = \"a fairly long string literal with an escape \\n and 中文 inside\";\n"
+        "        string m = \"\"\"\n            line one of a multiline string\n            line two\n            \"\"\";\n"
+        "        number 变量_with_ascii_suffix_long_enough_to_cross_blocks = count * 2;\r\n"
+        "                                                                return 变量_with_ascii_suffix_long_enough_to_cross_blocks;\n"
+        "}\n";
+
+    scan::ScanLevel original = scan::level();
+    scan::set_level(scan::ScanLevel::Scalar);
+    std::vector<Token> expected = Lexer(source).tokenize();
+    for (scan::ScanLevel level : {scan::ScanLevel::SSE2, scan::ScanLevel::AVX2}) {
+        if (scan::set_level(level) != level) continue;
+        std::vector<Token> tokens = Lexer(source).tokenize();
+        ASSERT_EQ(tokens.size(), expected.size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            EXPECT_EQ(tokens[i].type(), expected[i].type()) << i;
+            EXPECT_EQ(tokens[i].lexeme(), expected[i].lexeme()) << i;
+            EXPECT_EQ(tokens[i].line(), expected[i].line()) << i;
+            EXPECT_EQ(tokens[i].column(), expected[i].column()) << i;
+        }
+    }
+    scan::set_level(original);
+
+    // 行号按换行累计（含注释与多行字符串内的换行）：函数体结束的 } 位于第 11 行
+    ASSERT_GE(expected.size(), 2u);
+    EXPECT_EQ(expected[expected.size() - 2].type(), TokenType::DELIMITER_RBRACE);
+    EXPECT_EQ(expected[expected.size() - 2].line(), 11u);
+    EXPECT_EQ(expected[expected.size() - 2].column(), 1u);
+}
+
 #ifdef _WIN32
 void SetupWindowsConsole() {
     // 设置控制台代码页为 UTF-8
@@ -495,6 +495,51 @@ TEST(ParserTest, ComplexExpressions) {
     EXPECT_EQ(visitor.result(), "x = ((a+b)*(c-d));");
 }
 
+// 运算符优先级与结合性（优先级爬升表）
+TEST(ParserTest, OperatorPrecedenceAndAssociativity) {
+    const std::pair<std::string, std::string> cases[] = {
+        {"a - b - c;", "((a-b)-c);"},
+        {"a = b = c;", "a = b = c;"},
+        {"x += a * b;", "x = (x+(a*b));"},
+        {"a || b && c | d ^ e & f == g < h << i + j * -k;",
+         "(a||(b&&(c|(d^(e&(f==(g<(h<<(i+(j*-k))))))))));"},
+        {"a * b + c << d > e != f & g ^ h | i && j || k;",
+         "((((((((((a*b)+c)<<d)>e)!=f)&g)^h)|i)&&j)||k);"},
+        {"-a[0] * ~b;", "(-a[0]*~b);"},
+        {"v[i] = a + b;", "v[i] = (a+b);"},
+        {"x ==? 1, 2: a + b, c;", "(x ==? 1, 2: (a+b), c);"},
+    };
+    for (const auto& [source, expected] : cases) {
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.tokenize();
+        Parser parser(tokens);
+
+        auto stmt = parser.parse();
+        ASSERT_NE(stmt, nullptr) << source;
+
+        TestStmtVisitor visitor;
+        stmt->accept(visitor);
+        EXPECT_EQ(visitor.result(), expected) << source;
+    }
+}
+
+// 深层括号嵌套：每层只经过常数层调用
+TEST(ParserTest, DeeplyNestedParentheses) {
+    const int depth = 500;
+    std::string source = std::string(depth, '(') + "1" + std::string(depth, ')') + " + 2;";
+    Lexer lexer(source);
+    std::vector<Token> tokens = lexer.tokenize();
+    Parser parser(tokens);
+
+    auto program = parser.parse_program();
+    EXPECT_TRUE(parser.get_errors().empty());
+    ASSERT_EQ(program.size(), 1u);
+
+    TestStmtVisitor visitor;
+    program[0]->accept(visitor);
+    EXPECT_EQ(visitor.result(), "(1+2);");
+}
+
 // if 语句测试
 TEST(ParserTest, IfStatement) {
     // std::string source = "if (x > 0) { x = x - 1; } else { x = 0; }";
@@ -809,6 +854,130 @@ TEST(ParserTest, ParseProgramNoErrorsForValidSource) {
     EXPECT_EQ(stmts.size(), 2u);
 }
 
+// AST 归 ParsedProgram 的上下文所有：源码、Lexer、token 序列与 Parser 销毁后，
+// 节点与其中 token 的词素（含插值字符串脱糖出的文本段）仍然有效。
+TEST(ParserTest, ParsedProgramOutlivesLexerAndParser) {
+    ParsedProgram program;
+    {
+        std::string source = "number answer = 40 + 2;\nprint(@\"v={answer}!\");";
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.tokenize();
+        Parser parser(tokens);
+        program = parser.parse_program();
+        ASSERT_TRUE(parser.get_errors().empty());
+        source.assign(source.size(), '#');
+    }
+    ASSERT_EQ(program.size(), 2u);
+
+    auto* decl = dynamic_cast<const VarDeclStmt*>(program[0].get());
+    ASSERT_NE(decl, nullptr);
+    EXPECT_EQ(decl->name().lexeme(), "answer");
+    TestExprVisitor visitor;
+    decl->initializer()->accept(visitor);
+    EXPECT_EQ(visitor.result(), "(40+2)");
+
+    auto* print = dynamic_cast<const ExpressionStmt*>(program[1].get());
+    ASSERT_NE(print, nullptr);
+    auto* call = dynamic_cast<const CallExpr*>(print->expression());
+    ASSERT_NE(call, nullptr);
+    auto* concat = dynamic_cast<const BinaryExpr*>(call->arguments()[0].get());
+    ASSERT_NE(concat, nullptr);
+    auto* tail = dynamic_cast<const LiteralExpr*>(concat->right());
+    ASSERT_NE(tail, nullptr);
+    EXPECT_EQ(tail->token().lexeme(), "!");
+}
+
+// 流式解析（Parser 直接从 Lexer 拉取 token）与先 tokenize 再解析结果一致
+TEST(ParserTest, StreamingParseMatchesBatch) {
+    std::string source =
+        "function add(a number, b number) number { return a + b; }\n"
+        "number total = add(1, 2) * 3;\n"
+        "if (total > 5) { print(@\"big {total}\"); } else { total = 0; }\n"
+        "number broken = ;\n"
+        "while (total > 0) { total = total - 1; }\n";
+
+    Lexer batch_lexer(source);
+    std::vector<Token> tokens = batch_lexer.tokenize();
+    Parser batch_parser(tokens);
+    ParsedProgram batch = batch_parser.parse_program();
+
+    Lexer stream_lexer(source);
+    Parser stream_parser(stream_lexer);
+    ParsedProgram streamed = stream_parser.parse_program();
+
+    ASSERT_EQ(streamed.size(), batch.size());
+    ASSERT_EQ(stream_parser.get_errors().size(), batch_parser.get_errors().size());
+    ASSERT_EQ(batch_parser.get_errors().size(), 1u);
+    EXPECT_STREQ(stream_parser.get_errors()[0].what(), batch_parser.get_errors()[0].what());
+    EXPECT_EQ(stream_parser.get_errors()[0].line(), 4u);
+    EXPECT_EQ(streamed.context()->node_count(), batch.context()->node_count());
+
+    auto* decl = dynamic_cast<const VarDeclStmt*>(streamed[1].get());
+    ASSERT_NE(decl, nullptr);
+    TestExprVisitor visitor;
+    decl->initializer()->accept(visitor);
+    EXPECT_EQ(visitor.result(), "(add(1, 2)*3)");
+}
+
+// 流式解析时词法错误从 parse_program 抛出
+TEST(ParserTest, StreamingParsePropagatesLexError) {
+    std::string source = "number x = 1;\nnumber y = 2 $ 3;\n";
+    Lexer lexer(source);
+    Parser parser(lexer);
+    EXPECT_THROW(parser.parse_program(), LexError);
+}
+
+// 最深的回看：自定义类型声明先 peek_next 看到第二个标识符，再 advance 后用
+// previous() 取回类型名；命名元组同样先看 ':' 再回取名字，出错恢复则沿 previous()
+// 回看分号。流式窗口须覆盖这些位置（调试构建下 TokenStream::at 断言），结果与批量解析一致
+TEST(ParserTest, StreamingParseReadsBackWithinWindow) {
+    std::string source =
+        "Point p = (x: 1, y: 2);\n"
+        "Point q;\n"
+        "Point r s;\n"
+        "number t = (a: p, q) + ;\n"
+        "Shape u = (1, (b: 2));\n";
+
+    Lexer batch_lexer(source);
+    std::vector<Token> tokens = batch_lexer.tokenize();
+    Parser batch_parser(tokens);
+    ParsedProgram batch = batch_parser.parse_program();
+
+    Lexer stream_lexer(source);
+    Parser stream_parser(stream_lexer);
+    ParsedProgram streamed = stream_parser.parse_program();
+
+    ASSERT_EQ(batch_parser.get_errors().size(), 2u);
+    ASSERT_EQ(stream_parser.get_errors().size(), batch_parser.get_errors().size());
+    for (size_t i = 0; i < batch_parser.get_errors().size(); ++i) {
+        EXPECT_STREQ(stream_parser.get_errors()[i].what(), batch_parser.get_errors()[i].what());
+        EXPECT_EQ(stream_parser.get_errors()[i].line(), batch_parser.get_errors()[i].line());
+    }
+    ASSERT_EQ(streamed.size(), batch.size());
+    EXPECT_EQ(streamed.context()->node_count(), batch.context()->node_count());
+
+    auto* decl = dynamic_cast<const VarDeclStmt*>(streamed[0].get());
+    ASSERT_NE(decl, nullptr);
+    EXPECT_EQ(decl->type().lexeme(), "Point");
+    EXPECT_EQ(decl->name().lexeme(), "p");
+}
+
+// 窗口边界：最新 token 之前 WINDOW - 1 个位置仍可读
+TEST(ParserTest, TokenStreamKeepsFullWindowBehindLatest) {
+    std::string source = "a b c d e f g h i j k l m n o p";
+    Lexer lexer(source);
+    AstContext context;
+    TokenStream stream(lexer, context);
+    for (size_t i = 0; i < 12; ++i) {
+        stream.at(i);
+    }
+    EXPECT_EQ(stream.pulled(), 12u);
+    EXPECT_EQ(stream.at(12 - TokenStream::WINDOW).lexeme(), "e");
+    EXPECT_EQ(stream.at(11).lexeme(), "l");
+    EXPECT_EQ(stream.at(13).lexeme(), "n");
+    EXPECT_EQ(stream.at(13 + 1 - TokenStream::WINDOW).lexeme(), "g");
+}
+
 #ifdef _WIN32
 void SetupWindowsConsole() {
     SetConsoleOutputCP(CP_UTF8);
@@ -18,7 +18,7 @@ using namespace collie;
 // 检查已由 SemanticErrorTest 的绿色用例覆盖）。
 
 // 辅助函数：解析源代码并返回AST
-std::vector<std::unique_ptr<Stmt>> parse(const std::string& source) {
+ParsedProgram parse(const std::string& source) {
     Lexer lexer(source);
     auto tokens = lexer.tokenize();
     Parser parser(tokens);
@@ -1005,3 +1005,193 @@ TEST(SemanticAnalyzerTest, DISABLED_ArrayElementTypeCheck) {
     EXPECT_TRUE(analyzer.has_errors());
 }
 
+
+// 静态类型表：只收录运行期值种类可确定的表达式，动态 object 与先声明后赋值的变量不收录
+TEST(SemanticAnalyzerTest, ExprTypeTableRecordsGuaranteedTypes) {
+    SemanticAnalyzer analyzer;
+    auto ast = parse(R"(
+        number a = 1;
+        number b;
+        b = 2;
+        object o = 3;
+        number c = a * 2 + 1;
+        number d = b + 1;
+        number e = o + 1;
+        string s = "n=" + o;
+        bool f = o > 1;
+    )");
+    analyzer.analyze(ast);
+    ASSERT_FALSE(analyzer.has_errors());
+
+    const ExprTypeTable& types = analyzer.expr_types();
+    auto initializer = [&](size_t index) {
+        auto* decl = dynamic_cast<const VarDeclStmt*>(ast[index].get());
+        return decl ? decl->initializer() : nullptr;
+    };
+    EXPECT_EQ(types.type_of(initializer(0)), TokenType::KW_INTEGER);
+    EXPECT_EQ(types.type_of(initializer(4)), TokenType::KW_NUMBER);
+    EXPECT_EQ(types.type_of(initializer(5)), TokenType::INVALID);
+    EXPECT_EQ(types.type_of(initializer(6)), TokenType::INVALID);
+    EXPECT_EQ(types.type_of(initializer(7)), TokenType::KW_STRING);
+    EXPECT_EQ(types.type_of(initializer(8)), TokenType::KW_BOOL);
+}
+
+// 符号表：内层遮蔽外层、退出作用域恢复外层、同一作用域内函数重载按后定义在前返回
+TEST(SemanticAnalyzerTest, SymbolTableShadowingAndOverloads) {
+    SymbolTable table;
+    Token number_type(TokenType::KW_NUMBER, "number", 1, 1);
+    Token string_type(TokenType::KW_STRING, "string", 1, 1);
+    Token x(TokenType::IDENTIFIER, "x", 1, 1);
+    Token f(TokenType::IDENTIFIER, "f", 1, 1);
+
+    table.define(Symbol(SymbolKind::VARIABLE, number_type, x, 0, true));
+    table.define(Symbol(SymbolKind::FUNCTION, number_type, f, 0, true));
+    table.define(Symbol(SymbolKind::FUNCTION, string_type, f, 0, true));
+
+    table.begin_scope();
+    EXPECT_FALSE(table.is_defined_in_current_scope("x"));
+    table.define(Symbol(SymbolKind::VARIABLE, string_type, x, 1, true));
+    ASSERT_NE(table.resolve("x"), nullptr);
+    EXPECT_EQ(table.resolve("x")->type.type(), TokenType::KW_STRING);
+    EXPECT_TRUE(table.is_defined_in_current_scope("x"));
+    EXPECT_EQ(table.resolve_overloads("f").size(), 2u);
+    table.end_scope();
+
+    ASSERT_NE(table.resolve("x"), nullptr);
+    EXPECT_EQ(table.resolve("x")->type.type(), TokenType::KW_NUMBER);
+    EXPECT_EQ(table.resolve(table.intern("x")), table.resolve("x"));
+    EXPECT_EQ(table.resolve("y"), nullptr);
+
+    std::vector<const Symbol*> overloads = table.resolve_overloads("f");
+    ASSERT_EQ(overloads.size(), 2u);
+    EXPECT_EQ(overloads[0]->type.type(), TokenType::KW_STRING);
+    EXPECT_EQ(overloads[1]->type.type(), TokenType::KW_NUMBER);
+}
+
+// 两阶段分析：顶层函数/类签名先登记，前向引用与相互递归合法；
+// 函数体仍只看得到声明之前的全局变量
+TEST(SemanticAnalyzerTest, ForwardReferencesToTopLevelDeclarations) {
+    SemanticAnalyzer analyzer;
+    auto ast = parse(R"(
+        print(isEven(4));
+        Shape s = new Shape();
+        function isEven(n number) bool {
+            if (n == 0) { return true; }
+            return isOdd(n - 1);
+        }
+        function isOdd(n number) bool {
+            if (n == 0) { return false; }
+            return isEven(n - 1);
+        }
+        class Shape {
+            public function twice(x number) number { return double(x); }
+        }
+        function double(x number) number { return x * 2; }
+    )");
+    analyzer.analyze(ast);
+    EXPECT_FALSE(analyzer.has_errors())
+        << (analyzer.has_errors() ? analyzer.get_errors().front().what() : "");
+
+    SemanticAnalyzer late_global;
+    auto ast2 = parse(R"(
+        function read() none { print(later); }
+        number later = 1;
+    )");
+    late_global.analyze(ast2);
+    ASSERT_EQ(late_global.get_errors().size(), 1u);
+    EXPECT_NE(std::string(late_global.get_errors()[0].what()).find("later"), std::string::npos);
+}
+
+// 函数体给全局变量赋值后，其后的读取不报未初始化（与顺序分析一致），其前的读取照报
+TEST(SemanticAnalyzerTest, GlobalAssignedInEarlierFunctionBody) {
+    for (size_t jobs : {1, 4}) {
+        SemanticAnalyzer analyzer;
+        analyzer.set_jobs(jobs);
+        auto ast = parse(R"(
+            number early;
+            number counter;
+            function peek() none { print(early); }
+            function reset() none { counter = 0; }
+            reset();
+            print(counter);
+            print(early);
+        )");
+        analyzer.analyze(ast);
+        ASSERT_EQ(analyzer.get_errors().size(), 2u) << "jobs=" << jobs;
+        EXPECT_EQ(analyzer.get_errors()[0].line(), 4u) << "jobs=" << jobs;
+        EXPECT_EQ(analyzer.get_errors()[1].line(), 8u) << "jobs=" << jobs;
+    }
+}
+
+// 前向引用让函数体/类体可能在所读全局变量初始化之前运行：这些体内不登记静态类型
+//（执行引擎照常检查 none），只在初始化之后才可能运行的体照常登记
+TEST(SemanticAnalyzerTest, EarlyRunningBodiesDropGlobalReadTypes) {
+    for (size_t jobs : {1, 4}) {
+        SemanticAnalyzer analyzer;
+        analyzer.set_jobs(jobs);
+        auto ast = parse(R"(
+            function h() number { return f(); }
+            print(h(), new Early().twice());
+            number g = 1;
+            function f() number { return g + 1; }
+            class Early { public function twice() number { return g * 2; } }
+            number k = 2;
+            function late() number { return k + 1; }
+            print(late());
+        )");
+        analyzer.analyze(ast);
+        ASSERT_FALSE(analyzer.has_errors()) << "jobs=" << jobs;
+
+        auto returned = [](const Stmt* stmt) {
+            auto* fn = dynamic_cast<const FunctionStmt*>(stmt);
+            auto* ret = dynamic_cast<const ReturnStmt*>(fn->body()->statements().front().get());
+            return ret->value();
+        };
+        auto* early = dynamic_cast<const ClassStmt*>(ast[4].get());
+        const ExprTypeTable& types = analyzer.expr_types();
+        EXPECT_EQ(types.type_of(returned(ast[3].get())), TokenType::INVALID) << "jobs=" << jobs;
+        EXPECT_EQ(types.type_of(returned(early->members().front().get())), TokenType::INVALID)
+            << "jobs=" << jobs;
+        EXPECT_EQ(types.type_of(returned(ast[6].get())), TokenType::KW_NUMBER) << "jobs=" << jobs;
+    }
+}
+
+// 函数体/类体并行检查：诊断按所属顶层语句的顺序合并，与线程数无关
+TEST(SemanticAnalyzerTest, ParallelDiagnosticsAreDeterministic) {
+    std::string source;
+    for (int i = 0; i < 64; ++i) {
+        std::string n = std::to_string(i);
+        source += "function f" + n + "(x number) number {\n";
+        source += "    string s = x > " + n + ";\n";
+        source += "    return g" + n + "(x);\n";
+        source += "}\n";
+        source += "bool top" + n + " = f" + n + "(1);\n";
+        source += "class C" + n + " { public function m() none { return undefined" + n + "; } }\n";
+    }
+    auto ast = parse(source);
+
+    auto messages = [&](size_t jobs) {
+        SemanticAnalyzer analyzer;
+        analyzer.set_jobs(jobs);
+        analyzer.analyze(ast);
+        std::vector<std::string> result;
+        for (const auto& error : analyzer.get_errors()) {
+            result.push_back(error.what());
+        }
+        return result;
+    };
+    std::vector<std::string> sequential = messages(1);
+    ASSERT_EQ(sequential.size(), 64u * 5);
+    EXPECT_EQ(messages(4), sequential);
+    EXPECT_EQ(messages(16), sequential);
+
+    SemanticAnalyzer analyzer;
+    analyzer.set_jobs(4);
+    analyzer.analyze(ast);
+    // 每组 6 行源码（函数 4 行、全局变量 1 行、类 1 行）各产生 5 条诊断
+    for (size_t i = 0; i < analyzer.get_errors().size(); ++i) {
+        size_t group = i / 5;
+        EXPECT_GT(analyzer.get_errors()[i].line(), group * 6);
+        EXPECT_LE(analyzer.get_errors()[i].line(), group * 6 + 6);
+    }
+}
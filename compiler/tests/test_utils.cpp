@@ -25,12 +25,17 @@ size_t getCurrentMemoryUsage() {
     return 0;  // 如果无法获取内存使用量
 }
 
-std::pair<std::vector<std::unique_ptr<Stmt>>, std::vector<Token>>
+std::pair<ParsedProgram, std::vector<Token>>
 parse_and_get_tokens(const std::string& source) {
     Lexer lexer(source);
     auto tokens = lexer.tokenize();
     Parser parser(tokens);
-    return {parser.parse_program(), tokens};
+    ParsedProgram program = parser.parse_program();
+    // Lexer 在返回时销毁：把 tokens 的词素转到 AST 上下文里
+    for (Token& token : tokens) {
+        token = program.context()->intern(token);
+    }
+    return {std::move(program), std::move(tokens)};
 }
 
 } // namespace test
@@ -35,9 +35,9 @@ size_t getCurrentMemoryUsage();
 /**
  * @brief 解析源代码并返回AST和tokens
  * @param source 源代码字符串
- * @return 包含AST和tokens的pair
+ * @return 包含AST和tokens的pair（tokens 的词素驻留在 AST 上下文中，与 AST 同寿命）
  */
-std::pair<std::vector<std::unique_ptr<Stmt>>, std::vector<Token>>
+std::pair<ParsedProgram, std::vector<Token>>
 parse_and_get_tokens(const std::string& source);
 
 } // namespace test
@@ -0,0 +1,41 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 线性（bump）分配器实现
+ */
+#include "arena.h"
+
+#include <cstdint>
+
+namespace collie {
+
+void* Arena::allocate(size_t size, size_t align) {
+    if (size == 0) size = 1;
+
+    // 大对象单独成块，不移动当前块的游标，其剩余空间留给后续小对象
+    if (size > block_size_ / 4) {
+        bytes_used_ += size;
+        return new_block(size);
+    }
+
+    auto addr = reinterpret_cast<uintptr_t>(cursor_);
+    size_t padding = (align - (addr & (align - 1))) & (align - 1);
+    if (cursor_ == nullptr || padding + size > static_cast<size_t>(limit_ - cursor_)) {
+        cursor_ = new_block(block_size_);
+        limit_ = cursor_ + block_size_;
+        padding = 0;  // new[] 返回的块按 max_align_t 对齐
+    }
+
+    char* result = cursor_ + padding;
+    cursor_ = result + size;
+    bytes_used_ += padding + size;
+    return result;
+}
+
+char* Arena::new_block(size_t size) {
+    blocks_.push_back(std::unique_ptr<char[]>(new char[size]));
+    bytes_reserved_ += size;
+    return blocks_.back().get();
+}
+
+} // namespace collie
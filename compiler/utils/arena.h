@@ -0,0 +1,58 @@
+/*
+ * @Author: Zhang Bokai <zbrook@126.com>
+ * @Date: 2026-10-16
+ * @Description: 线性（bump）分配器：按块向前切分内存，整体一次释放
+ */
+#ifndef COLLIE_ARENA_H
+#define COLLIE_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace collie {
+
+/**
+ * @brief 线性分配器
+ *
+ * 分配只是在当前块内移动游标，不记录单个对象，也不支持单独释放；
+ * 析构时把所有块一次性归还。放入其中的对象由使用方负责调用析构函数
+ * （见 AstContext）。超过块大小四分之一的请求单独占一块，避免浪费当前块的剩余空间。
+ */
+class Arena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) noexcept = default;
+    Arena& operator=(Arena&&) noexcept = default;
+
+    /**
+     * @brief 分配 size 字节、按 align 对齐的未初始化内存
+     * @param align 必须是 2 的幂，且不超过 alignof(std::max_align_t)
+     */
+    void* allocate(size_t size, size_t align);
+
+    /// @brief 已向系统申请的总字节数
+    size_t bytes_reserved() const { return bytes_reserved_; }
+
+    /// @brief 已分配给调用方的总字节数（含对齐填充）
+    size_t bytes_used() const { return bytes_used_; }
+
+private:
+    char* new_block(size_t size);
+
+    size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;  ///< 当前块下一个空闲字节
+    char* limit_ = nullptr;   ///< 当前块末尾
+    size_t bytes_reserved_ = 0;
+    size_t bytes_used_ = 0;
+};
+
+} // namespace collie
+
+#endif // COLLIE_ARENA_H